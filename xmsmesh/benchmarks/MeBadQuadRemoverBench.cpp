@@ -0,0 +1,93 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \brief Benchmark of the time to remove bad quads from a quad mesh.
+/// \ingroup meshing
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/benchmarks/MeBenchmarks.h>
+
+// 3. Standard library headers
+#include <sstream>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/points/pt.h>
+#include <xmscore/stl/vector.h>
+#include <xmsgrid/ugrid/XmUGrid.h>
+#include <xmsmesh/meshing/detail/MeBadQuadRemover.h>
+#include <xmsmesh/meshing/detail/MeQuadBlossom.h>
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+namespace
+{
+//------------------------------------------------------------------------------
+/// \brief Creates a UGrid of quads by splitting each triangle of a grid of
+/// cells split into 2 triangles into 3 quads. Every triangle center becomes a
+/// point with 3 adjacent cells.
+/// \param[in] a_size: The number of points in each direction.
+/// \return The UGrid.
+//------------------------------------------------------------------------------
+BSHP<XmUGrid> iSplitQuadGrid(int a_size)
+{
+  VecPt3d points;
+  VecInt cells;
+  meBenchJiggledGrid(a_size, points, cells);
+  return MeQuadBlossom::SplitToQuads(XmUGrid::New(points, cells));
+} // iSplitQuadGrid
+} // unnamed namespace
+
+//----- Class / Function definitions -------------------------------------------
+
+//------------------------------------------------------------------------------
+/// \brief Times MeBadQuadRemover::RemoveBadQuads on quad meshes with many
+/// collapsible quads using one thread and all of the cores.
+//------------------------------------------------------------------------------
+void benchBadQuadRemover()
+{
+  const int sizes[] = {100, 300};
+  const int threads[] = {1, 0};
+  for (int size : sizes)
+  {
+    BSHP<XmUGrid> ugrid = iSplitQuadGrid(size);
+    for (int numThreads : threads)
+    {
+      BSHP<XmUGrid> removed;
+      double seconds = meBenchSeconds(
+        [&]() {
+          BSHP<MeBadQuadRemover> remover = MeBadQuadRemover::New(ugrid);
+          remover->SetNumThreads(numThreads);
+          removed = remover->RemoveBadQuads(0.7);
+        },
+        1);
+
+      std::stringstream ss;
+      ss << ugrid->GetCellCount() << " cells, " << (numThreads ? "1 thread" : "all threads")
+         << ", " << removed->GetCellCount() << " left";
+      meBenchReport("bad_quad_remover", ss.str(), seconds);
+    }
+  }
+} // benchBadQuadRemover
+
+} // namespace xms
@@ -0,0 +1,216 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \brief Runs the benchmarks for the meshing library.
+///
+/// Usage: xmsmesh_bench [benchmark name ...]
+/// With no arguments all of the benchmarks are run.
+/// \ingroup meshing
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/benchmarks/MeBenchmarks.h>
+
+// 3. Standard library headers
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/points/pt.h>
+#include <xmsgrid/ugrid/XmUGrid.h>
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+namespace
+{
+std::atomic<long long> g_allocations(0); ///< number of calls to operator new
+} // unnamed namespace
+
+//----- Class / Function definitions -------------------------------------------
+
+//------------------------------------------------------------------------------
+/// \brief Times a function.
+/// \param[in] a_func: The function to time.
+/// \param[in] a_repeat: Number of times to call the function.
+/// \return The fastest time in seconds.
+//------------------------------------------------------------------------------
+double meBenchSeconds(std::function<void()> a_func, int a_repeat)
+{
+  double best(-1);
+  for (int i = 0; i < a_repeat; ++i)
+  {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    a_func();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (best < 0 || elapsed.count() < best)
+      best = elapsed.count();
+  }
+  return best;
+} // meBenchSeconds
+//------------------------------------------------------------------------------
+/// \brief Writes the time of a benchmark case to stdout.
+/// \param[in] a_bench: The name of the benchmark.
+/// \param[in] a_case: The name of the case.
+/// \param[in] a_seconds: The time in seconds.
+//------------------------------------------------------------------------------
+void meBenchReport(const std::string& a_bench, const std::string& a_case, double a_seconds)
+{
+  printf("%-24s %-40s %12.6f s\n", a_bench.c_str(), a_case.c_str(), a_seconds);
+  fflush(stdout);
+} // meBenchReport
+//------------------------------------------------------------------------------
+/// \brief Returns the number of heap allocations made with operator new
+/// since the benchmarks started. Subtract 2 values to count the allocations
+/// made by a piece of code.
+/// \return The number of allocations.
+//------------------------------------------------------------------------------
+long long meBenchAllocations()
+{
+  return g_allocations;
+} // meBenchAllocations
+//------------------------------------------------------------------------------
+/// \brief Creates a grid of cells split into 2 triangles with the interior
+/// points moved a little. It is the grid of tutJiggledGrid, which is only
+/// built with the unit tests, as a UGrid cell stream.
+/// \param[in] a_size: The number of points in each direction.
+/// \param[out] a_points: The points, 10 apart before they are moved.
+/// \param[out] a_cells: The triangles as a UGrid cell stream.
+//------------------------------------------------------------------------------
+void meBenchJiggledGrid(int a_size, VecPt3d& a_points, VecInt& a_cells)
+{
+  a_points.clear();
+  for (int i = 0; i < a_size; ++i)
+  {
+    for (int j = 0; j < a_size; ++j)
+    {
+      bool boundary = i == 0 || j == 0 || i == a_size - 1 || j == a_size - 1;
+      double dx = boundary ? 0 : ((i * 7 + j * 3) % 5 - 2) * 0.8;
+      double dy = boundary ? 0 : ((i * 3 + j * 5) % 5 - 2) * 0.8;
+      a_points.push_back(Pt3d(j * 10.0 + dx, i * 10.0 + dy, 0));
+    }
+  }
+  a_cells.clear();
+  for (int i = 0; i < a_size - 1; ++i)
+  {
+    for (int j = 0; j < a_size - 1; ++j)
+    {
+      int p0 = i * a_size + j;
+      int tris[] = {XMU_TRIANGLE, 3, p0, p0 + 1,      p0 + a_size + 1,
+                    XMU_TRIANGLE, 3, p0, p0 + a_size + 1, p0 + a_size};
+      a_cells.insert(a_cells.end(), &tris[0], &tris[10]);
+    }
+  }
+} // meBenchJiggledGrid
+
+} // namespace xms
+
+//------------------------------------------------------------------------------
+/// \brief Replaces the global operator new to count the allocations.
+/// \param[in] a_size: Number of bytes to allocate.
+/// \return The allocated memory.
+//------------------------------------------------------------------------------
+void* operator new(std::size_t a_size)
+{
+  ++xms::g_allocations;
+  void* p = malloc(a_size ? a_size : 1);
+  if (!p)
+    throw std::bad_alloc();
+  return p;
+} // operator new
+//------------------------------------------------------------------------------
+/// \brief Replaces the global operator new[] to count the allocations.
+/// \param[in] a_size: Number of bytes to allocate.
+/// \return The allocated memory.
+//------------------------------------------------------------------------------
+void* operator new[](std::size_t a_size)
+{
+  return operator new(a_size);
+} // operator new[]
+//------------------------------------------------------------------------------
+/// \brief Replaces the global operator delete to match operator new.
+/// \param[in] a_p: The memory to free.
+//------------------------------------------------------------------------------
+void operator delete(void* a_p) throw()
+{
+  free(a_p);
+} // operator delete
+//------------------------------------------------------------------------------
+/// \brief Replaces the global operator delete[] to match operator new[].
+/// \param[in] a_p: The memory to free.
+//------------------------------------------------------------------------------
+void operator delete[](void* a_p) throw()
+{
+  free(a_p);
+} // operator delete[]
+
+//------------------------------------------------------------------------------
+/// \brief Runs the benchmarks named on the command line or all of them.
+/// \param[in] argc: Number of arguments.
+/// \param[in] argv: The arguments.
+/// \return 0 if successful.
+//------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+  struct Benchmark
+  {
+    const char* m_name;
+    void (*m_func)();
+  };
+  const Benchmark benchmarks[] = {
+    {"bad_quad_remover", &xms::benchBadQuadRemover},
+    {"clean_poly_offset", &xms::benchCleanPolyOffset},
+    {"incremental_mesh", &xms::benchIncrementalMesh},
+    {"intersect_segs", &xms::benchIntersectSegs},
+    {"point_weld_index", &xms::benchPointWeldIndex},
+    {"quad_blossom", &xms::benchQuadBlossom},
+    {"quad_mesh", &xms::benchQuadMesh},
+    {"size_from_poly", &xms::benchSizeFromPoly},
+    {"weight_matcher", &xms::benchWeightMatcher},
+  };
+
+  int ran(0);
+  for (const Benchmark& b : benchmarks)
+  {
+    bool run = argc < 2;
+    for (int i = 1; !run && i < argc; ++i)
+      run = strcmp(argv[i], b.m_name) == 0;
+    if (run)
+    {
+      b.m_func();
+      ++ran;
+    }
+  }
+  if (ran == 0)
+  {
+    printf("Unknown benchmark. Available benchmarks:\n");
+    for (const Benchmark& b : benchmarks)
+      printf("  %s\n", b.m_name);
+    return 1;
+  }
+  return 0;
+} // main
@@ -0,0 +1,45 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file
+/// \brief Benchmarks for the meshing library. Built when BUILD_BENCHMARKS is
+/// on.
+/// \ingroup meshing
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 3. Standard library headers
+#include <functional>
+#include <string>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/stl/vector.h>
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Function prototypes ----------------------------------------------------
+
+double meBenchSeconds(std::function<void()> a_func, int a_repeat = 3);
+void meBenchReport(const std::string& a_bench, const std::string& a_case, double a_seconds);
+long long meBenchAllocations();
+void meBenchJiggledGrid(int a_size, VecPt3d& a_points, VecInt& a_cells);
+
+void benchBadQuadRemover();
+void benchCleanPolyOffset();
+void benchIncrementalMesh();
+void benchIntersectSegs();
+void benchPointWeldIndex();
+void benchQuadBlossom();
+void benchQuadMesh();
+void benchSizeFromPoly();
+void benchWeightMatcher();
+
+} // namespace xms
@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \brief Benchmark of the time and heap allocations of cleaning an offset polygon.
+/// \ingroup meshing
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/benchmarks/MeBenchmarks.h>
+
+// 3. Standard library headers
+#include <cmath>
+#include <sstream>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/math/math.h>
+#include <xmscore/misc/XmError.h>
+#include <xmscore/points/pt.h>
+#include <xmsmesh/meshing/detail/MePolyCleaner.h>
+#include <xmsmesh/meshing/detail/MePolyOffsetter.h>
+#include <xmsmesh/meshing/detail/MePolyPts.h>
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+namespace
+{
+//------------------------------------------------------------------------------
+/// \brief Counts the places where a closed line crosses itself, found the same
+/// way MePolyCleaner::CleanPolyOffset finds them.
+/// \param[in] a_line: The closed line.
+/// \return The number of crossings.
+//------------------------------------------------------------------------------
+int iNumCrossings(const std::vector<Pt3d>& a_line)
+{
+  MePolyPts polyPts;
+  polyPts.XyTol() = 1e-9;
+  polyPts.Pts() = a_line;
+  std::vector<size_t> segs(polyPts.SegmentsForCleanPolyOffset());
+  polyPts.IntersectSegs(segs);
+  // each crossing is added to the sequence once for each of its 2 segments
+  return (int)(polyPts.SequenceWithIntersects(segs).size() - segs.size()) / 2;
+} // iNumCrossings
+} // unnamed namespace
+
+//----- Class / Function definitions -------------------------------------------
+
+//------------------------------------------------------------------------------
+/// \brief Times MePolyCleaner::CleanPolyOffset on closed lines that cross
+/// themselves many times and reports the number of heap allocations per call.
+///
+/// The lines are like the offset of a polygon with a tight zig-zag: a circle
+/// with a small loop every 20 points, each crossing the line once.
+//------------------------------------------------------------------------------
+void benchCleanPolyOffset()
+{
+  const int sizes[] = {200, 1000, 5000};
+  for (int numPts : sizes)
+  {
+    // a point turning numTurns times around a point going once around the
+    // circle makes numTurns - 1 loops. They cross the line when the loop
+    // radius times numTurns is more than the circle radius.
+    int numTurns = numPts / 20 + 1;
+    double loopRadius = 20.0 / numTurns;
+    std::vector<Pt3d> input;
+    for (int i = 0; i < numPts; ++i)
+    {
+      double a = -2 * XM_PI * i / numPts;
+      input.push_back(Pt3d(10 * cos(a) + loopRadius * cos(numTurns * a),
+                           10 * sin(a) + loopRadius * sin(numTurns * a), 0));
+    }
+    int crossings = iNumCrossings(input);
+    XM_ASSERT(crossings == numTurns - 1);
+
+    BSHP<MePolyCleaner> cleaner = MePolyCleaner::New();
+    MePolyOffsetterOutput out;
+    long long allocations = meBenchAllocations();
+    cleaner->CleanPolyOffset(input, MePolyOffsetter::OUTSIDE_POLY, 1e-9, out);
+    allocations = meBenchAllocations() - allocations;
+    double seconds = meBenchSeconds(
+      [&]() { cleaner->CleanPolyOffset(input, MePolyOffsetter::OUTSIDE_POLY, 1e-9, out); });
+
+    std::stringstream ss;
+    ss << numPts << " pts, " << crossings << " crossings, " << out.m_loops.size() << " loops, "
+       << allocations << " allocs";
+    meBenchReport("clean_poly_offset", ss.str(), seconds);
+  }
+} // benchCleanPolyOffset
+
+} // namespace xms
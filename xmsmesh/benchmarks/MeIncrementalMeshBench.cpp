@@ -0,0 +1,123 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \brief Benchmark of meshing many polygons again after one of them changes
+/// with and without reusing the meshes of the polygons that did not change.
+/// \ingroup meshing
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/benchmarks/MeBenchmarks.h>
+
+// 3. Standard library headers
+#include <sstream>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/points/pt.h>
+#include <xmsmesh/meshing/MeMultiPolyMesher.h>
+#include <xmsmesh/meshing/MeMultiPolyMesherIo.h>
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+namespace
+{
+//------------------------------------------------------------------------------
+/// \brief Creates the input for a grid of square polygons with 10 segments on
+/// each side.
+/// \param[in] a_columns: The number of polygons in x.
+/// \param[in] a_rows: The number of polygons in y.
+/// \param[out] a_io: The mesher io.
+//------------------------------------------------------------------------------
+void iPolygonGrid(int a_columns, int a_rows, MeMultiPolyMesherIo& a_io)
+{
+  a_io.m_polys.clear();
+  for (int i = 0; i < a_rows; ++i)
+  {
+    for (int j = 0; j < a_columns; ++j)
+    {
+      double x0 = j * 100.0, y0 = i * 100.0;
+      MePolyInput poly;
+      for (int k = 0; k < 10; ++k)
+        poly.m_outPoly.push_back(Pt3d(x0, y0 + k * 10.0, 0));
+      for (int k = 0; k < 10; ++k)
+        poly.m_outPoly.push_back(Pt3d(x0 + k * 10.0, y0 + 100.0, 0));
+      for (int k = 10; k > 0; --k)
+        poly.m_outPoly.push_back(Pt3d(x0 + 100.0, y0 + k * 10.0, 0));
+      for (int k = 10; k > 0; --k)
+        poly.m_outPoly.push_back(Pt3d(x0 + k * 10.0, y0, 0));
+      a_io.m_polys.push_back(poly);
+    }
+  }
+} // iPolygonGrid
+} // unnamed namespace
+
+//----- Class / Function definitions -------------------------------------------
+
+//------------------------------------------------------------------------------
+/// \brief Times meshing a grid of 300 polygons, then meshing it again after
+/// changing the bias of one polygon with all of the polygons meshed and with
+/// MeMultiPolyMesherIo::m_incremental.
+//------------------------------------------------------------------------------
+void benchIncrementalMesh()
+{
+  MeMultiPolyMesherIo input;
+  iPolygonGrid(20, 15, input);
+  std::stringstream ss;
+  ss << input.m_polys.size() << " polys, ";
+
+  BSHP<MeMultiPolyMesher> mesher = MeMultiPolyMesher::New();
+  MeMultiPolyMesherIo io;
+  size_t numPoints(0);
+  double seconds = meBenchSeconds(
+    [&]() {
+      io = input;
+      io.m_incremental = true;
+      mesher->MeshIt(io);
+      numPoints = io.m_points.size();
+    },
+    1);
+  meBenchReport("incremental_mesh", ss.str() + "first mesh", seconds);
+
+  input.m_polys[input.m_polys.size() / 2].m_bias = 0.5;
+  seconds = meBenchSeconds(
+    [&]() {
+      io = input;
+      MeMultiPolyMesher::New()->MeshIt(io);
+    },
+    1);
+  meBenchReport("incremental_mesh", ss.str() + "1 edit, all polys", seconds);
+
+  size_t numEditedPoints(0);
+  seconds = meBenchSeconds(
+    [&]() {
+      io = input;
+      io.m_incremental = true;
+      mesher->MeshIt(io);
+      numEditedPoints = io.m_points.size();
+    },
+    1);
+  ss << "1 edit, incremental, " << numPoints << " -> " << numEditedPoints << " pts";
+  meBenchReport("incremental_mesh", ss.str(), seconds);
+} // benchIncrementalMesh
+
+} // namespace xms
@@ -0,0 +1,98 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \brief Benchmark of intersecting the segments of an offset polygon with itself.
+/// \ingroup meshing
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/benchmarks/MeBenchmarks.h>
+
+// 3. Standard library headers
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/math/math.h>
+#include <xmscore/points/pt.h>
+#include <xmsmesh/meshing/detail/MePolyPts.h>
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+
+//----- Class / Function definitions -------------------------------------------
+
+//------------------------------------------------------------------------------
+/// \brief Times MePolyPts::IntersectSegs checking every pair of segments and
+/// using the grid of segment envelopes for increasing numbers of segments and
+/// reports the smallest size where the grid is faster. The line is a star
+/// shape that crosses itself like a poorly behaved offset polygon.
+//------------------------------------------------------------------------------
+void benchIntersectSegs()
+{
+  const int sizes[] = {16, 32, 48, 64, 96, 128, 256, 512, 1024, 4096, 16384};
+  int crossover(-1);
+  for (int numPts : sizes)
+  {
+    std::vector<Pt3d> input;
+    for (int i = 0; i < numPts; ++i)
+    {
+      double a = 2 * XM_PI * i / numPts;
+      double r = 10 + 2 * sin((numPts / 8 + 1) * a);
+      input.push_back(Pt3d(r * cos(a), r * sin(a), 0));
+    }
+    // repeat the calls so that the small cases take a measurable time
+    int repeat = std::max(1, 20000 / numPts);
+
+    double seconds[2];
+    const size_t thresholds[2] = {std::numeric_limits<size_t>::max(), 0};
+    const char* names[2] = {"all pairs", "grid"};
+    for (int engine = 0; engine < 2; ++engine)
+    {
+      seconds[engine] = meBenchSeconds([&]() {
+        for (int r = 0; r < repeat; ++r)
+        {
+          MePolyPts polyPts;
+          polyPts.Pts() = input;
+          polyPts.IntersectSegsGridThreshold() = thresholds[engine];
+          std::vector<size_t> segs(polyPts.SegmentsForCleanPolyOffset());
+          polyPts.IntersectSegs(segs);
+        }
+      }) / repeat;
+      std::stringstream ss;
+      ss << numPts << " segs, " << names[engine];
+      meBenchReport("intersect_segs", ss.str(), seconds[engine]);
+    }
+    if (crossover < 0 && seconds[1] < seconds[0])
+      crossover = numPts;
+  }
+
+  std::stringstream ss;
+  ss << "crossover at " << crossover << " segs (threshold "
+     << MePolyPts().IntersectSegsGridThreshold() << ")";
+  meBenchReport("intersect_segs", ss.str(), 0);
+} // benchIntersectSegs
+
+} // namespace xms
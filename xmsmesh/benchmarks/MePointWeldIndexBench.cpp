@@ -0,0 +1,149 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \brief Benchmark of merging the boundary points of neighboring polygon
+/// meshes with a hash map of every point and with MePointWeldIndex.
+/// \ingroup meshing
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/benchmarks/MeBenchmarks.h>
+
+// 3. Standard library headers
+#include <sstream>
+#include <utility>
+
+// 4. External library headers
+#include <boost/unordered_map.hpp>
+
+// 5. Shared code headers
+#include <xmscore/points/pt.h>
+#include <xmscore/stl/vector.h>
+#include <xmsmesh/meshing/detail/MePointWeldIndex.h>
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+namespace
+{
+//------------------------------------------------------------------------------
+/// \brief Makes the points of a row of square polygon meshes. Neighboring
+/// polygons share the points on their common edge.
+/// \param[in] a_numPolys: The number of polygons.
+/// \param[in] a_size: The number of points on each side of a polygon.
+/// \param[out] a_polyPts: The points of each polygon.
+/// \param[out] a_boundaryPts: The indices of the boundary points of each
+/// polygon.
+//------------------------------------------------------------------------------
+void iPolyMeshPoints(int a_numPolys, int a_size, VecPt3d2d& a_polyPts, VecInt2d& a_boundaryPts)
+{
+  a_polyPts.assign(a_numPolys, VecPt3d());
+  a_boundaryPts.assign(a_numPolys, VecInt());
+  for (int p = 0; p < a_numPolys; ++p)
+  {
+    for (int i = 0; i < a_size; ++i)
+    {
+      for (int j = 0; j < a_size; ++j)
+      {
+        if (i == 0 || j == 0 || i == a_size - 1 || j == a_size - 1)
+          a_boundaryPts[p].push_back((int)a_polyPts[p].size());
+        a_polyPts[p].push_back(Pt3d((p * (a_size - 1) + j) * 0.1, i * 0.1, 0));
+      }
+    }
+  }
+} // iPolyMeshPoints
+} // unnamed namespace
+
+//----- Class / Function definitions -------------------------------------------
+
+//------------------------------------------------------------------------------
+/// \brief Times merging the points of polygon meshes by hashing every point
+/// as MeMultiPolyMesher used to and by putting only the boundary points in a
+/// MePointWeldIndex, and reports the number of heap allocations of each.
+//------------------------------------------------------------------------------
+void benchPointWeldIndex()
+{
+  const int numPolys = 20;
+  const int sizes[] = {100, 300};
+  for (int size : sizes)
+  {
+    VecPt3d2d polyPts;
+    VecInt2d boundaryPts;
+    iPolyMeshPoints(numPolys, size, polyPts, boundaryPts);
+
+    size_t numPts(0);
+    long long allocations(0);
+    double seconds = meBenchSeconds([&]() {
+      allocations = meBenchAllocations();
+      boost::unordered_map<std::pair<double, double>, int> ptHash;
+      numPts = 0;
+      for (const VecPt3d& pts : polyPts)
+      {
+        for (const Pt3d& pt : pts)
+        {
+          if (ptHash.insert(std::make_pair(std::make_pair(pt.x, pt.y), (int)numPts)).second)
+            ++numPts;
+        }
+      }
+      allocations = meBenchAllocations() - allocations;
+    });
+    std::stringstream ss;
+    ss << numPts << " pts, unordered_map, " << allocations << " allocs";
+    meBenchReport("point_weld_index", ss.str(), seconds);
+
+    const double tols[] = {0.0, 1e-6};
+    for (double tol : tols)
+    {
+      seconds = meBenchSeconds([&]() {
+        allocations = meBenchAllocations();
+        MePointWeldIndex index;
+        index.SetTolerance(tol);
+        numPts = 0;
+        for (size_t p = 0; p < polyPts.size(); ++p)
+        {
+          const VecPt3d& pts = polyPts[p];
+          const VecInt& boundary = boundaryPts[p];
+          index.Reserve(index.Size() + boundary.size());
+          VecInt dups;
+          for (int b : boundary)
+          {
+            if (index.Find(pts[b]) != -1)
+              dups.push_back(b);
+          }
+          size_t dup = 0;
+          for (int b : boundary)
+          {
+            if (dup < dups.size() && dups[dup] == b)
+              ++dup;
+            else
+              index.Add(pts[b], (int)(numPts + b));
+          }
+          numPts += pts.size() - dups.size();
+        }
+        allocations = meBenchAllocations() - allocations;
+      });
+      ss.str("");
+      ss << numPts << " pts, tolerance " << tol << ", " << allocations << " allocs";
+      meBenchReport("point_weld_index", ss.str(), seconds);
+    }
+  }
+} // benchPointWeldIndex
+
+} // namespace xms
@@ -0,0 +1,149 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \brief Benchmark of the quality and time of converting triangles to quads
+/// with and without subdomains and with approximate matching.
+/// \ingroup meshing
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/benchmarks/MeBenchmarks.h>
+
+// 3. Standard library headers
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/math/math.h>
+#include <xmscore/points/pt.h>
+#include <xmscore/stl/vector.h>
+#include <xmsgrid/ugrid/XmUGrid.h>
+#include <xmsmesh/meshing/detail/MeQuadBlossom.h>
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+namespace
+{
+//------------------------------------------------------------------------------
+/// \brief Computes the mean quality of the quads and counts the triangles of a
+/// UGrid. The quality of a quad is 1 for a rectangle and goes to 0 as its
+/// worst angle goes to 0 or 180 degrees.
+/// \param[in] a_ugrid: The UGrid.
+/// \param[out] a_numTriangles: The number of triangles.
+/// \return The mean quad quality.
+//------------------------------------------------------------------------------
+double iMeanQuadQuality(BSHP<XmUGrid> a_ugrid, int& a_numTriangles)
+{
+  const VecPt3d& points = a_ugrid->GetLocations();
+  double total(0.0);
+  int numQuads(0);
+  a_numTriangles = 0;
+  for (int c = 0; c < a_ugrid->GetCellCount(); ++c)
+  {
+    VecInt cell = a_ugrid->GetCellPoints(c);
+    if (cell.size() != 4)
+    {
+      ++a_numTriangles;
+      continue;
+    }
+    double worst(0.0);
+    for (int i = 0; i < 4; ++i)
+    {
+      const Pt3d& p0 = points[cell[(i + 3) % 4]];
+      const Pt3d& p1 = points[cell[i]];
+      const Pt3d& p2 = points[cell[(i + 1) % 4]];
+      double a = atan2(p0.y - p1.y, p0.x - p1.x) - atan2(p2.y - p1.y, p2.x - p1.x);
+      a = fabs(remainder(a, 2 * XM_PI));
+      worst = std::max(worst, fabs(a - XM_PI / 2));
+    }
+    total += 1.0 - worst / (XM_PI / 2);
+    ++numQuads;
+  }
+  return numQuads ? total / numQuads : 0.0;
+} // iMeanQuadQuality
+} // unnamed namespace
+
+//----- Class / Function definitions -------------------------------------------
+
+//------------------------------------------------------------------------------
+/// \brief Times MeQuadBlossom::MakeQuads on triangulated grids matching all of
+/// the triangles at once, in subdomains and with the approximate matcher, and
+/// reports the quad quality and the triangles left. Meshes too big to match at
+/// once are only done in subdomains.
+//------------------------------------------------------------------------------
+void benchQuadBlossom()
+{
+  const int sizes[] = {30, 45, 100};
+  const int subdomains[] = {1, 4, 16, 64};
+  for (int size : sizes)
+  {
+    VecPt3d points;
+    VecInt cells;
+    meBenchJiggledGrid(size, points, cells);
+    BSHP<XmUGrid> ugrid = XmUGrid::New(points, cells);
+    int numPoints = ugrid->GetPointCount();
+    for (int numSubdomains : subdomains)
+    {
+      if (numSubdomains < MeQuadBlossom::NumSubdomainsForRunTime(numPoints, 1.0))
+        continue;
+
+      BSHP<XmUGrid> quads;
+      double seconds = meBenchSeconds(
+        [&]() {
+          BSHP<MeQuadBlossom> blossom = MeQuadBlossom::New(ugrid);
+          blossom->SetNumSubdomains(numSubdomains);
+          blossom->SetNumThreads(0);
+          quads = blossom->MakeQuads(true, false);
+        },
+        1);
+
+      int numTriangles(0);
+      double quality = iMeanQuadQuality(quads, numTriangles);
+      std::stringstream ss;
+      ss << numPoints << " pts, " << numSubdomains << " subdomains, quality " << quality
+         << ", " << numTriangles << " tris";
+      meBenchReport("quad_blossom", ss.str(), seconds);
+    }
+
+    BSHP<XmUGrid> quads;
+    double weight(0.0), upperBound(0.0);
+    double seconds = meBenchSeconds(
+      [&]() {
+        BSHP<MeQuadBlossom> blossom = MeQuadBlossom::New(ugrid);
+        blossom->SetApproximateMatching(true);
+        quads = blossom->MakeQuads(true, false);
+        blossom->GetMatchingWeight(weight, upperBound);
+      },
+      1);
+
+    int numTriangles(0);
+    double quality = iMeanQuadQuality(quads, numTriangles);
+    std::stringstream ss;
+    ss << numPoints << " pts, approximate, quality " << quality << ", " << numTriangles
+       << " tris, weight/bound " << (upperBound > 0.0 ? weight / upperBound : 1.0);
+    meBenchReport("quad_blossom", ss.str(), seconds);
+  }
+} // benchQuadBlossom
+
+} // namespace xms
@@ -0,0 +1,91 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \brief Benchmark of turning a triangle mesh into a cleaned quad mesh with
+/// and without building UGrids between the steps.
+/// \ingroup meshing
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/benchmarks/MeBenchmarks.h>
+
+// 3. Standard library headers
+#include <sstream>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/points/pt.h>
+#include <xmscore/stl/vector.h>
+#include <xmsgrid/ugrid/XmUGrid.h>
+#include <xmsmesh/meshing/MeMeshUtils.h>
+#include <xmsmesh/meshing/MeMultiPolyMesherIo.h>
+#include <xmsmesh/meshing/detail/MeBadQuadRemover.h>
+#include <xmsmesh/meshing/detail/MeQuadBlossom.h>
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+
+//----- Class / Function definitions -------------------------------------------
+
+//------------------------------------------------------------------------------
+/// \brief Times going from mesher output to a cleaned quad mesh with a UGrid
+/// built for each of MeQuadBlossom and MeBadQuadRemover and with
+/// meMakeQuadMesh, and reports the number of heap allocations of each.
+//------------------------------------------------------------------------------
+void benchQuadMesh()
+{
+  const int sizes[] = {30, 45};
+  for (int size : sizes)
+  {
+    MeMultiPolyMesherIo io;
+    long long allocations(0);
+    double seconds = meBenchSeconds(
+      [&]() {
+        meBenchJiggledGrid(size, io.m_points, io.m_cells);
+        allocations = meBenchAllocations();
+        BSHP<XmUGrid> triangles = XmUGrid::New(io.m_points, io.m_cells);
+        BSHP<XmUGrid> quads = MeQuadBlossom::New(triangles)->MakeQuads(true, false);
+        BSHP<XmUGrid> removed = MeBadQuadRemover::New(quads)->RemoveBadQuads(0.7);
+        io.m_points = removed->GetLocations();
+        io.m_cells = removed->GetCellstream();
+        allocations = meBenchAllocations() - allocations;
+      },
+      1);
+    std::stringstream ss;
+    ss << size * size << " pts, ugrids, " << allocations << " allocs";
+    meBenchReport("quad_mesh", ss.str(), seconds);
+
+    seconds = meBenchSeconds(
+      [&]() {
+        meBenchJiggledGrid(size, io.m_points, io.m_cells);
+        allocations = meBenchAllocations();
+        meMakeQuadMesh(io, 0.7, true, false);
+        allocations = meBenchAllocations() - allocations;
+      },
+      1);
+    ss.str("");
+    ss << size * size << " pts, fused, " << allocations << " allocs";
+    meBenchReport("quad_mesh", ss.str(), seconds);
+  }
+} // benchQuadMesh
+
+} // namespace xms
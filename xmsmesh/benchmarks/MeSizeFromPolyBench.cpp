@@ -0,0 +1,95 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \brief Benchmark of the size function created from the polygon spacing.
+/// \ingroup meshing
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/benchmarks/MeBenchmarks.h>
+
+// 3. Standard library headers
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/math/math.h>
+#include <xmscore/points/pt.h>
+#include <xmscore/stl/vector.h>
+#include <xmsmesh/meshing/MePolyRedistributePts.h>
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+
+//----- Class / Function definitions -------------------------------------------
+
+//------------------------------------------------------------------------------
+/// \brief Times SizeFromLocation using the exact interpolation from all of the
+/// polygon points and using the tree approximation with a few tolerances.
+/// The polygon is a wavy circle with a varying point spacing.
+//------------------------------------------------------------------------------
+void benchSizeFromPoly()
+{
+  const int numPts = 20000;
+  VecPt3d outPoly;
+  for (int i = 0; i < numPts; ++i)
+  {
+    double t = (double)i / numPts;
+    double a = -2 * XM_PI * (t + 0.1 * sin(2 * XM_PI * t) / (2 * XM_PI));
+    double r = 1000 + 50 * sin(12 * a);
+    outPoly.push_back(Pt3d(r * cos(a), r * sin(a), 0));
+  }
+  VecPt3d locations;
+  for (int i = 0; i < 2000; ++i)
+  {
+    double a = 2 * XM_PI * i / 2000;
+    double r = 900 * (i % 97) / 97.0;
+    locations.push_back(Pt3d(r * cos(a), r * sin(a), 0));
+  }
+
+  VecDbl exactSizes;
+  const double tols[] = {0.0, 1e-4, 1e-3, 1e-2};
+  for (double tol : tols)
+  {
+    BSHP<MePolyRedistributePts> redist = MePolyRedistributePts::New();
+    redist->SetSizeFromPolyTolerance(tol);
+    redist->SetSizeFuncFromPoly(outPoly, VecPt3d2d(), 1.0);
+    VecDbl sizes(locations.size());
+    double seconds = meBenchSeconds([&]() {
+      for (size_t i = 0; i < locations.size(); ++i)
+        sizes[i] = redist->SizeFromLocation(locations[i]);
+    });
+    if (exactSizes.empty())
+      exactSizes = sizes;
+    double maxErr(0);
+    for (size_t i = 0; i < sizes.size(); ++i)
+      maxErr = std::max(maxErr, fabs(sizes[i] - exactSizes[i]) / exactSizes[i]);
+
+    std::stringstream ss;
+    ss << numPts << " pts, tol " << tol << ", max rel err " << maxErr;
+    meBenchReport("size_from_poly", ss.str(), seconds);
+  }
+} // benchSizeFromPoly
+
+} // namespace xms
@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \brief Benchmark of how the time of MeWeightMatcher::MatchWeights scales
+/// with the number of edges.
+/// \ingroup meshing
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/benchmarks/MeBenchmarks.h>
+
+// 3. Standard library headers
+#include <sstream>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/stl/vector.h>
+#include <xmsmesh/meshing/detail/MeWeightMatcher.h>
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+namespace
+{
+//------------------------------------------------------------------------------
+/// \brief Creates the edges between adjacent triangles of a grid of cells
+/// split into 2 triangles like MeQuadBlossom passes to the matcher. The
+/// weights are scattered between 0 and 999.
+/// \param[in] a_size: The number of cells in each direction.
+/// \return The edges.
+//------------------------------------------------------------------------------
+VecMeEdge iTriangleGridEdges(int a_size)
+{
+  VecMeEdge edges;
+  edges.reserve(3 * a_size * a_size);
+  unsigned int hash = 12345;
+  auto weight = [&]() {
+    hash = hash * 1103515245 + 12345;
+    return (int)((hash >> 16) % 1000);
+  };
+  for (int i = 0; i < a_size; ++i)
+  {
+    for (int j = 0; j < a_size; ++j)
+    {
+      // lower triangle 2 * cell and upper triangle 2 * cell + 1
+      int cell = i * a_size + j;
+      edges.push_back(MeEdge(2 * cell, 2 * cell + 1, weight()));
+      if (j + 1 < a_size)
+        edges.push_back(MeEdge(2 * cell, 2 * (cell + 1) + 1, weight()));
+      if (i > 0)
+        edges.push_back(MeEdge(2 * cell, 2 * (cell - a_size) + 1, weight()));
+    }
+  }
+  return edges;
+} // iTriangleGridEdges
+} // unnamed namespace
+
+//----- Class / Function definitions -------------------------------------------
+
+//------------------------------------------------------------------------------
+/// \brief Times MeWeightMatcher::MatchWeights on triangle adjacency graphs
+/// from about 10 thousand to 1 million edges.
+//------------------------------------------------------------------------------
+void benchWeightMatcher()
+{
+  const int sizes[] = {58, 183, 577};
+  for (int size : sizes)
+  {
+    VecMeEdge edges = iTriangleGridEdges(size);
+    for (int maxCardinality = 0; maxCardinality < 2; ++maxCardinality)
+    {
+      VecInt mates;
+      double seconds = meBenchSeconds(
+        [&]() { mates = MeWeightMatcher::New()->MatchWeights(edges, maxCardinality != 0); },
+        1);
+
+      int numMatched(0);
+      for (size_t v = 0; v < mates.size(); ++v)
+      {
+        if (mates[v] > (int)v)
+          ++numMatched;
+      }
+      std::stringstream ss;
+      ss << edges.size() << " edges, " << (maxCardinality ? "max cardinality, " : "")
+         << numMatched << " matched";
+      meBenchReport("weight_matcher", ss.str(), seconds);
+    }
+  }
+} // benchWeightMatcher
+
+} // namespace xms
@@ -0,0 +1,62 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup meshing
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 3. Standard library headers
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/points/pt.h>
+#include <xmscore/stl/vector.h>
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Structs / Classes ------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MeMeshSink
+/// \brief Receives the mesh of each polygon from MeMultiPolyMesher as soon as
+/// it is merged with the polygons before it, so the mesh can be written or
+/// used without holding all of it in memory. Set
+/// MeMultiPolyMesherIo::m_meshSink to use it.
+///
+/// The polygons are given in polygon index order. Points are numbered in the
+/// order they are given starting at 0. The points on a polygon boundary that
+/// were already given with an earlier polygon are not given again, and the
+/// cells of the polygon refer to them by their earlier numbers.
+class MeMeshSink
+{
+public:
+  /// \brief Destructor
+  virtual ~MeMeshSink() {}
+
+  //----------------------------------------------------------------------------
+  /// \brief Receives the mesh of one polygon.
+  /// \param[in] a_polyIdx: Index of the polygon in MeMultiPolyMesherIo::m_polys.
+  /// \param[in] a_firstPtIdx: Number of the first point in a_points.
+  /// \param[in] a_points: Points of the polygon that are new to the mesh.
+  /// \param[in] a_cells: Cells of the polygon as a stream, with points
+  /// numbered for the whole mesh.
+  //----------------------------------------------------------------------------
+  virtual void ReceivePolygonMesh(int a_polyIdx,
+                                  int a_firstPtIdx,
+                                  const VecPt3d& a_points,
+                                  const VecInt& a_cells) = 0;
+}; // MeMeshSink
+
+//----- Function prototypes ----------------------------------------------------
+
+} // namespace xms
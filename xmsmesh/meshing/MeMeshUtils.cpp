@@ -16,6 +16,7 @@
 // 3. Standard library headers
 #include <map>
 #include <sstream>
+#include <utility>
 
 // 4. External library headers
 
@@ -23,7 +24,12 @@
 #include <xmscore/math/math.h>
 #include <xmscore/misc/XmError.h>
 #include <xmscore/misc/DynBitset.h>
+#include <xmsgrid/ugrid/XmUGrid.h>
 #include <xmsinterp/triangulate/TrTin.h>
+#include <xmsmesh/meshing/MeMultiPolyMesherIo.h>
+#include <xmsmesh/meshing/detail/MeBadQuadRemover.h>
+#include <xmsmesh/meshing/detail/MePointAdjacency.h>
+#include <xmsmesh/meshing/detail/MeQuadBlossom.h>
 
 // 6. Non-shared code headers
 
@@ -157,8 +163,8 @@ static void meiDoSmooth(SmoothIo& a_)
 
   // get references to the Tin
   const VecPt3d& pts(a_.m_tin->Points());
-  const VecInt2d& trisAdjToPts(a_.m_tin->TrisAdjToPts());
-  const VecInt& tris(a_.m_tin->Triangles());
+  MePointAdjacency neighbors;
+  neighbors.Build(a_.m_tin->Triangles(), pts.size());
 
   // iterate through the points
   auto it = mapSizeIdx.begin();
@@ -172,80 +178,69 @@ static void meiDoSmooth(SmoothIo& a_)
     {
       smoothSize[i] = (float)a_.m_minSize;
     }
-    const VecInt adjTris(trisAdjToPts[i]); // triangles adjacent to the point
-    for (const auto& t : adjTris)
+    // points connected to the point by a triangle edge
+    const int* endNeighbor = neighbors.End(i);
+    for (const int* n = neighbors.Begin(i); n != endNeighbor; ++n)
     {
-      int tIdx = t * 3;
-      int triPts[3];
-      // points in the adjacent triangle
-      triPts[0] = tris[tIdx];
-      triPts[1] = tris[tIdx + 1];
-      triPts[2] = tris[tIdx + 2];
-      for (int t1 = 0; t1 < 3; ++t1)
+      int ix = *n; // index of neighboring point
+      // make sure we have not already adjusted this point
+      if (ptsFlag[ix])
+        continue;
+
+      const Pt3d &p0(pts[i]), &p1(pts[ix]);
+      // calculate what the min or max size can be based on how close
+      // the elements are
+      double length = Mdist(p0.x, p0.y, p1.x, p1.y);
+      double maxSize(0);
+      XM_ENSURE_TRUE(a_.CalcMaxSize(length, smoothSize[i], maxSize));
+
+      switch (a_.m_anchorType)
       {
-        int ix = triPts[t1]; // index of triangle point
-        // make sure this is not the vertex in the "i" loop
-        if (ix == i)
-          continue;
-        // make sure we have not already adjusted this point
-        if (ptsFlag[ix])
-          continue;
-
-        const Pt3d &p0(pts[i]), &p1(pts[ix]);
-        // calculate what the min or max size can be based on how close
-        // the elements are
-        double length = Mdist(p0.x, p0.y, p1.x, p1.y);
-        double maxSize(0);
-        XM_ENSURE_TRUE(a_.CalcMaxSize(length, smoothSize[i], maxSize));
-
-        switch (a_.m_anchorType)
-        {
-        case 0: // anchor to the min size
+      case 0: // anchor to the min size
+      {
+        if (a_.m_checkMinSize)
+          XM_ENSURE_TRUE(maxSize > a_.m_minSize);
+        XM_ENSURE_TRUE(maxSize >= (double)smoothSize[i]);
+        if (maxSize < (double)smoothSize[ix])
         {
-          if (a_.m_checkMinSize)
-            XM_ENSURE_TRUE(maxSize > a_.m_minSize);
-          XM_ENSURE_TRUE(maxSize >= (double)smoothSize[i]);
-          if (maxSize < (double)smoothSize[ix])
-          {
-            smoothSize[ix] = (float)maxSize;
-            ptsFlag.set(ix, true);
-          }
-          else if (a_.m_checkMinSize && (double)smoothSize[ix] < a_.m_minSize)
-          {
-            smoothSize[ix] = (float)a_.m_minSize;
-            ptsFlag.set(ix, true);
-          }
+          smoothSize[ix] = (float)maxSize;
+          ptsFlag.set(ix, true);
         }
-        break;
-        case 1: // anchor to the max size
+        else if (a_.m_checkMinSize && (double)smoothSize[ix] < a_.m_minSize)
         {
-          double minSize = a_.CalcMinSize(length, smoothSize[i], maxSize);
-          // double minSize = smoothSize[i] - (maxSize - smoothSize[i]);
-          XM_ENSURE_TRUE(minSize < smoothSize[i]);
-          if (minSize > (double)smoothSize[ix])
-          {
-            smoothSize[ix] = (float)minSize;
-            ptsFlag.set(ix, true);
-          }
-          else if (a_.m_checkMinSize && (double)smoothSize[ix] < a_.m_minSize)
-          {
-            smoothSize[ix] = (float)a_.m_minSize;
-            ptsFlag.set(ix, true);
-          }
+          smoothSize[ix] = (float)a_.m_minSize;
+          ptsFlag.set(ix, true);
         }
-        break;
-        default:
-          XM_ASSERT(0);
-          break;
+      }
+      break;
+      case 1: // anchor to the max size
+      {
+        double minSize = a_.CalcMinSize(length, smoothSize[i], maxSize);
+        // double minSize = smoothSize[i] - (maxSize - smoothSize[i]);
+        XM_ENSURE_TRUE(minSize < smoothSize[i]);
+        if (minSize > (double)smoothSize[ix])
+        {
+          smoothSize[ix] = (float)minSize;
+          ptsFlag.set(ix, true);
         }
-        // resort the point if it changed size
-        if (ptsFlag[ix])
+        else if (a_.m_checkMinSize && (double)smoothSize[ix] < a_.m_minSize)
         {
-          ptsFlag.set(ix, false);
-          mapSizeIdx.erase(vecIt[ix]);
-          vecIt[ix] = mapSizeIdx.insert(std::make_pair(val * smoothSize[ix], ix));
+          smoothSize[ix] = (float)a_.m_minSize;
+          ptsFlag.set(ix, true);
         }
       }
+      break;
+      default:
+        XM_ASSERT(0);
+        break;
+      }
+      // resort the point if it changed size
+      if (ptsFlag[ix])
+      {
+        ptsFlag.set(ix, false);
+        mapSizeIdx.erase(vecIt[ix]);
+        vecIt[ix] = mapSizeIdx.insert(std::make_pair(val * smoothSize[ix], ix));
+      }
     }
   }
 } // meiDoSmooth
@@ -384,6 +379,52 @@ void meModifyMessageWithPolygonId(int a_polyId, std::string& a_msg)
     a_msg = ss.str() + a_msg;
   }
 } // meModifyMessageWithPolygonId
+//------------------------------------------------------------------------------
+/// \brief Turns the triangle mesh in a MeMultiPolyMesherIo into a quad mesh
+/// with the bad quads removed. Does the same thing as MeQuadBlossom::MakeQuads
+/// followed by MeBadQuadRemover::RemoveBadQuads but the points and cells are
+/// handed from one step to the next without building a UGrid in between.
+/// \param[in,out] a_io The mesher output. m_points and m_cells are replaced
+/// by the quad mesh. m_cellPolygons is cleared because the cells no longer
+/// match the ones made by the polygons. m_numThreads is used for removing the
+/// bad quads.
+/// \param[in] a_maxAspect The maximum aspect ratio for the diagonals of a
+/// quad. See MeBadQuadRemover::RemoveBadQuads.
+/// \param[in] a_splitBoundaryPoints See MeQuadBlossom::MakeQuads.
+/// \param[in] a_useAngle See MeQuadBlossom::MakeQuads.
+/// \return true if successful. false if a cell is not a triangle.
+//------------------------------------------------------------------------------
+bool meMakeQuadMesh(MeMultiPolyMesherIo& a_io,
+                    double a_maxAspect,
+                    bool a_splitBoundaryPoints,
+                    bool a_useAngle)
+{
+  VecInt2d triangles;
+  const VecInt& cells = a_io.m_cells;
+  triangles.reserve(cells.size() / 5);
+  for (size_t i = 0; i < cells.size(); i += cells[i + 1] + 2)
+  {
+    if (cells[i] != XMU_TRIANGLE || cells[i + 1] != 3)
+    {
+      XM_LOG(xmlog::error, "Only a mesh of triangles can be turned into quads.");
+      return false;
+    }
+    triangles.push_back({cells[i + 2], cells[i + 3], cells[i + 4]});
+  }
+
+  VecPt3d points;
+  VecInt2d faces;
+  BSHP<MeQuadBlossom> blossom =
+    MeQuadBlossom::New(std::move(a_io.m_points), std::move(triangles));
+  blossom->MakeQuads(a_splitBoundaryPoints, a_useAngle, points, faces);
+  blossom.reset();
+
+  BSHP<MeBadQuadRemover> remover = MeBadQuadRemover::New(std::move(points), std::move(faces));
+  remover->SetNumThreads(a_io.m_numThreads);
+  remover->RemoveBadQuads(a_maxAspect, a_io.m_points, a_io.m_cells);
+  a_io.m_cellPolygons.clear();
+  return true;
+} // meMakeQuadMesh
 
 } // namespace xms
 
@@ -393,6 +434,8 @@ void meModifyMessageWithPolygonId(int a_polyId, std::string& a_msg)
 
 #include <xmscore/testing/TestTools.h>
 #include <xmsinterp/triangulate/TrTriangulatorPoints.h>
+#include <xmsmesh/meshing/MeMultiPolyMesherIo.h>
+#include <xmsmesh/tutorial/TutMeshing.t.h>
 
 ////////////////////////////////////////////////////////////////////////////////
 /// \class MeMeshUtilsUnitTests
@@ -637,4 +680,38 @@ void MeMeshUtilsUnitTests::testSmoothSizeFunc3()
 } // MeMeshUtilsUnitTests::testSmoothSizeFunc3
   //! [snip_MeMeshUtilsTests::testSmoothSizeFunc3]
 
-#endif
\ No newline at end of file
+//------------------------------------------------------------------------------
+/// \brief Tests that meMakeQuadMesh gives the same mesh as running
+/// MeQuadBlossom and MeBadQuadRemover on UGrids.
+//------------------------------------------------------------------------------
+void MeMeshUtilsUnitTests::testMakeQuadMesh()
+{
+  // a 12x12 grid of points with the interior points moved, split into
+  // triangles
+  xms::MeMultiPolyMesherIo io;
+  xms::VecInt tris;
+  xms::tutJiggledGrid(12, io.m_points, tris);
+  for (size_t i = 0; i + 2 < tris.size(); i += 3)
+  {
+    int cell[] = {xms::XMU_TRIANGLE, 3, tris[i], tris[i + 1], tris[i + 2]};
+    io.m_cells.insert(io.m_cells.end(), &cell[0], &cell[5]);
+    io.m_cellPolygons.push_back(0);
+  }
+
+  BSHP<xms::XmUGrid> triangles = xms::XmUGrid::New(io.m_points, io.m_cells);
+  BSHP<xms::XmUGrid> quads = xms::MeQuadBlossom::New(triangles)->MakeQuads(true, false);
+  BSHP<xms::XmUGrid> expected = xms::MeBadQuadRemover::New(quads)->RemoveBadQuads(0.7);
+
+  io.m_numThreads = 2;
+  TS_ASSERT(xms::meMakeQuadMesh(io, 0.7, true, false));
+  TS_ASSERT_EQUALS_VEC(expected->GetLocations(), io.m_points);
+  TS_ASSERT_EQUALS_VEC(expected->GetCellstream(), io.m_cells);
+  TS_ASSERT(io.m_cellPolygons.empty());
+
+  // the quads can't be turned into quads again
+  xms::VecInt cells = io.m_cells;
+  TS_ASSERT(!xms::meMakeQuadMesh(io));
+  TS_ASSERT_EQUALS_VEC(cells, io.m_cells);
+} // MeMeshUtilsUnitTests::testMakeQuadMesh
+
+#endif
@@ -25,6 +25,7 @@ namespace xms
 {
 //----- Forward declarations ---------------------------------------------------
 class TrTin;
+class MeMultiPolyMesherIo;
 
 //----- Constants / Enumerations -----------------------------------------------
 
@@ -49,4 +50,8 @@ void meSmoothElevBySlope(BSHP<TrTin> a_tin,
                          const DynBitset& a_ptFlags,
                          VecFlt& a_smoothSize);
 void meModifyMessageWithPolygonId(int a_polyId, std::string& a_msg);
+bool meMakeQuadMesh(MeMultiPolyMesherIo& a_io,
+                    double a_maxAspect = 0.7,
+                    bool a_splitBoundaryPoints = true,
+                    bool a_useAngle = false);
 } // namespace xms
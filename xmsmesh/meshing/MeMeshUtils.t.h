@@ -26,6 +26,7 @@ public:
   void testSmoothSizeFunc1();
   void testSmoothSizeFunc2();
   void testSmoothSizeFunc3();
+  void testMakeQuadMesh();
 };
 
 #endif
@@ -13,27 +13,44 @@
 #include <xmsmesh/meshing/MeMultiPolyMesher.h>
 
 // 3. Standard library headers
+#include <algorithm>
 #include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
 #include <numeric>
 #include <set>
 #include <sstream>
+#include <utility>
 
 // 4. External library headers
 #include <boost/format.hpp>
-#include <boost/unordered_map.hpp>
+#include <boost/functional/hash.hpp>
+#pragma warning(push)
+#pragma warning(disable : 4512) // boost code: no assignment operator
+#include <boost/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
+#pragma warning(pop)
 #include <xmscore/misc/StringUtil.h>
 #include <xmscore/misc/Progress.h>
+#include <xmscore/misc/XmConst.h>
 #include <xmscore/misc/XmError.h>
 #include <xmscore/stl/set.h>
 #include <xmscore/stl/vector.h>
+#include <xmsinterp/geometry/GmBoostTypes.h> // GmBstBox3d
 #include <xmsinterp/geometry/GmPtSearch.h>
 #include <xmsinterp/geometry/geoms.h>
 #include <xmsinterp/interpolate/InterpIdw.h>
 #include <xmsinterp/interpolate/InterpLinear.h>
 
 // 5. Shared code headers
+#include <xmsmesh/meshing/MeMeshSink.h>
 #include <xmsmesh/meshing/MeMultiPolyMesherIo.h>
 #include <xmsmesh/meshing/MePolyMesher.h>
+#include <xmsmesh/meshing/detail/MeParallel.h>
+#include <xmsmesh/meshing/detail/MePointWeldIndex.h>
+#include <xmsmesh/meshing/detail/MeSizeFunctionTris.h>
+#include <xmsmesh/meshing/detail/MeTracer.h>
 
 // 6. Non-shared code headers
 
@@ -45,9 +62,123 @@
 
 namespace xms
 {
+// function to access method on MePolyMesherImpl that we don't want in the
+// public interface.
+void mePolyMesherSetSizeFuncTris(BSHP<MePolyMesher> a_mesher,
+                                 const std::vector<BSHP<MeSizeFunctionTris>>& a_sizeFuncTris);
+void mePolyMesherSetTracer(BSHP<MePolyMesher> a_mesher, MeTracer* a_tracer);
+
 //----- Constants / Enumerations -----------------------------------------------
+namespace
+{
+namespace bgi = boost::geometry::index;
+
+/// segment envelope and the index of the segment's second point
+typedef std::pair<GmBstBox3d, size_t> MeSegEnvelope;
+/// rtree of segment envelopes
+typedef bgi::rtree<MeSegEnvelope, bgi::quadratic<16>> MeSegRtree;
+
+const size_t SEGMENT_BLOCK_SIZE = 1024; ///< segments checked per parallel task
+
+typedef std::pair<int, int> MeEdge; ///< edge as the smaller and larger point
+
+} // unnamed namespace
 
 //----- Classes / Structs ------------------------------------------------------
+////////////////////////////////////////////////////////////////////////////////
+/// \brief The mesh generated for one polygon. Held until it is merged into the
+/// mesh of all polygons.
+struct MePolyMeshResult
+{
+public:
+  /// \brief Constructor
+  MePolyMeshResult()
+  : m_meshed(false)
+  {
+  }
+
+  bool m_meshed;       ///< true if the polygon was meshed without errors
+  VecPt3d m_pts;       ///< mesh points
+  VecInt m_tris;       ///< mesh triangles from paving
+  VecInt m_cells;      ///< mesh cells from patch
+  VecPt3d m_refinePts; ///< refine points processed by the polygon
+  std::vector<MeRelaxIteration> m_relaxMetrics; ///< relaxation iterations
+  MePolyMeshStats m_stats;                      ///< time and counts of meshing
+};                                              // struct MePolyMeshResult
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Identifies the points, triangles, scalars and settings of an
+/// interpolator when polygons were meshed with it. They are not copied: the
+/// state keeps the vectors the interpolator returned, their sizes and a hash
+/// of their contents. The polygons that use an interpolator share one state so
+/// it is only hashed once in each call to MeshIt.
+struct MeInterpState
+{
+public:
+  /// \brief Constructor
+  MeInterpState()
+  : m_interp()
+  , m_pts()
+  , m_tris()
+  , m_scalars()
+  , m_numPts(0)
+  , m_numTris(0)
+  , m_numScalars(0)
+  , m_hash(0)
+  {
+  }
+
+  BSHP<InterpBase> m_interp; ///< the interpolator
+  BSHP<VecPt3d> m_pts;       ///< its points, may be null
+  BSHP<VecInt> m_tris;       ///< its triangles, may be null
+  BSHP<VecFlt> m_scalars;    ///< its scalars, may be null
+  size_t m_numPts;           ///< number of points when it was hashed
+  size_t m_numTris;          ///< size of the triangles when it was hashed
+  size_t m_numScalars;       ///< number of scalars when it was hashed
+  size_t m_hash;             ///< hash of the points, triangles, scalars and settings
+};                           // struct MeInterpState
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Everything the mesh of a polygon depends on. Kept with the mesh when
+/// meshing incrementally so the mesh is only reused if they have not changed.
+struct MePolyMeshInputs
+{
+public:
+  /// \brief Constructor
+  MePolyMeshInputs()
+  : m_poly()
+  , m_sizeFunction()
+  , m_elevFunction()
+  , m_refPts()
+  , m_returnRelaxMetrics(false)
+  , m_parallelRelax(false)
+  {
+  }
+
+  MePolyInput m_poly;                  ///< input of the polygon
+  BSHP<MeInterpState> m_sizeFunction;  ///< state of the size function, may be null
+  BSHP<MeInterpState> m_elevFunction;  ///< state of the elevation function, may be null
+  std::vector<MeRefinePoint> m_refPts; ///< refine points in the outer polygon's bounds
+  bool m_returnRelaxMetrics;           ///< MeMultiPolyMesherIo::m_returnRelaxMetrics
+  bool m_parallelRelax;                ///< MeMultiPolyMesherIo::m_parallelRelax
+};                                     // struct MePolyMeshInputs
+
+////////////////////////////////////////////////////////////////////////////////
+/// \brief The mesh of a polygon kept for the next call to MeshIt.
+struct MePolyCacheEntry
+{
+public:
+  /// \brief Constructor
+  MePolyCacheEntry()
+  : m_inputs()
+  , m_result()
+  {
+  }
+
+  MePolyMeshInputs m_inputs;       ///< inputs the mesh was made from
+  BSHP<MePolyMeshResult> m_result; ///< the mesh
+};                                 // struct MePolyCacheEntry
+
 class MeMultiPolyMesherImpl : public MeMultiPolyMesher
 {
 public:
@@ -58,9 +189,17 @@ public:
   virtual void CheckForIntersections(const MeMultiPolyMesherIo& a_io,
                                      std::string& a_errors) const override;
 
+  /// \brief Gets the number of polygons meshed (not reused) by the last call
+  /// to MeshIt.
+  /// \return The number of polygons meshed.
+  int NumPolysMeshed() const { return m_numPolysMeshed; }
+
 private:
-  void AppendMesh(VecPt3d& a_points, const VecInt& a_triangles, VecInt& a_cells);
-  void AddUniquePoints(const VecPt3d& a_points, VecInt& a_oldDups, VecInt& a_newDups);
+  void AppendMesh(int a_polyIdx, VecPt3d& a_points, const VecInt& a_triangles, VecInt& a_cells);
+  void AddUniquePoints(VecPt3d& a_points,
+                       const VecInt& a_boundaryPts,
+                       VecInt& a_oldDups,
+                       VecInt& a_newDups);
   void RenumberNewMesh(int a_oldNumPts,
                        size_t a_numNewPts,
                        const VecInt& a_oldDups,
@@ -70,16 +209,23 @@ private:
   void ReportUnusedRefinePts(const MeMultiPolyMesherIo& a_io, const VecPt3d& a_usedPts);
   void EnsureProperPolygonInputs(MeMultiPolyMesherIo& a_io);
   bool ValidateInput(const MeMultiPolyMesherIo& a_io);
-  bool ExtentsOverlap(const Pt3d& oneMn,
-                      const Pt3d& oneMx,
-                      const Pt3d& two1,
-                      const Pt3d& two2) const;
+  void UpdateSizeFuncTris(const MeMultiPolyMesherIo& a_io);
 
   BSHP<VecPt3d> m_pts; ///< Mesh points. BSHP because of PtSearch::VectorThatGrowsToSearch
   VecInt m_cells;      ///< Mesh cells as a stream
   int m_cellCount;     ///< Number of cells
-  boost::unordered_map<std::pair<double, double>, int> m_ptHash; ///< hashes points
-};                                                               // class MeMultiPolyMesherImpl
+  int m_numPts;        ///< Number of mesh points
+  BSHP<MeMeshSink> m_sink; ///< receives each polygon's mesh instead of m_pts and m_cells
+  MePointWeldIndex m_weldIndex; ///< boundary points of the polygons meshed so far
+  /// size and elevation functions shared by the polygons. The triangles of the
+  /// size functions are built once.
+  std::vector<BSHP<MeSizeFunctionTris>> m_sizeFuncTris;
+  /// mesh of each polygon from the last call to MeshIt by the hash of its inputs
+  std::multimap<size_t, BSHP<MePolyCacheEntry>> m_polyCache;
+  /// state of the interpolators used in the last call to MeshIt
+  std::map<InterpBase*, BSHP<MeInterpState>> m_interpStates;
+  int m_numPolysMeshed; ///< number of polygons meshed (not reused) by MeshIt
+};                      // class MeMultiPolyMesherImpl
 
 ////////////////////////////////////////////////////////////////////////////////
 /// \brief Struct defining the location of a polygon line segment in the list of
@@ -106,6 +252,7 @@ public:
   int m_inPolySeg; ///< Index of segment on inner polygon
 };                 // struct SegmentLocation
 
+
 //----- Internal functions -----------------------------------------------------
 namespace
 {
@@ -202,6 +349,307 @@ void iWriteInputsToDebugFile(MeMultiPolyMesherIo& a_io)
   }
 
 } // iWriteInputsToDebugFile
+//------------------------------------------------------------------------------
+/// \brief Returns the xy envelope of a segment with z set to 0.
+/// \param a_p1: First point of the segment.
+/// \param a_p2: Second point of the segment.
+/// \return The envelope.
+//------------------------------------------------------------------------------
+GmBstBox3d iSegmentEnvelope(const Pt3d& a_p1, const Pt3d& a_p2)
+{
+  GmBstBox3d b;
+  b.min_corner() = Pt3d(std::min(a_p1.x, a_p2.x), std::min(a_p1.y, a_p2.y), 0.0);
+  b.max_corner() = Pt3d(std::max(a_p1.x, a_p2.x), std::max(a_p1.y, a_p2.y), 0.0);
+  return b;
+} // iSegmentEnvelope
+//------------------------------------------------------------------------------
+/// \brief Builds the error message reported when two input polygon segments
+///        intersect.
+/// \param a_a0: Location of the first point of the first segment.
+/// \param a_a1: Location of the second point of the first segment.
+/// \param a_b0: Location of the first point of the second segment.
+/// \param a_b1: Location of the second point of the second segment.
+/// \return The error message.
+//------------------------------------------------------------------------------
+std::string iIntersectionMessage(const SegmentLocation& a_a0,
+                                 const SegmentLocation& a_a1,
+                                 const SegmentLocation& a_b0,
+                                 const SegmentLocation& a_b1)
+{
+  std::string s;
+  if (a_a0.m_inPoly == -1)
+  { // First segment on an outer poly
+    if (a_b0.m_inPoly == -1)
+    { // Second segment on an outer poly
+      s = (boost::format("Error: Input polygon segments intersect."
+                         " The segment defined by points %d and %d"
+                         " of outer polygon %d"
+                         " intersects with the segment defined by points %d and %d"
+                         " of outer polygon %d.\n") %
+           a_a0.m_polySeg % a_a1.m_polySeg % a_a0.m_poly % a_b0.m_polySeg % a_b1.m_polySeg %
+           a_b0.m_poly)
+            .str();
+    }
+    else
+    { // Second segment on an inner poly
+      s = (boost::format("Error: Input polygon segments intersect."
+                         " The segment defined by points %d and %d"
+                         " of outer polygon %d"
+                         " intersects with the segment defined by points %d and %d"
+                         " of inner polygon %d of outer polygon %d.\n") %
+           a_a0.m_polySeg % a_a1.m_polySeg % a_a0.m_poly % a_b0.m_inPolySeg % a_b1.m_inPolySeg %
+           a_b0.m_inPoly % a_b0.m_poly)
+            .str();
+    }
+  }
+  else
+  { // First segment on an inner poly
+    if (a_b0.m_inPoly == -1)
+    { // Second segment on an outer poly
+      s = (boost::format("Error: Input polygon segments intersect."
+                         " The segment defined by points %d and %d"
+                         " of inner polygon %d of outer polygon %d"
+                         " intersects with the segment defined by points %d and %d"
+                         " of outer polygon %d.\n") %
+           a_a0.m_inPolySeg % a_a1.m_inPolySeg % a_a0.m_inPoly % a_a0.m_poly % a_b0.m_polySeg %
+           a_b1.m_polySeg % a_b0.m_poly)
+            .str();
+    }
+    else
+    { // Second segment on an inner poly
+      s = (boost::format("Error: Input polygon segments intersect."
+                         " The segment defined by points %d and %d"
+                         " of inner polygon %d of outer polygon %d"
+                         " intersects with the segment defined by points %d and %d"
+                         " of inner polygon %d of outer polygon %d.\n") %
+           a_a0.m_inPolySeg % a_a1.m_inPolySeg % a_a0.m_inPoly % a_a0.m_poly % a_b0.m_inPolySeg %
+           a_b1.m_inPolySeg % a_b0.m_inPoly % a_b0.m_poly)
+            .str();
+    }
+  }
+  return s;
+} // iIntersectionMessage
+//------------------------------------------------------------------------------
+/// \brief Finds the points on the boundary of a mesh. These are the points on
+/// edges that are used by only one cell.
+/// \param a_cells: The cells of the mesh as a stream.
+/// \param a_boundaryPts: The sorted indices of the boundary points.
+//------------------------------------------------------------------------------
+void iBoundaryPoints(const VecInt& a_cells, VecInt& a_boundaryPts)
+{
+  std::vector<MeEdge> edges;
+  edges.reserve(a_cells.size());
+  for (size_t i = 0; i < a_cells.size(); i += a_cells[i + 1] + 2)
+  {
+    int nPts = a_cells[i + 1];
+    const int* pts = &a_cells[i + 2];
+    for (int j = 0; j < nPts; ++j)
+    {
+      int p0 = pts[j], p1 = pts[(j + 1) % nPts];
+      edges.push_back(MeEdge(std::min(p0, p1), std::max(p0, p1)));
+    }
+  }
+  std::sort(edges.begin(), edges.end());
+
+  a_boundaryPts.resize(0);
+  for (size_t i = 0; i < edges.size();)
+  {
+    size_t j = i + 1;
+    while (j < edges.size() && edges[j] == edges[i])
+      ++j;
+    if (j == i + 1)
+    {
+      a_boundaryPts.push_back(edges[i].first);
+      a_boundaryPts.push_back(edges[i].second);
+    }
+    i = j;
+  }
+  std::sort(a_boundaryPts.begin(), a_boundaryPts.end());
+  a_boundaryPts.erase(std::unique(a_boundaryPts.begin(), a_boundaryPts.end()),
+                      a_boundaryPts.end());
+} // iBoundaryPoints
+//------------------------------------------------------------------------------
+/// \brief Adds the locations of points to a hash.
+/// \param a_seed: The hash.
+/// \param a_pts: The points.
+//------------------------------------------------------------------------------
+void iHashPoints(size_t& a_seed, const VecPt3d& a_pts)
+{
+  boost::hash_combine(a_seed, a_pts.size());
+  for (const Pt3d& p : a_pts)
+  {
+    boost::hash_combine(a_seed, p.x);
+    boost::hash_combine(a_seed, p.y);
+    boost::hash_combine(a_seed, p.z);
+  }
+} // iHashPoints
+//------------------------------------------------------------------------------
+/// \brief Creates the state of an interpolator. Its points, triangles and
+/// scalars are hashed in place.
+/// \param a_interp: The interpolator.
+/// \return The state.
+//------------------------------------------------------------------------------
+BSHP<MeInterpState> iNewInterpState(const BSHP<InterpBase>& a_interp)
+{
+  BSHP<MeInterpState> state(new MeInterpState());
+  state->m_interp = a_interp;
+  state->m_pts = a_interp->GetPts();
+  state->m_tris = a_interp->GetTris();
+  state->m_scalars = a_interp->GetScalars();
+  size_t seed(0);
+  if (state->m_pts)
+  {
+    state->m_numPts = state->m_pts->size();
+    iHashPoints(seed, *state->m_pts);
+  }
+  if (state->m_tris)
+  {
+    state->m_numTris = state->m_tris->size();
+    boost::hash_range(seed, state->m_tris->begin(), state->m_tris->end());
+  }
+  if (state->m_scalars)
+  {
+    state->m_numScalars = state->m_scalars->size();
+    boost::hash_range(seed, state->m_scalars->begin(), state->m_scalars->end());
+  }
+  boost::hash_combine(seed, a_interp->ToString());
+  state->m_hash = seed;
+  return state;
+} // iNewInterpState
+//------------------------------------------------------------------------------
+/// \brief Checks if two states of the same interpolator have the same points,
+/// triangles, scalars and settings. The vectors must be the same objects with
+/// the same sizes and the hashes must match.
+/// \param a_lhs: A state.
+/// \param a_rhs: A state.
+/// \return true if they are the same.
+//------------------------------------------------------------------------------
+bool iSameInterp(const MeInterpState& a_lhs, const MeInterpState& a_rhs)
+{
+  return a_lhs.m_interp == a_rhs.m_interp && a_lhs.m_pts == a_rhs.m_pts &&
+         a_lhs.m_tris == a_rhs.m_tris && a_lhs.m_scalars == a_rhs.m_scalars &&
+         a_lhs.m_numPts == a_rhs.m_numPts && a_lhs.m_numTris == a_rhs.m_numTris &&
+         a_lhs.m_numScalars == a_rhs.m_numScalars && a_lhs.m_hash == a_rhs.m_hash;
+} // iSameInterp
+//------------------------------------------------------------------------------
+/// \brief Gets everything the mesh of a polygon depends on. Only the refine
+/// points inside the bounds of the outer polygon are included so moving a
+/// refine point only changes the inputs of the polygons near it.
+/// \param a_io: The input of the mesher.
+/// \param a_polyIdx: Index of the polygon in MeMultiPolyMesherIo::m_polys.
+/// \param a_states: The state of each interpolator used by the polygons.
+/// \param a_inputs: The inputs of the polygon.
+//------------------------------------------------------------------------------
+void iPolyMeshInputs(const MeMultiPolyMesherIo& a_io,
+                     size_t a_polyIdx,
+                     const std::map<InterpBase*, BSHP<MeInterpState>>& a_states,
+                     MePolyMeshInputs& a_inputs)
+{
+  const MePolyInput& p = a_io.m_polys[a_polyIdx];
+  a_inputs.m_poly = p;
+  a_inputs.m_sizeFunction.reset();
+  a_inputs.m_elevFunction.reset();
+  if (p.m_sizeFunction)
+    a_inputs.m_sizeFunction = a_states.find(p.m_sizeFunction.get())->second;
+  if (p.m_elevFunction)
+    a_inputs.m_elevFunction = a_states.find(p.m_elevFunction.get())->second;
+  a_inputs.m_returnRelaxMetrics = a_io.m_returnRelaxMetrics;
+  a_inputs.m_parallelRelax = a_io.m_parallelRelax;
+
+  Pt3d mn(XM_DBL_HIGHEST), mx(XM_DBL_LOWEST);
+  for (const Pt3d& pt : p.m_outPoly)
+  {
+    mn.x = std::min(mn.x, pt.x);
+    mn.y = std::min(mn.y, pt.y);
+    mx.x = std::max(mx.x, pt.x);
+    mx.y = std::max(mx.y, pt.y);
+  }
+  double tol = 1e-9 * std::max(mx.x - mn.x, mx.y - mn.y);
+  a_inputs.m_refPts.clear();
+  for (const MeRefinePoint& r : a_io.m_refPts)
+  {
+    if (r.m_pt.x < mn.x - tol || r.m_pt.y < mn.y - tol || r.m_pt.x > mx.x + tol ||
+        r.m_pt.y > mx.y + tol)
+      continue;
+    a_inputs.m_refPts.push_back(r);
+  }
+} // iPolyMeshInputs
+//------------------------------------------------------------------------------
+/// \brief Computes a hash of the inputs of a polygon. The interpolators are
+/// hashed by their state so their points are not hashed again.
+/// \param a_inputs: The inputs of the polygon.
+/// \return The hash.
+//------------------------------------------------------------------------------
+size_t iPolyInputHash(const MePolyMeshInputs& a_inputs)
+{
+  const MePolyInput& p = a_inputs.m_poly;
+  size_t seed(0);
+  iHashPoints(seed, p.m_outPoly);
+  boost::hash_combine(seed, p.m_insidePolys.size());
+  for (const VecPt3d& inPoly : p.m_insidePolys)
+    iHashPoints(seed, inPoly);
+  boost::hash_combine(seed, p.m_bias);
+  boost::hash_combine(seed, a_inputs.m_sizeFunction ? a_inputs.m_sizeFunction->m_hash : 0);
+  boost::hash_combine(seed, p.m_constSizeFunction);
+  boost::hash_combine(seed, p.m_constSizeBias);
+  boost::hash_combine(seed, p.m_polyCorners);
+  boost::hash_combine(seed, a_inputs.m_elevFunction ? a_inputs.m_elevFunction->m_hash : 0);
+  iHashPoints(seed, p.m_boundPtsToRemove);
+  boost::hash_combine(seed, p.m_removeInternalFourTrianglePts);
+  boost::hash_combine(seed, p.m_polyId);
+  iHashPoints(seed, p.m_seedPoints);
+  boost::hash_combine(seed, p.m_relaxationMethod);
+  boost::hash_combine(seed, p.m_sizeFromPolyTolerance);
+  boost::hash_combine(seed, p.m_relaxMaxIterations);
+  boost::hash_combine(seed, p.m_relaxTolerance);
+  boost::hash_combine(seed, p.m_relaxTimeLimit);
+  boost::hash_combine(seed, a_inputs.m_returnRelaxMetrics);
+  boost::hash_combine(seed, a_inputs.m_parallelRelax);
+  for (const MeRefinePoint& r : a_inputs.m_refPts)
+  {
+    boost::hash_combine(seed, r.m_pt.x);
+    boost::hash_combine(seed, r.m_pt.y);
+    boost::hash_combine(seed, r.m_pt.z);
+    boost::hash_combine(seed, r.m_size);
+    boost::hash_combine(seed, r.m_createMeshPoint);
+  }
+  return seed;
+} // iPolyInputHash
+//------------------------------------------------------------------------------
+/// \brief Checks if the inputs of a polygon are the same. The interpolator
+/// states must be the same objects.
+/// \param a_lhs: The inputs of a polygon.
+/// \param a_rhs: The inputs of a polygon.
+/// \return true if they are the same.
+//------------------------------------------------------------------------------
+bool iSamePolyMeshInputs(const MePolyMeshInputs& a_lhs, const MePolyMeshInputs& a_rhs)
+{
+  const MePolyInput& l = a_lhs.m_poly;
+  const MePolyInput& r = a_rhs.m_poly;
+  if (a_lhs.m_sizeFunction != a_rhs.m_sizeFunction ||
+      a_lhs.m_elevFunction != a_rhs.m_elevFunction ||
+      a_lhs.m_returnRelaxMetrics != a_rhs.m_returnRelaxMetrics ||
+      a_lhs.m_parallelRelax != a_rhs.m_parallelRelax || a_lhs.m_refPts.size() != a_rhs.m_refPts.size())
+    return false;
+  for (size_t i = 0; i < a_lhs.m_refPts.size(); ++i)
+  {
+    const MeRefinePoint& lp = a_lhs.m_refPts[i];
+    const MeRefinePoint& rp = a_rhs.m_refPts[i];
+    if (lp.m_pt != rp.m_pt || lp.m_size != rp.m_size || lp.m_createMeshPoint != rp.m_createMeshPoint)
+      return false;
+  }
+  return l.m_outPoly == r.m_outPoly && l.m_insidePolys == r.m_insidePolys &&
+         l.m_bias == r.m_bias && l.m_constSizeFunction == r.m_constSizeFunction &&
+         l.m_constSizeBias == r.m_constSizeBias && l.m_polyCorners == r.m_polyCorners &&
+         l.m_boundPtsToRemove == r.m_boundPtsToRemove &&
+         l.m_removeInternalFourTrianglePts == r.m_removeInternalFourTrianglePts &&
+         l.m_polyId == r.m_polyId && l.m_seedPoints == r.m_seedPoints &&
+         l.m_relaxationMethod == r.m_relaxationMethod &&
+         l.m_sizeFromPolyTolerance == r.m_sizeFromPolyTolerance &&
+         l.m_relaxMaxIterations == r.m_relaxMaxIterations &&
+         l.m_relaxTolerance == r.m_relaxTolerance && l.m_relaxTimeLimit == r.m_relaxTimeLimit;
+} // iSamePolyMeshInputs
+
 
 } // unnamed namespace
 //----- Class / Function definitions -------------------------------------------
@@ -218,6 +666,11 @@ MeMultiPolyMesherImpl::MeMultiPolyMesherImpl()
 : m_pts(new VecPt3d())
 , m_cells()
 , m_cellCount(0)
+, m_numPts(0)
+, m_sink()
+, m_polyCache()
+, m_interpStates()
+, m_numPolysMeshed(0)
 {
 } // MeMultiPolyMesherImpl::MeMultiPolyMesherImpl
 //------------------------------------------------------------------------------
@@ -235,51 +688,208 @@ bool MeMultiPolyMesherImpl::MeshIt(MeMultiPolyMesherIo& a_io)
   {
     return false;
   }
-
-  // Mesh each polygon and merge the triangles together into one mesh
-  BSHP<MePolyMesher> pm = MePolyMesher::New();
+  UpdateSizeFuncTris(a_io);
+  m_weldIndex.SetTolerance(a_io.m_mergeTolerance);
+  m_sink = a_io.m_meshSink;
+
+  // Mesh each polygon and merge the triangles together into one mesh. The
+  // polygons may be meshed concurrently but they are always merged in polygon
+  // index order so the output does not depend on the number of threads.
+  size_t numPolys = a_io.m_polys.size();
   std::stringstream ss;
-  ss << "Meshing polygon 1 of " << a_io.m_polys.size();
+  ss << "Meshing polygon 1 of " << numPolys;
   Progress prog(ss.str());
 
-  VecPt3d pts, refinePts, tmpPts;
-  VecInt tris, cells, cellPolygons;
-  for (size_t i = 0; i < a_io.m_polys.size(); ++i)
+  int numThreads = meNumThreadsToUse(a_io.m_numThreads, numPolys);
+  std::vector<BSHP<MePolyMesher>> meshers(numThreads);
+  std::vector<BSHP<MePolyMeshResult>> results(numPolys);
+
+  // polygons with the same inputs as in the last call reuse the mesh from then
+  std::vector<size_t> polyHashes;
+  std::vector<BSHP<MePolyCacheEntry>> entries;
+  std::vector<bool> reused(numPolys, false);
+  std::multimap<size_t, BSHP<MePolyCacheEntry>> polyCache;
+  std::map<InterpBase*, BSHP<MeInterpState>> interpStates;
+  if (a_io.m_incremental)
   {
-    pts.resize(0);
-    tris.resize(0);
-    if (pm->MeshIt(a_io, i, pts, tris, cells))
+    // hash and compare each interpolator once, not once for each polygon
+    for (const MePolyInput& p : a_io.m_polys)
     {
-      pm->GetProcessedRefinePts(tmpPts);
-      refinePts.insert(refinePts.end(), tmpPts.begin(), tmpPts.end());
-      AppendMesh(pts, tris, cells);
+      for (const BSHP<InterpBase>* interp : {&p.m_sizeFunction, &p.m_elevFunction})
+      {
+        if (!*interp || interpStates.find(interp->get()) != interpStates.end())
+          continue;
+        BSHP<MeInterpState> state = iNewInterpState(*interp);
+        auto it = m_interpStates.find(interp->get());
+        if (it != m_interpStates.end() && iSameInterp(*it->second, *state))
+          state = it->second;
+        interpStates[interp->get()] = state;
+      }
+    }
 
-      // Assign cell polygons
-      if (a_io.m_returnCellPolygons)
+    polyHashes.resize(numPolys);
+    entries.resize(numPolys);
+    for (size_t i = 0; i < numPolys; ++i)
+    {
+      entries[i].reset(new MePolyCacheEntry());
+      iPolyMeshInputs(a_io, i, interpStates, entries[i]->m_inputs);
+      polyHashes[i] = iPolyInputHash(entries[i]->m_inputs);
+      auto range = m_polyCache.equal_range(polyHashes[i]);
+      for (auto it = range.first; it != range.second; ++it)
       {
-        cellPolygons.resize(m_cellCount, (int)i);
+        if (iSamePolyMeshInputs(it->second->m_inputs, entries[i]->m_inputs))
+        {
+          entries[i] = it->second;
+          results[i] = it->second->m_result;
+          reused[i] = true;
+          break;
+        }
       }
     }
+  }
+  m_numPolysMeshed = 0;
+  VecPt3d refinePts;
+  VecInt cellPolygons;
+  std::vector<std::vector<MeRelaxIteration>> relaxMetrics;
+  if (a_io.m_returnRelaxMetrics)
+    relaxMetrics.resize(numPolys);
+  std::vector<MePolyMeshStats> polyStats;
+  if (a_io.m_returnStats)
+    polyStats.resize(numPolys);
+  BSHP<MeTracer> tracer;
+  if (!a_io.m_traceFile.empty())
+    tracer.reset(new MeTracer());
+  auto meshPoly = [&](size_t a_polyIdx, int a_thread) {
+    if (reused[a_polyIdx])
+      return;
+    results[a_polyIdx].reset(new MePolyMeshResult());
+    MePolyMeshResult& r(*results[a_polyIdx]);
+    MeTraceSpan span(tracer.get(), "polygon", "poly", (int)a_polyIdx);
+    BSHP<MePolyMesher>& pm(meshers[a_thread]);
+    if (!pm)
+    {
+      pm = MePolyMesher::New();
+      mePolyMesherSetSizeFuncTris(pm, m_sizeFuncTris);
+      mePolyMesherSetTracer(pm, tracer.get());
+    }
+    r.m_meshed = pm->MeshIt(a_io, a_polyIdx, r.m_pts, r.m_tris, r.m_cells);
+    if (r.m_meshed)
+    {
+      pm->GetProcessedRefinePts(r.m_refinePts);
+      if (a_io.m_returnRelaxMetrics)
+        pm->GetRelaxMetrics(r.m_relaxMetrics);
+      if (a_io.m_returnStats)
+        pm->GetStats(r.m_stats);
+    }
+  };
+  auto mergePoly = [&](size_t a_polyIdx) {
+    MeTraceSpan span(tracer.get(), "merge_polygon", "poly", (int)a_polyIdx);
+    MePolyMeshResult& r(*results[a_polyIdx]);
+    if (!reused[a_polyIdx])
+      ++m_numPolysMeshed;
+    if (r.m_meshed && a_io.m_incremental)
+    {
+      // the mesh is kept for the next call so AppendMesh gets copies
+      entries[a_polyIdx]->m_result = results[a_polyIdx];
+      polyCache.insert(std::make_pair(polyHashes[a_polyIdx], entries[a_polyIdx]));
+      VecPt3d pts(r.m_pts);
+      VecInt cells(r.m_cells);
+      refinePts.insert(refinePts.end(), r.m_refinePts.begin(), r.m_refinePts.end());
+      AppendMesh((int)a_polyIdx, pts, r.m_tris, cells);
+      if (a_io.m_returnRelaxMetrics)
+        relaxMetrics[a_polyIdx] = r.m_relaxMetrics;
+      // a reused mesh took no time to make
+      if (a_io.m_returnStats && !reused[a_polyIdx])
+        polyStats[a_polyIdx] = r.m_stats;
+    }
+    else if (r.m_meshed)
+    {
+      refinePts.insert(refinePts.end(), r.m_refinePts.begin(), r.m_refinePts.end());
+      AppendMesh((int)a_polyIdx, r.m_pts, r.m_tris, r.m_cells);
+      if (a_io.m_returnRelaxMetrics)
+        relaxMetrics[a_polyIdx].swap(r.m_relaxMetrics);
+      if (a_io.m_returnStats)
+        polyStats[a_polyIdx] = r.m_stats;
+    }
+    // Assign cell polygons
+    if (r.m_meshed && a_io.m_returnCellPolygons && !m_sink)
+    {
+      cellPolygons.resize(m_cellCount, (int)a_polyIdx);
+    }
+    // free the memory for this polygon
+    results[a_polyIdx].reset();
 
     // Update progress
     ss.str("");
-    ss << "Meshing polygon " << i + 2 << " of " << a_io.m_polys.size();
+    ss << "Meshing polygon " << a_polyIdx + 2 << " of " << numPolys;
     prog.UpdateMessage(ss.str());
-    prog.ProgressStatus((double)i / a_io.m_polys.size());
-  }
-
-  // Move memory and cleanup
-  a_io.m_points.swap(*m_pts);
-  a_io.m_cells.swap(m_cells);
+    prog.ProgressStatus((double)a_polyIdx / numPolys);
+  };
+  meParallelForOrdered(numPolys, numThreads, meshPoly, mergePoly);
+
+  // Move memory and cleanup. The mesh is moved, not swapped, so the output of
+  // an earlier call in a_io is freed instead of being appended to next time.
+  a_io.m_points = std::move(*m_pts);
+  m_pts->clear();
+  a_io.m_cells = std::move(m_cells);
+  m_cells.clear();
   a_io.m_cellPolygons.swap(cellPolygons);
-  m_ptHash.clear();
+  a_io.m_relaxMetrics.swap(relaxMetrics);
+  a_io.m_polyStats.swap(polyStats);
+  m_weldIndex.Clear();
   m_cellCount = 0;
+  m_numPts = 0;
+  m_sink.reset();
+  m_polyCache.swap(polyCache);
+  m_interpStates.swap(interpStates);
 
   // report unused refine points
   ReportUnusedRefinePts(a_io, refinePts);
+
+  if (tracer && !tracer->WriteFile(a_io.m_traceFile))
+    XM_LOG(xmlog::error, "Unable to write the trace file: " + a_io.m_traceFile);
   return true;
 } // MeMultiPolyMesherImpl::MeshIt
 //------------------------------------------------------------------------------
+/// \brief Builds the triangles of each distinct size function used by the
+/// polygons so they are built once instead of once per polygon.
+///
+/// Elevation functions are also wrapped in a MeSizeFunctionTris so that only
+/// one thread at a time interpolates from an interpolator, even when it is
+/// both the size and the elevation function. The triangles of an elevation
+/// function are not built unless it is also a size function. Size function
+/// triangles from the previous call to MeshIt are reused if the size function
+/// has not been given new points or triangles since then.
+/// \param a_io: The input/output parameters.
+//------------------------------------------------------------------------------
+void MeMultiPolyMesherImpl::UpdateSizeFuncTris(const MeMultiPolyMesherIo& a_io)
+{
+  std::vector<BSHP<MeSizeFunctionTris>> sizeFuncTris;
+  for (size_t i = 0; i < a_io.m_polys.size(); ++i)
+  {
+    for (const BSHP<InterpBase>* interp :
+         {&a_io.m_polys[i].m_sizeFunction, &a_io.m_polys[i].m_elevFunction})
+    {
+      if (!*interp)
+        continue;
+      bool found = false;
+      for (size_t j = 0; !found && j < sizeFuncTris.size(); ++j)
+        found = sizeFuncTris[j]->Interp() == *interp;
+      for (size_t j = 0; !found && j < m_sizeFuncTris.size(); ++j)
+      {
+        if (m_sizeFuncTris[j]->IsCurrent(*interp))
+        {
+          sizeFuncTris.push_back(m_sizeFuncTris[j]);
+          found = true;
+        }
+      }
+      if (!found)
+        sizeFuncTris.push_back(MeSizeFunctionTris::New(*interp));
+    }
+  }
+  m_sizeFuncTris.swap(sizeFuncTris);
+} // MeMultiPolyMesherImpl::UpdateSizeFuncTris
+//------------------------------------------------------------------------------
 /// \brief Remove last point of polygon if it is the same as the first point and
 /// make sure the polygon points are ordered correctly.
 /// \param a_io: The input/output parameters.
@@ -404,7 +1014,8 @@ bool MeMultiPolyMesherImpl::ValidateInput(const MeMultiPolyMesherIo& a_io)
 ///        entirely inside or outside of where they are supposed to be.
 ///
 /// We check by intersecting every line segment on every poly with every other
-/// line segment on every other poly, if the extents overlap. This can be slow.
+/// line segment whose extents overlap. The segment extents are found with an
+/// rtree and the search is done on MeMultiPolyMesherIo::m_numThreads threads.
 /// \param a_io: Mesher input/output
 /// \param a_errors: Error string that may get appended to.
 //------------------------------------------------------------------------------
@@ -468,41 +1079,57 @@ void MeMultiPolyMesherImpl::CheckForIntersections(const MeMultiPolyMesherIo& a_i
     }
   }
 
-  // Intersect all segments with all other segments
-
-  double xi, yi, zi1, zi2, tol(gmXyTol());
-  size_t size = segments.size();
+  // Put the envelope of every segment in an rtree. Segments are identified by
+  // the index of their second point in segments.
 
-  // Loop through every segment
+  double tol(gmXyTol());
+  std::vector<MeSegEnvelope> envelopes;
+  envelopes.reserve(segments.size());
   for (size_t i = 1; i < segments.size(); ++i)
   {
     // Skip nulls which indicate the end of a poly
-    if (segments[i] == nullptr)
-    {
-      ++i;
-      continue;
-    }
-    const Pt3d* one1 = segments[i - 1];
-    const Pt3d* one2 = segments[i];
-    Pt3d oneMn, oneMx;
-    gmAddToExtents(*one1, oneMn, oneMx);
-    gmAddToExtents(*one2, oneMn, oneMx);
-    oneMn -= tol;
-    oneMx += tol;
-
-    // Starting on the next segment from where we are, go to end of segments
-    for (size_t j = i + 1; j < size; ++j)
+    if (segments[i] && segments[i - 1])
+      envelopes.push_back(MeSegEnvelope(iSegmentEnvelope(*segments[i - 1], *segments[i]), i));
+  }
+  MeSegRtree rtree(envelopes.begin(), envelopes.end());
+
+  // Intersect every segment with every later segment whose envelope overlaps.
+  // Consecutive segments are near each other so blocks of them are checked in
+  // parallel. Each block's errors are appended in segment order so the result
+  // is the same as checking every pair in order.
+
+  size_t numBlocks = (envelopes.size() + SEGMENT_BLOCK_SIZE - 1) / SEGMENT_BLOCK_SIZE;
+  std::vector<std::string> blockErrors(numBlocks);
+  auto checkBlock = [&](size_t a_block, int) {
+    double xi, yi, zi1, zi2;
+    std::vector<MeSegEnvelope> found;
+    std::vector<size_t> laterSegs;
+    size_t end = std::min(envelopes.size(), (a_block + 1) * SEGMENT_BLOCK_SIZE);
+    for (size_t k = a_block * SEGMENT_BLOCK_SIZE; k < end; ++k)
     {
-      // Skip nulls which indicate the end of a poly
-      if (segments[j] == nullptr)
+      size_t i = envelopes[k].second;
+      GmBstBox3d query(envelopes[k].first);
+      query.min_corner().x -= tol;
+      query.min_corner().y -= tol;
+      query.max_corner().x += tol;
+      query.max_corner().y += tol;
+      found.clear();
+      rtree.query(bgi::intersects(query), std::back_inserter(found));
+      laterSegs.clear();
+      for (size_t f = 0; f < found.size(); ++f)
       {
-        ++j;
-        continue;
+        if (found[f].second > i)
+          laterSegs.push_back(found[f].second);
       }
-      const Pt3d* two1 = segments[j - 1];
-      const Pt3d* two2 = segments[j];
-      if (ExtentsOverlap(oneMn, oneMx, *two1, *two2))
+      std::sort(laterSegs.begin(), laterSegs.end());
+
+      const Pt3d* one1 = segments[i - 1];
+      const Pt3d* one2 = segments[i];
+      for (size_t f = 0; f < laterSegs.size(); ++f)
       {
+        size_t j = laterSegs[f];
+        const Pt3d* two1 = segments[j - 1];
+        const Pt3d* two2 = segments[j];
         if (gmIntersectLineSegmentsWithTol(*one1, *one2, *two1, *two2, &xi, &yi, &zi1, &zi2, tol))
         {
           // See if we didn't just intersect on the ends
@@ -510,112 +1137,31 @@ void MeMultiPolyMesherImpl::CheckForIntersections(const MeMultiPolyMesherIo& a_i
               !gmEqualPointsXY(one2->x, one2->y, xi, yi, tol))
           {
             // Report the intersection
-            std::stringstream ss;
-            SegmentLocation& a0 = segmentLocs[i - 1];
-            SegmentLocation& a1 = segmentLocs[i];
-            SegmentLocation& b0 = segmentLocs[j - 1];
-            SegmentLocation& b1 = segmentLocs[j];
-            std::string s;
-            if (a0.m_inPoly == -1)
-            { // First segment on an outer poly
-              if (b0.m_inPoly == -1)
-              { // Second segment on an outer poly
-                s = (boost::format("Error: Input polygon segments intersect."
-                                   " The segment defined by points %d and %d"
-                                   " of outer polygon %d"
-                                   " intersects with the segment defined by points %d and %d"
-                                   " of outer polygon %d.\n") %
-                     a0.m_polySeg % a1.m_polySeg % a0.m_poly % b0.m_polySeg % b1.m_polySeg %
-                     b0.m_poly)
-                      .str();
-              }
-              else
-              { // Second segment on an inner poly
-                s = (boost::format("Error: Input polygon segments intersect."
-                                   " The segment defined by points %d and %d"
-                                   " of outer polygon %d"
-                                   " intersects with the segment defined by points %d and %d"
-                                   " of inner polygon %d of outer polygon %d.\n") %
-                     a0.m_polySeg % a1.m_polySeg % a0.m_poly % b0.m_inPolySeg % b1.m_inPolySeg %
-                     b0.m_inPoly % b0.m_poly)
-                      .str();
-              }
-            }
-            else
-            { // First segment on an inner poly
-              if (b0.m_inPoly == -1)
-              { // Second segment on an outer poly
-                s = (boost::format("Error: Input polygon segments intersect."
-                                   " The segment defined by points %d and %d"
-                                   " of inner polygon %d of outer polygon %d"
-                                   " intersects with the segment defined by points %d and %d"
-                                   " of outer polygon %d.\n") %
-                     a0.m_inPolySeg % a1.m_inPolySeg % a0.m_inPoly % a0.m_poly % b0.m_polySeg %
-                     b1.m_polySeg % b0.m_poly)
-                      .str();
-              }
-              else
-              { // Second segment on an inner poly
-                s = (boost::format("Error: Input polygon segments intersect."
-                                   " The segment defined by points %d and %d"
-                                   " of inner polygon %d of outer polygon %d"
-                                   " intersects with the segment defined by points %d and %d"
-                                   " of inner polygon %d of outer polygon %d.\n") %
-                     a0.m_inPolySeg % a1.m_inPolySeg % a0.m_inPoly % a0.m_poly % b0.m_inPolySeg %
-                     b1.m_inPolySeg % b0.m_inPoly % b0.m_poly)
-                      .str();
-              }
-            }
-            a_errors += s;
+            blockErrors[a_block] += iIntersectionMessage(segmentLocs[i - 1], segmentLocs[i],
+                                                         segmentLocs[j - 1], segmentLocs[j]);
           }
         }
       }
     }
-  }
+  };
+  auto appendBlockErrors = [&](size_t a_block) {
+    a_errors += blockErrors[a_block];
+    blockErrors[a_block].clear();
+  };
+  meParallelForOrdered(numBlocks, a_io.m_numThreads, checkBlock, appendBlockErrors);
 } // MeMultiPolyMesherImpl::CheckForIntersections
 //------------------------------------------------------------------------------
-/// \brief Given extents of one segment, and another segment, return true if
-///        the extents of the two segments overlap.
-/// \param a_oneMn: Min extents of first segment.
-/// \param a_oneMx: Max extents of first segment.
-/// \param a_two1: First point defining second segment.
-/// \param a_two2: Second point defining second segment.
-/// \return true if overlap, else false.
-//------------------------------------------------------------------------------
-bool MeMultiPolyMesherImpl::ExtentsOverlap(const Pt3d& a_oneMn,
-                                           const Pt3d& a_oneMx,
-                                           const Pt3d& a_two1,
-                                           const Pt3d& a_two2) const
-{
-  Pt3d twoMn, twoMx;
-  gmAddToExtents(a_two1, twoMn, twoMx);
-  gmAddToExtents(a_two2, twoMn, twoMx);
-  if (twoMn.x > a_oneMx.x)
-  {
-    return false;
-  }
-  if (twoMx.x < a_oneMn.x)
-  {
-    return false;
-  }
-  if (twoMn.y > a_oneMx.y)
-  {
-    return false;
-  }
-  if (twoMx.y < a_oneMn.y)
-  {
-    return false;
-  }
-  return true;
-} // MeMultiPolyMesherImpl::ExtentsOverlap
-//------------------------------------------------------------------------------
-/// \brief Adds new points and triangles to existing mesh, hashing points and
-///        renumbering.
+/// \brief Adds new points and triangles to existing mesh, merging the points
+///        on the polygon boundary with points of earlier polygons and
+///        renumbering. The new points and cells are given to the mesh sink
+///        if there is one.
+/// \param a_polyIdx: Index of the polygon the mesh is from.
 /// \param a_points: New mesh points.
 /// \param a_triangles: New mesh triangle cells.
 /// \param a_cells: New mesh cells.
 //------------------------------------------------------------------------------
-void MeMultiPolyMesherImpl::AppendMesh(VecPt3d& a_points,
+void MeMultiPolyMesherImpl::AppendMesh(int a_polyIdx,
+                                       VecPt3d& a_points,
                                        const VecInt& a_triangles,
                                        VecInt& a_cells)
 {
@@ -653,40 +1199,51 @@ void MeMultiPolyMesherImpl::AppendMesh(VecPt3d& a_points,
   }
   m_cellCount += cellCount;
 
-  if ((*m_pts).empty())
+  // Only points on the boundary of the polygon can be shared with other
+  // polygons
+  VecInt boundaryPts;
+  iBoundaryPoints(cells, boundaryPts);
+  m_weldIndex.Reserve(m_weldIndex.Size() + boundaryPts.size());
+
+  VecInt oldDups, newDups;
+  int oldNumPts = m_numPts;
+  size_t numNewPts = a_points.size();
+  AddUniquePoints(a_points, boundaryPts, oldDups, newDups);
+  RenumberNewMesh(oldNumPts, numNewPts, oldDups, newDups, cells);
+  m_numPts += (int)a_points.size();
+
+  if (m_sink)
   {
-    std::pair<std::pair<double, double>, int> pd;
-    for (size_t i = 0; i < a_points.size(); ++i)
-    {
-      pd.first.first = a_points[i].x;
-      pd.first.second = a_points[i].y;
-      pd.second = (int)i;
-      m_ptHash.insert(pd);
-    }
-    // First time, just add points to m_pts and return
+    m_sink->ReceivePolygonMesh(a_polyIdx, oldNumPts, a_points, cells);
+  }
+  else if ((*m_pts).empty())
+  {
+    // First time, just add points to m_pts
     m_pts->swap(a_points);
     m_cells.swap(cells);
-    return;
   }
-
-  VecInt oldDups, newDups;
-  int oldNumPts = (int)(*m_pts).size();
-  AddUniquePoints(a_points, oldDups, newDups);
-
-  RenumberNewMesh(oldNumPts, a_points.size(), oldDups, newDups, cells);
-  AppendNewCells(cells);
+  else
+  {
+    m_pts->insert(m_pts->end(), a_points.begin(), a_points.end());
+    AppendNewCells(cells);
+  }
 } // MeMultiPolyMesherImpl::AppendMesh
 //------------------------------------------------------------------------------
-/// \brief Adds new mesh points that aren't in old mesh, to old mesh.
+/// \brief Removes the new mesh points that are in the old mesh and adds the
+/// boundary points that are left to the weld index.
 ///
-/// Also gives back lists of duplicate points found (if any) in a_oldDups and
-/// a_newDups which are the same size and correspond with each other
-/// (a_oldDups[3] => a_newDups[3])
-/// \param a_points:  New mesh points.
-/// \param a_oldDups: Indices in m_pts (old mesh) of duplicate points.
+/// Only the boundary points of the new mesh are looked for in the old mesh,
+/// and only among the boundary points of earlier polygons. Also gives back
+/// lists of duplicate points found (if any) in a_oldDups and a_newDups which
+/// are the same size and correspond with each other (a_oldDups[3] =>
+/// a_newDups[3])
+/// \param a_points:  New mesh points. The duplicate points are removed.
+/// \param a_boundaryPts: Sorted indices in a_points of the boundary points.
+/// \param a_oldDups: Indices in the old mesh of duplicate points.
 /// \param a_newDups: Indices in a_points (new mesh) of duplicate points.
 //------------------------------------------------------------------------------
-void MeMultiPolyMesherImpl::AddUniquePoints(const VecPt3d& a_points,
+void MeMultiPolyMesherImpl::AddUniquePoints(VecPt3d& a_points,
+                                            const VecInt& a_boundaryPts,
                                             VecInt& a_oldDups,
                                             VecInt& a_newDups)
 {
@@ -694,27 +1251,34 @@ void MeMultiPolyMesherImpl::AddUniquePoints(const VecPt3d& a_points,
   a_newDups.clear();
   XM_ENSURE_TRUE_VOID_NO_ASSERT(!a_points.empty());
 
-  // const double tol = 1e-9;
-  // int idxOld;
-  std::pair<std::pair<double, double>, int> pd;
-  auto itEnd = m_ptHash.end();
+  for (size_t i = 0; i < a_boundaryPts.size(); ++i)
+  {
+    int idxOld = m_weldIndex.Find(a_points[a_boundaryPts[i]]);
+    if (idxOld != -1)
+    {
+      a_oldDups.push_back(idxOld);
+      a_newDups.push_back(a_boundaryPts[i]);
+    }
+  }
+
+  // Keep the points that are not duplicates in order. a_newDups is sorted.
+  size_t dup = 0, boundary = 0, numKept = 0;
   for (size_t i = 0; i < a_points.size(); ++i)
   {
-    pd.first.first = a_points[i].x;
-    pd.first.second = a_points[i].y;
-    pd.second = (int)m_pts->size();
-    auto it = m_ptHash.find(pd.first);
-    if (it == itEnd)
+    if (dup < a_newDups.size() && a_newDups[dup] == (int)i)
     {
-      m_ptHash.insert(pd);
-      m_pts->push_back(a_points[i]);
+      ++dup;
+      ++boundary;
+      continue;
     }
-    else
+    if (boundary < a_boundaryPts.size() && a_boundaryPts[boundary] == (int)i)
     {
-      a_oldDups.push_back(it->second);
-      a_newDups.push_back((int)i);
+      m_weldIndex.Add(a_points[i], m_numPts + (int)numKept);
+      ++boundary;
     }
+    a_points[numKept++] = a_points[i];
   }
+  a_points.resize(numKept);
 } // MeMultiPolyMesherImpl::AddUniquePoints
 //------------------------------------------------------------------------------
 /// \brief Renumber points referred to in the new mesh to remove duplicate
@@ -836,12 +1400,54 @@ BSHP<MeMultiPolyMesher> MeMultiPolyMesher::New()
 #include <xmsmesh/meshing/MeMultiPolyMesher.t.h>
 
 #include <xmscore/testing/TestTools.h>
+#include <xmsmesh/tutorial/TutMeshing.t.h>
 
 //----- Namespace declaration --------------------------------------------------
 
 // namespace xms {
 using namespace xms;
 
+namespace
+{
+////////////////////////////////////////////////////////////////////////////////
+/// \brief Mesh sink that collects the polygon meshes it is given.
+class MeCollectMeshSink : public MeMeshSink
+{
+public:
+  /// \brief Constructor
+  MeCollectMeshSink()
+  : m_points()
+  , m_cells()
+  , m_polys()
+  , m_firstPtIdxOk(true)
+  {
+  }
+
+  //----------------------------------------------------------------------------
+  /// \brief Appends the mesh of a polygon.
+  /// \param[in] a_polyIdx: Index of the polygon.
+  /// \param[in] a_firstPtIdx: Number of the first point in a_points.
+  /// \param[in] a_points: Points new to the mesh.
+  /// \param[in] a_cells: Cells of the polygon.
+  //----------------------------------------------------------------------------
+  virtual void ReceivePolygonMesh(int a_polyIdx,
+                                  int a_firstPtIdx,
+                                  const VecPt3d& a_points,
+                                  const VecInt& a_cells) override
+  {
+    m_firstPtIdxOk = m_firstPtIdxOk && a_firstPtIdx == (int)m_points.size();
+    m_points.insert(m_points.end(), a_points.begin(), a_points.end());
+    m_cells.insert(m_cells.end(), a_cells.begin(), a_cells.end());
+    m_polys.push_back(a_polyIdx);
+  }
+
+  VecPt3d m_points;    ///< points of all of the polygons
+  VecInt m_cells;      ///< cells of all of the polygons
+  VecInt m_polys;      ///< polygons in the order they were given
+  bool m_firstPtIdxOk; ///< true if each polygon's points followed the last
+};
+} // unnamed namespace
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \class MeMultiPolyMesherUnitTests
 /// \brief Tests for MeMultiPolyMesher.
@@ -1060,6 +1666,447 @@ void MeMultiPolyMesherUnitTests::testCheckForIntersections5()
 
   TS_ASSERT_EQUALS(expected, errors);
 } // MeMultiPolyMesherUnitTests::testCheckForIntersections5
+//------------------------------------------------------------------------------
+/// \brief Tests that checking for intersections on several threads reports
+/// the same errors in the same order as checking on one thread. A row of 50
+/// squares where each square overlaps the next one. Each overlap has 2
+/// crossing segments. Square i starts at (95 * i, 10 * (i % 2)).
+//------------------------------------------------------------------------------
+void MeMultiPolyMesherUnitTests::testCheckForIntersectionsParallel()
+{
+  MeMultiPolyMesherIo input;
+  const int numSquares = 50;
+  const int numSegsPerSide = 7;
+  for (int i = 0; i < numSquares; ++i)
+  {
+    double x0 = 95.0 * i, y0 = 10.0 * (i % 2);
+    MePolyInput poly;
+    for (int k = 0; k < numSegsPerSide; ++k)
+      poly.m_outPoly.push_back(Pt3d(x0 + 100.0 * k / numSegsPerSide, y0, 0));
+    for (int k = 0; k < numSegsPerSide; ++k)
+      poly.m_outPoly.push_back(Pt3d(x0 + 100.0, y0 + 100.0 * k / numSegsPerSide, 0));
+    for (int k = 0; k < numSegsPerSide; ++k)
+      poly.m_outPoly.push_back(Pt3d(x0 + 100.0 - 100.0 * k / numSegsPerSide, y0 + 100.0, 0));
+    for (int k = 0; k < numSegsPerSide; ++k)
+      poly.m_outPoly.push_back(Pt3d(x0, y0 + 100.0 - 100.0 * k / numSegsPerSide, 0));
+    input.m_polys.push_back(poly);
+  }
+
+  BSHP<MeMultiPolyMesher> mesher = MeMultiPolyMesher::New();
+  std::string serialErrors, parallelErrors;
+  input.m_numThreads = 1;
+  mesher->CheckForIntersections(input, serialErrors);
+  input.m_numThreads = 4;
+  mesher->CheckForIntersections(input, parallelErrors);
+  TS_ASSERT_EQUALS(serialErrors, parallelErrors);
+
+  int numErrors = 0;
+  for (size_t pos = serialErrors.find("Error:"); pos != std::string::npos;
+       pos = serialErrors.find("Error:", pos + 1))
+    ++numErrors;
+  TS_ASSERT_EQUALS(2 * (numSquares - 1), numErrors);
+
+  std::string expected =
+    "Error: Input polygon segments intersect. The segment defined by points 7 and 8 of outer "
+    "polygon 0 intersects with the segment defined by points 0 and 1 of outer polygon 1.\n";
+  TS_ASSERT_EQUALS(expected, serialErrors.substr(0, expected.size()));
+} // MeMultiPolyMesherUnitTests::testCheckForIntersectionsParallel
+//------------------------------------------------------------------------------
+/// \brief Tests that meshing polygons on several threads gives exactly the
+/// same mesh as meshing them one after another. There are fewer, as many and
+/// more threads than polygons.
+/// \verbatim
+///             100    *------*------*------*
+///                    |      |      |      |
+///                    |  0   |  1   |  2   |
+///                    |      |      |      |
+///               0    *------*------*------*
+///                    0-----100----200----300
+/// \endverbatim
+//------------------------------------------------------------------------------
+void MeMultiPolyMesherUnitTests::testParallelMatchesSerial()
+{
+  MeMultiPolyMesherIo input;
+  tutSquarePolygons(3, 10, input);
+  for (int i = 0; i < 3; ++i)
+    input.m_polys[i].m_bias = 1.0 - 0.25 * i;
+  input.m_refPts.push_back(MeRefinePoint(Pt3d(150, 50, 0), 2.0, true));
+
+  BSHP<MeMultiPolyMesher> mesher = MeMultiPolyMesher::New();
+  MeMultiPolyMesherIo serial(input);
+  TS_ASSERT(mesher->MeshIt(serial));
+  TS_ASSERT(!serial.m_points.empty());
+  for (int numThreads : {2, 3, 8})
+  {
+    MeMultiPolyMesherIo parallel(input);
+    parallel.m_numThreads = numThreads;
+    TS_ASSERT(mesher->MeshIt(parallel));
+    TS_ASSERT_EQUALS_VEC(serial.m_points, parallel.m_points);
+    TS_ASSERT_EQUALS_VEC(serial.m_cells, parallel.m_cells);
+    TS_ASSERT_EQUALS_VEC(serial.m_cellPolygons, parallel.m_cellPolygons);
+  }
+} // MeMultiPolyMesherUnitTests::testParallelMatchesSerial
+//------------------------------------------------------------------------------
+/// \brief Tests that relaxing in color classes gives the same mesh for any
+/// number of threads, whether or not there are threads to spare for each
+/// polygon.
+//------------------------------------------------------------------------------
+void MeMultiPolyMesherUnitTests::testParallelRelax()
+{
+  MeMultiPolyMesherIo input;
+  tutSquarePolygons(3, 10, input);
+  for (int i = 0; i < 3; ++i)
+    input.m_polys[i].m_bias = 1.0 - 0.25 * i;
+  input.m_refPts.push_back(MeRefinePoint(Pt3d(150, 50, 0), 2.0, true));
+  input.m_parallelRelax = true;
+
+  BSHP<MeMultiPolyMesher> mesher = MeMultiPolyMesher::New();
+  MeMultiPolyMesherIo oneThread(input);
+  TS_ASSERT(mesher->MeshIt(oneThread));
+  TS_ASSERT(!oneThread.m_points.empty());
+  for (int numThreads : {2, 3, 8})
+  {
+    MeMultiPolyMesherIo parallel(input);
+    parallel.m_numThreads = numThreads;
+    TS_ASSERT(mesher->MeshIt(parallel));
+    TS_ASSERT_EQUALS_VEC(oneThread.m_points, parallel.m_points);
+    TS_ASSERT_EQUALS_VEC(oneThread.m_cells, parallel.m_cells);
+  }
+
+  // the points are relaxed in a different order than by default
+  MeMultiPolyMesherIo gaussSeidel(input);
+  gaussSeidel.m_parallelRelax = false;
+  TS_ASSERT(mesher->MeshIt(gaussSeidel));
+  TS_ASSERT_EQUALS(gaussSeidel.m_points.size(), oneThread.m_points.size());
+  TS_ASSERT(gaussSeidel.m_points != oneThread.m_points);
+} // MeMultiPolyMesherUnitTests::testParallelRelax
+//------------------------------------------------------------------------------
+/// \brief Tests that polygons sharing a size function give the same mesh as
+/// polygons with their own copy of the size function. The triangles of the
+/// shared size function are built once and reused by the next call to MeshIt.
+//------------------------------------------------------------------------------
+void MeMultiPolyMesherUnitTests::testSharedSizeFunction()
+{
+  BSHP<VecPt3d> sPts(new VecPt3d());
+  *sPts = {{-10, -10, 10}, {-10, 110, 10}, {210, 110, 10}, {210, -10, 10}, {60, 70, 2}};
+  BSHP<VecInt> sTris(new VecInt());
+  *sTris = {0, 4, 1, 1, 4, 2, 2, 4, 3, 3, 4, 0};
+  BSHP<InterpBase> shared(InterpLinear::New());
+  shared->SetPtsTris(sPts, sTris);
+
+  MeMultiPolyMesherIo input;
+  tutSquarePolygons(2, 1, input);
+  for (size_t i = 0; i < input.m_polys.size(); ++i)
+    input.m_polys[i].m_sizeFunction = shared;
+
+  MeMultiPolyMesherIo separate(input);
+  for (size_t i = 0; i < separate.m_polys.size(); ++i)
+  {
+    BSHP<InterpBase> linear(InterpLinear::New());
+    linear->SetPtsTris(BSHP<VecPt3d>(new VecPt3d(*sPts)), BSHP<VecInt>(new VecInt(*sTris)));
+    separate.m_polys[i].m_sizeFunction = linear;
+  }
+  BSHP<MeMultiPolyMesher> mesher = MeMultiPolyMesher::New();
+  TS_ASSERT(mesher->MeshIt(separate));
+
+  MeMultiPolyMesherIo first(input);
+  TS_ASSERT(mesher->MeshIt(first));
+  MeMultiPolyMesherIo second(input);
+  second.m_numThreads = 2;
+  TS_ASSERT(mesher->MeshIt(second));
+
+  TS_ASSERT(!separate.m_points.empty());
+  TS_ASSERT_EQUALS_VEC(separate.m_points, first.m_points);
+  TS_ASSERT_EQUALS_VEC(separate.m_cells, first.m_cells);
+  TS_ASSERT_EQUALS_VEC(separate.m_points, second.m_points);
+  TS_ASSERT_EQUALS_VEC(separate.m_cells, second.m_cells);
+} // MeMultiPolyMesherUnitTests::testSharedSizeFunction
+//------------------------------------------------------------------------------
+/// \brief Tests polygons meshed on several threads that share an interpolator
+/// used as both their size and elevation function.
+//------------------------------------------------------------------------------
+void MeMultiPolyMesherUnitTests::testSharedElevFunction()
+{
+  BSHP<VecPt3d> sPts(new VecPt3d());
+  *sPts = {{-10, -10, 10}, {-10, 110, 10}, {310, 110, 20}, {310, -10, 20}, {160, 50, 5}};
+  BSHP<VecInt> sTris(new VecInt());
+  *sTris = {0, 4, 1, 1, 4, 2, 2, 4, 3, 3, 4, 0};
+  BSHP<InterpBase> shared(InterpLinear::New());
+  shared->SetPtsTris(sPts, sTris);
+
+  MeMultiPolyMesherIo input;
+  tutSquarePolygons(3, 10, input);
+  for (size_t i = 0; i < input.m_polys.size(); ++i)
+  {
+    input.m_polys[i].m_sizeFunction = shared;
+    input.m_polys[i].m_elevFunction = shared;
+  }
+
+  BSHP<MeMultiPolyMesher> mesher = MeMultiPolyMesher::New();
+  MeMultiPolyMesherIo serial(input);
+  TS_ASSERT(mesher->MeshIt(serial));
+  MeMultiPolyMesherIo parallel(input);
+  parallel.m_numThreads = 3;
+  TS_ASSERT(mesher->MeshIt(parallel));
+
+  TS_ASSERT(!serial.m_points.empty());
+  TS_ASSERT_EQUALS_VEC(serial.m_points, parallel.m_points);
+  TS_ASSERT_EQUALS_VEC(serial.m_cells, parallel.m_cells);
+  for (const Pt3d& p : parallel.m_points)
+  {
+    TS_ASSERT(p.z >= 5.0 && p.z <= 20.0);
+  }
+} // MeMultiPolyMesherUnitTests::testSharedElevFunction
+//------------------------------------------------------------------------------
+/// \brief Tests that the relaxation metrics are returned for each polygon and
+/// that the default settings give the same mesh as before they were added.
+//------------------------------------------------------------------------------
+void MeMultiPolyMesherUnitTests::testRelaxMetrics()
+{
+  MeMultiPolyMesherIo input;
+  tutSquarePolygons(2, 10, input);
+  // the second polygon is not relaxed
+  input.m_polys[1].m_seedPoints = {{150, 50, 0}};
+
+  BSHP<MeMultiPolyMesher> mesher = MeMultiPolyMesher::New();
+  MeMultiPolyMesherIo plain(input);
+  TS_ASSERT(mesher->MeshIt(plain));
+  TS_ASSERT(plain.m_relaxMetrics.empty());
+
+  MeMultiPolyMesherIo metrics(input);
+  metrics.m_returnRelaxMetrics = true;
+  TS_ASSERT(mesher->MeshIt(metrics));
+  TS_ASSERT_EQUALS_VEC(plain.m_points, metrics.m_points);
+  TS_ASSERT_EQUALS_VEC(plain.m_cells, metrics.m_cells);
+  TS_ASSERT_EQUALS(2, metrics.m_relaxMetrics.size());
+  TS_ASSERT_EQUALS(3, metrics.m_relaxMetrics[0].size());
+  TS_ASSERT(metrics.m_relaxMetrics[1].empty());
+  for (size_t i = 0; i < metrics.m_relaxMetrics[0].size(); ++i)
+  {
+    const MeRelaxIteration& it(metrics.m_relaxMetrics[0][i]);
+    TS_ASSERT(it.m_meanMove <= it.m_maxMove);
+    TS_ASSERT(it.m_minQuality > 0.0 && it.m_minQuality <= it.m_meanQuality);
+    TS_ASSERT(it.m_meanQuality <= 1.0);
+  }
+
+  MeMultiPolyMesherIo converge(input);
+  converge.m_returnRelaxMetrics = true;
+  converge.m_polys[0].m_relaxMaxIterations = 50;
+  converge.m_polys[0].m_relaxTolerance = 1e-3;
+  TS_ASSERT(mesher->MeshIt(converge));
+  TS_ASSERT(!converge.m_relaxMetrics[0].empty());
+  TS_ASSERT(converge.m_relaxMetrics[0].size() < 50);
+} // MeMultiPolyMesherUnitTests::testRelaxMetrics
+//------------------------------------------------------------------------------
+/// \brief Tests merging the points of neighboring polygons that are within
+/// the merge tolerance but not at the same location.
+//------------------------------------------------------------------------------
+void MeMultiPolyMesherUnitTests::testMergeTolerance()
+{
+  // Two squares that share the edge at x = 100. In the second input the
+  // right square's copy of the edge is moved 1e-7 to the right.
+  MeMultiPolyMesherIo shared;
+  tutSquarePolygons(2, 10, shared);
+  MeMultiPolyMesherIo moved(shared);
+  for (auto& p : moved.m_polys[1].m_outPoly)
+  {
+    if (p.x == 100.0)
+      p.x += 1e-7;
+  }
+
+  BSHP<MeMultiPolyMesher> mesher = MeMultiPolyMesher::New();
+  TS_ASSERT(mesher->MeshIt(shared));
+  MeMultiPolyMesherIo exact(moved);
+  TS_ASSERT(mesher->MeshIt(exact));
+  moved.m_mergeTolerance = 1e-6;
+  TS_ASSERT(mesher->MeshIt(moved));
+
+  // the points on the shared edge are only merged with the tolerance
+  TS_ASSERT(!shared.m_points.empty());
+  TS_ASSERT(exact.m_points.size() > shared.m_points.size());
+  TS_ASSERT_EQUALS(shared.m_points.size(), moved.m_points.size());
+} // MeMultiPolyMesherUnitTests::testMergeTolerance
+//------------------------------------------------------------------------------
+/// \brief Tests that a mesh sink is given the same mesh, one polygon at a
+/// time, and that the mesh is not kept in MeMultiPolyMesherIo.
+//------------------------------------------------------------------------------
+void MeMultiPolyMesherUnitTests::testMeshSink()
+{
+  MeMultiPolyMesherIo input;
+  tutSquarePolygons(3, 1, input);
+
+  BSHP<MeMultiPolyMesher> mesher = MeMultiPolyMesher::New();
+  BSHP<MeCollectMeshSink> sink(new MeCollectMeshSink());
+  MeMultiPolyMesherIo streamed(input);
+  streamed.m_meshSink = sink;
+  streamed.m_numThreads = 2;
+  MeMultiPolyMesherIo parallel(input);
+  parallel.m_numThreads = 2;
+  TS_ASSERT(mesher->MeshIt(streamed));
+  TS_ASSERT(mesher->MeshIt(parallel));
+
+  TS_ASSERT(streamed.m_points.empty());
+  TS_ASSERT(streamed.m_cells.empty());
+  TS_ASSERT(streamed.m_cellPolygons.empty());
+  TS_ASSERT(sink->m_firstPtIdxOk);
+  VecInt polys = {0, 1, 2};
+  TS_ASSERT_EQUALS_VEC(polys, sink->m_polys);
+  TS_ASSERT(!parallel.m_points.empty());
+  TS_ASSERT_EQUALS_VEC(parallel.m_points, sink->m_points);
+  TS_ASSERT_EQUALS_VEC(parallel.m_cells, sink->m_cells);
+} // MeMultiPolyMesherUnitTests::testMeshSink
+//------------------------------------------------------------------------------
+/// \brief Tests meshing several times with the same MeMultiPolyMesherIo and
+/// mesher. Each mesh must match the mesh from a new mesher and io.
+//------------------------------------------------------------------------------
+void MeMultiPolyMesherUnitTests::testMeshItReusingIo()
+{
+  MeMultiPolyMesherIo input;
+  tutSquarePolygons(2, 10, input);
+  MeMultiPolyMesherIo expected(input);
+  TS_ASSERT(MeMultiPolyMesher::New()->MeshIt(expected));
+
+  for (bool incremental : {false, true})
+  {
+    BSHP<MeMultiPolyMesher> mesher = MeMultiPolyMesher::New();
+    MeMultiPolyMesherIo io(input);
+    io.m_incremental = incremental;
+    for (int i = 0; i < 3; ++i)
+    {
+      TS_ASSERT(mesher->MeshIt(io));
+      TS_ASSERT_EQUALS_VEC(expected.m_points, io.m_points);
+      TS_ASSERT_EQUALS_VEC(expected.m_cells, io.m_cells);
+      TS_ASSERT_EQUALS_VEC(expected.m_cellPolygons, io.m_cellPolygons);
+    }
+  }
+} // MeMultiPolyMesherUnitTests::testMeshItReusingIo
+//------------------------------------------------------------------------------
+/// \brief Tests that only the polygons that changed are meshed again when
+/// incremental and that the mesh is the same as meshing all of the polygons.
+//------------------------------------------------------------------------------
+void MeMultiPolyMesherUnitTests::testIncremental()
+{
+  MeMultiPolyMesherIo input;
+  input.m_incremental = true;
+  tutSquarePolygons(4, 1, input);
+
+  BSHP<MeMultiPolyMesher> mesher = MeMultiPolyMesher::New();
+  BSHP<MeMultiPolyMesherImpl> impl = BDPC<MeMultiPolyMesherImpl>(mesher);
+  MeMultiPolyMesherIo first(input);
+  TS_ASSERT(mesher->MeshIt(first));
+  TS_ASSERT_EQUALS(4, impl->NumPolysMeshed());
+  MeMultiPolyMesherIo same(input);
+  TS_ASSERT(mesher->MeshIt(same));
+  TS_ASSERT_EQUALS(0, impl->NumPolysMeshed());
+  TS_ASSERT_EQUALS_VEC(first.m_points, same.m_points);
+  TS_ASSERT_EQUALS_VEC(first.m_cells, same.m_cells);
+
+  // change one polygon and a refine point in another
+  input.m_polys[2].m_bias = 0.5;
+  input.m_refPts.push_back(MeRefinePoint(Pt3d(50, 50, 0), 5.0, true));
+  MeMultiPolyMesherIo edited(input);
+  TS_ASSERT(mesher->MeshIt(edited));
+  TS_ASSERT_EQUALS(2, impl->NumPolysMeshed());
+
+  MeMultiPolyMesherIo all(input);
+  all.m_incremental = false;
+  TS_ASSERT(MeMultiPolyMesher::New()->MeshIt(all));
+  TS_ASSERT(first.m_points != edited.m_points);
+  TS_ASSERT_EQUALS_VEC(all.m_points, edited.m_points);
+  TS_ASSERT_EQUALS_VEC(all.m_cells, edited.m_cells);
+  TS_ASSERT_EQUALS_VEC(all.m_cellPolygons, edited.m_cellPolygons);
+
+  // changing the scalars of a shared size function remeshes its polygons
+  BSHP<VecPt3d> sPts(new VecPt3d());
+  *sPts = {{-10, -10, 10}, {-10, 110, 10}, {410, 110, 10}, {410, -10, 10}};
+  BSHP<VecInt> sTris(new VecInt());
+  *sTris = {0, 2, 1, 0, 3, 2};
+  BSHP<InterpBase> sizeFunc(InterpLinear::New());
+  sizeFunc->SetPtsTris(sPts, sTris);
+  input.m_polys[0].m_sizeFunction = sizeFunc;
+  input.m_polys[3].m_sizeFunction = sizeFunc;
+  MeMultiPolyMesherIo sized(input);
+  TS_ASSERT(mesher->MeshIt(sized));
+  TS_ASSERT_EQUALS(2, impl->NumPolysMeshed());
+  VecFlt scalars(sPts->size(), 20.0);
+  sizeFunc->SetScalars(scalars);
+  MeMultiPolyMesherIo rescaled(input);
+  TS_ASSERT(mesher->MeshIt(rescaled));
+  TS_ASSERT_EQUALS(2, impl->NumPolysMeshed());
+  TS_ASSERT(sized.m_points != rescaled.m_points);
+} // MeMultiPolyMesherUnitTests::testIncremental
+//------------------------------------------------------------------------------
+/// \brief Tests the time and counts of the stages of meshing each polygon.
+//------------------------------------------------------------------------------
+void MeMultiPolyMesherUnitTests::testStats()
+{
+  MeMultiPolyMesherIo input;
+  tutSquarePolygons(2, 10, input);
+  // the second polygon is not paved or relaxed
+  input.m_polys[1].m_seedPoints = {{150, 50, 0}};
+
+  BSHP<MeMultiPolyMesher> mesher = MeMultiPolyMesher::New();
+  MeMultiPolyMesherIo plain(input);
+  TS_ASSERT(mesher->MeshIt(plain));
+  TS_ASSERT(plain.m_polyStats.empty());
+
+  MeMultiPolyMesherIo timed(input);
+  timed.m_returnStats = true;
+  TS_ASSERT(mesher->MeshIt(timed));
+  TS_ASSERT_EQUALS_VEC(plain.m_points, timed.m_points);
+  TS_ASSERT_EQUALS_VEC(plain.m_cells, timed.m_cells);
+  TS_ASSERT_EQUALS(2, timed.m_polyStats.size());
+
+  const MePolyMeshStats& paved = timed.m_polyStats[0];
+  TS_ASSERT_EQUALS(1, paved.m_calls[MePolyMeshStats::GENERATE_MESH_PTS]);
+  TS_ASSERT(paved.m_calls[MePolyMeshStats::DO_PAVE] > 0);
+  TS_ASSERT_EQUALS(2 * paved.m_calls[MePolyMeshStats::DO_PAVE],
+                   paved.m_calls[MePolyMeshStats::CLEAN_PAVE]);
+  TS_ASSERT(paved.m_calls[MePolyMeshStats::TRIANGULATE] > 0);
+  TS_ASSERT(paved.m_calls[MePolyMeshStats::RELAX] > 0);
+  TS_ASSERT(paved.m_seconds[MePolyMeshStats::GENERATE_MESH_PTS] >=
+            paved.m_seconds[MePolyMeshStats::DO_PAVE]);
+  TS_ASSERT(paved.m_numRings > 1);
+  TS_ASSERT(paved.m_numMeshPts > 40);
+  TS_ASSERT(paved.m_maxPavePolyPts >= 40);
+
+  const MePolyMeshStats& seeded = timed.m_polyStats[1];
+  TS_ASSERT_EQUALS(1, seeded.m_calls[MePolyMeshStats::GENERATE_MESH_PTS]);
+  TS_ASSERT_EQUALS(0, seeded.m_calls[MePolyMeshStats::DO_PAVE]);
+  TS_ASSERT_EQUALS(0, seeded.m_calls[MePolyMeshStats::RELAX]);
+  TS_ASSERT_EQUALS(0, seeded.m_numMeshPts);
+} // MeMultiPolyMesherUnitTests::testStats
+//------------------------------------------------------------------------------
+/// \brief Tests writing a trace of meshing 2 polygons on 2 threads.
+//------------------------------------------------------------------------------
+void MeMultiPolyMesherUnitTests::testTrace()
+{
+#ifdef XMS_TEST_PATH
+  const std::string path(std::string(XMS_TEST_PATH) + "meshing/");
+#else
+  const std::string path("test_files/meshing/");
+#endif
+  MeMultiPolyMesherIo input;
+  tutSquarePolygons(2, 1, input);
+  input.m_numThreads = 2;
+  input.m_traceFile = path + "MeMultiPolyMesher_trace_out.json";
+  BSHP<MeMultiPolyMesher> mesher = MeMultiPolyMesher::New();
+  TS_ASSERT(mesher->MeshIt(input));
+
+  std::ifstream is(input.m_traceFile.c_str());
+  TS_ASSERT(is.good());
+  std::string json((std::istreambuf_iterator<char>(is)), std::istreambuf_iterator<char>());
+  TS_ASSERT_EQUALS(0, json.find("{\"traceEvents\":["));
+  TS_ASSERT(json.find("\"name\":\"caller\"") != std::string::npos);
+  TS_ASSERT(json.find("\"name\":\"thread 1\"") != std::string::npos);
+  TS_ASSERT(json.find("\"args\":{\"poly\":0}") != std::string::npos);
+  TS_ASSERT(json.find("\"args\":{\"poly\":1}") != std::string::npos);
+  TS_ASSERT(json.find("\"name\":\"merge_polygon\"") != std::string::npos);
+  TS_ASSERT(json.find("\"name\":\"pave_poly\"") != std::string::npos);
+  TS_ASSERT(json.find("\"args\":{\"ring\":1}") != std::string::npos);
+  TS_ASSERT(json.find("\"name\":\"triangulate\"") != std::string::npos);
+  TS_ASSERT(json.find("\"name\":\"relax\"") != std::string::npos);
+} // MeMultiPolyMesherUnitTests::testTrace
 
 //} // namespace xms
 
@@ -29,6 +29,18 @@ public:
   void testCheckForIntersections3();
   void testCheckForIntersections4();
   void testCheckForIntersections5();
+  void testCheckForIntersectionsParallel();
+  void testParallelMatchesSerial();
+  void testParallelRelax();
+  void testSharedSizeFunction();
+  void testSharedElevFunction();
+  void testRelaxMetrics();
+  void testMergeTolerance();
+  void testMeshSink();
+  void testMeshItReusingIo();
+  void testIncremental();
+  void testStats();
+  void testTrace();
 };
 
 //} // namespace xms
@@ -23,6 +23,7 @@
 namespace xms
 {
 class InterpBase;
+class MeMeshSink;
 //----- Constants / Enumerations -----------------------------------------------
 
 //----- Structs / Classes ------------------------------------------------------
@@ -59,6 +60,10 @@ public:
   , m_removeInternalFourTrianglePts(false)
   , m_polyId(-1)
   , m_relaxationMethod()
+  , m_sizeFromPolyTolerance(0.0)
+  , m_relaxMaxIterations(3)
+  , m_relaxTolerance(0.0)
+  , m_relaxTimeLimit(0.0)
   {
   }
 
@@ -106,11 +111,100 @@ public:
   VecPt3d m_seedPoints;
 
   /// Optional. Relaxation method. The default relaxation method is an area
-  /// relax. Set the value to "spring_relaxation". See MeRelaxer.cpp for
-  /// details on spring relaxation;
+  /// relax. Set the value to "spring_relaxation" or "odt_relaxation". See
+  /// MeRelaxer.cpp for details on spring and optimal Delaunay relaxation;
   std::string m_relaxationMethod;
+
+  /// Optional. Tolerance for approximating the size function that is created
+  /// from the spacing of the polygon points when m_sizeFunction is not set.
+  /// Larger values are faster and less accurate. The relative error of the
+  /// sizes is less than the tolerance. The default of 0 is exact.
+  double m_sizeFromPolyTolerance;
+
+  /// Optional. Most relaxation iterations. The default is 3.
+  int m_relaxMaxIterations;
+
+  /// Optional. Relaxation stops when an iteration changes the average
+  /// triangle quality (see MeRelaxIteration) by less than this. The default of
+  /// 0 always does m_relaxMaxIterations iterations.
+  double m_relaxTolerance;
+
+  /// Optional. Relaxation stops after the iteration that uses up this many
+  /// seconds. The default of 0 has no time limit. At least 1 iteration is done.
+  double m_relaxTimeLimit;
 }; // MePolyInput
 
+////////////////////////////////////////////////////////////////////////////////
+/// \class MeRelaxIteration
+/// \brief How much one relaxation iteration of a polygon moved the points and
+/// the triangle quality after it. The quality of a triangle is
+/// 4 * sqrt(3) * area / (sum of squared edge lengths), which is 1 for an
+/// equilateral triangle and goes to 0 as the triangle flattens.
+class MeRelaxIteration
+{
+public:
+  /// \brief Constructor
+  MeRelaxIteration()
+  : m_maxMove(0.0)
+  , m_meanMove(0.0)
+  , m_minQuality(0.0)
+  , m_meanQuality(0.0)
+  {
+  }
+
+  double m_maxMove;     ///< Farthest a point moved.
+  double m_meanMove;    ///< Average distance the relaxed points moved.
+  double m_minQuality;  ///< Quality of the worst triangle.
+  double m_meanQuality; ///< Average quality of the triangles.
+}; // MeRelaxIteration
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MePolyMeshStats
+/// \brief Time spent in each stage of meshing a polygon and counts of the work
+/// done. Stages run on several threads have the time of each thread added.
+class MePolyMeshStats
+{
+public:
+  /// Stages of meshing a polygon. The paving stages are part of
+  /// GENERATE_MESH_PTS.
+  enum Stage
+  {
+    GENERATE_MESH_PTS,     ///< MePolyMesher creating the mesh points
+    DO_PAVE,               ///< paving one ring in from a polygon
+    CLEAN_PAVE,            ///< removing overlaps from the paved polygons
+    REDISTRIBUTE_PTS,      ///< redistributing the points of a ring
+    CLASSIFY_POLYS,        ///< splitting a ring into polygons to pave next
+    TRIANGULATE,           ///< triangulating the mesh points
+    FIND_POLY_POINT_IDXS,  ///< finding the mesh points on the polygons
+    FIX_FOUR_TRIANGLE_PTS, ///< removing points with 4 triangles
+    ADD_BREAKLINES,        ///< adding the polygon edges to the triangles
+    DELETE_OUTSIDE_TRIS,   ///< deleting triangles outside of the polygon
+    RELAX,                 ///< relaxing the mesh points
+    NUM_STAGES             ///< number of stages
+  };
+
+  /// \brief Constructor
+  MePolyMeshStats()
+  : m_numRings(0)
+  , m_numMeshPts(0)
+  , m_maxPaveStack(0)
+  , m_maxPavePolyPts(0)
+  {
+    for (int i = 0; i < NUM_STAGES; ++i)
+    {
+      m_seconds[i] = 0.0;
+      m_calls[i] = 0;
+    }
+  }
+
+  double m_seconds[NUM_STAGES]; ///< Seconds spent in each stage.
+  int m_calls[NUM_STAGES];      ///< Number of times each stage was done.
+  int m_numRings;               ///< Most rings paved in from the boundary.
+  int m_numMeshPts;             ///< Number of mesh points created by paving.
+  int m_maxPaveStack;           ///< Most polygons waiting to be paved.
+  int m_maxPavePolyPts;         ///< Most points in a polygon being paved.
+}; // MePolyMeshStats
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \class MeRefinePoint
 /// \brief A refine point used in meshing.
@@ -153,6 +247,14 @@ public:
   , m_refPts()
   , m_checkTopology(false)
   , m_returnCellPolygons(true)
+  , m_numThreads(1)
+  , m_parallelRelax(false)
+  , m_returnRelaxMetrics(false)
+  , m_mergeTolerance(0.0)
+  , m_meshSink()
+  , m_incremental(false)
+  , m_returnStats(false)
+  , m_traceFile()
   , m_cellPolygons()
   {
   }
@@ -169,10 +271,66 @@ public:
   /// If true, returns the polygon index of each cell.
   bool m_returnCellPolygons;
 
+  /// Optional. Number of threads used to mesh the polygons. The default of 1
+  /// meshes the polygons one after another. A value of 0 uses one thread per
+  /// hardware core. Threads that are not needed for other polygons are used to
+  /// pave (and relax, see m_parallelRelax) the inside of a polygon, so a
+  /// single large polygon also benefits. The mesh does not depend on the
+  /// number of threads. Size and elevation functions shared by several
+  /// polygons are used by one thread at a time.
+  int m_numThreads;
+
+  /// Optional. If true, the mesh points are relaxed in color classes (see
+  /// MeRelaxer) so the threads not needed for other polygons also help relax
+  /// a polygon. The mesh differs slightly from relaxing the points one after
+  /// another but it does not depend on m_numThreads.
+  bool m_parallelRelax;
+
+  /// Optional. If true, returns m_relaxMetrics.
+  bool m_returnRelaxMetrics;
+
+  /// Optional. Points on the boundaries of neighboring polygons that are
+  /// within this xy distance of each other are merged into one point. The
+  /// default of 0 only merges points with the same x and y.
+  double m_mergeTolerance;
+
+  /// Optional. If set, the mesh of each polygon is given to the sink as soon
+  /// as it is merged into the mesh and m_points, m_cells and m_cellPolygons
+  /// are left empty. Only the points on the polygon boundaries are kept while
+  /// meshing.
+  BSHP<MeMeshSink> m_meshSink;
+
+  /// Optional. If true, the MeMultiPolyMesher keeps the mesh of each polygon
+  /// and polygons whose inputs have not changed since its last call to MeshIt
+  /// are not meshed again. The output is the same as meshing all of the
+  /// polygons. The inputs of a polygon include the refine points inside the
+  /// bounds of its outer polygon and the points, triangles, scalars and
+  /// options of its size and elevation functions. A polygon whose size or
+  /// elevation function is replaced by a different object is meshed again.
+  /// Messages logged while meshing a polygon are not logged again when its
+  /// mesh is reused.
+  bool m_incremental;
+
+  /// Optional. If true, returns m_polyStats. Nothing is timed or counted when
+  /// false.
+  bool m_returnStats;
+
+  /// Optional. If not empty, a timeline of meshing is written to this file as
+  /// trace event JSON that can be loaded in a trace viewer such as
+  /// chrome://tracing or Perfetto. There is a span for each polygon and for
+  /// each paving iteration and stage within it, with one lane per thread.
+  std::string m_traceFile;
+
   // Output:
   VecPt3d m_points;      ///< The points of the resulting mesh.
   VecInt m_cells;        ///< The cells of the resulting mesh, as a stream.
   VecInt m_cellPolygons; ///< Polygon index of each cell.
+  /// Relaxation iterations of each polygon. Empty for polygons that were
+  /// patched, given seed points or failed to mesh.
+  std::vector<std::vector<MeRelaxIteration>> m_relaxMetrics;
+  /// Time and counts of meshing each polygon. Zero for polygons that failed to
+  /// mesh or whose mesh was reused (see m_incremental).
+  std::vector<MePolyMeshStats> m_polyStats;
 
 }; // MeMultiPolyMesherIo
 
@@ -14,6 +14,7 @@
 
 // 3. Standard library headers
 #include <fstream>
+#include <limits>
 
 // 4. External library headers
 #pragma warning(push)
@@ -38,10 +39,14 @@
 #include <xmsinterp/triangulate/TrTriangulatorPoints.h>
 #include <xmsinterp/triangulate/TrBreaklineAdder.h>
 #include <xmsinterp/triangulate/TrTin.h>
+#include <xmsmesh/meshing/detail/MeParallel.h>
 #include <xmsmesh/meshing/detail/MePolyPaverToMeshPts.h>
 #include <xmsmesh/meshing/detail/MePolyPatcher.h>
 #include <xmsmesh/meshing/detail/MeRefinePtsToPolys.h>
 #include <xmsmesh/meshing/detail/MeRelaxer.h>
+#include <xmsmesh/meshing/detail/MeSizeFunctionTris.h>
+#include <xmsmesh/meshing/detail/MeStageTimer.h>
+#include <xmsmesh/meshing/detail/MeTracer.h>
 #include <xmsmesh/meshing/MeMeshUtils.h>
 #include <xmsmesh/meshing/MeMultiPolyMesherIo.h>
 #include <xmsmesh/meshing/MePolyRedistributePts.h>
@@ -56,6 +61,11 @@
 
 namespace xms
 {
+// function to access method on MePolyRedistributePtsImpl that we don't want in
+// the public interface.
+void mePolyRedistributeSetSizeFuncTris(BSHP<MePolyRedistributePts> a_redist,
+                                       BSHP<MeSizeFunctionTris> a_sizeFuncTris);
+
 //----- Constants / Enumerations -----------------------------------------------
 
 //----- Classes / Structs ------------------------------------------------------
@@ -90,6 +100,11 @@ public:
                       VecInt& a_triangles);
 
   virtual void GetProcessedRefinePts(std::vector<Pt3d>& a_pts) override;
+  virtual void GetRelaxMetrics(std::vector<MeRelaxIteration>& a_metrics) override;
+  virtual void GetStats(MePolyMeshStats& a_stats) override;
+
+  void SetSizeFuncTris(const std::vector<BSHP<MeSizeFunctionTris>>& a_sizeFuncTris);
+  void SetTracer(MeTracer* a_tracer);
 
   void TestWithPoints(const VecInt& a_outPoly,
                       const VecInt2d& a_inPolys,
@@ -110,6 +125,7 @@ private:
   void DeleteTrianglesOutsidePolys();
   void AutoFixFourTrianglePts();
   void Relax();
+  void InterpElevations(VecPt3d& a_points);
   void ExportTinForDebug();
 
 private:
@@ -144,6 +160,10 @@ private:
   VecPt3d m_boundPtsToRemove; ///< boundary points to remove after the paving process is complete
   bool m_removeInternalFourTrianglePts =
     false; ///< flag to indicate the removal of internal pts connected to 4 triangles will occur
+  /// size function triangles shared with other polygons
+  std::vector<BSHP<MeSizeFunctionTris>> m_sizeFuncTris;
+  BSHP<MePolyMeshStats> m_stats; ///< time and counts of the stages, null if not wanted
+  MeTracer* m_tracer;            ///< tracer spans are added to, may be null
 };         // class MePolyMesherImpl
 
 //----- Internal functions -----------------------------------------------------
@@ -200,6 +220,8 @@ MePolyMesherImpl::MePolyMesherImpl()
 , m_testing(false)
 , m_polyId(-1)
 , m_seedPts()
+, m_stats()
+, m_tracer(nullptr)
 {
 } // MePolyMesherImpl::MePolyMesherImpl
 //------------------------------------------------------------------------------
@@ -238,6 +260,13 @@ bool MePolyMesherImpl::MeshIt(const MeMultiPolyMesherIo& a_input,
     m_relaxer->SetRelaxationMethod(polyInput.m_relaxationMethod);
     m_relaxer->SetPointSizer(m_redist);
   }
+  m_relaxer->SetMaxIterations(polyInput.m_relaxMaxIterations);
+  m_relaxer->SetConvergenceTolerance(polyInput.m_relaxTolerance);
+  m_relaxer->SetTimeLimit(polyInput.m_relaxTimeLimit);
+  m_relaxer->SetComputeMetrics(a_input.m_returnRelaxMetrics);
+  m_stats.reset(a_input.m_returnStats ? new MePolyMeshStats() : nullptr);
+  m_polyPaver->SetStats(m_stats.get());
+  m_polyPaver->SetTracer(m_tracer);
 
   m_polyId = polyInput.m_polyId;
   m_outPoly = polyInput.m_outPoly;
@@ -257,11 +286,21 @@ bool MePolyMesherImpl::MeshIt(const MeMultiPolyMesherIo& a_input,
   {
     VecPt3d2d inPolys(m_inPolys);
     inPolys.insert(inPolys.end(), m_refPtPolys.begin(), m_refPtPolys.end());
+    m_redist->SetSizeFromPolyTolerance(polyInput.m_sizeFromPolyTolerance);
     m_redist->SetSizeFuncFromPoly(m_outPoly, inPolys, m_bias);
   }
   else
   {
-    m_redist->SetSizeFunc(polyInput.m_sizeFunction);
+    BSHP<MeSizeFunctionTris> sizeFuncTris;
+    for (size_t i = 0; !sizeFuncTris && i < m_sizeFuncTris.size(); ++i)
+    {
+      if (m_sizeFuncTris[i]->IsCurrent(polyInput.m_sizeFunction))
+        sizeFuncTris = m_sizeFuncTris[i];
+    }
+    if (sizeFuncTris)
+      mePolyRedistributeSetSizeFuncTris(m_redist, sizeFuncTris);
+    else
+      m_redist->SetSizeFunc(polyInput.m_sizeFunction);
   }
   if (polyInput.m_constSizeFunction != -1.0)
   {
@@ -270,6 +309,14 @@ bool MePolyMesherImpl::MeshIt(const MeMultiPolyMesherIo& a_input,
       m_redist->SetConstantSizeBias(polyInput.m_constSizeBias);
   }
   m_polyPaver->SetRedistributor(m_redist);
+  // threads that are not used to mesh other polygons help pave and relax
+  // this one. Only colored relaxation uses them so the number of threads does
+  // not change the mesh.
+  int numThreads = meNumThreadsToUse(a_input.m_numThreads, std::numeric_limits<size_t>::max());
+  int polyThreads = meNumThreadsToUse(a_input.m_numThreads, a_input.m_polys.size());
+  m_polyPaver->SetNumThreads(numThreads / polyThreads);
+  m_relaxer->SetNumThreads(numThreads / polyThreads);
+  m_relaxer->SetColored(a_input.m_parallelRelax);
 
   // patch
   if (!polyInput.m_polyCorners.empty())
@@ -347,6 +394,41 @@ void MePolyMesherImpl::GetProcessedRefinePts(std::vector<Pt3d>& a_pts)
   a_pts.insert(a_pts.end(), m_refPtsTooClose.begin(), m_refPtsTooClose.end());
 } // MePolyMesherImpl::GetProcessedRefinePts
 //------------------------------------------------------------------------------
+/// \brief Gets the metrics of each relaxation iteration of the polygon.
+/// \param a_metrics The metrics. Empty if the polygon was not relaxed.
+//------------------------------------------------------------------------------
+void MePolyMesherImpl::GetRelaxMetrics(std::vector<MeRelaxIteration>& a_metrics)
+{
+  a_metrics = m_relaxer->GetMetrics();
+} // MePolyMesherImpl::GetRelaxMetrics
+//------------------------------------------------------------------------------
+/// \brief Gets the time and counts of the stages of meshing the polygon.
+/// \param a_stats The stats. Zero if MeMultiPolyMesherIo::m_returnStats was
+/// false.
+//------------------------------------------------------------------------------
+void MePolyMesherImpl::GetStats(MePolyMeshStats& a_stats)
+{
+  a_stats = m_stats ? *m_stats : MePolyMeshStats();
+} // MePolyMesherImpl::GetStats
+//------------------------------------------------------------------------------
+/// \brief Sets size function triangles that were built once for all of the
+/// polygons. A polygon whose size function matches one of them uses it
+/// instead of triangulating the size function again.
+/// \param a_sizeFuncTris Size function triangles shared by the polygons.
+//------------------------------------------------------------------------------
+void MePolyMesherImpl::SetSizeFuncTris(const std::vector<BSHP<MeSizeFunctionTris>>& a_sizeFuncTris)
+{
+  m_sizeFuncTris = a_sizeFuncTris;
+} // MePolyMesherImpl::SetSizeFuncTris
+//------------------------------------------------------------------------------
+/// \brief Sets the tracer that the stages of meshing are added to as spans.
+/// \param a_tracer The tracer. May be null.
+//------------------------------------------------------------------------------
+void MePolyMesherImpl::SetTracer(MeTracer* a_tracer)
+{
+  m_tracer = a_tracer;
+} // MePolyMesherImpl::SetTracer
+//------------------------------------------------------------------------------
 /// \brief Creates the mesh from inputs that have set member variables in the
 /// class.
 /// \param[out] a_points:    Points filled by meshing.
@@ -386,19 +468,43 @@ bool MePolyMesherImpl::MeshFromInputs(VecPt3d& a_points, VecInt& a_triangles, Ve
     m_tin->Clear();
     m_polyCorners.clear();
     if (m_elev)
-      for (Pt3d& p : a_points)
-        p.z = (double)m_elev->InterpToPt(p);
+      InterpElevations(a_points);
   }
   catch (std::exception& e)
   {
     std::string msg = e.what();
     meModifyMessageWithPolygonId(m_polyId, msg);
-    XM_LOG(xmlog::error, msg);
+    {
+      std::lock_guard<std::mutex> lock(meLogMutex());
+      XM_LOG(xmlog::error, msg);
+    }
     return false;
   }
   return true;
 } // MePolyMesherImpl::MeshFromInputs
 //------------------------------------------------------------------------------
+/// \brief Interpolates the elevation of each mesh point from m_elev. An
+/// elevation function shared with other polygons (see SetSizeFuncTris) is used
+/// through its MeSizeFunctionTris so only one thread at a time uses it.
+/// \param[in,out] a_points: The mesh points.
+//------------------------------------------------------------------------------
+void MePolyMesherImpl::InterpElevations(VecPt3d& a_points)
+{
+  for (size_t i = 0; i < m_sizeFuncTris.size(); ++i)
+  {
+    if (m_sizeFuncTris[i]->IsCurrent(m_elev))
+    {
+      VecFlt z;
+      m_sizeFuncTris[i]->InterpToPts(a_points, z);
+      for (size_t j = 0; j < z.size(); ++j)
+        a_points[j].z = (double)z[j];
+      return;
+    }
+  }
+  for (Pt3d& p : a_points)
+    p.z = (double)m_elev->InterpToPt(p);
+} // MePolyMesherImpl::InterpElevations
+//------------------------------------------------------------------------------
 /// \brief Used only for testing. Test the class by supplying the polygons
 ///        and mesh points.
 /// \param[in] a_outPoly: Outer polygon.
@@ -471,6 +577,7 @@ void MePolyMesherImpl::GenerateMeshPts()
 {
   if (m_testing)
     return;
+  MeStageTimer timer(m_stats.get(), MePolyMeshStats::GENERATE_MESH_PTS, m_tracer);
   if (!m_polyCorners.empty())
   {
     if (!m_seedPts.empty())
@@ -501,6 +608,8 @@ void MePolyMesherImpl::GenerateMeshPts()
     {
       // generate mesh points
       m_polyPaver->PolyToMeshPts(m_outPoly, inPolys, m_bias, m_xyTol, *m_points);
+      if (m_stats)
+        m_stats->m_numMeshPts = (int)m_points->size();
     }
 
     // add the mesh refine points
@@ -548,6 +657,7 @@ void MePolyMesherImpl::ProcessBoundaryPtsFlaggedToRemove()
 //------------------------------------------------------------------------------
 void MePolyMesherImpl::Triangulate()
 {
+  MeStageTimer timer(m_stats.get(), MePolyMeshStats::TRIANGULATE, m_tracer);
   m_tin->SetPoints(m_points);
   TrTriangulatorPoints client(*m_points.get(), m_tin->Triangles(), &m_tin->TrisAdjToPts());
   bool rv = client.Triangulate();
@@ -572,6 +682,7 @@ void MePolyMesherImpl::ExportTinForDebug()
 //------------------------------------------------------------------------------
 void MePolyMesherImpl::AddBreaklines()
 {
+  MeStageTimer timer(m_stats.get(), MePolyMeshStats::ADD_BREAKLINES, m_tracer);
   BSHP<TrBreaklineAdder> adder = TrBreaklineAdder::New();
   adder->SetTin(m_tin, m_xyTol);
 
@@ -596,6 +707,7 @@ void MePolyMesherImpl::AddBreaklines()
 //------------------------------------------------------------------------------
 void MePolyMesherImpl::DeleteTrianglesOutsidePolys()
 {
+  MeStageTimer timer(m_stats.get(), MePolyMeshStats::DELETE_OUTSIDE_TRIS, m_tracer);
   // Close the polygons by making the last point the same as the first and
   // create one 2D array for outer and all inner
   VecInt2d allPolys;
@@ -618,6 +730,7 @@ void MePolyMesherImpl::AutoFixFourTrianglePts()
 {
   if (!m_removeInternalFourTrianglePts)
     return;
+  MeStageTimer timer(m_stats.get(), MePolyMeshStats::FIX_FOUR_TRIANGLE_PTS, m_tracer);
   BSHP<TrAutoFixFourTrianglePts> fixer = TrAutoFixFourTrianglePts::New();
 
   // can't delete boundary pts or refine points
@@ -644,6 +757,7 @@ void MePolyMesherImpl::Relax()
   // if the user specified the seed points then do not relax
   if (!m_seedPts.empty())
     return;
+  MeStageTimer timer(m_stats.get(), MePolyMeshStats::RELAX, m_tracer);
 
   // Put polygons into one vector
   VecInt fixedPoints(m_outPolyPtIdxs.begin(), m_outPolyPtIdxs.end());
@@ -653,7 +767,12 @@ void MePolyMesherImpl::Relax()
   }
   // add refine points to the fixed
   fixedPoints.insert(fixedPoints.end(), m_refPtIdxs.begin(), m_refPtIdxs.end());
+  size_t numPts(m_points->size());
   m_relaxer->Relax(fixedPoints, m_tin);
+  // points deleted by the relaxer are replaced by the last point so the
+  // indices of the poly points may have changed
+  if (m_points->size() != numPts && !m_tin->Triangles().empty())
+    FindAllPolyPointIdxs();
 } // MePolyMesherImpl::Relax
 //------------------------------------------------------------------------------
 /// \brief Find the indices of the poly points among m_points. They will most
@@ -662,6 +781,7 @@ void MePolyMesherImpl::Relax()
 //------------------------------------------------------------------------------
 void MePolyMesherImpl::FindAllPolyPointIdxs()
 {
+  MeStageTimer timer(m_stats.get(), MePolyMeshStats::FIND_POLY_POINT_IDXS, m_tracer);
   m_ptHash.clear();
   std::pair<std::pair<double, double>, int> pd;
   size_t nPts(m_points->size());
@@ -714,6 +834,32 @@ void MePolyMesherImpl::FindPolyPointIdxs(const VecPt3d& a_poly, VecInt& a_polyPt
       a_polyPtIdxs.push_back(it->second);
   }
 } // MePolyMesherImpl::FindPolyPointIdxs
+//------------------------------------------------------------------------------
+/// \brief Free function to give a MePolyMesher the size function triangles
+/// shared by all polygons. Keeps MeSizeFunctionTris out of the public
+/// interface.
+/// \param[in] a_mesher: a MePolyMesher class
+/// \param[in] a_sizeFuncTris: Size function triangles shared by the polygons.
+//------------------------------------------------------------------------------
+void mePolyMesherSetSizeFuncTris(BSHP<MePolyMesher> a_mesher,
+                                 const std::vector<BSHP<MeSizeFunctionTris>>& a_sizeFuncTris)
+{
+  BSHP<MePolyMesherImpl> m = BDPC<MePolyMesherImpl>(a_mesher);
+  XM_ENSURE_TRUE_VOID(m);
+  m->SetSizeFuncTris(a_sizeFuncTris);
+} // mePolyMesherSetSizeFuncTris
+//------------------------------------------------------------------------------
+/// \brief Free function to give a MePolyMesher a tracer. Keeps MeTracer out of
+/// the public interface.
+/// \param[in] a_mesher: a MePolyMesher class
+/// \param[in] a_tracer: The tracer. May be null.
+//------------------------------------------------------------------------------
+void mePolyMesherSetTracer(BSHP<MePolyMesher> a_mesher, MeTracer* a_tracer)
+{
+  BSHP<MePolyMesherImpl> m = BDPC<MePolyMesherImpl>(a_mesher);
+  XM_ENSURE_TRUE_VOID(m);
+  m->SetTracer(a_tracer);
+} // mePolyMesherSetTracer
 
 } // namespace xms
 
@@ -26,6 +26,8 @@
 namespace xms
 {
 class MeMultiPolyMesherIo;
+class MeRelaxIteration;
+class MePolyMeshStats;
 //----- Constants / Enumerations -----------------------------------------------
 
 //----- Structs / Classes ------------------------------------------------------
@@ -52,6 +54,8 @@ public:
                       VecInt& a_cell) = 0;
 
   virtual void GetProcessedRefinePts(VecPt3d& a_pts) = 0;
+  virtual void GetRelaxMetrics(std::vector<MeRelaxIteration>& a_metrics) = 0;
+  virtual void GetStats(MePolyMeshStats& a_stats) = 0;
 
 private:
   XM_DISALLOW_COPY_AND_ASSIGN(MePolyMesher);
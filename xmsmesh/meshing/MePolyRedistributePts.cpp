@@ -13,12 +13,11 @@
 #include <xmsmesh/meshing/MePolyRedistributePts.h>
 
 // 3. Standard library headers
+#include <algorithm>
 #include <cfloat>
 #include <sstream>
 
 // 4. External library headers
-#include <boost/make_shared.hpp>
-#include <boost/thread/mutex.hpp>
 
 // 5. Shared code headers
 #include <xmscore/points/pt.h>
@@ -26,15 +25,15 @@
 #include <xmscore/misc/StringUtil.h>
 #include <xmscore/stl/vector.h>
 #include <xmsinterp/geometry/GmMultiPolyIntersector.h>
-#include <xmsinterp/geometry/GmMultiPolyIntersectionSorter.h>
-#include <xmsinterp/geometry/GmMultiPolyIntersectionSorterTerse.h>
 #include <xmsinterp/interpolate/InterpBase.h>
+#include <xmsmesh/meshing/detail/MeParallel.h>
 #include <xmsmesh/meshing/detail/MePolyOffsetter.h>
 #include <xmsmesh/meshing/detail/MePolyRedistributePtsCurvature.h>
+#include <xmsmesh/meshing/detail/MePolySizeTree.h>
+#include <xmsmesh/meshing/detail/MeSizeFunctionTris.h>
 #include <xmscore/misc/xmstype.h>
 #include <xmscore/misc/XmError.h>
 #include <xmscore/misc/XmLog.h>
-#include <xmsinterp/triangulate/TrTriangulatorPoints.h>
 #include <xmscore/misc/XmConst.h>
 
 // 6. Non-shared code headers
@@ -47,10 +46,72 @@
 namespace xms
 {
 //----- Constants / Enumerations -----------------------------------------------
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 6 && defined(__x86_64__) && \
+  defined(__linux__)
+/// Compiles the function for AVX-512, AVX2 and the default instruction set.
+/// The best one for the cpu is selected when the program is loaded.
+#define ME_SIMD_CLONES __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+/// Compiles the function for the instruction set given to the compiler.
+#define ME_SIMD_CLONES
+#endif
+
+namespace
+{
+const size_t IDW_BATCH = 8; ///< number of locations interpolated together
+} // unnamed namespace
 
 //----- Classes / Structs ------------------------------------------------------
 
 //----- Internal functions -----------------------------------------------------
+namespace
+{
+//------------------------------------------------------------------------------
+/// \brief Interpolates the polygon edge lengths to IDW_BATCH locations. Uses
+/// the same weights as MePolyRedistributePtsImpl::CalcInterpWeights. The
+/// polygon points are in separate x and y arrays and the loop over the
+/// locations is innermost so that the compiler can use vector instructions.
+/// The sums for each location are done in the same order as
+/// CalcInterpWeights so the results only differ from it by rounding.
+/// \param[in] a_x: x coordinates of the polygon points.
+/// \param[in] a_y: y coordinates of the polygon points.
+/// \param[in] a_lengths: Edge length at each polygon point.
+/// \param[in] a_n: Number of polygon points.
+/// \param[in] a_minLength: Minimum edge length.
+/// \param[in] a_sizeBias: Transition factor for the size function.
+/// \param[in] a_qx: x coordinates of the IDW_BATCH locations.
+/// \param[in] a_qy: y coordinates of the IDW_BATCH locations.
+/// \param[out] a_result: Interpolated length at the IDW_BATCH locations.
+//------------------------------------------------------------------------------
+ME_SIMD_CLONES
+void iIdwBatch(const double* a_x,
+               const double* a_y,
+               const double* a_lengths,
+               size_t a_n,
+               double a_minLength,
+               double a_sizeBias,
+               const double* a_qx,
+               const double* a_qy,
+               double* a_result)
+{
+  double sumWt[IDW_BATCH] = {0}, sumWtLength[IDW_BATCH] = {0};
+  for (size_t i = 0; i < a_n; ++i)
+  {
+    const double x(a_x[i]), y(a_y[i]), length(a_lengths[i]);
+    const double factor = a_minLength + (a_sizeBias * (length - a_minLength));
+    for (size_t k = 0; k < IDW_BATCH; ++k)
+    {
+      double dx = a_qx[k] - x, dy = a_qy[k] - y;
+      double d2 = dx * dx + dy * dy;
+      double wt = (d2 < 10e-8 ? 10e10 : 1 / d2) * factor;
+      sumWt[k] += wt;
+      sumWtLength[k] += wt * length;
+    }
+  }
+  for (size_t k = 0; k < IDW_BATCH; ++k)
+    a_result[k] = sumWtLength[k] / sumWt[k];
+} // iIdwBatch
+} // unnamed namespace
 
 //----- Class / Function definitions -------------------------------------------
 
@@ -66,19 +127,22 @@ public:
   , m_intersectWithTris(false)
   , m_distSqTol(0)
   , m_biasConstSize(false)
-  , m_polyOffsetIter(0)
   , m_featureSizeCurvature(0)
   , m_meanSpacingCurvature(0)
   , m_minimumCurvature(0.001)
   , m_smoothCurvature(false)
   , m_curvatureRedist()
+  , m_sizeTreeTol(0)
+  , m_sizeTree()
   {
   }
 
   virtual void SetSizeFunc(BSHP<InterpBase> a_interp) override;
+  void SetSizeFuncTris(BSHP<MeSizeFunctionTris> a_sizeFuncTris);
   virtual void SetSizeFuncFromPoly(const VecPt3d& a_outPoly,
                                    const VecPt3d2d& a_inPolys,
                                    double a_sizeBias) override;
+  virtual void SetSizeFromPolyTolerance(double a_tol) override;
 
   //------------------------------------------------------------------------------
   /// \brief Sets the size function to a constant value
@@ -115,13 +179,15 @@ public:
 
   VecPt3d LoopToVecPt3d(const VecSizet& a_idx, const VecPt3d& a_pts);
   void IntersectWithTris(VecPt3d& a_pts);
-  void InterpEdgeLengths(const VecPt3d& a_pts, VecDbl& lengths);
+  void InterpEdgeLengths(const VecPt3d& a_pts, VecDbl& lengths, int a_polyOffsetIter = 0);
   void InterpToPoint(size_t a_idx,
                      const VecPt3d& a_pts,
                      VecDbl& a_lengths,
                      VecDbl& a_wt,
                      VecDbl& a_d2,
                      double& a_bias);
+  void InterpToPtsBatch(const VecPt3d& a_pts, const VecSizet& a_idx, VecDbl& a_lengths);
+  void LimitLength(double& a_length, double a_bias);
   void CalcInterpWeights(const Pt3d& a_pt, VecDbl& a_wt, VecDbl& a_d2, double& a_sumWt);
   VecPt3d RedistPts(const VecPt3d& a_pts, const VecDbl& lengths);
   VecPt3d RedistPts2(const VecPt3d& a_pts, const VecDbl& lengths);
@@ -136,13 +202,13 @@ public:
                      VecDbl& a_tVals);
   void SizeFromPolyCalcAveEdgeLengthAtPts(const VecPt3d& a_outPoly, const VecPt3d2d& a_inPolys);
   void SizeFromPolyAddEdgeLengths(const VecPt3d& a_pts);
+  void UpdateSizeTree();
   void CalcSegLengths(const VecPt3d& a_pts, VecDbl& a_segLength, VecDbl& _segTvalues);
   void GetSegmentFromTval(const VecDbl& a_segTvalues,
                           double a_tVal,
                           size_t& a_segIdx,
                           double& a_segT0,
                           double& a_segT1);
-  void CreatePolyIntersector();
 
   double m_constSize,        ///< constant size function
     m_minLength,             ///< min segment length in polygon
@@ -150,18 +216,17 @@ public:
     m_sizeBias;              ///< transition factor for size function
   BSHP<VecPt3d> m_polyPts;   ///< polygon point locations
   VecDbl m_polyEdgeLengths;  ///< edge lengths of the polygon
+  VecDbl m_polyX;            ///< x of m_polyPts. Used by InterpToPtsBatch.
+  VecDbl m_polyY;            ///< y of m_polyPts. Used by InterpToPtsBatch.
   BSHP<InterpBase> m_interp; ///< interpolation class given to this class
   // BSHP<InterpIdw>              m_idw; ///< interpolation class used with larger numbers of
   // polygon points
-  BSHP<VecPt3d> m_sizePts;                        ///< points from the m_interp class
-  BSHP<VecInt> m_sizeTris;                        ///< triangles from the m_interp class
-  BSHP<GmMultiPolyIntersector> m_polyIntersector; ///< used to intersect the polygon with m_sizeTris
-  VecInt2d m_polys; ///< polygon definition of triangles for m_polyIntersector
+  /// triangles of the m_interp class used to intersect the polygon
+  BSHP<MeSizeFunctionTris> m_sizeFuncTris;
   /// flag to indicate that polygon should be intersected with the triangles
   bool   m_intersectWithTris;
   double m_distSqTol;    ///< tolerance used to speed up interpolation
   bool m_biasConstSize;  ///< flag to indicate transitioning to constant size function
-  int m_polyOffsetIter;  ///< number of iterations from the polygon boundary
   /// Used by curvature redistribution. The size of the smallest feature in the polyline to be
   /// detected. Large values will generate point distributions that follow coarser curvatures.
   double m_featureSizeCurvature;
@@ -176,6 +241,10 @@ public:
   bool m_smoothCurvature;
   /// Point redistributor that uses curvature
   BSHP<MePolyRedistributePtsCurvature> m_curvatureRedist;
+  /// Tolerance for approximating the size function from the polygon. 0 is exact.
+  double m_sizeTreeTol;
+  /// Tree used to approximate the size function from the polygon
+  BSHP<MePolySizeTree> m_sizeTree;
 };
 
 //------------------------------------------------------------------------------
@@ -210,28 +279,22 @@ MePolyRedistributePts::MePolyRedistributePts()
 //------------------------------------------------------------------------------
 void MePolyRedistributePtsImpl::SetSizeFunc(BSHP<InterpBase> a_interp)
 {
+  SetSizeFuncTris(MeSizeFunctionTris::New(a_interp));
+} // SetSizeFunc
+//------------------------------------------------------------------------------
+/// \brief Sets the size function from triangles that were already built for
+/// the size function interpolator. The triangles may be shared with other
+/// instances of this class.
+/// \param a_sizeFuncTris Size function interpolator and its triangles
+//------------------------------------------------------------------------------
+void MePolyRedistributePtsImpl::SetSizeFuncTris(BSHP<MeSizeFunctionTris> a_sizeFuncTris)
+{
+  XM_ENSURE_TRUE_VOID(a_sizeFuncTris);
   m_curvatureRedist.reset(); // remove curvature redistribution
-  m_interp = a_interp;
+  m_interp = a_sizeFuncTris->Interp();
   m_intersectWithTris = true;
-  // make sure we have triangles
-  m_sizePts = m_interp->GetPts();
-  m_sizeTris = m_interp->GetTris();
-  if (m_intersectWithTris && m_sizeTris->empty())
-  {
-    VecInt vTris;
-    TrTriangulatorPoints tri(*m_sizePts, vTris);
-    tri.Triangulate();
-    if (!vTris.empty())
-    {
-      m_sizeTris = BSHP<VecInt>(new VecInt());
-      m_sizeTris->reserve(vTris.size());
-      for (size_t i = 0; i < vTris.size(); ++i)
-        m_sizeTris->push_back((int)vTris[i]);
-    }
-  }
-  if (m_intersectWithTris)
-    CreatePolyIntersector();
-} // SetSizeFunc
+  m_sizeFuncTris = a_sizeFuncTris;
+} // MePolyRedistributePtsImpl::SetSizeFuncTris
 //------------------------------------------------------------------------------
 /// \brief Creates an interpolator that uses the spacing on the input polygon
 /// as its scalar
@@ -287,8 +350,22 @@ void MePolyRedistributePtsImpl::SetSizeFuncFromPoly(const VecPt3d& a_outPoly,
     double boundsDistSq = MdistSq(pMin.x, pMin.y, pMax.x, pMax.y);
     m_distSqTol = 1e-4 * boundsDistSq;
   }
+  UpdateSizeTree();
 } // MePolyRedistributePtsImpl::SetSizeFuncFromPoly
 //------------------------------------------------------------------------------
+/// \brief Sets the tolerance used to approximate the size function created
+/// by SetSizeFuncFromPoly. Polygon points far from the location being
+/// interpolated are grouped together. The relative error of the interpolated
+/// size is less than the tolerance (1e-3 gives sizes within 0.1%). The default
+/// of 0 does the exact interpolation from every point.
+/// \param a_tol The tolerance. 0 for exact interpolation.
+//------------------------------------------------------------------------------
+void MePolyRedistributePtsImpl::SetSizeFromPolyTolerance(double a_tol)
+{
+  m_sizeTreeTol = a_tol;
+  UpdateSizeTree();
+} // MePolyRedistributePtsImpl::SetSizeFromPolyTolerance
+//------------------------------------------------------------------------------
 /// \brief Specifies that curvature redistribution will be used
 /// \param[in] a_featureSize: The size of the smallest feature in the polyline to be detected.
 ///   Large values will generate point distributions that follow coarser curvatures.
@@ -323,7 +400,6 @@ void MePolyRedistributePtsImpl::Redistribute(const MePolyOffsetterOutput& a_inpu
                                              int a_polyOffsetIter)
 {
   VecDbl lengths;
-  m_polyOffsetIter = a_polyOffsetIter;
   a_out.m_loops.resize(0);
   a_out.m_pts.resize(0);
   a_out.m_loopTypes.resize(0);
@@ -338,14 +414,13 @@ void MePolyRedistributePtsImpl::Redistribute(const MePolyOffsetterOutput& a_inpu
     }
     pts.push_back(pts.front());
     // interpolate edge lengths
-    InterpEdgeLengths(pts, lengths);
+    InterpEdgeLengths(pts, lengths, a_polyOffsetIter);
     // redistribute the points
     VecPt3d redistPts = RedistPts(pts, lengths);
     if (!redistPts.empty())
       redistPts.pop_back();
     RedistPtsToOutput(redistPts, lType, a_out);
   }
-  m_polyOffsetIter = 0;
 } // MePolyPaverToMeshPtsImpl::Redistribute
 //------------------------------------------------------------------------------
 /// \brief Redistributes points on a polyline.
@@ -384,10 +459,10 @@ double MePolyRedistributePtsImpl::SizeFromLocation(const Pt3d& a_location)
     std::string msg = "MePolyRedistributePts set to use curvature redistribution; "
       "MePolyRedistributePtsImpl::SizeFromLocation can not be call with these "
       "settings. XM_NODATA will be returned.";
-    boost::mutex mtx;
-    mtx.lock();
-    XM_LOG(xmlog::error, msg);
-    mtx.unlock();
+    {
+      std::lock_guard<std::mutex> lock(meLogMutex());
+      XM_LOG(xmlog::error, msg);
+    }
     return XM_NODATA;
   }
   VecPt3d pts(1, a_location);
@@ -440,17 +515,19 @@ void MePolyRedistributePtsImpl::IntersectWithTris(VecPt3d& a_pts)
 {
   VecPt3d newPts, pts;
   VecInt polys;
+  BSHP<GmMultiPolyIntersector> intersector = m_sizeFuncTris->AcquireIntersector();
   for (size_t i = 0; i < a_pts.size(); ++i)
   {
     Pt3d p0(a_pts[i]), p1(a_pts[0]);
     if (i < a_pts.size() - 1)
       p1 = a_pts[i + 1];
-    m_polyIntersector->TraverseLineSegment(p0.x, p0.y, p1.x, p1.y, polys, pts);
+    intersector->TraverseLineSegment(p0.x, p0.y, p1.x, p1.y, polys, pts);
     auto start = pts.begin();
     if (i > 0)
       ++start;
     newPts.insert(newPts.end(), start, pts.end());
   }
+  m_sizeFuncTris->ReleaseIntersector(intersector);
   a_pts.swap(newPts);
   a_pts.pop_back();
 } // MePolyRedistributePtsImpl::IntersectWithTris
@@ -460,8 +537,12 @@ void MePolyRedistributePtsImpl::IntersectWithTris(VecPt3d& a_pts)
 /// \param a_pts Vector of locations.
 /// \param a_lengths Vector of interpolated lengths filled in by the method.
 /// Will be the same size as a_idx.
+/// \param a_polyOffsetIter Number of paving iterations from the polygon
+/// boundary. Used when transitioning to a constant size function.
 //------------------------------------------------------------------------------
-void MePolyRedistributePtsImpl::InterpEdgeLengths(const VecPt3d& a_pts, VecDbl& a_lengths)
+void MePolyRedistributePtsImpl::InterpEdgeLengths(const VecPt3d& a_pts,
+                                                  VecDbl& a_lengths,
+                                                  int a_polyOffsetIter)
 {
   a_lengths.assign(a_pts.size(), 0.0);
   if (XM_NONE != m_constSize && !m_biasConstSize)
@@ -478,13 +559,16 @@ void MePolyRedistributePtsImpl::InterpEdgeLengths(const VecPt3d& a_pts, VecDbl&
     else if (bias < .01)
       bias = .01;
     bias = 1 - bias;
-    bias = pow(bias, (double)m_polyOffsetIter);
+    bias = pow(bias, (double)a_polyOffsetIter);
   }
 
   if (m_interp)
   { // size function interpolation
     VecFlt s;
-    m_interp->InterpToPts(a_pts, s);
+    if (m_sizeFuncTris)
+      m_sizeFuncTris->InterpToPts(a_pts, s);
+    else
+      m_interp->InterpToPts(a_pts, s);
     for (size_t i = 0; i < s.size(); ++i)
       a_lengths[i] = (double)s[i];
   }
@@ -497,31 +581,38 @@ void MePolyRedistributePtsImpl::InterpEdgeLengths(const VecPt3d& a_pts, VecDbl&
   //}
   else if (!m_polyEdgeLengths.empty())
   {
-    double lastInterp(-1), distSq(0);
-    VecDbl wt, d2;
-    Pt3d aPt;
-    InterpToPoint(0, a_pts, a_lengths, wt, d2, bias);
-    lastInterp = a_lengths[0];
-    aPt = a_pts[0];
-
-    // do the rest of the points
+    // find the points to interpolate. Points close to the last interpolated
+    // point get its length.
+    VecSizet interpIdx(1, 0), fromIdx(a_pts.size(), 0);
+    Pt3d aPt(a_pts[0]);
     for (size_t i = 1; i < a_pts.size(); ++i)
     {
-      distSq = MdistSq(aPt.x, aPt.y, a_pts[i].x, a_pts[i].y);
-      if (distSq < m_distSqTol)
+      double distSq = MdistSq(aPt.x, aPt.y, a_pts[i].x, a_pts[i].y);
+      if (distSq >= m_distSqTol)
       {
-        a_lengths[i] = lastInterp;
-        continue;
+        interpIdx.push_back(i);
+        aPt = a_pts[i];
       }
-      InterpToPoint(i, a_pts, a_lengths, wt, d2, bias);
-      lastInterp = a_lengths[i];
-      aPt = a_pts[i];
+      fromIdx[i] = interpIdx.back();
+    }
+
+    if (m_sizeTree)
+    {
+      VecDbl wt, d2;
+      for (size_t i = 0; i < interpIdx.size(); ++i)
+        InterpToPoint(interpIdx[i], a_pts, a_lengths, wt, d2, bias);
+    }
+    else
+    {
+      InterpToPtsBatch(a_pts, interpIdx, a_lengths);
+      for (size_t i = 0; i < interpIdx.size(); ++i)
+        LimitLength(a_lengths[interpIdx[i]], bias);
     }
+    for (size_t i = 0; i < a_pts.size(); ++i)
+      a_lengths[i] = a_lengths[fromIdx[i]];
   }
   else
   {
-    boost::mutex mtx;
-    mtx.lock();
     VecDbl lengths, tvals;
     CalcSegLengths(a_pts, lengths, tvals);
     double sum(0);
@@ -533,9 +624,11 @@ void MePolyRedistributePtsImpl::InterpEdgeLengths(const VecPt3d& a_pts, VecDbl&
     ss << "Interpolator not defined in MePolyRedistributePts. Size function "
           "set to constant value: "
        << sum << ".";
-    XM_LOG(xmlog::debug, ss.str());
-    InterpEdgeLengths(a_pts, a_lengths);
-    mtx.unlock();
+    {
+      std::lock_guard<std::mutex> lock(meLogMutex());
+      XM_LOG(xmlog::debug, ss.str());
+    }
+    InterpEdgeLengths(a_pts, a_lengths, a_polyOffsetIter);
   }
 } // MePolyRedistributePtsImpl::InterpEdgeLengths
 //------------------------------------------------------------------------------
@@ -557,15 +650,65 @@ void MePolyRedistributePtsImpl::InterpToPoint(size_t a_idx,
                                               VecDbl& a_d2,
                                               double& a_bias)
 {
-  double sumWt(0);
-  CalcInterpWeights(a_pts[a_idx], a_wt, a_d2, sumWt);
-  for (size_t j = 0; j < m_polyEdgeLengths.size(); ++j)
+  if (m_sizeTree)
+  {
+    a_lengths[a_idx] = m_sizeTree->Interp(a_pts[a_idx]);
+  }
+  else
+  {
+    double sumWt(0);
+    CalcInterpWeights(a_pts[a_idx], a_wt, a_d2, sumWt);
+    for (size_t j = 0; j < m_polyEdgeLengths.size(); ++j)
+    {
+      a_lengths[a_idx] += m_polyEdgeLengths[j] * (a_wt[j] / sumWt);
+    }
+  }
+  LimitLength(a_lengths[a_idx], a_bias);
+} // MePolyRedistributePtsImpl::InterpToPoint
+//------------------------------------------------------------------------------
+/// \brief Interpolates to several points from the boundary of the polygon.
+/// The points are done IDW_BATCH at a time by iIdwBatch. The results are
+/// the same as InterpToPoint without a tree to within floating point rounding
+/// (a relative difference of about 1e-12 for polygons with 10,000 points).
+/// LimitLength is not called.
+/// \param[in] a_pts Vector of point locations
+/// \param[in] a_idx Indices of the points in a_pts to interpolate to
+/// \param[out] a_lengths Vector of lengths. Values at a_idx computed.
+//------------------------------------------------------------------------------
+void MePolyRedistributePtsImpl::InterpToPtsBatch(const VecPt3d& a_pts,
+                                                 const VecSizet& a_idx,
+                                                 VecDbl& a_lengths)
+{
+  XM_ENSURE_TRUE_VOID(m_polyX.size() == m_polyEdgeLengths.size());
+  double qx[IDW_BATCH], qy[IDW_BATCH], result[IDW_BATCH];
+  for (size_t start = 0; start < a_idx.size(); start += IDW_BATCH)
   {
-    a_lengths[a_idx] += m_polyEdgeLengths[j] * (a_wt[j] / sumWt);
+    size_t n = std::min(IDW_BATCH, a_idx.size() - start);
+    for (size_t k = 0; k < IDW_BATCH; ++k)
+    {
+      // fill the end of a partial batch with the last point
+      const Pt3d& p(a_pts[a_idx[start + std::min(k, n - 1)]]);
+      qx[k] = p.x;
+      qy[k] = p.y;
+    }
+    iIdwBatch(&m_polyX[0], &m_polyY[0], &m_polyEdgeLengths[0], m_polyEdgeLengths.size(),
+              m_minLength, m_sizeBias, qx, qy, result);
+    for (size_t k = 0; k < n; ++k)
+      a_lengths[a_idx[start + k]] = result[k];
   }
+} // MePolyRedistributePtsImpl::InterpToPtsBatch
+//------------------------------------------------------------------------------
+/// \brief Limits an interpolated length to the range of the polygon edge
+/// lengths or transitions it to the constant size function.
+/// \param[in,out] a_length The length.
+/// \param[in] a_bias A factor for scaling the length when doing a smooth
+/// transition to a constant size function.
+//------------------------------------------------------------------------------
+void MePolyRedistributePtsImpl::LimitLength(double& a_length, double a_bias)
+{
   if (XM_NONE != a_bias)
   {
-    double& d(a_lengths[a_idx]);
+    double& d(a_length);
     if (d > m_constSize)
     {
       d = d * a_bias;
@@ -581,12 +724,12 @@ void MePolyRedistributePtsImpl::InterpToPoint(size_t a_idx,
   }
   else
   {
-    if (a_lengths[a_idx] < m_minLength)
-      a_lengths[a_idx] = m_minLength;
-    if (a_lengths[a_idx] > m_maxLength)
-      a_lengths[a_idx] = m_maxLength;
+    if (a_length < m_minLength)
+      a_length = m_minLength;
+    if (a_length > m_maxLength)
+      a_length = m_maxLength;
   }
-} // MePolyRedistributePtsImpl::InterpToPoint
+} // MePolyRedistributePtsImpl::LimitLength
 //------------------------------------------------------------------------------
 /// \brief Calculates the interpolation weights of the points used to do the
 /// interpolation
@@ -984,6 +1127,8 @@ void MePolyRedistributePtsImpl::SizeFromPolyAddEdgeLengths(const VecPt3d& a_pts)
       nextPt = a_pts[i + 1];
     }
     m_polyPts->push_back(a_pts[i]);
+    m_polyX.push_back(a_pts[i].x);
+    m_polyY.push_back(a_pts[i].y);
 
     dx = a_pts[i].x - nextPt.x;
     dy = a_pts[i].y - nextPt.y;
@@ -998,6 +1143,30 @@ void MePolyRedistributePtsImpl::SizeFromPolyAddEdgeLengths(const VecPt3d& a_pts)
   }
 } // MePolyRedistributePtsImpl::SizeFromPolyAddEdgeLengths
 //------------------------------------------------------------------------------
+/// \brief Builds the tree used to approximate the size function from the
+/// polygon when a tolerance has been set. Small polygons are always
+/// interpolated exactly because the tree would not be any faster.
+//------------------------------------------------------------------------------
+void MePolyRedistributePtsImpl::UpdateSizeTree()
+{
+  const size_t MIN_TREE_PTS = 128;
+  m_sizeTree.reset();
+  if (m_sizeTreeTol <= 0.0 || m_polyPts->size() < MIN_TREE_PTS ||
+      m_polyPts->size() != m_polyEdgeLengths.size())
+    return;
+
+  // same weights as CalcInterpWeights without the distance
+  VecDbl factors(m_polyEdgeLengths.size());
+  for (size_t i = 0; i < factors.size(); ++i)
+  {
+    factors[i] = m_minLength + (m_sizeBias * (m_polyEdgeLengths[i] - m_minLength));
+    if (factors[i] <= 0.0)
+      return;
+  }
+  m_sizeTree = MePolySizeTree::New();
+  m_sizeTree->SetPts(*m_polyPts, m_polyEdgeLengths, factors, m_sizeTreeTol);
+} // MePolyRedistributePtsImpl::UpdateSizeTree
+//------------------------------------------------------------------------------
 /// \brief Calculates the lengths of segments and parametric values of segment
 /// endpoints.
 /// \param a_pts Vector of locations.
@@ -1070,27 +1239,6 @@ void MePolyRedistributePtsImpl::GetSegmentFromTval(const VecDbl& a_segTvalues,
   }
 } // MePolyRedistributePtsImpl::GetSegmentFromTval
 //------------------------------------------------------------------------------
-/// \brief Creates the poly intersector class member variable
-//------------------------------------------------------------------------------
-void MePolyRedistributePtsImpl::CreatePolyIntersector()
-{
-  m_polys.assign(m_sizeTris->size() / 3, VecInt(3, 0));
-  int* iPtr(&(*m_sizeTris)[0]);
-  size_t idx;
-  for (size_t i = 0; i < m_polys.size(); ++i)
-  {
-    idx = i * 3;
-    m_polys[i][0] = iPtr[idx + 0];
-    m_polys[i][1] = iPtr[idx + 1];
-    m_polys[i][2] = iPtr[idx + 2];
-  }
-  BSHP<GmMultiPolyIntersectionSorterTerse> sorterTerse =
-    boost::make_shared<GmMultiPolyIntersectionSorterTerse>();
-  BSHP<GmMultiPolyIntersectionSorter> sorter = BDPC<GmMultiPolyIntersectionSorter>(sorterTerse);
-  m_polyIntersector = GmMultiPolyIntersector::New(*m_sizePts, m_polys, sorter);
-
-} // MePolyRedistributePtsImpl::CreatePolyIntersector
-//------------------------------------------------------------------------------
 /// \brief Free function access an implement method that needs to be hidden
 /// from the public interface
 /// \param[in] a_redist: a MePolyRedistributePts class
@@ -1107,6 +1255,20 @@ void mePolyPaverRedistribute(BSHP<MePolyRedistributePts> a_redist,
   XM_ENSURE_TRUE(r);
   r->Redistribute(a_input, a_out, a_polyOffsetIter);
 } // mePolyPaverRedistribute
+//------------------------------------------------------------------------------
+/// \brief Free function to set a size function whose triangles are shared
+/// with other MePolyRedistributePts classes. Keeps MeSizeFunctionTris out of
+/// the public interface.
+/// \param[in] a_redist: a MePolyRedistributePts class
+/// \param[in] a_sizeFuncTris: Size function interpolator and its triangles
+//------------------------------------------------------------------------------
+void mePolyRedistributeSetSizeFuncTris(BSHP<MePolyRedistributePts> a_redist,
+                                       BSHP<MeSizeFunctionTris> a_sizeFuncTris)
+{
+  BSHP<MePolyRedistributePtsImpl> r = BDPC<MePolyRedistributePtsImpl>(a_redist);
+  XM_ENSURE_TRUE_VOID(r);
+  r->SetSizeFuncTris(a_sizeFuncTris);
+} // mePolyRedistributeSetSizeFuncTris
 
 } // namespace xms
 
@@ -1218,6 +1380,84 @@ void MePolyRedistributePtsUnitTests::testInterpEdgeLengths4()
   TS_ASSERT_EQUALS_VEC(baseLengths, lengths);
 } // MePolyRedistributePtsUnitTests::testInterpEdgeLengths4
 //------------------------------------------------------------------------------
+/// \brief tests approximating the size function from a large polygon
+//------------------------------------------------------------------------------
+void MePolyRedistributePtsUnitTests::testInterpEdgeLengthsTolerance()
+{
+  // circle with a hole that has coarser spacing
+  VecPt3d outPoly;
+  for (int i = 0; i < 1000; ++i)
+  {
+    double a = -2 * XM_PI * i / 1000;
+    outPoly.push_back(Pt3d(100 * cos(a), 100 * sin(a), 0));
+  }
+  VecPt3d2d inPolys(1);
+  for (int i = 0; i < 100; ++i)
+  {
+    double a = 2 * XM_PI * i / 100;
+    inPolys[0].push_back(Pt3d(20 * cos(a), 20 * sin(a), 0));
+  }
+  BSHP<MePolyRedistributePts> exact = MePolyRedistributePts::New();
+  exact->SetSizeFuncFromPoly(outPoly, inPolys, 1);
+  BSHP<MePolyRedistributePts> approx = MePolyRedistributePts::New();
+  approx->SetSizeFromPolyTolerance(1e-3);
+  approx->SetSizeFuncFromPoly(outPoly, inPolys, 1);
+
+  for (int i = 0; i < 36; ++i)
+  {
+    double a = 2 * XM_PI * i / 36;
+    double r = 25 + 2 * i;
+    Pt3d p(r * cos(a), r * sin(a), 0);
+    double expected = exact->SizeFromLocation(p);
+    TS_ASSERT_DELTA(expected, approx->SizeFromLocation(p), 1e-3 * expected);
+  }
+
+  // a tolerance of 0 is the exact interpolation
+  approx->SetSizeFromPolyTolerance(0);
+  Pt3d p(50, 10, 0);
+  TS_ASSERT_EQUALS(exact->SizeFromLocation(p), approx->SizeFromLocation(p));
+} // MePolyRedistributePtsUnitTests::testInterpEdgeLengthsTolerance
+//------------------------------------------------------------------------------
+/// \brief tests that the batched interpolation matches interpolating one
+/// point at a time
+//------------------------------------------------------------------------------
+void MePolyRedistributePtsUnitTests::testInterpToPtsBatch()
+{
+  VecPt3d outPoly;
+  for (int i = 0; i < 500; ++i)
+  {
+    double a = -2 * XM_PI * i / 500;
+    double r = 100 + 10 * sin(5 * a);
+    outPoly.push_back(Pt3d(r * cos(a), r * sin(a), 0));
+  }
+  VecPt3d2d inPolys(1);
+  for (int i = 0; i < 50; ++i)
+  {
+    double a = 2 * XM_PI * i / 50;
+    inPolys[0].push_back(Pt3d(20 * cos(a), 20 * sin(a), 0));
+  }
+  MePolyRedistributePtsImpl r;
+  r.SetSizeFuncFromPoly(outPoly, inPolys, 0.5);
+
+  // 13 points so the last batch is partial. Includes a polygon point.
+  VecPt3d pts = {outPoly[7]};
+  for (int i = 0; i < 12; ++i)
+    pts.push_back(Pt3d(30 + 5 * i, -40 + 7 * i, 0));
+  VecSizet idx;
+  for (size_t i = 0; i < pts.size(); ++i)
+    idx.push_back(i);
+
+  VecDbl batch(pts.size(), 0.0), single(pts.size(), 0.0), wt, d2;
+  r.InterpToPtsBatch(pts, idx, batch);
+  double bias(XM_NONE);
+  for (size_t i = 0; i < pts.size(); ++i)
+  {
+    r.InterpToPoint(i, pts, single, wt, d2, bias);
+    r.LimitLength(batch[i], bias);
+    TS_ASSERT_DELTA(single[i], batch[i], 1e-10 * single[i]);
+  }
+} // MePolyRedistributePtsUnitTests::testInterpToPtsBatch
+//------------------------------------------------------------------------------
 /// \brief test redistributing the points on the polygon boundary
 //------------------------------------------------------------------------------
 void MePolyRedistributePtsUnitTests::testRedistPts()
@@ -1315,9 +1555,7 @@ void MePolyRedistributePtsUnitTests::testIntersectWithTris()
   *triTris = {0, 1, 2, 0, 2, 3, 0, 3, 4, 0, 4, 5, 0, 5, 6, 0, 6, 7, 0, 7, 8, 0, 8, 1};
 
   MePolyRedistributePtsImpl r;
-  r.m_sizePts = triPts;
-  r.m_sizeTris = triTris;
-  r.CreatePolyIntersector();
+  r.m_sizeFuncTris = MeSizeFunctionTris::New(triPts, triTris);
   r.IntersectWithTris(loop);
   VecPt3d baseLoop = {{0, 0, 0},   {0, 5, 0},  {0, 10, 0}, {5, 10, 0},
                       {10, 10, 0}, {10, 5, 0}, {10, 0, 0}, {5, 0, 0}};
@@ -36,6 +36,7 @@ public:
   virtual void SetSizeFuncFromPoly(const VecPt3d& a_outPoly,
                                    const VecPt3d2d& a_inPolys,
                                    double a_sizeBias) = 0;
+  virtual void SetSizeFromPolyTolerance(double a_tol) = 0;
   virtual void SetConstantSizeFunc(double a_size) = 0;
   virtual void SetConstantSizeBias(double a_sizeBias) = 0;
   virtual void SetUseCurvatureRedistribution(double a_featureSize,
@@ -34,6 +34,8 @@ public:
   void testInterpEdgeLengths2();
   void testInterpEdgeLengths3();
   void testInterpEdgeLengths4();
+  void testInterpEdgeLengthsTolerance();
+  void testInterpToPtsBatch();
   void testRedistPts();
   void testRedistPts1();
   void testRedistPts2();
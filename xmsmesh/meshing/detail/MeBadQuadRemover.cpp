@@ -13,8 +13,10 @@
 #include <xmsmesh/meshing/detail/MeBadQuadRemover.h>
 
 // 3. Standard library headers
+#include <algorithm>
 #include <cmath>
 #include <numeric>
+#include <utility>
 
 // 4. External library headers
 #include <boost/utility.hpp>
@@ -26,6 +28,7 @@
 #include <xmsgrid/ugrid/XmEdge.h>
 #include <xmsgrid/ugrid/XmUGrid.h>
 #include <xmsinterp/geometry/geoms.h>
+#include <xmsmesh/meshing/detail/MeParallel.h>
 
 // 6. Non-shared code headers
 
@@ -67,34 +70,76 @@ struct CellData
 
 typedef std::vector<CellData> VecCellData; ///< Vector of CellData.
 
+/// A change to a cell and its points found by MeBadQuadRemoverImpl::
+/// ComputeCellData and made by MeBadQuadRemoverImpl::ApplyCellData.
+struct CellChange
+{
+  /// The kind of change.
+  enum Type {
+    SET_DATA,       ///< Only set the cell data.
+    MERGE_TRIANGLE, ///< Merge the cell into the adjacent triangle.
+    MERGE_QUAD,     ///< Merge the cell into the adjacent quad.
+    COLLAPSE        ///< Collapse the cell from a point with 3 adjacent cells.
+  };
+
+  /// Constructor.
+  CellChange()
+  : m_type(SET_DATA)
+  , m_pointIdx(-1)
+  , m_otherPtIdx(-1)
+  , m_adjCellIdx(-1)
+  {
+  }
+
+  Type m_type;       ///< The kind of change.
+  CellData m_data;   ///< The cell data for SET_DATA.
+  int m_pointIdx;    ///< The point with 2 or 3 adjacent cells.
+  int m_otherPtIdx;  ///< The point opposite m_pointIdx in the cell.
+  int m_adjCellIdx;  ///< The adjacent cell for MERGE_TRIANGLE and MERGE_QUAD.
+  VecInt m_adjCells; ///< The cells adjacent to m_pointIdx for COLLAPSE.
+};
+
 class MeBadQuadRemoverImpl : public MeBadQuadRemover
 {
 public:
   MeBadQuadRemoverImpl(BSHP<XmUGrid> a_ugrid);
+  MeBadQuadRemoverImpl(VecPt3d&& a_points, VecInt2d&& a_cells);
 
   virtual BSHP<XmUGrid> RemoveBadQuads(double a_maxAspect = 0.7) override;
+  virtual void RemoveBadQuads(double a_maxAspect, VecPt3d& a_points, VecInt& a_cells) override;
+  virtual void SetNumThreads(int a_numThreads) override;
 
   // implementation helpers
+  void BuildPointCells();
+  int GetEdgeAdjacentCell(int a_cellIdx, int a_edgeIdx) const;
+  int GetAdjacentPointCount(int a_pointIdx) const;
+  const VecInt& GetAdjacentPointCounts() const;
   bool ReplacePoint(int a_ptIdx, int a_newPtIdx);
   void MovePoint(int a_ptIdx, const Pt3d& a_newPoint);
   void DeleteCell(int a_cellIdx);
   BSHP<XmUGrid> BuildUGridFromReplacedPoints();
+  void BuildCellsFromReplacedPoints(VecPt3d& a_points, VecInt& a_cells);
   void CollapseFromPoint(int a_cellIdx, int a_pointIdx_w3, const VecInt& a_adjCells);
-  void ComputeCellData(int a_cellIdx, double max_aspect);
+  void ComputeCellData(int a_cellIdx, double max_aspect, CellChange& a_change) const;
+  void ApplyCellData(int a_cellIdx, const CellChange& a_change);
   bool CanCollapse(int a_cellIdx, int pointIdx_w3, VecInt& a_adjCells);
 
 private:
   typedef std::pair<int, Pt3d> MovedPoint;       ///< Index of point and new location.
   typedef std::vector<MovedPoint> MovedPointVec; ///< Vector of moved points.
-  BSHP<XmUGrid> m_ugrid;                         ///< The input UGrid containing the bad quads.
+  VecPt3d m_points;            ///< The points of the mesh containing the bad quads.
+  VecInt2d m_cells;            ///< The point indices of each cell.
+  VecInt m_cellTypes;          ///< The UGrid cell type of each cell.
+  VecInt m_pointCellsStart;    ///< Start of each point's cells in m_pointCells.
+  VecInt m_pointCells;         ///< The cells adjacent to each point in cell order.
   VecInt m_pointIdxMap;        ///< A mapping of original index to new point index.
   DynBitset m_cellsToDelete;   ///< True if a cell is to be deleted.
   MovedPointVec m_movedPoints; ///< List of points moved with new location.
   VecCellData m_cellsData;     ///< Vector of potentially collapsable quads.
+  int m_numThreads;            ///< Number of threads used to compute m_cellsData.
 
-  /// Number of adjacent points to m_ugrid->GetPoint(i). Negative if a boundary
-  /// point.
-  const VecInt m_adjPointCnts;
+  /// Number of adjacent points to m_points[i]. Negative if a boundary point.
+  VecInt m_adjPointCnts;
 };
 
 //----- Internal functions -----------------------------------------------------
@@ -133,161 +178,257 @@ BSHP<XmUGrid> BuildUGrid(const VecPt3d& a_points, const VecInt2d& a_faces)
 
   return XmUGrid::New(a_points, cells);
 } // BuildUGrid
+////////////////////////////////////////////////////////////////////////////////
+/// \class MeBadQuadRemoverImpl
+/// \brief Identifies and removes badly formed quads. Badly formed quads
+/// include those
+/// - that have a non-boundary point that is adjacent to only 2 cells
+/// - that have only one non-boundary point that is adjacent to 3 cells
+/// - that have exactly two non-boundary points opposite each other that
+///   both have exactly 3 adjacent cells
+/// and that have a narrow aspect ratio of the diagonal including the 2 or 3
+/// adjacent cell points and the other diagonal.
+////////////////////////////////////////////////////////////////////////////////
 //------------------------------------------------------------------------------
-/// \brief Get point indices attached to a UGrid point across edges.
-/// \param[in] a_ugrid The UGrid.
-/// \param[in] a_pointIdx The point index to get the adjacent points from.
-/// \param[out] a_edgePoints The point indices that are adjacent to the point.
+/// \brief Constructor.
+/// \param[in] a_ugrid The UGrid to remove badly formed quads from.
 //------------------------------------------------------------------------------
-void GetPointIdxsAttachedByEdge(BSHP<XmUGrid> a_ugrid, int a_pointIdx, VecInt& a_edgePoints)
+MeBadQuadRemoverImpl::MeBadQuadRemoverImpl(BSHP<XmUGrid> a_ugrid)
+: m_points(a_ugrid->GetLocations())
+, m_numThreads(1)
 {
-  // TODO: Use new UGrid code in xmsgrid
-  a_edgePoints.clear();
-  VecInt associatedCells = a_ugrid->GetPointAdjacentCells(a_pointIdx);
-  if (associatedCells.size() == 0)
+  const VecInt& cellstream = a_ugrid->GetCellstream();
+  m_cells.reserve(a_ugrid->GetCellCount());
+  for (size_t i = 0; i + 1 < cellstream.size(); i += 2 + cellstream[i + 1])
   {
-    return;
+    m_cellTypes.push_back(cellstream[i]);
+    m_cells.push_back(VecInt(&cellstream[i + 2], &cellstream[i + 2] + cellstream[i + 1]));
   }
-  for (int i = 0; i < associatedCells.size(); ++i)
+  BuildPointCells();
+} // MeBadQuadRemoverImpl::MeBadQuadRemoverImpl
+//------------------------------------------------------------------------------
+/// \brief Constructor that takes the points and cells without copying them or
+/// building a UGrid.
+/// \param[in] a_points The points. Moved from.
+/// \param[in] a_cells The point indices of each triangle or quad. Moved from.
+//------------------------------------------------------------------------------
+MeBadQuadRemoverImpl::MeBadQuadRemoverImpl(VecPt3d&& a_points, VecInt2d&& a_cells)
+: m_points(std::move(a_points))
+, m_cells(std::move(a_cells))
+, m_numThreads(1)
+{
+  m_cellTypes.reserve(m_cells.size());
+  for (auto& cell : m_cells)
+  {
+    m_cellTypes.push_back(cell.size() == 3 ? XMU_TRIANGLE : (cell.size() == 4 ? XMU_QUAD : XMU_POLYGON));
+  }
+  BuildPointCells();
+} // MeBadQuadRemoverImpl::MeBadQuadRemoverImpl
+//------------------------------------------------------------------------------
+/// \brief Builds the cells adjacent to each point and the adjacent point
+/// counts, and sizes the other per point and per cell data.
+//------------------------------------------------------------------------------
+void MeBadQuadRemoverImpl::BuildPointCells()
+{
+  int numPoints = (int)m_points.size();
+  int numCells = (int)m_cells.size();
+  m_pointCellsStart.assign(numPoints + 1, 0);
+  for (auto& cell : m_cells)
   {
-    for (int j = 0; j < a_ugrid->GetCellEdgeCount(associatedCells[i]); ++j)
+    for (auto pointIdx : cell)
     {
-      XmEdge temp = a_ugrid->GetCellEdge(associatedCells[i], j);
-      if (temp.GetFirst() == a_pointIdx)
-      {
-        a_edgePoints.push_back(temp.GetSecond());
-      }
-      else if (temp.GetSecond() == a_pointIdx)
+      ++m_pointCellsStart[pointIdx + 1];
+    }
+  }
+  for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+  {
+    m_pointCellsStart[pointIdx + 1] += m_pointCellsStart[pointIdx];
+  }
+  m_pointCells.resize(m_pointCellsStart.back());
+  VecInt next(m_pointCellsStart.begin(), m_pointCellsStart.end() - 1);
+  for (int cellIdx = 0; cellIdx < numCells; ++cellIdx)
+  {
+    for (auto pointIdx : m_cells[cellIdx])
+    {
+      m_pointCells[next[pointIdx]++] = cellIdx;
+    }
+  }
+
+  m_adjPointCnts.resize(numPoints);
+  for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
+  {
+    m_adjPointCnts[pointIdx] = GetAdjacentPointCount(pointIdx);
+  }
+  m_pointIdxMap.assign(numPoints, -1);
+  m_cellsToDelete.resize(numCells);
+  m_cellsData.resize(numCells);
+} // MeBadQuadRemoverImpl::BuildPointCells
+//------------------------------------------------------------------------------
+/// \brief Get the cell across an edge of a cell.
+/// \param[in] a_cellIdx The cell.
+/// \param[in] a_edgeIdx The edge from point a_edgeIdx to the next point.
+/// \return The adjacent cell or -1 if the edge is on the boundary.
+//------------------------------------------------------------------------------
+int MeBadQuadRemoverImpl::GetEdgeAdjacentCell(int a_cellIdx, int a_edgeIdx) const
+{
+  const VecInt& cell = m_cells[a_cellIdx];
+  int pt0 = cell[a_edgeIdx];
+  int pt1 = cell[(a_edgeIdx + 1) % cell.size()];
+  for (int i = m_pointCellsStart[pt0]; i < m_pointCellsStart[pt0 + 1]; ++i)
+  {
+    int cellIdx = m_pointCells[i];
+    if (cellIdx != a_cellIdx)
+    {
+      const VecInt& other = m_cells[cellIdx];
+      if (std::find(other.begin(), other.end(), pt1) != other.end())
       {
-        a_edgePoints.push_back(temp.GetFirst());
+        return cellIdx;
       }
     }
   }
-  std::sort(a_edgePoints.begin(), a_edgePoints.end());
-  auto it = std::unique(a_edgePoints.begin(), a_edgePoints.end());
-  a_edgePoints.erase(it, a_edgePoints.end());
-} // GetPointIdxsAttachedByEdge
+  return -1;
+} // MeBadQuadRemoverImpl::GetEdgeAdjacentCell
 //------------------------------------------------------------------------------
 /// \brief Get The count of adjacent points to a given point. The result is
 /// the negative count if the point is on a boundary.
-/// \param[in] a_ugrid The UGrid containing the point.
 /// \param[in] a_pointIdx The index of the point.
-/// \return The number of edges eminating from each vertex (but negative if the
-/// vertex is on the boundary.
+/// \return The number of edges eminating from the point (but negative if the
+/// point is on the boundary).
 //------------------------------------------------------------------------------
-int GetAdjacentPointCount(BSHP<XmUGrid> a_ugrid, int a_pointIdx)
+int MeBadQuadRemoverImpl::GetAdjacentPointCount(int a_pointIdx) const
 {
+  // each edge is counted once for each adjacent cell
   VecInt adjacentPoints;
-  GetPointIdxsAttachedByEdge(a_ugrid, a_pointIdx, adjacentPoints);
+  for (int i = m_pointCellsStart[a_pointIdx]; i < m_pointCellsStart[a_pointIdx + 1]; ++i)
+  {
+    const VecInt& cell = m_cells[m_pointCells[i]];
+    int size = (int)cell.size();
+    int position = int(std::find(cell.begin(), cell.end(), a_pointIdx) - cell.begin());
+    adjacentPoints.push_back(cell[(position + size - 1) % size]);
+    adjacentPoints.push_back(cell[(position + 1) % size]);
+  }
+  std::sort(adjacentPoints.begin(), adjacentPoints.end());
+
+  int count = 0;
   bool isBoundary = false;
-  VecInt adjacentCells;
-  for (auto adjacentPtIdx : adjacentPoints)
+  for (size_t i = 0; i < adjacentPoints.size(); ++count)
   {
-    a_ugrid->GetPointsAdjacentCells(a_pointIdx, adjacentPtIdx, adjacentCells);
-    if (adjacentCells.size() == 1)
+    size_t j = i + 1;
+    while (j < adjacentPoints.size() && adjacentPoints[j] == adjacentPoints[i])
+    {
+      ++j;
+    }
+    if (j - i == 1)
     {
       isBoundary = true;
-      break;
     }
+    i = j;
   }
-
-  int count = (int)adjacentPoints.size();
   return isBoundary ? -count : count;
-} // GetAdjacentPointCount
+} // MeBadQuadRemoverImpl::GetAdjacentPointCount
 //------------------------------------------------------------------------------
-/// \brief Get the adjacent point counts for the points in a UGrid.
-/// \param[in] a_ugrid The UGrid to get the count for.
+/// \brief Get the adjacent point counts for the points.
 /// \return The number of edges eminating from each point (but negative if the
-/// point is on the boundary.
-//------------------------------------------------------------------------------
-VecInt GetAdjacentPointCounts(BSHP<XmUGrid> a_ugrid)
-{
-  VecInt counts(a_ugrid->GetPointCount());
-  int numPoints = a_ugrid->GetPointCount();
-  for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
-  {
-    counts[pointIdx] = GetAdjacentPointCount(a_ugrid, pointIdx);
-  }
-  return counts;
-} // GetAdjacentPointCounts
-////////////////////////////////////////////////////////////////////////////////
-/// \class MeBadQuadRemoverImpl
-/// \brief Identifies and removes badly formed quads. Badly formed quads
-/// include those
-/// - that have a non-boundary point that is adjacent to only 2 cells
-/// - that have only one non-boundary point that is adjacent to 3 cells
-/// - that have exactly two non-boundary points opposite each other that
-///   both have exactly 3 adjacent cells
-/// and that have a narrow aspect ratio of the diagonal including the 2 or 3
-/// adjacent cell points and the other diagonal.
-////////////////////////////////////////////////////////////////////////////////
-//------------------------------------------------------------------------------
-/// \brief Constructor.
-/// \param[in] a_ugrid The UGrid to remove badly formed quads from.
+/// point is on the boundary).
 //------------------------------------------------------------------------------
-MeBadQuadRemoverImpl::MeBadQuadRemoverImpl(BSHP<XmUGrid> a_ugrid)
-: m_ugrid(a_ugrid)
-, m_pointIdxMap(a_ugrid->GetPointCount(), -1)
-, m_adjPointCnts(GetAdjacentPointCounts(a_ugrid))
+const VecInt& MeBadQuadRemoverImpl::GetAdjacentPointCounts() const
 {
-  int cellCount = a_ugrid->GetCellCount();
-  m_cellsToDelete.resize(cellCount);
-  m_cellsData.resize(cellCount);
-} // MeBadQuadRemoverImpl::MeBadQuadRemoverImpl
+  return m_adjPointCnts;
+} // MeBadQuadRemoverImpl::GetAdjacentPointCounts
 //------------------------------------------------------------------------------
 /// \brief Remove bad quads and return a reconstructed UGrid with them removed.
 /// \param[in] a_maxAspect The maximum aspect ratio for the diagonals.
 /// \return The reconstructed UGrid with the bad quads removed.
 //------------------------------------------------------------------------------
 BSHP<XmUGrid> MeBadQuadRemoverImpl::RemoveBadQuads(double a_maxAspect)
+{
+  VecPt3d points;
+  VecInt cells;
+  RemoveBadQuads(a_maxAspect, points, cells);
+  return XmUGrid::New(points, cells);
+} // MeBadQuadRemoverImpl::RemoveBadQuads
+//------------------------------------------------------------------------------
+/// \brief Remove bad quads and give back the points and cells without
+/// building a UGrid. Can only be called once.
+/// \param[in] a_maxAspect The maximum aspect ratio for the diagonals.
+/// \param[out] a_points The points with the bad quads removed.
+/// \param[out] a_cells The cells with the bad quads removed, as a UGrid cell
+/// stream.
+//------------------------------------------------------------------------------
+void MeBadQuadRemoverImpl::RemoveBadQuads(double a_maxAspect, VecPt3d& a_points, VecInt& a_cells)
 {
   if (a_maxAspect != 0.0)
   {
     a_maxAspect *= a_maxAspect;
   }
 
-  int cellCnt = m_ugrid->GetCellCount();
-
-  for (int a_cellIdx = 0; a_cellIdx < cellCnt; ++a_cellIdx)
-  {
-    CellData& cellData = m_cellsData[a_cellIdx];
-    if (cellData.m_num3EdgePoints == -999)
+  // The changes are found in parallel in blocks of cells and made in cell
+  // order, so a cell already changed by an earlier cell is skipped and the
+  // result is the same for any number of threads.
+  const int kBlockSize = 256;
+  int cellCnt = (int)m_cells.size();
+  int numBlocks = (cellCnt + kBlockSize - 1) / kBlockSize;
+  std::vector<std::vector<CellChange>> blockChanges(numBlocks);
+  auto computeBlock = [&](size_t a_block, int) {
+    int begin = (int)a_block * kBlockSize;
+    int end = std::min(cellCnt, begin + kBlockSize);
+    std::vector<CellChange>& changes = blockChanges[a_block];
+    changes.resize(end - begin);
+    for (int cellIdx = begin; cellIdx < end; ++cellIdx)
     {
-      ComputeCellData(a_cellIdx, a_maxAspect);
+      ComputeCellData(cellIdx, a_maxAspect, changes[cellIdx - begin]);
     }
-  }
-
-  while (true)
-  {
-    int collapseCnt = 0;
-    for (int a_cellIdx = 0; a_cellIdx < cellCnt; ++a_cellIdx)
+  };
+  auto applyBlock = [&](size_t a_block) {
+    int begin = (int)a_block * kBlockSize;
+    std::vector<CellChange>& changes = blockChanges[a_block];
+    for (int i = 0; i < (int)changes.size(); ++i)
     {
-      if (!m_cellsToDelete[a_cellIdx])
+      if (m_cellsData[begin + i].m_num3EdgePoints == -999)
       {
-        CellData& data = m_cellsData[a_cellIdx];
-        if (data.m_num3EdgePoints == 1)
-        {
-          int collapsablePtIdx = data.m_pointIdx;
-          VecInt adjCells;
-          if (collapsablePtIdx != -1 && CanCollapse(a_cellIdx, collapsablePtIdx, adjCells))
-          {
-            ++collapseCnt;
-            CollapseFromPoint(a_cellIdx, collapsablePtIdx, adjCells);
-          }
-          // m_cellsData[a_cellIdx].m_num3EdgeVertices = -4;
-        }
+        ApplyCellData(begin + i, changes[i]);
       }
     }
-    if (collapseCnt == 0)
+    std::vector<CellChange>().swap(changes);
+  };
+  meParallelForOrdered(numBlocks, m_numThreads, computeBlock, applyBlock);
+
+  // Collapsing a cell only flags the cells adjacent to the collapsed point as
+  // not collapsible, so a cell that can't collapse never can later. Each
+  // candidate is checked once, in cell order, and the cells flagged by an
+  // earlier collapse drop out when their turn comes.
+  VecInt candidates;
+  for (int cellIdx = 0; cellIdx < cellCnt; ++cellIdx)
+  {
+    if (!m_cellsToDelete[cellIdx] && m_cellsData[cellIdx].m_num3EdgePoints == 1 &&
+        m_cellsData[cellIdx].m_pointIdx != -1)
     {
-      break;
+      candidates.push_back(cellIdx);
+    }
+  }
+  VecInt adjCells;
+  for (auto cellIdx : candidates)
+  {
+    const CellData& data = m_cellsData[cellIdx];
+    if (!m_cellsToDelete[cellIdx] && data.m_num3EdgePoints == 1 &&
+        CanCollapse(cellIdx, data.m_pointIdx, adjCells))
+    {
+      CollapseFromPoint(cellIdx, data.m_pointIdx, adjCells);
     }
   }
 
-  BSHP<XmUGrid> newUgrid = BuildUGridFromReplacedPoints();
-  return newUgrid;
+  BuildCellsFromReplacedPoints(a_points, a_cells);
 } // MeBadQuadRemoverImpl::RemoveBadQuads
 //------------------------------------------------------------------------------
+/// \brief Sets the number of threads used to find the bad quads. The UGrid is
+/// only read by the threads.
+/// \param[in] a_numThreads The number of threads. See meNumThreadsToUse.
+//------------------------------------------------------------------------------
+void MeBadQuadRemoverImpl::SetNumThreads(int a_numThreads)
+{
+  m_numThreads = a_numThreads;
+} // MeBadQuadRemoverImpl::SetNumThreads
+//------------------------------------------------------------------------------
 /// \brief Create a mapping to redirect all references from one point index to
 /// another in the new UGrid.
 /// \param[in] a_ptIdx The point to replace.
@@ -330,15 +471,26 @@ void MeBadQuadRemoverImpl::DeleteCell(int a_cellIdx)
 //------------------------------------------------------------------------------
 BSHP<XmUGrid> MeBadQuadRemoverImpl::BuildUGridFromReplacedPoints()
 {
-  VecPt3d oldPoints = m_ugrid->GetLocations();
+  VecPt3d points;
+  VecInt cells;
+  BuildCellsFromReplacedPoints(points, cells);
+  return XmUGrid::New(points, cells);
+} // MeBadQuadRemoverImpl::BuildUGridFromReplacedPoints
+//------------------------------------------------------------------------------
+/// \brief Build the points and cell stream given the recorded actions to take
+/// including deleting cells, moving points, and replacing points. The points
+/// are moved out so this can only be called once.
+/// \param[out] a_points The new points.
+/// \param[out] a_cells The new cells as a UGrid cell stream.
+//------------------------------------------------------------------------------
+void MeBadQuadRemoverImpl::BuildCellsFromReplacedPoints(VecPt3d& a_points, VecInt& a_cells)
+{
   for (auto& movedPoint : m_movedPoints)
   {
-    oldPoints[movedPoint.first] = movedPoint.second;
+    m_points[movedPoint.first] = movedPoint.second;
   }
 
-  VecPt3d newPoints;
-  int numPoints = (int)m_ugrid->GetPointCount();
-  newPoints.reserve(numPoints);
+  int numPoints = (int)m_points.size();
   int currPtIdx = 0;
   VecInt newPointIdxLookupTable(numPoints, -1);
   // - - - - - - - before mapping any
@@ -347,11 +499,14 @@ BSHP<XmUGrid> MeBadQuadRemoverImpl::BuildUGridFromReplacedPoints()
   {
     if (m_pointIdxMap[pointIdx] == -1)
     {
-      newPoints.push_back(oldPoints[pointIdx]);
+      m_points[currPtIdx] = m_points[pointIdx];
       newPointIdxLookupTable[pointIdx] = currPtIdx;
       ++currPtIdx;
     }
   }
+  m_points.resize(currPtIdx);
+  a_points.swap(m_points);
+  m_points.clear();
   // - 0 - 1 2 3 - newPointIdxLookupTable after the first pass
 
   for (int pointIdx = 0; pointIdx < numPoints; ++pointIdx)
@@ -364,27 +519,23 @@ BSHP<XmUGrid> MeBadQuadRemoverImpl::BuildUGridFromReplacedPoints()
   }
   // 0 * 3 * * * 1 newPointIdxLookupTable after second pass (* means unchanged)
   // 0 0 3 1 2 3 1 newPointIdxLookupTable after second pass
-  VecInt cells;
-  int numCells = m_ugrid->GetCellCount();
-  cells.reserve(6 * numCells);
+  int numCells = (int)m_cells.size();
+  a_cells.clear();
+  a_cells.reserve(6 * numCells);
   for (int cellIdx = 0; cellIdx < numCells; ++cellIdx)
   {
     if (!m_cellsToDelete[cellIdx])
     {
-      int cellType = m_ugrid->GetCellType(cellIdx);
-      XM_ASSERT(m_ugrid->GetCellDimension(cellIdx) == 2);
-      cells.push_back(cellType);
-      cells.push_back(m_ugrid->GetCellEdgeCount(cellIdx));
-      VecInt cellPoints = m_ugrid->GetCellPoints(cellIdx);
+      const VecInt& cellPoints = m_cells[cellIdx];
+      a_cells.push_back(m_cellTypes[cellIdx]);
+      a_cells.push_back((int)cellPoints.size());
       for (auto pointIdx : cellPoints)
       {
-        cells.push_back(newPointIdxLookupTable[pointIdx]);
+        a_cells.push_back(newPointIdxLookupTable[pointIdx]);
       }
     }
   }
-  BSHP<XmUGrid> newUGrid = XmUGrid::New(newPoints, cells);
-  return newUGrid;
-} // MeBadQuadRemoverImpl::BuildUGridFromReplacedPoints
+} // MeBadQuadRemoverImpl::BuildCellsFromReplacedPoints
 //------------------------------------------------------------------------------
 /// \brief Collapses one cell on itself by moving one point to its opposite
 /// diagonal point.
@@ -396,7 +547,7 @@ void MeBadQuadRemoverImpl::CollapseFromPoint(int a_cellIdx,
                                              int a_pointIdx_w3,
                                              const VecInt& a_adjCells)
 {
-  VecInt pointIdxs = m_ugrid->GetCellPoints(a_cellIdx);
+  const VecInt& pointIdxs = m_cells[a_cellIdx];
   auto it = std::find(pointIdxs.begin(), pointIdxs.end(), a_pointIdx_w3);
   XM_ASSERT(it != pointIdxs.end());
   int position = int(it - pointIdxs.begin());
@@ -408,7 +559,7 @@ void MeBadQuadRemoverImpl::CollapseFromPoint(int a_cellIdx,
     XM_ASSERT(vCnt == 3);
     if (diagonalCnt > 0)
     {
-      const VecPt3d& points = m_ugrid->GetLocations();
+      const VecPt3d& points = m_points;
       double sumWt = (double)(diagonalCnt + vCnt);
       double ptWt = double(vCnt) / sumWt;
       double diagonalPtWt = double(diagonalCnt) / sumWt;
@@ -425,27 +576,30 @@ void MeBadQuadRemoverImpl::CollapseFromPoint(int a_cellIdx,
 //------------------------------------------------------------------------------
 /// \brief Determines if a cell is badly shaped and can be collapsed.
 ///
-/// If the cell has points only 2 adjacent cells, record the actions to collapse
+/// If the cell has points only 2 adjacent cells, find the change to collapse
 /// it. It if has exactly 2 points that are opposite each other with 3 adjacent
-/// cells, record the actions to collapse it.  If it has exactly 1 three-cell
+/// cells, find the change to collapse it.  If it has exactly 1 three-cell
 /// point, record that for possible future collapse. In all other cases, flag
-/// the cell as not collapsable.  If a cell is collapsed, flag the cells that
-/// are adjacent to its collapsed point as not collapsable.
+/// the cell as not collapsable. Doesn't change anything so it can be called
+/// for many cells at once. See ApplyCellData.
 /// \param[in] a_cellIdx The index of the cell to check.
 /// \param[in] a_maxAspect The maximum aspect ratio for the diagonals.
+/// \param[out] a_change The change to make to the cell.
 //------------------------------------------------------------------------------
-void MeBadQuadRemoverImpl::ComputeCellData(int a_cellIdx, double max_aspect)
+void MeBadQuadRemoverImpl::ComputeCellData(int a_cellIdx,
+                                           double max_aspect,
+                                           CellChange& a_change) const
 {
-  VecInt pointIdxs = m_ugrid->GetCellPoints(a_cellIdx);
-  VecPt3d points = m_ugrid->GetPointsLocations(pointIdxs);
-  int adjPointCnt = (int)points.size();
+  const VecInt& pointIdxs = m_cells[a_cellIdx];
+  int adjPointCnt = (int)pointIdxs.size();
 
   if (adjPointCnt != 4)
   {
-    CellData data(-adjPointCnt, -1);
-    m_cellsData[a_cellIdx] = data;
+    a_change.m_data = CellData(-adjPointCnt, -1);
     return;
   }
+  const Pt3d points[] = {m_points[pointIdxs[0]], m_points[pointIdxs[1]], m_points[pointIdxs[2]],
+                         m_points[pointIdxs[3]]};
 
   // Compute the aspect ratio of diagonals
   VecBool aspectOk = {true, true, true, true};
@@ -473,9 +627,9 @@ void MeBadQuadRemoverImpl::ComputeCellData(int a_cellIdx, double max_aspect)
     if (adjPointCnt == 2 && !on_boundary)
     {
       int opposingIdx = pointIdxs[(i + 2) % 4];
-      Pt3d opposingPt = m_ugrid->GetPointLocation(opposingIdx);
-      int adjCellIdx = m_ugrid->GetCell2dEdgeAdjacentCell(a_cellIdx, i);
-      VecInt adjPointIdxs = m_ugrid->GetCellPoints(adjCellIdx);
+      const Pt3d& opposingPt = m_points[opposingIdx];
+      int adjCellIdx = GetEdgeAdjacentCell(a_cellIdx, i);
+      const VecInt& adjPointIdxs = m_cells[adjCellIdx];
       if (adjPointIdxs.size() == 3)
       {
         // adjacent cell is a triangle
@@ -486,13 +640,10 @@ void MeBadQuadRemoverImpl::ComputeCellData(int a_cellIdx, double max_aspect)
         // | /   /
         // |/ /
         // +
-        if (ReplacePoint(opposingIdx, pointIdxs[i]))
-        {
-          MovePoint(pointIdxs[i], opposingPt);
-          DeleteCell(a_cellIdx);
-        }
-        m_cellsData[a_cellIdx].m_num3EdgePoints = -4;
-        m_cellsData[adjCellIdx].m_num3EdgePoints = -4;
+        a_change.m_type = CellChange::MERGE_TRIANGLE;
+        a_change.m_pointIdx = pointIdxs[i];
+        a_change.m_otherPtIdx = opposingIdx;
+        a_change.m_adjCellIdx = adjCellIdx;
         return;
       }
       else if (adjPointIdxs.size() == 4)
@@ -510,18 +661,16 @@ void MeBadQuadRemoverImpl::ComputeCellData(int a_cellIdx, double max_aspect)
         int position = int(it - adjPointIdxs.begin());
         int adjOpposingIdx = adjPointIdxs[(position + 2) % (int)adjPointIdxs.size()];
         // int adjOpposingIdx = pointIdxs[(position + 2) % (int)adjPointIdxs.size()];
-        Pt3d adjOpposingPt = m_ugrid->GetPointLocation(adjOpposingIdx);
+        const Pt3d& adjOpposingPt = m_points[adjOpposingIdx];
         // Pt3d adjOpposingPt = m_ugrid->GetPoint(adjPointIdxs.at(adjOpposingIdx));
         double d0 = gmXyDistanceSquared(adjOpposingPt, opposingPt);
         double d1 = diagonals[(i + 1) & 0x1];
         if (d0 / d1 < 1.0)
         {
-          if (ReplacePoint(pointIdxs[i], opposingIdx))
-          {
-            DeleteCell(a_cellIdx);
-            m_cellsData[adjCellIdx].m_num3EdgePoints = -4;
-            m_cellsData[a_cellIdx].m_num3EdgePoints = -4;
-          }
+          a_change.m_type = CellChange::MERGE_QUAD;
+          a_change.m_pointIdx = pointIdxs[i];
+          a_change.m_otherPtIdx = opposingIdx;
+          a_change.m_adjCellIdx = adjCellIdx;
           return;
         }
       }
@@ -554,13 +703,51 @@ void MeBadQuadRemoverImpl::ComputeCellData(int a_cellIdx, double max_aspect)
   if (pointIdx_w3 != XM_NONE && threes == 2 &&
       (bits == BOOST_BINARY(0101) || bits == BOOST_BINARY(1010)))
   {
-    VecInt adjCells = m_ugrid->GetPointAdjacentCells(pointIdx_w3);
-    CollapseFromPoint(a_cellIdx, pointIdx_w3, adjCells);
+    a_change.m_type = CellChange::COLLAPSE;
+    a_change.m_pointIdx = pointIdx_w3;
+    a_change.m_adjCells.assign(m_pointCells.begin() + m_pointCellsStart[pointIdx_w3],
+                               m_pointCells.begin() + m_pointCellsStart[pointIdx_w3 + 1]);
     return;
   }
 
-  m_cellsData[a_cellIdx] = CellData(threes, pointIdx_w3);
-} // MeBadQuadRemoverImpl::Compute3VertexCellData
+  a_change.m_data = CellData(threes, pointIdx_w3);
+} // MeBadQuadRemoverImpl::ComputeCellData
+//------------------------------------------------------------------------------
+/// \brief Makes the change to a cell found by ComputeCellData. If a cell is
+/// collapsed, flag the cells that are adjacent to its collapsed point as not
+/// collapsable.
+/// \param[in] a_cellIdx The index of the cell.
+/// \param[in] a_change The change to make.
+//------------------------------------------------------------------------------
+void MeBadQuadRemoverImpl::ApplyCellData(int a_cellIdx, const CellChange& a_change)
+{
+  switch (a_change.m_type)
+  {
+  case CellChange::SET_DATA:
+    m_cellsData[a_cellIdx] = a_change.m_data;
+    break;
+  case CellChange::MERGE_TRIANGLE:
+    if (ReplacePoint(a_change.m_otherPtIdx, a_change.m_pointIdx))
+    {
+      MovePoint(a_change.m_pointIdx, m_points[a_change.m_otherPtIdx]);
+      DeleteCell(a_cellIdx);
+    }
+    m_cellsData[a_cellIdx].m_num3EdgePoints = -4;
+    m_cellsData[a_change.m_adjCellIdx].m_num3EdgePoints = -4;
+    break;
+  case CellChange::MERGE_QUAD:
+    if (ReplacePoint(a_change.m_pointIdx, a_change.m_otherPtIdx))
+    {
+      DeleteCell(a_cellIdx);
+      m_cellsData[a_change.m_adjCellIdx].m_num3EdgePoints = -4;
+      m_cellsData[a_cellIdx].m_num3EdgePoints = -4;
+    }
+    break;
+  case CellChange::COLLAPSE:
+    CollapseFromPoint(a_cellIdx, a_change.m_pointIdx, a_change.m_adjCells);
+    break;
+  }
+} // MeBadQuadRemoverImpl::ApplyCellData
 //------------------------------------------------------------------------------
 /// \brief Determines a cell can collapse from a given point.
 /// \param[in] a_cellIdx The index of the cell to check.
@@ -579,7 +766,8 @@ bool MeBadQuadRemoverImpl::CanCollapse(int a_cellIdx, int pointIdx_w3, VecInt& a
   adjPointCnt = std::abs(adjPointCnt);
   XM_ASSERT(adjPointCnt == 3 && !on_boundary);
 
-  a_adjCells = m_ugrid->GetPointAdjacentCells(pointIdx_w3);
+  a_adjCells.assign(m_pointCells.begin() + m_pointCellsStart[pointIdx_w3],
+                    m_pointCells.begin() + m_pointCellsStart[pointIdx_w3 + 1]);
   for (auto adjCell : a_adjCells)
   {
     if (adjCell != a_cellIdx)
@@ -613,6 +801,19 @@ BSHP<MeBadQuadRemover> MeBadQuadRemover::New(BSHP<XmUGrid> a_ugrid)
   return badQuadRemover;
 } // MeBadQuadRemover::New
 //------------------------------------------------------------------------------
+/// \brief Create new MeBadQuadRemover from points and cells without building
+/// a UGrid.
+/// \param[in] a_points The points. Moved from.
+/// \param[in] a_cells The point indices of each triangle or quad. Moved from.
+/// \return The new MeBadQuadRemover.
+//------------------------------------------------------------------------------
+BSHP<MeBadQuadRemover> MeBadQuadRemover::New(VecPt3d&& a_points, VecInt2d&& a_cells)
+{
+  BSHP<MeBadQuadRemover> badQuadRemover(
+    new MeBadQuadRemoverImpl(std::move(a_points), std::move(a_cells)));
+  return badQuadRemover;
+} // MeBadQuadRemover::New
+//------------------------------------------------------------------------------
 /// \brief Constructor.
 //------------------------------------------------------------------------------
 MeBadQuadRemover::MeBadQuadRemover()
@@ -635,6 +836,8 @@ MeBadQuadRemover::~MeBadQuadRemover()
 #include <xmsmesh/meshing/detail/MeBadQuadRemover.t.h>
 
 #include <xmscore/testing/TestTools.h>
+#include <xmsmesh/meshing/detail/MeQuadBlossom.h>
+#include <xmsmesh/tutorial/TutMeshing.t.h>
 
 //----- Namespace declaration --------------------------------------------------
 
@@ -656,7 +859,8 @@ void MeBadQuadRemoverUnitTests::testGetAdjacentPointCounts()
   //     6-----7-----8
 
   BSHP<xms::XmUGrid> grid = TEST_XmUGridSimpleQuad();
-  VecInt counts = GetAdjacentPointCounts(grid);
+  MeBadQuadRemoverImpl remover(grid);
+  VecInt counts = remover.GetAdjacentPointCounts();
   VecInt expectedCounts = {-2, -3, -2, -3, 4, -3, -2, -3, -2};
   TS_ASSERT_EQUALS_VEC(expectedCounts, counts);
 } // MeBadQuadRemoverUnitTests::testGetAdjacentPointCounts
@@ -921,5 +1125,31 @@ void MeBadQuadRemoverUnitTests::testCollapseQuadTri()
   VecInt actualCells = collapsedUGrid->GetCellstream();
   TS_ASSERT_EQUALS(expectedCells, actualCells);
 } // MeBadQuadRemoverUnitTests::testCollapseQuadTri
+//------------------------------------------------------------------------------
+/// \brief Test removing bad quads from a big quad mesh gives the same result
+/// with more than one thread.
+//------------------------------------------------------------------------------
+void MeBadQuadRemoverUnitTests::testNumThreads()
+{
+  // split a grid of triangles into quads so each triangle center is a point
+  // with 3 adjacent cells
+  VecPt3d points;
+  VecInt tris;
+  tutJiggledGrid(30, points, tris);
+  VecInt2d faces;
+  for (size_t i = 0; i + 2 < tris.size(); i += 3)
+    faces.push_back({tris[i], tris[i + 1], tris[i + 2]});
+  BSHP<XmUGrid> ugridIn = MeQuadBlossom::SplitToQuads(BuildUGrid(points, faces));
+
+  BSHP<MeBadQuadRemover> remover = MeBadQuadRemover::New(ugridIn);
+  BSHP<XmUGrid> expectedUGrid = remover->RemoveBadQuads(0.7);
+  TS_ASSERT(expectedUGrid->GetCellCount() < ugridIn->GetCellCount());
+
+  remover = MeBadQuadRemover::New(ugridIn);
+  remover->SetNumThreads(4);
+  BSHP<XmUGrid> actualUGrid = remover->RemoveBadQuads(0.7);
+  TS_ASSERT_DELTA_VECPT3D(expectedUGrid->GetLocations(), actualUGrid->GetLocations(), 1.0e-9);
+  TS_ASSERT_EQUALS(expectedUGrid->GetCellstream(), actualUGrid->GetCellstream());
+} // MeBadQuadRemoverUnitTests::testNumThreads
 
 #endif // CXX_TEST
@@ -35,11 +35,14 @@ class MeBadQuadRemover
 {
 public:
   static BSHP<MeBadQuadRemover> New(BSHP<XmUGrid> a_ugrid);
+  static BSHP<MeBadQuadRemover> New(VecPt3d&& a_points, VecInt2d&& a_cells);
   MeBadQuadRemover();
   virtual ~MeBadQuadRemover();
 
   /// \cond
   virtual BSHP<XmUGrid> RemoveBadQuads(double a_maxAspect = 0.7) = 0;
+  virtual void RemoveBadQuads(double a_maxAspect, VecPt3d& a_points, VecInt& a_cells) = 0;
+  virtual void SetNumThreads(int a_numThreads) = 0;
 
 private:
   XM_DISALLOW_COPY_AND_ASSIGN(MeBadQuadRemover);
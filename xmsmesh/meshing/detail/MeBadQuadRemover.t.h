@@ -27,6 +27,7 @@ public:
   void testReplacePoints();
   void testCollapse();
   void testCollapseQuadTri();
+  void testNumThreads();
 };
 
 //} // namespace xms
@@ -13,6 +13,11 @@
 #include <xmsmesh/meshing/detail/MeIntersectPolys.h>
 
 // 3. Standard library headers
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <numeric>
 
 // 4. External library headers
 #pragma warning(push)
@@ -21,11 +26,14 @@
 #pragma warning(disable : 4127) // boost code: conditional expression is constant
 #pragma warning(disable : 4267) // boost code: size_t to const int
 #include <boost/geometry/geometry.hpp>
+#include <boost/geometry/geometries/multi_polygon.hpp>
+#include <boost/geometry/index/rtree.hpp>
 #pragma warning(pop)
 #include <boost/unordered_set.hpp>
 
 // 5. Shared code headers
 #include <xmsinterp/geometry/GmBoostTypes.h> // GmBstPoly3d, XmBstRing
+#include <xmsmesh/meshing/detail/MeParallel.h>
 #include <xmsmesh/meshing/detail/MePolyOffsetter.h>
 #include <xmscore/misc/XmError.h>
 #include <xmscore/stl/vector.h>
@@ -45,15 +53,51 @@ namespace xms
 namespace
 {
 namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
 
 #define T_TOL 1e-13   ///< tolerance used in multipoly intersector
 #define TOLERANCE 1e9 ///< tolerance used in PolyOffsetter
+/// clusters with at least this many polygons are unioned with a cascade
+#define CASCADE_UNION_SIZE 8
+
+/// envelope of a polygon and the index of the polygon
+typedef std::pair<GmBstBox3d, size_t> MeEnvelope;
+/// rtree of polygon envelopes
+typedef bgi::rtree<MeEnvelope, bgi::quadratic<16>> MeEnvelopeRtree;
+/// several polygons
+typedef bg::model::multi_polygon<GmBstPoly3d> MeMultiPoly;
+
+/// \brief INSIDE_POLY polygons whose envelopes overlap or touch each other
+/// (directly or through other polygons) and the result of intersecting them.
+/// A polygon in one cluster never intersects a polygon in another cluster so
+/// the clusters can be intersected independently. Local index i refers to
+/// m_bPolys[m_polys[i]] when i < m_polys.size() and to
+/// m_newPolys[i - m_polys.size()] otherwise.
+class MeInInCluster
+{
+public:
+  MeInInCluster()
+  : m_cascade(false)
+  {
+  }
+  std::vector<size_t> m_polys;            ///< polygons in stack order (indexes to m_bPolys)
+  std::vector<GmBstPoly3d> m_newPolys;    ///< polygons created by union operations
+  std::vector<GmBstBox3d> m_newEnvelopes; ///< envelopes of m_newPolys
+  /// the polygon at the front of the stack and the polygon it was unioned
+  /// with. The second is the same as the first if it was moved to the output.
+  std::vector<std::pair<size_t, size_t>> m_steps;
+  bool m_cascade;                        ///< true if unioned with a cascade
+  std::vector<GmBstPoly3d> m_cascadeOut; ///< polygons from the cascade
+};
 } // unnamed namespace
 
 class MeIntersectPolys::impl
 {
 public:
-  impl() {}
+  impl()
+  : m_numThreads(1)
+  {
+  }
 
   void SetupInIn(const std::vector<MePolyOffsetterOutput>& a_offsets, double a_xyTol);
   void SetupInOut(const MePolyOffsetterOutput& a_offsets, double a_xyTol);
@@ -68,6 +112,12 @@ public:
   void ClassifyDisjointPolys(SetIdx& a_delPolys);
   void ClassifyPolysInsideOfPolys(SetIdx& a_delPolys);
   void UpdateInPolyLoopsFromHash(const std::vector<size_t>& a_idx);
+  void InInFindClusters(std::vector<MeInInCluster>& a_clusters,
+                        std::vector<std::pair<size_t, size_t>>& a_stack);
+  void InInIntersectCluster(MeInInCluster& a_cluster);
+  void InInCascadeCluster(MeInInCluster& a_cluster);
+  void InInOutputClusters(std::vector<MeInInCluster>& a_clusters,
+                          const std::vector<std::pair<size_t, size_t>>& a_stack);
   void InOutCalcStartingStack();
   std::vector<size_t> InOutFindIntersectingPolys(size_t a_poly);
   void FillPolysInsideOfPolys(std::set<size_t>& a_oPoly,
@@ -75,7 +125,7 @@ public:
                               std::vector<std::vector<size_t>>& a_output);
 
   GmBstPoly3d BoostPoly(size_t a_loopIdx);
-  bool BoostPolyUnion(size_t a_i, size_t a_j);
+  bool BoostPolyUnion(MeInInCluster& a_cluster, size_t a_i, size_t a_j);
   bool BoostPolySubtract(size_t a_i, size_t a_j);
 
   void DeleteBad_NEWOUT_POLY(MePolyOffsetterOutput& a_out, const VecPt3d& a_origOutsidePoly);
@@ -91,7 +141,9 @@ public:
   std::vector<GmBstPoly3d> m_bOutPolys; ///< boost::geometry::polygon
   std::vector<int> m_bOutPolyType; ///< type of polygon (OUTSIDE_POLY, INSIDE_POLY, NEWOUT_POLY)
 
-  SetIdx m_inOutOpolys; ///< outside polygons
+  SetIdx m_inOutOpolys;         ///< outside polygons
+  MeEnvelopeRtree m_inOutRtree; ///< envelopes of m_inOutOpolys
+  int m_numThreads;             ///< number of threads used to intersect clusters
 
   // used by intersect IN wth IN
   /// index of polygon that is inside of another polygon
@@ -132,6 +184,20 @@ static GmBstBox3d iCalcPolyEnvelope(const std::vector<size_t>& a_loop,
 } // iCalcPolyEnvelope
 //------------------------------------------------------------------------------
 /// \brief Returns true only if the envelopes overlap (not touch)
+/// \param a_i Envelope of a polygon.
+/// \param a_j Envelope of a polygon.
+/// \return Returns true only if the envelopes overlap (not touch)
+//------------------------------------------------------------------------------
+static bool iEnvelopesOverlap(const GmBstBox3d& a_i, const GmBstBox3d& a_j)
+{
+  const Pt3d &iMin(a_i.min_corner()), &iMax(a_i.max_corner()), &jMin(a_j.min_corner()),
+    &jMax(a_j.max_corner());
+  if (iMax.x > jMin.x && iMin.x < jMax.x && iMax.y > jMin.y && iMin.y < jMax.y)
+    return true;
+  return false;
+} // iEnvelopesOverlap
+//------------------------------------------------------------------------------
+/// \brief Returns true only if the envelopes overlap (not touch)
 /// \param a_i Index to an envelope from a polygon.
 /// \param a_j Index to an envelope from a polygon.
 /// \param a_iEnv Vector of envelopes used by the a_i variable.
@@ -143,11 +209,7 @@ static bool iEnvelopesOverlap(size_t a_i,
                               const std::vector<GmBstBox3d>& a_iEnv,
                               const std::vector<GmBstBox3d>& a_jEnv)
 {
-  const Pt3d &iMin(a_iEnv[a_i].min_corner()), &iMax(a_iEnv[a_i].max_corner()),
-    &jMin(a_jEnv[a_j].min_corner()), &jMax(a_jEnv[a_j].max_corner());
-  if (iMax.x > jMin.x && iMin.x < jMax.x && iMax.y > jMin.y && iMin.y < jMax.y)
-    return true;
-  return false;
+  return iEnvelopesOverlap(a_iEnv[a_i], a_jEnv[a_j]);
 } // iEnvelopesOverlap
 //------------------------------------------------------------------------------
 /// \brief Returns true if envelope a_i is inside of envelope a_j
@@ -203,6 +265,15 @@ void MeIntersectPolys::SetupInOut(const MePolyOffsetterOutput& a_offsets, double
   m_p->SetupInOut(a_offsets, a_xyTol);
 } // InsidePolys::SetupInOut
 //------------------------------------------------------------------------------
+/// \brief Sets the number of threads used by InInDoIntersection to intersect
+/// clusters of overlapping polygons
+/// \param a_numThreads The number of threads. See meNumThreadsToUse.
+//------------------------------------------------------------------------------
+void MeIntersectPolys::SetNumThreads(int a_numThreads)
+{
+  m_p->m_numThreads = a_numThreads;
+} // MeIntersectPolys::SetNumThreads
+//------------------------------------------------------------------------------
 /// \brief Calculates the envelope of all of the polygons
 //------------------------------------------------------------------------------
 void MeIntersectPolys::CalcEnvelopes()
@@ -432,35 +503,160 @@ void MeIntersectPolys::impl::InInTrivialPolyCases()
 /// one another. The stack is sorted by the size of the polygon envelope. The
 /// largest envelopes are processed first. If 2 polygons do intersect then a
 /// new polygon is formed that is the union of the 2 polygons. The 2 polygons
-/// are removed from the stack and the new polygon is put on the front of the
+/// are removed from the stack and the new polygon is put on the end of the
 /// stack and intersected with the remaining polygons. If a polygon does not
 /// intersect any other polygon then it is removed from the stack and moved to
 /// the output.
+///
+/// Polygons can only intersect polygons in the same cluster so the stack is
+/// split into clusters (see InInFindClusters) and the clusters are intersected
+/// on several threads. The results are put in the output in the same order as
+/// processing the whole stack would.
 //------------------------------------------------------------------------------
 void MeIntersectPolys::impl::InInDoIntersection()
 {
-  while (!m_stack.empty())
+  std::vector<MeInInCluster> clusters;
+  std::vector<std::pair<size_t, size_t>> stack;
+  InInFindClusters(clusters, stack);
+  m_stack.clear();
+
+  // a cluster with 1 polygon just moves it to the output
+  std::vector<size_t> work;
+  for (size_t i = 0; i < clusters.size(); ++i)
   {
-    std::list<size_t>::iterator it = m_stack.begin();
+    if (clusters[i].m_polys.size() > 1)
+      work.push_back(i);
+    else
+      clusters[i].m_steps.push_back(std::make_pair(0, 0));
+  }
+  meParallelFor(work.size(), m_numThreads, [&](size_t a_task, int) {
+    MeInInCluster& cluster(clusters[work[a_task]]);
+    if (cluster.m_cascade)
+      InInCascadeCluster(cluster);
+    else
+      InInIntersectCluster(cluster);
+  });
+  InInOutputClusters(clusters, stack);
+} // InsidePolys::impl::InInDoIntersection
+//------------------------------------------------------------------------------
+/// \brief Splits the stack of INSIDE_POLY polygons into clusters. Polygons are
+/// in the same cluster if their envelopes overlap or touch, directly or
+/// through other polygons. Polygons in different clusters are separated so
+/// a union of them never makes a single polygon.
+/// \param a_clusters The clusters. Numbered by their first polygon on the
+/// stack.
+/// \param a_stack The stack as pairs of cluster index and the index of the
+/// polygon in the cluster.
+//------------------------------------------------------------------------------
+void MeIntersectPolys::impl::InInFindClusters(std::vector<MeInInCluster>& a_clusters,
+                                              std::vector<std::pair<size_t, size_t>>& a_stack)
+{
+  std::vector<size_t> polys(m_stack.begin(), m_stack.end());
+  std::vector<MeEnvelope> envelopes;
+  for (size_t i = 0; i < polys.size(); ++i)
+    envelopes.push_back(MeEnvelope(m_envelopes[polys[i]], i));
+  MeEnvelopeRtree rtree(envelopes.begin(), envelopes.end());
+
+  // union find on the positions in the stack
+  std::vector<size_t> parent(polys.size());
+  std::iota(parent.begin(), parent.end(), 0);
+  auto root = [&parent](size_t a_i) {
+    while (parent[a_i] != a_i)
+    {
+      parent[a_i] = parent[parent[a_i]];
+      a_i = parent[a_i];
+    }
+    return a_i;
+  };
+  std::vector<MeEnvelope> found;
+  for (size_t i = 0; i < polys.size(); ++i)
+  {
+    found.resize(0);
+    rtree.query(bgi::intersects(m_envelopes[polys[i]]), std::back_inserter(found));
+    for (size_t j = 0; j < found.size(); ++j)
+    {
+      size_t ri = root(i), rj = root(found[j].second);
+      if (ri != rj)
+        parent[std::max(ri, rj)] = std::min(ri, rj);
+    }
+  }
+
+  // polygons that must not be unioned with each other
+  SetIdx noUnion;
+  for (auto it = m_polyInsideOfPoly.begin(); it != m_polyInsideOfPoly.end(); ++it)
+  {
+    noUnion.insert(it->first);
+    noUnion.insert(it->second);
+  }
+
+  a_clusters.resize(0);
+  a_stack.resize(0);
+  std::vector<size_t> clusterIdx(polys.size(), std::numeric_limits<size_t>::max());
+  for (size_t i = 0; i < polys.size(); ++i)
+  {
+    size_t r = root(i);
+    if (clusterIdx[r] == std::numeric_limits<size_t>::max())
+    {
+      clusterIdx[r] = a_clusters.size();
+      a_clusters.push_back(MeInInCluster());
+    }
+    MeInInCluster& cluster(a_clusters[clusterIdx[r]]);
+    a_stack.push_back(std::make_pair(clusterIdx[r], cluster.m_polys.size()));
+    cluster.m_polys.push_back(polys[i]);
+  }
+  for (size_t i = 0; i < a_clusters.size(); ++i)
+  {
+    MeInInCluster& cluster(a_clusters[i]);
+    if (cluster.m_polys.size() < CASCADE_UNION_SIZE)
+      continue;
+    cluster.m_cascade = true;
+    for (size_t j = 0; cluster.m_cascade && j < cluster.m_polys.size(); ++j)
+    {
+      if (noUnion.find(cluster.m_polys[j]) != noUnion.end())
+        cluster.m_cascade = false;
+    }
+  }
+} // MeIntersectPolys::impl::InInFindClusters
+//------------------------------------------------------------------------------
+/// \brief Intersects the polygons in a cluster the same way InInDoIntersection
+/// describes. Records each step so the output can be put in stack order.
+/// \param a_cluster The cluster.
+//------------------------------------------------------------------------------
+void MeIntersectPolys::impl::InInIntersectCluster(MeInInCluster& a_cluster)
+{
+  size_t numPolys = a_cluster.m_polys.size();
+  auto envelope = [&](size_t a_idx) -> const GmBstBox3d& {
+    if (a_idx < numPolys)
+      return m_envelopes[a_cluster.m_polys[a_idx]];
+    return a_cluster.m_newEnvelopes[a_idx - numPolys];
+  };
+
+  std::list<size_t> stack;
+  for (size_t i = 0; i < numPolys; ++i)
+    stack.push_back(i);
+  while (!stack.empty())
+  {
+    std::list<size_t>::iterator it = stack.begin();
     size_t idx = *it, idx2;
 
     bool processed = false;
     std::list<size_t>::iterator it2 = it;
     ++it2;
-    while (!processed && it2 != m_stack.end())
+    while (!processed && it2 != stack.end())
     {
       idx2 = *it2;
       // find potentially intersecting poly
-      if (iEnvelopesOverlap(idx, idx2, m_envelopes, m_envelopes))
+      if (iEnvelopesOverlap(envelope(idx), envelope(idx2)))
       { // process the 2 polygons. If they intersect a new poly is created and
-        // the original 2 are removed from the stack. A new OUTSIDE_POLY can
-        // also be created in this process; it is moved to the output
-        processed = BoostPolyUnion(idx, idx2);
+        // the original 2 are removed from the stack.
+        processed = BoostPolyUnion(a_cluster, idx, idx2);
       }
       if (processed)
       {
-        m_stack.erase(it);
-        m_stack.erase(it2);
+        stack.push_back(numPolys + a_cluster.m_newPolys.size() - 1);
+        stack.erase(it);
+        stack.erase(it2);
+        a_cluster.m_steps.push_back(std::make_pair(idx, idx2));
       }
       else
         ++it2;
@@ -468,12 +664,108 @@ void MeIntersectPolys::impl::InInDoIntersection()
 
     if (!processed)
     { // move this loop to the output
-      m_stack.pop_front();
-      m_bOutPolys.push_back(m_bPolys[idx]);
+      stack.pop_front();
+      a_cluster.m_steps.push_back(std::make_pair(idx, idx));
+    }
+  }
+} // MeIntersectPolys::impl::InInIntersectCluster
+//------------------------------------------------------------------------------
+/// \brief Unions all of the polygons in a cluster at once. Pairs of polygons
+/// that are next to each other are unioned, then pairs of those results, and
+/// so on. This avoids repeatedly unioning small polygons with one big polygon
+/// that keeps growing. Only used when no polygon in the cluster is inside of
+/// another one (see m_polyInsideOfPoly). Gives the same polygons and holes as
+/// InInIntersectCluster but their rings may start at a different point.
+/// \param a_cluster The cluster.
+//------------------------------------------------------------------------------
+void MeIntersectPolys::impl::InInCascadeCluster(MeInInCluster& a_cluster)
+{
+  // order the polygons so neighbors are unioned first
+  std::vector<size_t> polys(a_cluster.m_polys);
+  std::sort(polys.begin(), polys.end(), [this](size_t a_i, size_t a_j) {
+    const GmBstBox3d &bi(m_envelopes[a_i]), &bj(m_envelopes[a_j]);
+    double xi = bi.min_corner().x + bi.max_corner().x;
+    double xj = bj.min_corner().x + bj.max_corner().x;
+    if (xi != xj)
+      return xi < xj;
+    return a_i < a_j;
+  });
+  std::vector<MeMultiPoly> level(polys.size()), next;
+  for (size_t i = 0; i < polys.size(); ++i)
+    level[i].push_back(m_bPolys[polys[i]]);
+  while (level.size() > 1)
+  {
+    next.assign((level.size() + 1) / 2, MeMultiPoly());
+    for (size_t i = 0; i < next.size(); ++i)
+    {
+      if (2 * i + 1 < level.size())
+        bg::union_(level[2 * i], level[2 * i + 1], next[i]);
+      else
+        next[i].swap(level[2 * i]);
+    }
+    level.swap(next);
+  }
+  a_cluster.m_cascadeOut.assign(level[0].begin(), level[0].end());
+} // MeIntersectPolys::impl::InInCascadeCluster
+//------------------------------------------------------------------------------
+/// \brief Moves the results from the clusters to the output. Replays the steps
+/// of the clusters on the whole stack so the polygons are output in the same
+/// order as processing the whole stack. The polygons from a cluster that was
+/// unioned with a cascade are output when its first polygon is reached.
+/// \param a_clusters The clusters.
+/// \param a_stack The stack as pairs of cluster index and the index of the
+/// polygon in the cluster.
+//------------------------------------------------------------------------------
+void MeIntersectPolys::impl::InInOutputClusters(
+  std::vector<MeInInCluster>& a_clusters,
+  const std::vector<std::pair<size_t, size_t>>& a_stack)
+{
+  typedef std::list<std::pair<size_t, size_t>> StackList;
+  StackList stack(a_stack.begin(), a_stack.end());
+  // where each polygon of each cluster is on the stack
+  std::vector<std::vector<StackList::iterator>> position(a_clusters.size());
+  for (StackList::iterator it = stack.begin(); it != stack.end(); ++it)
+    position[it->first].push_back(it);
+  std::vector<size_t> nextStep(a_clusters.size(), 0);
+
+  while (!stack.empty())
+  {
+    size_t c = stack.front().first, idx = stack.front().second;
+    MeInInCluster& cluster(a_clusters[c]);
+    stack.pop_front();
+    if (cluster.m_cascade)
+    {
+      if (nextStep[c] == 0)
+      {
+        nextStep[c] = 1;
+        for (size_t i = 0; i < cluster.m_cascadeOut.size(); ++i)
+        {
+          m_bOutPolys.push_back(cluster.m_cascadeOut[i]);
+          m_bOutPolyType.push_back(MePolyOffsetter::INSIDE_POLY);
+        }
+      }
+      continue;
+    }
+
+    const std::pair<size_t, size_t>& step(cluster.m_steps[nextStep[c]++]);
+    XM_ASSERT(step.first == idx);
+    if (step.second != step.first)
+    { // unioned with another polygon in the cluster
+      stack.erase(position[c][step.second]);
+      stack.push_back(std::make_pair(c, position[c].size()));
+      position[c].push_back(--stack.end());
+    }
+    else
+    { // move this loop to the output
+      size_t numPolys = cluster.m_polys.size();
+      if (idx < numPolys)
+        m_bOutPolys.push_back(m_bPolys[cluster.m_polys[idx]]);
+      else
+        m_bOutPolys.push_back(cluster.m_newPolys[idx - numPolys]);
       m_bOutPolyType.push_back(MePolyOffsetter::INSIDE_POLY);
     }
   }
-} // InsidePolys::impl::InInDoIntersection
+} // MeIntersectPolys::impl::InInOutputClusters
 //------------------------------------------------------------------------------
 /// \brief A stack is created of INSIDE_POLY polygons. Each of these polygons
 /// is checked to see if it intersects with OUTSIDE_POLY polygons. If they
@@ -651,23 +943,29 @@ void MeIntersectPolys::impl::ClassifyPolys(const MePolyOffsetterOutput& a_input,
 void MeIntersectPolys::impl::ClassifyDisjointPolys(SetIdx& a_delPolys)
 {
   std::vector<GmBstBox3d>& env(m_envelopes);
+  std::vector<MeEnvelope> envelopes;
+  for (size_t i = 0; i < env.size(); ++i)
+  {
+    if (a_delPolys.find(i) == a_delPolys.end())
+      envelopes.push_back(MeEnvelope(env[i], i));
+  }
+  MeEnvelopeRtree rtree(envelopes.begin(), envelopes.end());
+
   // find polys that are completely out of other poly envelopes
   std::vector<int> overlaps(env.size(), 0);
-  for (size_t i = 0; i < env.size(); ++i)
+  std::vector<MeEnvelope> found;
+  for (size_t k = 0; k < envelopes.size(); ++k)
   {
-    if (a_delPolys.find(i) != a_delPolys.end())
+    size_t i = envelopes[k].second;
+    if (overlaps[i])
       continue;
 
-    for (size_t j = 0; j < env.size(); j++)
+    found.resize(0);
+    rtree.query(bgi::intersects(env[i]), std::back_inserter(found));
+    for (size_t f = 0; f < found.size(); ++f)
     {
-      if (i == j)
-        continue;
-      if (overlaps[j])
-        continue;
-      if (a_delPolys.find(j) != a_delPolys.end())
-        continue;
-
-      if (iEnvelopesOverlap(i, j, env, env))
+      size_t j = found[f].second;
+      if (i != j && iEnvelopesOverlap(i, j, env, env))
       {
         overlaps[i] = overlaps[j] = 1;
       }
@@ -693,13 +991,31 @@ void MeIntersectPolys::impl::ClassifyDisjointPolys(SetIdx& a_delPolys)
 void MeIntersectPolys::impl::ClassifyPolysInsideOfPolys(SetIdx& a_delPolys)
 {
   std::vector<GmBstBox3d>& env(m_envelopes);
+  std::vector<MeEnvelope> envelopes;
+  for (size_t i = 0; i < env.size(); ++i)
+  {
+    if (a_delPolys.find(i) == a_delPolys.end())
+      envelopes.push_back(MeEnvelope(env[i], i));
+  }
+  MeEnvelopeRtree rtree(envelopes.begin(), envelopes.end());
+
+  std::vector<MeEnvelope> found;
+  std::vector<size_t> inside;
   for (size_t i = 0; i < env.size(); ++i)
   {
     if (a_delPolys.find(i) != a_delPolys.end())
       continue;
 
-    for (size_t j = 0; j < env.size(); j++)
+    // polys with envelopes inside of this envelope, in index order
+    found.resize(0);
+    rtree.query(bgi::covered_by(env[i]), std::back_inserter(found));
+    inside.resize(0);
+    for (size_t f = 0; f < found.size(); ++f)
+      inside.push_back(found[f].second);
+    std::sort(inside.begin(), inside.end());
+    for (size_t k = 0; k < inside.size(); ++k)
     {
+      size_t j = inside[k];
       if (i == j)
         continue;
       if (a_delPolys.find(j) != a_delPolys.end())
@@ -712,11 +1028,11 @@ void MeIntersectPolys::impl::ClassifyPolysInsideOfPolys(SetIdx& a_delPolys)
           m_polyInsideOfPoly.insert(std::make_pair(i, j));
           // make sure the poly is not inside of an NEWOUT_POLY
           bool inNewOut(false);
-          for (size_t k = 0; !inNewOut && k < m_out.m_loops.size(); ++k)
+          for (size_t n = 0; !inNewOut && n < m_out.m_loops.size(); ++n)
           {
-            if (m_out.m_loopTypes[k] == MePolyOffsetter::NEWOUT_POLY)
+            if (m_out.m_loopTypes[n] == MePolyOffsetter::NEWOUT_POLY)
             {
-              std::vector<size_t> idx(m_out.m_loops[k]);
+              std::vector<size_t> idx(m_out.m_loops[n]);
               std::reverse(idx.begin(), idx.end());
               if (m_polyPts.PolyInsideOfPoly(idx, m_loops[j]))
               {
@@ -763,7 +1079,10 @@ void MeIntersectPolys::impl::InOutCalcStartingStack()
   for (size_t i = 0; i < m_loopTypes.size(); ++i)
   {
     if (MePolyOffsetter::OUTSIDE_POLY == m_loopTypes[i])
+    {
       m_inOutOpolys.insert(i);
+      m_inOutRtree.insert(MeEnvelope(m_envelopes[i], i));
+    }
     else if (MePolyOffsetter::INSIDE_POLY == m_loopTypes[i])
       inPolys.push_back(i);
   }
@@ -792,14 +1111,19 @@ std::vector<size_t> MeIntersectPolys::impl::InOutFindIntersectingPolys(size_t a_
   std::vector<size_t> outPolys;
   // find potentially intersecting OUTSIDE_POLY
   std::vector<GmBstBox3d>& env(m_envelopes);
-  SetIdx::iterator it(m_inOutOpolys.begin()), iend(m_inOutOpolys.end());
-  for (; it != iend; ++it)
+  std::vector<MeEnvelope> found;
+  m_inOutRtree.query(bgi::intersects(env[a_poly]), std::back_inserter(found));
+  std::vector<size_t> candidates;
+  for (size_t i = 0; i < found.size(); ++i)
+    candidates.push_back(found[i].second);
+  std::sort(candidates.begin(), candidates.end());
+  for (size_t i = 0; i < candidates.size(); ++i)
   {
-    if (iEnvelopesOverlap(a_poly, *it, env, env))
+    if (iEnvelopesOverlap(a_poly, candidates[i], env, env))
     {
-      if (!m_polyPts.PolyInsideOfPoly(m_bPolys[*it].outer(), m_loops[a_poly]))
+      if (!m_polyPts.PolyInsideOfPoly(m_bPolys[candidates[i]].outer(), m_loops[a_poly]))
       {
-        outPolys.push_back(*it);
+        outPolys.push_back(candidates[i]);
       }
     }
   }
@@ -838,31 +1162,41 @@ GmBstPoly3d MeIntersectPolys::impl::BoostPoly(size_t a_loopIdx)
   return poly;
 } // MeIntersectPolys::impl::BoostPoly
 //------------------------------------------------------------------------------
-/// \brief Performs a union operation on 2 polygons. Used by InInDoIntersection
-/// \param a_i Index to a polygon (m_loops[a_i]).
-/// \param a_j Index to a polygon (m_loops[a_j]).
+/// \brief Performs a union operation on 2 polygons. Used by
+/// InInIntersectCluster
+/// \param a_cluster The cluster with the polygons. The new polygon is added to
+/// it.
+/// \param a_i Index to a polygon in the cluster.
+/// \param a_j Index to a polygon in the cluster.
 /// \return true if the union resulted in a new polygon.
 //------------------------------------------------------------------------------
-bool MeIntersectPolys::impl::BoostPolyUnion(size_t a_i, size_t a_j)
+bool MeIntersectPolys::impl::BoostPolyUnion(MeInInCluster& a_cluster, size_t a_i, size_t a_j)
 {
   std::vector<GmBstPoly3d> out;
-  GmBstPoly3d &iPoly(m_bPolys[a_i]), &jPoly(m_bPolys[a_j]);
-  std::pair<size_t, size_t> p1(a_i, a_j), p2(a_j, a_i);
-  if (m_polyInsideOfPoly.find(p1) != m_polyInsideOfPoly.end() ||
-      m_polyInsideOfPoly.find(p2) != m_polyInsideOfPoly.end())
-    return false;
+  size_t numPolys = a_cluster.m_polys.size();
+  if (a_i < numPolys && a_j < numPolys)
+  {
+    std::pair<size_t, size_t> p1(a_cluster.m_polys[a_i], a_cluster.m_polys[a_j]),
+      p2(p1.second, p1.first);
+    if (m_polyInsideOfPoly.find(p1) != m_polyInsideOfPoly.end() ||
+        m_polyInsideOfPoly.find(p2) != m_polyInsideOfPoly.end())
+      return false;
+  }
+  const GmBstPoly3d& iPoly(a_i < numPolys ? m_bPolys[a_cluster.m_polys[a_i]]
+                                          : a_cluster.m_newPolys[a_i - numPolys]);
+  const GmBstPoly3d& jPoly(a_j < numPolys ? m_bPolys[a_cluster.m_polys[a_j]]
+                                          : a_cluster.m_newPolys[a_j - numPolys]);
   bg::union_(iPoly, jPoly, out);
   if (out.size() != 1)
     return false;
-  m_stack.push_back(m_bPolys.size());
-  m_bPolys.push_back(out[0]);
+  a_cluster.m_newPolys.push_back(out[0]);
   // do not remove inner polygons
-  // m_bPolys.back().inners().clear();
-  std::vector<Pt3d>& pts(m_bPolys.back().outer());
+  // a_cluster.m_newPolys.back().inners().clear();
+  std::vector<Pt3d>& pts(a_cluster.m_newPolys.back().outer());
   std::vector<size_t> loop(pts.size());
   for (size_t i = 0; i < loop.size(); ++i)
     loop[i] = i;
-  m_envelopes.push_back(iCalcPolyEnvelope(loop, pts));
+  a_cluster.m_newEnvelopes.push_back(iCalcPolyEnvelope(loop, pts));
 #if 0
   // put any inner polygons into the output
   for (size_t i = 0; i < out[0].inners().size(); ++i)
@@ -895,6 +1229,7 @@ bool MeIntersectPolys::impl::BoostPolySubtract(size_t a_i, size_t a_j)
     return false;
   bg::difference(iPoly, jPoly, out);
   m_inOutOpolys.erase(a_i);
+  m_inOutRtree.remove(MeEnvelope(m_envelopes[a_i], a_i));
   for (size_t i = 0; i < out.size(); ++i)
   {
     m_inOutOpolys.insert(m_bPolys.size());
@@ -905,6 +1240,7 @@ bool MeIntersectPolys::impl::BoostPolySubtract(size_t a_i, size_t a_j)
     for (size_t i = 0; i < loop.size(); ++i)
       loop[i] = i;
     m_envelopes.push_back(iCalcPolyEnvelope(loop, pts));
+    m_inOutRtree.insert(MeEnvelope(m_envelopes.back(), m_bPolys.size() - 1));
     m_loopTypes.push_back(MePolyOffsetter::OUTSIDE_POLY);
   }
   return true;
@@ -1040,6 +1376,168 @@ void MeIntersectPolysUnitTests::testClassify()
   baseIdx = {1, 2, 3};
   TS_ASSERT_EQUALS_VEC(baseIdx, output[1]);
 } // MeIntersectPolysUnitTests::testClassify
+//------------------------------------------------------------------------------
+/// \brief tests intersecting clusters of INSIDE_POLY polygons
+//------------------------------------------------------------------------------
+void MeIntersectPolysUnitTests::testInInClusters()
+{
+  // 10 overlapping squares from x=0 to x=5.5 (unioned with a cascade), 3
+  // overlapping squares from x=10 to x=12 and a square by itself at x=20
+  MePolyOffsetterOutput o;
+  auto addSquare = [&o](double a_x, double a_y) {
+    size_t start = o.m_pts.size();
+    o.m_pts.push_back(Pt3d(a_x, a_y, 0));
+    o.m_pts.push_back(Pt3d(a_x + 1, a_y, 0));
+    o.m_pts.push_back(Pt3d(a_x + 1, a_y + 1, 0));
+    o.m_pts.push_back(Pt3d(a_x, a_y + 1, 0));
+    std::vector<size_t> loop = {start, start + 1, start + 2, start + 3};
+    o.m_loops.push_back(loop);
+    o.m_loopTypes.push_back(MePolyOffsetter::INSIDE_POLY);
+  };
+  for (int i = 0; i < 10; ++i)
+    addSquare(0.5 * i, 0);
+  addSquare(10, 0);
+  addSquare(10.5, 0);
+  addSquare(11, 0.5);
+  addSquare(20, 0);
+  std::vector<MePolyOffsetterOutput> vO(1, o);
+
+  MePolyOffsetterOutput out[2];
+  int numThreads[2] = {1, 4};
+  for (int t = 0; t < 2; ++t)
+  {
+    MeIntersectPolys inPolys;
+    inPolys.SetNumThreads(numThreads[t]);
+    inPolys.SetupInIn(vO, 1e-9);
+    inPolys.CalcEnvelopes();
+    inPolys.InInTrivialPolyCases();
+    inPolys.InInDoIntersection();
+    inPolys.FillOutput(out[t]);
+  }
+  TS_ASSERT_EQUALS(3, out[0].m_loops.size());
+  if (3 != out[0].m_loops.size())
+    return;
+  std::vector<int> baseTypes(3, MePolyOffsetter::INSIDE_POLY);
+  TS_ASSERT_EQUALS_VEC(baseTypes, out[0].m_loopTypes);
+
+  std::vector<double> areas;
+  for (size_t i = 0; i < out[0].m_loops.size(); ++i)
+  {
+    const std::vector<size_t>& loop(out[0].m_loops[i]);
+    double area(0);
+    for (size_t j = 0; j < loop.size(); ++j)
+    {
+      const Pt3d &p0(out[0].m_pts[loop[j]]), &p1(out[0].m_pts[loop[(j + 1) % loop.size()]]);
+      area += (p0.x * p1.y - p1.x * p0.y) / 2;
+    }
+    areas.push_back(area);
+  }
+  std::sort(areas.begin(), areas.end());
+  std::vector<double> baseAreas = {1.0, 2.25, 5.5};
+  TS_ASSERT_DELTA_VEC(baseAreas, areas, 1e-9);
+
+  // the same output with several threads
+  TS_ASSERT_EQUALS_VEC(out[0].m_pts, out[1].m_pts);
+  TS_ASSERT_EQUALS(out[0].m_loops.size(), out[1].m_loops.size());
+  for (size_t i = 0; i < out[0].m_loops.size() && i < out[1].m_loops.size(); ++i)
+  {
+    TS_ASSERT_EQUALS_VEC(out[0].m_loops[i], out[1].m_loops[i]);
+  }
+} // MeIntersectPolysUnitTests::testInInClusters
+//------------------------------------------------------------------------------
+/// \brief tests that unioning a cluster with a cascade gives the same polygons
+/// as unioning it a pair at a time
+//------------------------------------------------------------------------------
+void MeIntersectPolysUnitTests::testInInCascadeMatchesSerial()
+{
+  // a frame of 12 overlapping squares around a hole and a staircase of 9
+  // overlapping squares
+  MePolyOffsetterOutput o;
+  auto addSquare = [&o](double a_x, double a_y, double a_size) {
+    size_t start = o.m_pts.size();
+    o.m_pts.push_back(Pt3d(a_x, a_y, 0));
+    o.m_pts.push_back(Pt3d(a_x + a_size, a_y, 0));
+    o.m_pts.push_back(Pt3d(a_x + a_size, a_y + a_size, 0));
+    o.m_pts.push_back(Pt3d(a_x, a_y + a_size, 0));
+    std::vector<size_t> loop = {start, start + 1, start + 2, start + 3};
+    o.m_loops.push_back(loop);
+    o.m_loopTypes.push_back(MePolyOffsetter::INSIDE_POLY);
+  };
+  for (int i = 0; i < 4; ++i)
+  {
+    for (int j = 0; j < 4; ++j)
+    {
+      if (i == 0 || j == 0 || i == 3 || j == 3)
+        addSquare(i, j, 1.25);
+    }
+  }
+  for (int i = 0; i < 9; ++i)
+    addSquare(10 + 0.5 * i, 0.3 * i, 1.0);
+  std::vector<MePolyOffsetterOutput> vO(1, o);
+
+  MeIntersectPolys inPolys;
+  inPolys.SetupInIn(vO, 1e-9);
+  inPolys.CalcEnvelopes();
+  inPolys.InInTrivialPolyCases();
+  MeIntersectPolys::impl& pc(*inPolys.m_p);
+  std::vector<MeInInCluster> clusters;
+  std::vector<std::pair<size_t, size_t>> stack;
+  pc.InInFindClusters(clusters, stack);
+  TS_ASSERT_EQUALS(2, clusters.size());
+
+  auto ringArea = [](const VecPt3d& a_ring) {
+    double area(0);
+    for (size_t i = 0; i + 1 < a_ring.size(); ++i)
+      area += (a_ring[i].x * a_ring[i + 1].y - a_ring[i + 1].x * a_ring[i].y) / 2;
+    return fabs(area);
+  };
+  // outer area, number of holes and area of the holes of each polygon
+  auto describe = [&ringArea](const std::vector<GmBstPoly3d>& a_polys) {
+    std::vector<double> d;
+    for (size_t i = 0; i < a_polys.size(); ++i)
+    {
+      double holeArea(0);
+      for (size_t j = 0; j < a_polys[i].inners().size(); ++j)
+        holeArea += ringArea(a_polys[i].inners()[j]);
+      d.push_back(ringArea(a_polys[i].outer()));
+      d.push_back((double)a_polys[i].inners().size());
+      d.push_back(holeArea);
+    }
+    return d;
+  };
+
+  std::vector<double> baseHoles = {1.0, 0.0};
+  for (size_t c = 0; c < clusters.size(); ++c)
+  {
+    MeInInCluster& cascade(clusters[c]);
+    TS_ASSERT(cascade.m_cascade);
+    MeInInCluster serial(cascade);
+    serial.m_cascade = false;
+    pc.InInIntersectCluster(serial);
+    pc.InInCascadeCluster(cascade);
+
+    // the polygons the serial union moved to the output
+    std::vector<GmBstPoly3d> serialOut;
+    size_t numPolys = serial.m_polys.size();
+    for (size_t i = 0; i < serial.m_steps.size(); ++i)
+    {
+      size_t idx = serial.m_steps[i].first;
+      if (idx != serial.m_steps[i].second)
+        continue;
+      if (idx < numPolys)
+        serialOut.push_back(pc.m_bPolys[serial.m_polys[idx]]);
+      else
+        serialOut.push_back(serial.m_newPolys[idx - numPolys]);
+    }
+    TS_ASSERT_EQUALS(1, serialOut.size());
+    TS_ASSERT_EQUALS(serialOut.size(), cascade.m_cascadeOut.size());
+    std::vector<double> serialDesc = describe(serialOut);
+    std::vector<double> cascadeDesc = describe(cascade.m_cascadeOut);
+    TS_ASSERT_DELTA_VEC(serialDesc, cascadeDesc, 1e-6);
+    if (c < baseHoles.size() && serialDesc.size() > 1)
+      TS_ASSERT_EQUALS(baseHoles[c], serialDesc[1]);
+  }
+} // MeIntersectPolysUnitTests::testInInCascadeMatchesSerial
 
 //} // namespace xms
 #endif
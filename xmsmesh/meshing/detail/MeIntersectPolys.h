@@ -32,6 +32,7 @@ public:
 
   void SetupInIn(const std::vector<MePolyOffsetterOutput>& a_offsets, double a_xyTol);
   void SetupInOut(const MePolyOffsetterOutput& a_offsets, double a_xyTol);
+  void SetNumThreads(int a_numThreads);
   void CalcEnvelopes();
   void InInTrivialPolyCases();
   void InInDoIntersection();
@@ -30,6 +30,8 @@ class MeIntersectPolysUnitTests : public CxxTest::TestSuite
 {
 public:
   void testClassify();
+  void testInInClusters();
+  void testInInCascadeMatchesSerial();
 };
 //----- Function prototypes ----------------------------------------------------
 
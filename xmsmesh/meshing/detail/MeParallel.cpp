@@ -0,0 +1,273 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup meshing_detail
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/meshing/detail/MeParallel.h>
+
+// 3. Standard library headers
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <thread>
+#include <vector>
+
+// 4. External library headers
+
+// 5. Shared code headers
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+
+//----- Class / Function definitions -------------------------------------------
+
+//------------------------------------------------------------------------------
+/// \brief Determines the number of worker threads to use for a job.
+/// \param[in] a_requested: The number of threads requested. A value of 0 (or
+/// less) means use one thread per hardware core.
+/// \param[in] a_numTasks: The number of independent tasks in the job. More
+/// threads than tasks are never used.
+/// \return The number of threads to use. Always at least 1.
+//------------------------------------------------------------------------------
+int meNumThreadsToUse(int a_requested, size_t a_numTasks)
+{
+  int numThreads = a_requested;
+  if (numThreads < 1)
+    numThreads = (int)std::thread::hardware_concurrency();
+  if (numThreads < 1)
+    numThreads = 1;
+  if ((size_t)numThreads > a_numTasks)
+    numThreads = (int)a_numTasks;
+  return numThreads < 1 ? 1 : numThreads;
+} // meNumThreadsToUse
+//------------------------------------------------------------------------------
+/// \brief Runs a_work for every task index in [0, a_numTasks) using a pool of
+/// threads. Tasks are handed out one at a time so threads that get cheap tasks
+/// pick up more of them.
+///
+/// When only one thread is used the tasks are run in order on the calling
+/// thread. If any task throws, the remaining tasks are abandoned and the
+/// exception from the lowest numbered failing task is rethrown on the calling
+/// thread after all threads have finished.
+/// \param[in] a_numTasks: The number of tasks.
+/// \param[in] a_numThreads: The number of threads requested. See
+/// meNumThreadsToUse.
+/// \param[in] a_work: Function called with the task index and the index of the
+/// thread (0 to number of threads - 1) running it. Per thread scratch data can
+/// be indexed by the thread index.
+//------------------------------------------------------------------------------
+void meParallelFor(size_t a_numTasks,
+                   int a_numThreads,
+                   const std::function<void(size_t a_task, int a_thread)>& a_work)
+{
+  meParallelForOrdered(a_numTasks, a_numThreads, a_work, std::function<void(size_t)>());
+} // meParallelFor
+//------------------------------------------------------------------------------
+/// \brief Runs a_work for every task index using a pool of threads and calls
+/// a_consume on the calling thread for each task, in task index order, as soon
+/// as that task and all tasks before it are finished.
+///
+/// This lets the caller merge per task results deterministically while later
+/// tasks are still being computed. See meParallelFor for the threading and
+/// exception behavior.
+/// \param[in] a_numTasks: The number of tasks.
+/// \param[in] a_numThreads: The number of threads requested. See
+/// meNumThreadsToUse.
+/// \param[in] a_work: Function called on a worker thread with the task index
+/// and the thread index.
+/// \param[in] a_consume: Function called on the calling thread with the task
+/// index. May be empty.
+//------------------------------------------------------------------------------
+void meParallelForOrdered(size_t a_numTasks,
+                          int a_numThreads,
+                          const std::function<void(size_t a_task, int a_thread)>& a_work,
+                          const std::function<void(size_t a_task)>& a_consume)
+{
+  int numThreads = meNumThreadsToUse(a_numThreads, a_numTasks);
+  if (numThreads < 2)
+  {
+    for (size_t i = 0; i < a_numTasks; ++i)
+    {
+      a_work(i, 0);
+      if (a_consume)
+        a_consume(i);
+    }
+    return;
+  }
+
+  std::atomic<size_t> nextTask(0);
+  std::atomic<bool> stop(false);
+  std::mutex mtx;
+  std::condition_variable cv;
+  std::vector<char> done(a_numTasks, 0);
+  std::vector<std::exception_ptr> errors(a_numTasks);
+
+  auto worker = [&](int a_thread) {
+    while (!stop)
+    {
+      size_t task = nextTask++;
+      if (task >= a_numTasks)
+        break;
+      try
+      {
+        a_work(task, a_thread);
+      }
+      catch (...)
+      {
+        errors[task] = std::current_exception();
+        stop = true;
+      }
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        done[task] = 1;
+      }
+      cv.notify_all();
+    }
+    // wake the consumer in case it waits on a task that will not be run
+    cv.notify_all();
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads);
+  for (int t = 0; t < numThreads; ++t)
+    threads.push_back(std::thread(worker, t));
+
+  std::exception_ptr consumeError;
+  if (a_consume)
+  {
+    for (size_t i = 0; i < a_numTasks && !stop; ++i)
+    {
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [&]() { return done[i] != 0 || stop; });
+        if (!done[i] || errors[i])
+          break;
+      }
+      try
+      {
+        a_consume(i);
+      }
+      catch (...)
+      {
+        consumeError = std::current_exception();
+        stop = true;
+      }
+    }
+  }
+
+  for (auto& t : threads)
+    t.join();
+
+  for (size_t i = 0; i < a_numTasks; ++i)
+  {
+    if (errors[i])
+      std::rethrow_exception(errors[i]);
+  }
+  if (consumeError)
+    std::rethrow_exception(consumeError);
+} // meParallelForOrdered
+//------------------------------------------------------------------------------
+/// \brief Mutex to serialize writes to the log from code that may be running
+/// on a worker thread.
+/// \return The mutex.
+//------------------------------------------------------------------------------
+std::mutex& meLogMutex()
+{
+  static std::mutex mtx;
+  return mtx;
+} // meLogMutex
+
+} // namespace xms
+
+#if CXX_TEST
+////////////////////////////////////////////////////////////////////////////////
+// UNIT TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+#include <xmsmesh/meshing/detail/MeParallel.t.h>
+
+#include <stdexcept>
+
+#include <xmscore/stl/vector.h>
+#include <xmscore/testing/TestTools.h>
+
+//----- Namespace declaration --------------------------------------------------
+
+// namespace xms {
+using namespace xms;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MeParallelUnitTests
+/// \brief Tests for the parallel helper functions.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief tests the number of threads used
+//------------------------------------------------------------------------------
+void MeParallelUnitTests::testNumThreadsToUse()
+{
+  TS_ASSERT_EQUALS(1, meNumThreadsToUse(1, 10));
+  TS_ASSERT_EQUALS(4, meNumThreadsToUse(4, 10));
+  TS_ASSERT_EQUALS(3, meNumThreadsToUse(4, 3));
+  TS_ASSERT_EQUALS(1, meNumThreadsToUse(4, 0));
+  TS_ASSERT(meNumThreadsToUse(0, 1000) >= 1);
+} // MeParallelUnitTests::testNumThreadsToUse
+//------------------------------------------------------------------------------
+/// \brief tests that every task is run once and consumed in order
+//------------------------------------------------------------------------------
+void MeParallelUnitTests::testParallelForOrdered()
+{
+  const size_t numTasks = 200;
+  VecInt results(numTasks, 0), order;
+  auto work = [&](size_t a_task, int) { results[a_task] = (int)(a_task * a_task); };
+  auto consume = [&](size_t a_task) { order.push_back((int)a_task); };
+  meParallelForOrdered(numTasks, 4, work, consume);
+
+  VecInt expectedOrder(numTasks);
+  for (size_t i = 0; i < numTasks; ++i)
+  {
+    expectedOrder[i] = (int)i;
+    TS_ASSERT_EQUALS((int)(i * i), results[i]);
+  }
+  TS_ASSERT_EQUALS_VEC(expectedOrder, order);
+
+  // serial
+  results.assign(numTasks, 0);
+  order.clear();
+  meParallelForOrdered(numTasks, 1, work, consume);
+  TS_ASSERT_EQUALS_VEC(expectedOrder, order);
+} // MeParallelUnitTests::testParallelForOrdered
+//------------------------------------------------------------------------------
+/// \brief tests that an exception on a worker thread gets to the caller
+//------------------------------------------------------------------------------
+void MeParallelUnitTests::testParallelForException()
+{
+  auto work = [](size_t a_task, int) {
+    if (a_task == 7)
+      throw std::runtime_error("task 7");
+  };
+  TS_ASSERT_THROWS(meParallelFor(50, 4, work), std::runtime_error);
+} // MeParallelUnitTests::testParallelForException
+
+//} // namespace xms
+
+#endif // CXX_TEST
@@ -0,0 +1,40 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup meshing_detail
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 3. Standard library headers
+#include <functional>
+#include <mutex>
+
+// 4. External library headers
+
+// 5. Shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Structs / Classes ------------------------------------------------------
+
+//----- Function prototypes ----------------------------------------------------
+int meNumThreadsToUse(int a_requested, size_t a_numTasks);
+void meParallelFor(size_t a_numTasks,
+                   int a_numThreads,
+                   const std::function<void(size_t a_task, int a_thread)>& a_work);
+void meParallelForOrdered(size_t a_numTasks,
+                          int a_numThreads,
+                          const std::function<void(size_t a_task, int a_thread)>& a_work,
+                          const std::function<void(size_t a_task)>& a_consume);
+std::mutex& meLogMutex();
+
+} // namespace xms
@@ -0,0 +1,423 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup meshing_detail
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/meshing/detail/MePointAdjacency.h>
+
+// 3. Standard library headers
+#include <algorithm>
+#include <utility>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/misc/XmError.h>
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+namespace
+{
+typedef std::pair<int, int> MeEdge; ///< edge as the smaller and larger point
+
+//------------------------------------------------------------------------------
+/// \brief Gets the unique edges of some triangles.
+/// \param[in] a_tris: Triangles as 3 point indexes each.
+/// \param[in] a_triIdxs: The triangles to get edges from.
+/// \param[out] a_edges: The sorted, unique edges.
+//------------------------------------------------------------------------------
+void iTriangleEdges(const VecInt& a_tris, const VecInt& a_triIdxs, std::vector<MeEdge>& a_edges)
+{
+  a_edges.resize(0);
+  for (size_t i = 0; i < a_triIdxs.size(); ++i)
+  {
+    const int* tri = &a_tris[a_triIdxs[i] * 3];
+    for (int t = 0; t < 3; ++t)
+    {
+      int p0 = tri[t], p1 = tri[(t + 1) % 3];
+      a_edges.push_back(MeEdge(std::min(p0, p1), std::max(p0, p1)));
+    }
+  }
+  std::sort(a_edges.begin(), a_edges.end());
+  a_edges.erase(std::unique(a_edges.begin(), a_edges.end()), a_edges.end());
+} // iTriangleEdges
+} // unnamed namespace
+
+//----- Class / Function definitions -------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MePointAdjacency
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Constructor
+//------------------------------------------------------------------------------
+MePointAdjacency::MePointAdjacency()
+: m_start()
+, m_count()
+, m_capacity()
+, m_neighbors()
+, m_unused(0)
+{
+} // MePointAdjacency::MePointAdjacency
+//------------------------------------------------------------------------------
+/// \brief Builds the neighbors of every point from triangles. Each point gets
+/// room for twice the number of triangles it is in, which is usually twice
+/// its number of neighbors.
+/// \param[in] a_tris: Triangles as 3 point indexes each.
+/// \param[in] a_numPts: The number of points.
+//------------------------------------------------------------------------------
+void MePointAdjacency::Build(const VecInt& a_tris, size_t a_numPts)
+{
+  m_start.assign(a_numPts, 0);
+  m_count.assign(a_numPts, 0);
+  m_capacity.assign(a_numPts, 0);
+  m_unused = 0;
+  for (size_t i = 0; i < a_tris.size(); ++i)
+    m_capacity[a_tris[i]] += 2;
+  int start(0);
+  for (size_t p = 0; p < a_numPts; ++p)
+  {
+    m_start[p] = start;
+    start += m_capacity[p];
+  }
+  m_neighbors.assign(start, 0);
+  for (size_t i = 0; i + 2 < a_tris.size(); i += 3)
+  {
+    for (int t = 0; t < 3; ++t)
+    {
+      int p = a_tris[i + t];
+      m_neighbors[m_start[p] + m_count[p]++] = a_tris[i + (t + 1) % 3];
+      m_neighbors[m_start[p] + m_count[p]++] = a_tris[i + (t + 2) % 3];
+    }
+  }
+  for (size_t p = 0; p < a_numPts; ++p)
+  {
+    int* begin = m_neighbors.data() + m_start[p];
+    std::sort(begin, begin + m_count[p]);
+    m_count[p] = (int)(std::unique(begin, begin + m_count[p]) - begin);
+  }
+} // MePointAdjacency::Build
+//------------------------------------------------------------------------------
+/// \brief Updates the neighbors after edges in the triangles were swapped.
+/// Only the points of triangles that changed are updated. If the number of
+/// triangles changed then the neighbors are built again.
+/// \param[in] a_oldTris: The triangles before the edges were swapped.
+/// \param[in] a_newTris: The triangles after the edges were swapped.
+//------------------------------------------------------------------------------
+void MePointAdjacency::SwapEdges(const VecInt& a_oldTris, const VecInt& a_newTris)
+{
+  if (a_oldTris.size() != a_newTris.size())
+  {
+    Build(a_newTris, m_start.size());
+    return;
+  }
+
+  VecInt changed;
+  for (size_t i = 0; i + 2 < a_newTris.size(); i += 3)
+  {
+    if (a_oldTris[i] != a_newTris[i] || a_oldTris[i + 1] != a_newTris[i + 1] ||
+        a_oldTris[i + 2] != a_newTris[i + 2])
+      changed.push_back((int)(i / 3));
+  }
+  if (changed.empty())
+    return;
+
+  // the changed triangles cover the same area before and after so an edge
+  // only in the old ones was swapped away and an edge only in the new ones
+  // was swapped in
+  std::vector<MeEdge> oldEdges, newEdges, swapped;
+  iTriangleEdges(a_oldTris, changed, oldEdges);
+  iTriangleEdges(a_newTris, changed, newEdges);
+  std::set_difference(oldEdges.begin(), oldEdges.end(), newEdges.begin(), newEdges.end(),
+                      std::back_inserter(swapped));
+  for (size_t i = 0; i < swapped.size(); ++i)
+    RemoveEdge(swapped[i].first, swapped[i].second);
+  swapped.resize(0);
+  std::set_difference(newEdges.begin(), newEdges.end(), oldEdges.begin(), oldEdges.end(),
+                      std::back_inserter(swapped));
+  for (size_t i = 0; i < swapped.size(); ++i)
+    AddEdge(swapped[i].first, swapped[i].second);
+} // MePointAdjacency::SwapEdges
+//------------------------------------------------------------------------------
+/// \brief Connects 2 points.
+/// \param[in] a_pt1: A point index.
+/// \param[in] a_pt2: A point index.
+//------------------------------------------------------------------------------
+void MePointAdjacency::AddEdge(int a_pt1, int a_pt2)
+{
+  AddNeighbor(a_pt1, a_pt2);
+  AddNeighbor(a_pt2, a_pt1);
+  // rows that moved to the end left their old room unused
+  if (m_unused > m_neighbors.size() / 2)
+    Compact();
+} // MePointAdjacency::AddEdge
+//------------------------------------------------------------------------------
+/// \brief Disconnects 2 points.
+/// \param[in] a_pt1: A point index.
+/// \param[in] a_pt2: A point index.
+//------------------------------------------------------------------------------
+void MePointAdjacency::RemoveEdge(int a_pt1, int a_pt2)
+{
+  RemoveNeighbor(a_pt1, a_pt2);
+  RemoveNeighbor(a_pt2, a_pt1);
+} // MePointAdjacency::RemoveEdge
+//------------------------------------------------------------------------------
+/// \brief Gets the number of points.
+/// \return The number of points.
+//------------------------------------------------------------------------------
+size_t MePointAdjacency::NumPoints() const
+{
+  return m_start.size();
+} // MePointAdjacency::NumPoints
+//------------------------------------------------------------------------------
+/// \brief Gets the number of neighbors of a point.
+/// \param[in] a_pt: The point index.
+/// \return The number of neighbors.
+//------------------------------------------------------------------------------
+size_t MePointAdjacency::NumNeighbors(int a_pt) const
+{
+  return (size_t)m_count[a_pt];
+} // MePointAdjacency::NumNeighbors
+//------------------------------------------------------------------------------
+/// \brief Gets the first neighbor of a point.
+/// \param[in] a_pt: The point index.
+/// \return Pointer to the first neighbor.
+//------------------------------------------------------------------------------
+const int* MePointAdjacency::Begin(int a_pt) const
+{
+  return m_neighbors.data() + m_start[a_pt];
+} // MePointAdjacency::Begin
+//------------------------------------------------------------------------------
+/// \brief Gets the end of the neighbors of a point.
+/// \param[in] a_pt: The point index.
+/// \return Pointer to one past the last neighbor.
+//------------------------------------------------------------------------------
+const int* MePointAdjacency::End(int a_pt) const
+{
+  return m_neighbors.data() + m_start[a_pt] + m_count[a_pt];
+} // MePointAdjacency::End
+//------------------------------------------------------------------------------
+/// \brief Gets a copy of the neighbors of a point.
+/// \param[in] a_pt: The point index.
+/// \return The neighbors in increasing order.
+//------------------------------------------------------------------------------
+VecInt MePointAdjacency::Neighbors(int a_pt) const
+{
+  return VecInt(Begin(a_pt), End(a_pt));
+} // MePointAdjacency::Neighbors
+//------------------------------------------------------------------------------
+/// \brief Adds a neighbor to a point. Moves the point's neighbors to the end
+/// with twice the room if they are full.
+/// \param[in] a_pt: The point index.
+/// \param[in] a_neighbor: The neighbor point index.
+//------------------------------------------------------------------------------
+void MePointAdjacency::AddNeighbor(int a_pt, int a_neighbor)
+{
+  int* begin = m_neighbors.data() + m_start[a_pt];
+  int* end = begin + m_count[a_pt];
+  int* it = std::lower_bound(begin, end, a_neighbor);
+  if (it != end && *it == a_neighbor)
+    return;
+  int pos = (int)(it - begin);
+  if (m_count[a_pt] == m_capacity[a_pt])
+  {
+    int capacity = std::max(4, 2 * m_capacity[a_pt]);
+    int start = (int)m_neighbors.size();
+    m_neighbors.resize(m_neighbors.size() + capacity);
+    std::copy(m_neighbors.begin() + m_start[a_pt],
+              m_neighbors.begin() + m_start[a_pt] + m_count[a_pt], m_neighbors.begin() + start);
+    m_unused += m_capacity[a_pt];
+    m_start[a_pt] = start;
+    m_capacity[a_pt] = capacity;
+  }
+  begin = m_neighbors.data() + m_start[a_pt];
+  std::copy_backward(begin + pos, begin + m_count[a_pt], begin + m_count[a_pt] + 1);
+  begin[pos] = a_neighbor;
+  ++m_count[a_pt];
+} // MePointAdjacency::AddNeighbor
+//------------------------------------------------------------------------------
+/// \brief Removes a neighbor from a point.
+/// \param[in] a_pt: The point index.
+/// \param[in] a_neighbor: The neighbor point index.
+//------------------------------------------------------------------------------
+void MePointAdjacency::RemoveNeighbor(int a_pt, int a_neighbor)
+{
+  int* begin = m_neighbors.data() + m_start[a_pt];
+  int* end = begin + m_count[a_pt];
+  int* it = std::lower_bound(begin, end, a_neighbor);
+  XM_ENSURE_TRUE_VOID(it != end && *it == a_neighbor);
+  std::copy(it + 1, end, it);
+  --m_count[a_pt];
+} // MePointAdjacency::RemoveNeighbor
+//------------------------------------------------------------------------------
+/// \brief Puts the neighbors of all points back to back, with a little room
+/// for each point to grow.
+//------------------------------------------------------------------------------
+void MePointAdjacency::Compact()
+{
+  VecInt neighbors;
+  int start(0);
+  for (size_t p = 0; p < m_start.size(); ++p)
+    start += m_count[p] + 2;
+  neighbors.assign(start, 0);
+  start = 0;
+  for (size_t p = 0; p < m_start.size(); ++p)
+  {
+    std::copy(m_neighbors.begin() + m_start[p], m_neighbors.begin() + m_start[p] + m_count[p],
+              neighbors.begin() + start);
+    m_start[p] = start;
+    m_capacity[p] = m_count[p] + 2;
+    start += m_capacity[p];
+  }
+  m_neighbors.swap(neighbors);
+  m_unused = 0;
+} // MePointAdjacency::Compact
+
+} // namespace xms
+
+#ifdef CXX_TEST
+////////////////////////////////////////////////////////////////////////////////
+// UNIT TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+#include <xmsmesh/meshing/detail/MePointAdjacency.t.h>
+
+#include <xmscore/testing/TestTools.h>
+
+//----- Namespace declaration --------------------------------------------------
+
+// namespace xms {
+using namespace xms;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MePointAdjacencyUnitTests
+/// \brief Tests for MePointAdjacency.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Tests building the neighbors from triangles.
+/// \code
+///
+///  6-9--7----8
+///  | // |  / |
+///  3----4----5
+///  | /  |  \ |
+///  0----1----2
+///
+/// \endcode
+//------------------------------------------------------------------------------
+void MePointAdjacencyUnitTests::testBuild()
+{
+  VecInt tris = {0, 4, 3, 0, 1, 4, 1, 2, 4, 2, 5, 4, 3, 7, 9, 4, 8, 7, 4, 5, 8, 3, 9, 6, 3, 4, 7};
+  MePointAdjacency adj;
+  adj.Build(tris, 10);
+  TS_ASSERT_EQUALS(10, adj.NumPoints());
+  VecInt2d expected = {{1, 3, 4}, {0, 2, 4}, {1, 4, 5},       {0, 4, 6, 7, 9}, {0, 1, 2, 3, 5, 7, 8},
+                       {2, 4, 8}, {3, 9},    {3, 4, 8, 9},    {4, 5, 7},       {3, 6, 7}};
+  for (int i = 0; i < 10; ++i)
+  {
+    TS_ASSERT_EQUALS_VEC(expected[i], adj.Neighbors(i));
+    TS_ASSERT_EQUALS(expected[i].size(), adj.NumNeighbors(i));
+  }
+} // MePointAdjacencyUnitTests::testBuild
+//------------------------------------------------------------------------------
+/// \brief Tests building the neighbors when there are no triangles.
+//------------------------------------------------------------------------------
+void MePointAdjacencyUnitTests::testBuildNoTriangles()
+{
+  MePointAdjacency adj;
+  adj.Build(VecInt(), 3);
+  TS_ASSERT_EQUALS(3, adj.NumPoints());
+  for (int i = 0; i < 3; ++i)
+  {
+    TS_ASSERT_EQUALS(0, adj.NumNeighbors(i));
+    TS_ASSERT(adj.Neighbors(i).empty());
+  }
+  adj.AddEdge(0, 2);
+  TS_ASSERT_EQUALS_VEC(VecInt({2}), adj.Neighbors(0));
+  TS_ASSERT_EQUALS_VEC(VecInt({0}), adj.Neighbors(2));
+
+  adj.Build(VecInt(), 0);
+  TS_ASSERT_EQUALS(0, adj.NumPoints());
+} // MePointAdjacencyUnitTests::testBuildNoTriangles
+//------------------------------------------------------------------------------
+/// \brief Tests patching the neighbors after edges are swapped.
+/// \code
+///
+///  6----7----8      6----7----8
+///  | \  |  / |      |  / | \  |
+///  3----4----5  ->  3----4----5
+///  | /  |  \ |      | \  |  / |
+///  0----1----2      0----1----2
+///
+/// \endcode
+//------------------------------------------------------------------------------
+void MePointAdjacencyUnitTests::testSwapEdges()
+{
+  VecInt oldTris = {0, 1, 4, 0, 4, 3, 1, 2, 4, 2, 5, 4, 3, 4, 6, 4, 7, 6, 4, 5, 8, 4, 8, 7};
+  VecInt newTris = {0, 1, 3, 1, 4, 3, 1, 2, 5, 1, 5, 4, 3, 4, 7, 3, 7, 6, 4, 5, 7, 5, 8, 7};
+  MePointAdjacency adj, expected;
+  adj.Build(oldTris, 9);
+  adj.SwapEdges(oldTris, newTris);
+  expected.Build(newTris, 9);
+  for (int i = 0; i < 9; ++i)
+  {
+    TS_ASSERT_EQUALS_VEC(expected.Neighbors(i), adj.Neighbors(i));
+  }
+  // and back again
+  adj.SwapEdges(newTris, oldTris);
+  expected.Build(oldTris, 9);
+  for (int i = 0; i < 9; ++i)
+  {
+    TS_ASSERT_EQUALS_VEC(expected.Neighbors(i), adj.Neighbors(i));
+  }
+} // MePointAdjacencyUnitTests::testSwapEdges
+//------------------------------------------------------------------------------
+/// \brief Tests adding more neighbors than there is room for and removing
+/// them.
+//------------------------------------------------------------------------------
+void MePointAdjacencyUnitTests::testAddRemoveEdges()
+{
+  VecInt tris = {0, 1, 2};
+  MePointAdjacency adj;
+  adj.Build(tris, 40);
+  for (int i = 39; i > 2; --i)
+    adj.AddEdge(0, i);
+  VecInt expected(39);
+  for (int i = 0; i < 39; ++i)
+    expected[i] = i + 1;
+  TS_ASSERT_EQUALS_VEC(expected, adj.Neighbors(0));
+  TS_ASSERT_EQUALS_VEC(VecInt({0, 2}), adj.Neighbors(1));
+  TS_ASSERT_EQUALS_VEC(VecInt({0}), adj.Neighbors(20));
+
+  for (int i = 3; i < 40; i += 2)
+    adj.RemoveEdge(i, 0);
+  expected = {1, 2};
+  for (int i = 4; i < 40; i += 2)
+    expected.push_back(i);
+  TS_ASSERT_EQUALS_VEC(expected, adj.Neighbors(0));
+  TS_ASSERT_EQUALS(0, adj.NumNeighbors(21));
+  TS_ASSERT_EQUALS_VEC(VecInt({0}), adj.Neighbors(22));
+} // MePointAdjacencyUnitTests::testAddRemoveEdges
+
+//} // namespace xms
+#endif // CXX_TEST
@@ -0,0 +1,60 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup meshing_detail
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 3. Standard library headers
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/stl/vector.h>
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Structs / Classes ------------------------------------------------------
+/// \brief The points connected to each point by a triangle edge, stored in
+/// compressed sparse row form. The neighbors of each point are sorted. Each
+/// point has some room to grow so edge swaps can be patched in place.
+class MePointAdjacency
+{
+public:
+  MePointAdjacency();
+
+  void Build(const VecInt& a_tris, size_t a_numPts);
+  void SwapEdges(const VecInt& a_oldTris, const VecInt& a_newTris);
+  void AddEdge(int a_pt1, int a_pt2);
+  void RemoveEdge(int a_pt1, int a_pt2);
+
+  size_t NumPoints() const;
+  size_t NumNeighbors(int a_pt) const;
+  const int* Begin(int a_pt) const;
+  const int* End(int a_pt) const;
+  VecInt Neighbors(int a_pt) const;
+
+private:
+  void AddNeighbor(int a_pt, int a_neighbor);
+  void RemoveNeighbor(int a_pt, int a_neighbor);
+  void Compact();
+
+  VecInt m_start;     ///< start of each point's neighbors in m_neighbors
+  VecInt m_count;     ///< number of neighbors of each point
+  VecInt m_capacity;  ///< room for neighbors of each point
+  VecInt m_neighbors; ///< neighbors of all of the points
+  size_t m_unused;    ///< entries in m_neighbors not owned by any point
+};
+
+//----- Function prototypes ----------------------------------------------------
+
+} // namespace xms
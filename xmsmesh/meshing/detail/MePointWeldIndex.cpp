@@ -0,0 +1,323 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup meshing_detail
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/meshing/detail/MePointWeldIndex.h>
+
+// 3. Standard library headers
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// 4. External library headers
+
+// 5. Shared code headers
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+namespace
+{
+const size_t MIN_CAPACITY = 16; ///< smallest table size
+
+//------------------------------------------------------------------------------
+/// \brief Gets the bits of a double.
+/// \param[in] a_d: The double.
+/// \return The bits.
+//------------------------------------------------------------------------------
+uint64_t iBits(double a_d)
+{
+  uint64_t bits;
+  memcpy(&bits, &a_d, sizeof(bits));
+  return bits;
+} // iBits
+} // unnamed namespace
+
+//----- Class / Function definitions -------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MePointWeldIndex
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Constructor
+//------------------------------------------------------------------------------
+MePointWeldIndex::MePointWeldIndex()
+: m_tol(0.0)
+, m_table()
+, m_mask(0)
+, m_size(0)
+{
+} // MePointWeldIndex::MePointWeldIndex
+//------------------------------------------------------------------------------
+/// \brief Sets the xy distance within which points match.
+/// \param[in] a_tol: The tolerance. 0 or less only matches equal x and y.
+//------------------------------------------------------------------------------
+void MePointWeldIndex::SetTolerance(double a_tol)
+{
+  m_tol = a_tol > 0.0 ? a_tol : 0.0;
+  if (m_size > 0)
+    Rehash(m_table.size());
+} // MePointWeldIndex::SetTolerance
+//------------------------------------------------------------------------------
+/// \brief Makes room so that a number of points can be added without growing
+/// the table.
+/// \param[in] a_numPts: The number of points the index will hold.
+//------------------------------------------------------------------------------
+void MePointWeldIndex::Reserve(size_t a_numPts)
+{
+  size_t capacity = MIN_CAPACITY;
+  while (capacity < 2 * a_numPts)
+    capacity *= 2;
+  if (capacity > m_table.size())
+    Rehash(capacity);
+} // MePointWeldIndex::Reserve
+//------------------------------------------------------------------------------
+/// \brief Removes all of the points and frees the table.
+//------------------------------------------------------------------------------
+void MePointWeldIndex::Clear()
+{
+  std::vector<Entry>().swap(m_table);
+  m_mask = 0;
+  m_size = 0;
+} // MePointWeldIndex::Clear
+//------------------------------------------------------------------------------
+/// \brief Adds a point. The table grows when it gets half full.
+/// \param[in] a_pt: The location of the point.
+/// \param[in] a_idx: The index of the point given back by Find.
+//------------------------------------------------------------------------------
+void MePointWeldIndex::Add(const Pt3d& a_pt, int a_idx)
+{
+  if (2 * (m_size + 1) > m_table.size())
+    Rehash(m_table.empty() ? MIN_CAPACITY : 2 * m_table.size());
+  double bx, by;
+  Bucket(a_pt.x, a_pt.y, bx, by);
+  size_t slot = Slot(bx, by);
+  while (m_table[slot].m_idx != -1)
+    slot = (slot + 1) & m_mask;
+  Entry& e = m_table[slot];
+  e.m_x = a_pt.x;
+  e.m_y = a_pt.y;
+  e.m_idx = a_idx;
+  ++m_size;
+} // MePointWeldIndex::Add
+//------------------------------------------------------------------------------
+/// \brief Finds the point closest to a location within the tolerance.
+/// \param[in] a_pt: The location.
+/// \return The index of the point, or -1 if no point is within the tolerance.
+/// Of points the same distance away the smallest index is given back.
+//------------------------------------------------------------------------------
+int MePointWeldIndex::Find(const Pt3d& a_pt) const
+{
+  if (m_size == 0)
+    return -1;
+
+  // Every point in a bucket is in the probe sequence starting at the bucket's
+  // slot, so looking through the sequences of the buckets the tolerance
+  // touches finds every point that can match.
+  double bx0, by0, bx1, by1;
+  Bucket(a_pt.x - m_tol, a_pt.y - m_tol, bx0, by0);
+  Bucket(a_pt.x + m_tol, a_pt.y + m_tol, bx1, by1);
+  int nx = m_tol > 0.0 ? (int)(bx1 - bx0) + 1 : 1;
+  int ny = m_tol > 0.0 ? (int)(by1 - by0) + 1 : 1;
+  double tol2 = m_tol * m_tol;
+  int found = -1;
+  double foundDist2 = 0.0;
+  for (int i = 0; i < nx; ++i)
+  {
+    for (int j = 0; j < ny; ++j)
+    {
+      for (size_t slot = Slot(bx0 + i, by0 + j); m_table[slot].m_idx != -1;
+           slot = (slot + 1) & m_mask)
+      {
+        const Entry& e = m_table[slot];
+        double dx = e.m_x - a_pt.x;
+        double dy = e.m_y - a_pt.y;
+        double dist2 = dx * dx + dy * dy;
+        bool match = m_tol > 0.0 ? dist2 <= tol2 : dx == 0.0 && dy == 0.0;
+        if (match && (found == -1 || dist2 < foundDist2 ||
+                      (dist2 == foundDist2 && e.m_idx < found)))
+        {
+          found = e.m_idx;
+          foundDist2 = dist2;
+        }
+      }
+    }
+  }
+  return found;
+} // MePointWeldIndex::Find
+//------------------------------------------------------------------------------
+/// \brief Gets the number of points added.
+/// \return The number of points.
+//------------------------------------------------------------------------------
+size_t MePointWeldIndex::Size() const
+{
+  return m_size;
+} // MePointWeldIndex::Size
+//------------------------------------------------------------------------------
+/// \brief Gets the bucket of a location. With a tolerance of 0 each distinct
+/// location is its own bucket.
+/// \param[in] a_x: The x location.
+/// \param[in] a_y: The y location.
+/// \param[out] a_bx: The x of the bucket.
+/// \param[out] a_by: The y of the bucket.
+//------------------------------------------------------------------------------
+void MePointWeldIndex::Bucket(double a_x, double a_y, double& a_bx, double& a_by) const
+{
+  if (m_tol > 0.0)
+  {
+    a_bx = floor(a_x / m_tol);
+    a_by = floor(a_y / m_tol);
+  }
+  else
+  {
+    // adding 0 turns -0 into 0 so they hash the same
+    a_bx = a_x + 0.0;
+    a_by = a_y + 0.0;
+  }
+} // MePointWeldIndex::Bucket
+//------------------------------------------------------------------------------
+/// \brief Gets the first slot in the table for a bucket.
+/// \param[in] a_bx: The x of the bucket.
+/// \param[in] a_by: The y of the bucket.
+/// \return The slot.
+//------------------------------------------------------------------------------
+size_t MePointWeldIndex::Slot(double a_bx, double a_by) const
+{
+  // the low bits of a double are often 0 so they are mixed with the high bits
+  uint64_t h = iBits(a_bx + 0.0) ^ (iBits(a_by + 0.0) * 0x9E3779B97F4A7C15ULL);
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCDULL;
+  h ^= h >> 33;
+  h *= 0xC4CEB9FE1A85EC53ULL;
+  h ^= h >> 33;
+  return (size_t)h & m_mask;
+} // MePointWeldIndex::Slot
+//------------------------------------------------------------------------------
+/// \brief Moves the points to a new table.
+/// \param[in] a_capacity: The size of the new table. A power of 2.
+//------------------------------------------------------------------------------
+void MePointWeldIndex::Rehash(size_t a_capacity)
+{
+  Entry empty;
+  empty.m_x = 0.0;
+  empty.m_y = 0.0;
+  empty.m_idx = -1;
+  std::vector<Entry> old(a_capacity, empty);
+  old.swap(m_table);
+  m_mask = a_capacity - 1;
+  m_size = 0;
+  for (size_t i = 0; i < old.size(); ++i)
+  {
+    if (old[i].m_idx != -1)
+      Add(Pt3d(old[i].m_x, old[i].m_y, 0.0), old[i].m_idx);
+  }
+} // MePointWeldIndex::Rehash
+
+} // namespace xms
+
+#ifdef CXX_TEST
+////////////////////////////////////////////////////////////////////////////////
+// UNIT TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+#include <xmsmesh/meshing/detail/MePointWeldIndex.t.h>
+
+#include <xmscore/testing/TestTools.h>
+
+//----- Namespace declaration --------------------------------------------------
+
+// namespace xms {
+using namespace xms;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MePointWeldIndexUnitTests
+/// \brief Tests for MePointWeldIndex.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Tests that only equal x and y match with a tolerance of 0.
+//------------------------------------------------------------------------------
+void MePointWeldIndexUnitTests::testExact()
+{
+  MePointWeldIndex index;
+  TS_ASSERT_EQUALS(-1, index.Find(Pt3d(0, 0, 0)));
+  index.Add(Pt3d(0, 0, 0), 7);
+  index.Add(Pt3d(1.5, -2, 3), 3);
+  TS_ASSERT_EQUALS(2, index.Size());
+  TS_ASSERT_EQUALS(7, index.Find(Pt3d(0, 0, 0)));
+  TS_ASSERT_EQUALS(7, index.Find(Pt3d(-0.0, -0.0, 0)));
+  TS_ASSERT_EQUALS(3, index.Find(Pt3d(1.5, -2, 0)));
+  TS_ASSERT_EQUALS(-1, index.Find(Pt3d(1.5, -2 + 1e-12, 0)));
+  TS_ASSERT_EQUALS(-1, index.Find(Pt3d(1e-300, 0, 0)));
+
+  index.Clear();
+  TS_ASSERT_EQUALS(0, index.Size());
+  TS_ASSERT_EQUALS(-1, index.Find(Pt3d(0, 0, 0)));
+} // MePointWeldIndexUnitTests::testExact
+//------------------------------------------------------------------------------
+/// \brief Tests matching within a tolerance across bucket edges.
+//------------------------------------------------------------------------------
+void MePointWeldIndexUnitTests::testTolerance()
+{
+  MePointWeldIndex index;
+  index.SetTolerance(0.1);
+  index.Add(Pt3d(0.99, 0.99, 0), 0);
+  index.Add(Pt3d(1.2, 1.0, 0), 1);
+  index.Add(Pt3d(-0.05, 0.0, 0), 2);
+
+  // across the bucket edge at 1.0
+  TS_ASSERT_EQUALS(0, index.Find(Pt3d(1.01, 1.01, 0)));
+  // closest of two
+  TS_ASSERT_EQUALS(1, index.Find(Pt3d(1.15, 1.0, 0)));
+  TS_ASSERT_EQUALS(0, index.Find(Pt3d(1.05, 1.0, 0)));
+  // across 0
+  TS_ASSERT_EQUALS(2, index.Find(Pt3d(0.04, 0.0, 0)));
+  // farther than the tolerance
+  TS_ASSERT_EQUALS(-1, index.Find(Pt3d(0.99, 1.1, 0)));
+  TS_ASSERT_EQUALS(-1, index.Find(Pt3d(0.5, 0.5, 0)));
+
+  // changing the tolerance keeps the points
+  index.SetTolerance(0.2);
+  TS_ASSERT_EQUALS(0, index.Find(Pt3d(0.99, 1.15, 0)));
+} // MePointWeldIndexUnitTests::testTolerance
+//------------------------------------------------------------------------------
+/// \brief Tests growing the table past the reserved size.
+//------------------------------------------------------------------------------
+void MePointWeldIndexUnitTests::testGrow()
+{
+  MePointWeldIndex index;
+  index.SetTolerance(1e-6);
+  index.Reserve(100);
+  for (int i = 0; i < 1000; ++i)
+    index.Add(Pt3d(i % 40, i / 40, 0), i);
+  TS_ASSERT_EQUALS(1000, index.Size());
+  int misses = 0;
+  for (int i = 0; i < 1000; ++i)
+  {
+    if (index.Find(Pt3d(i % 40 + 1e-7, i / 40 - 1e-7, 0)) != i)
+      ++misses;
+  }
+  TS_ASSERT_EQUALS(0, misses);
+  TS_ASSERT_EQUALS(-1, index.Find(Pt3d(0.5, 0.5, 0)));
+} // MePointWeldIndexUnitTests::testGrow
+
+#endif // CXX_TEST
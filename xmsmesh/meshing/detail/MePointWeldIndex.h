@@ -0,0 +1,67 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup meshing_detail
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 3. Standard library headers
+#include <vector>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/points/pt.h>
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Structs / Classes ------------------------------------------------------
+/// \brief Finds points that match a location within an xy tolerance. Points
+/// are put in square buckets the size of the tolerance and the buckets are
+/// hashed into one flat open addressing table, so a search looks at the few
+/// buckets the tolerance touches. With a tolerance of 0 only points with the
+/// same x and y match.
+class MePointWeldIndex
+{
+public:
+  MePointWeldIndex();
+
+  void SetTolerance(double a_tol);
+  void Reserve(size_t a_numPts);
+  void Clear();
+
+  void Add(const Pt3d& a_pt, int a_idx);
+  int Find(const Pt3d& a_pt) const;
+  size_t Size() const;
+
+private:
+  /// \brief A point in the table.
+  struct Entry
+  {
+    double m_x; ///< x of the point
+    double m_y; ///< y of the point
+    int m_idx;  ///< index of the point, -1 for an empty slot
+  };
+
+  void Bucket(double a_x, double a_y, double& a_bx, double& a_by) const;
+  size_t Slot(double a_bx, double a_by) const;
+  void Rehash(size_t a_capacity);
+
+  double m_tol;                ///< xy tolerance
+  std::vector<Entry> m_table;  ///< open addressing table, size a power of 2
+  size_t m_mask;               ///< table size - 1
+  size_t m_size;               ///< number of points in the table
+};
+
+//----- Function prototypes ----------------------------------------------------
+
+} // namespace xms
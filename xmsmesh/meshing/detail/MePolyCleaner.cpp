@@ -14,6 +14,7 @@
 
 // 3. Standard library headers
 #include <iostream>
+#include <limits>
 
 // 4. External library headers
 #include <xmscore/misc/XmError.h>
@@ -39,13 +40,21 @@ namespace xms
 class MePolyCleanerImpl : public MePolyCleaner
 {
 public:
-  MePolyCleanerImpl() {}
+  MePolyCleanerImpl()
+  : m_numThreads(1)
+  {
+  }
 
   virtual void CleanPolyOffset(const VecPt3d& a_input,
                                int a_pType,
                                double a_tol,
                                MePolyOffsetterOutput& a_out) override;
   virtual void SetOriginalOutsidePolygon(const VecPt3d& a_origOutsidePoly) override;
+  //------------------------------------------------------------------------------
+  /// \brief Sets the number of threads used to intersect polygons
+  /// \param a_numThreads The number of threads. See meNumThreadsToUse.
+  //------------------------------------------------------------------------------
+  virtual void SetNumThreads(int a_numThreads) override { m_numThreads = a_numThreads; }
   virtual void IntersectCleanInPolys(const std::vector<MePolyOffsetterOutput>& a_offsets,
                                      MePolyOffsetterOutput& a_out,
                                      double a_xyTol) override;
@@ -55,10 +64,11 @@ public:
 
   void FillOutputForCleanPolyOffset(MePolyOffsetterOutput& a_out,
                                     int a_pType,
-                                    std::list<std::vector<size_t>>& a_loops,
+                                    const MePolyLoops& a_loops,
                                     std::vector<int>& a_loopType,
                                     const VecPt3d& a_pts);
   VecPt3d m_origOutsidePoly; ///< the original outside polygon for this step of the paving process
+  int m_numThreads;          ///< number of threads used to intersect polygons
 };
 //----- Internal functions -----------------------------------------------------
 #if 0
@@ -127,22 +137,20 @@ void MePolyCleanerImpl::CleanPolyOffset(const std::vector<Pt3d>& a_input,
   // Intersect the segments
   polyPts.IntersectSegs(segs);
 
-  // Generate a list of segments that includes the intersections just
-  // calculated. We use a list because we are going to iteratively remove
-  // elements from the list and we didn't want to force a vector to keep
-  // copying stuff around when we delete items in the list.
-  std::list<size_t> sequence(polyPts.SequenceWithIntersects(segs));
+  // Generate a sequence of segments that includes the intersections just
+  // calculated.
+  std::vector<size_t> sequence(polyPts.SequenceWithIntersects(segs));
 
   // create closed loops (polygons) using the list of segments. One polyline
   // came into this method "a_input". That line may have intersected itself
   // and is really multiple polygons. This next method extracts those multiple
   // polygons
-  std::list<std::vector<size_t>> loops;
+  MePolyLoops loops;
   polyPts.CalcLoopsForCleanPolyOffset(sequence, loops);
 
   // clean up the polygons that were extracted
   std::vector<int> loopType;
-  if (MePolyOffsetter::OUTSIDE_POLY == a_pType || loops.size() < 2)
+  if (MePolyOffsetter::OUTSIDE_POLY == a_pType || loops.Size() < 2)
   { // when we pave inward or if we only extracted 1 polygon then
     // we delete any polygons with an area that has
     // the opposite sign from what we are expecting
@@ -181,6 +189,7 @@ void MePolyCleanerImpl::IntersectCleanInPolys(const std::vector<MePolyOffsetterO
                                               double a_xyTol)
 {
   MeIntersectPolys inPolys;
+  inPolys.SetNumThreads(m_numThreads);
   inPolys.SetupInIn(a_offsets, a_xyTol);
   // compute envelopes for all INSIDE_POLY polygons
   inPolys.CalcEnvelopes();
@@ -220,23 +229,22 @@ void MePolyCleanerImpl::IntersectCleanInOutPolys(const MePolyOffsetterOutput& a_
 //------------------------------------------------------------------------------
 void MePolyCleanerImpl::FillOutputForCleanPolyOffset(MePolyOffsetterOutput& a_out,
                                                      int a_pType,
-                                                     std::list<std::vector<size_t>>& a_loops,
+                                                     const MePolyLoops& a_loops,
                                                      std::vector<int>& a_loopType,
                                                      const std::vector<Pt3d>& a_pts)
 {
   a_out.m_pts = a_pts;
   a_out.m_loops.resize(0);
-  a_out.m_loops.reserve(a_loops.size());
-  std::list<std::vector<size_t>>::iterator it(a_loops.begin());
-  for (; it != a_loops.end(); ++it)
+  a_out.m_loops.reserve(a_loops.Size());
+  for (size_t i = 0; i < a_loops.Size(); ++i)
   {
-    a_out.m_loops.push_back(std::vector<size_t>(it->begin(), it->end()));
+    a_out.m_loops.push_back(a_loops.Loop(i));
   }
   std::vector<int>& lt(a_out.m_loopTypes);
   if (!a_loopType.empty())
     lt.swap(a_loopType);
   else
-    lt.assign(a_loops.size(), a_pType);
+    lt.assign(a_loops.Size(), a_pType);
 } // MePolyCleanerImpl::FillOutputForCleanPolyOffset
 
 } // namespace xms
@@ -246,6 +254,7 @@ void MePolyCleanerImpl::FillOutputForCleanPolyOffset(MePolyOffsetterOutput& a_ou
 
 #include <xmsmesh/meshing/detail/MePolyCleaner.t.h>
 
+#include <xmscore/math/math.h>
 #include <xmscore/testing/TestTools.h>
 
 // namespace xms {
@@ -2297,5 +2306,95 @@ void MePolyCleanerUnitTests::testCleanInOut1b()
   TS_ASSERT_EQUALS_VEC(baseLoopType, o1.m_loopTypes);
 } // MePolyCleanerUnitTests::testCleanInOut1b
 
+//------------------------------------------------------------------------------
+/// \brief tests classifying many small loops inside and outside of a large
+/// loop.
+//------------------------------------------------------------------------------
+void MePolyCleanerUnitTests::testClassifyManyLoops()
+{
+  // outer loop is counter clockwise from (0, 0) to (100, 100). Inside of it
+  // is a 10x10 grid of unit squares. The ones with an even column are
+  // clockwise (holes that are kept) and the ones with an odd column are
+  // counter clockwise (removed). A row of clockwise squares below the outer
+  // loop is removed.
+  MePolyPts polyPts;
+  std::vector<Pt3d>& pts(polyPts.Pts());
+  MePolyLoops loops;
+  std::vector<size_t> loop;
+  pts = {{0, 0, 0}, {100, 0, 0}, {100, 100, 0}, {0, 100, 0}};
+  loop = {0, 1, 2, 3};
+  loops.Add(loop.data(), loop.data() + loop.size());
+  std::vector<size_t> baseLoops(1, 0);
+  for (int row = -1; row < 10; ++row)
+  {
+    for (int col = 0; col < 10; ++col)
+    {
+      double x(10.0 * col + 5), y(10.0 * row + 5);
+      size_t n(pts.size());
+      pts.push_back(Pt3d(x, y, 0));
+      pts.push_back(Pt3d(x + 1, y, 0));
+      pts.push_back(Pt3d(x + 1, y + 1, 0));
+      pts.push_back(Pt3d(x, y + 1, 0));
+      if (row >= 0 && col % 2 == 1)
+        loop = {n, n + 1, n + 2, n + 3};
+      else
+        loop = {n + 3, n + 2, n + 1, n};
+      if (row >= 0 && col % 2 == 0)
+        baseLoops.push_back(loops.Size());
+      loops.Add(loop.data(), loop.data() + loop.size());
+    }
+  }
+
+  MePolyLoops expected;
+  for (size_t i = 0; i < baseLoops.size(); ++i)
+  {
+    loop = loops.Loop(baseLoops[i]);
+    expected.Add(loop.data(), loop.data() + loop.size());
+  }
+  std::vector<int> loopType;
+  polyPts.ClassifyLoopsFromInPolyAndRemoveInvalid(loops, loopType);
+  TS_ASSERT_EQUALS_VEC(expected.m_idxs, loops.m_idxs);
+  TS_ASSERT_EQUALS_VEC(expected.m_start, loops.m_start);
+  std::vector<int> baseLoopType(baseLoops.size(), MePolyOffsetter::NEWOUT_POLY);
+  baseLoopType[0] = MePolyOffsetter::INSIDE_POLY;
+  TS_ASSERT_EQUALS_VEC(baseLoopType, loopType);
+} // MePolyCleanerUnitTests::testClassifyManyLoops
+//------------------------------------------------------------------------------
+/// \brief tests that IntersectSegs gives the same intersections when it uses
+/// the grid of segment envelopes as when it checks every pair of segments.
+//------------------------------------------------------------------------------
+void MePolyCleanerUnitTests::testIntersectSegsGrid()
+{
+  // a star shaped line that crosses itself many times with a few repeated
+  // points and a segment that doubles back on itself
+  std::vector<Pt3d> input;
+  const int numPts = 300;
+  for (int i = 0; i < numPts; ++i)
+  {
+    double a = 2 * XM_PI * i / numPts;
+    double r = 10 + 4 * sin(37 * a);
+    input.push_back(Pt3d(r * cos(a), r * sin(a), 0));
+    if (i % 50 == 0)
+      input.push_back(input.back());
+  }
+  input.push_back(input[10]);
+  input.push_back(input[5]);
+
+  MePolyPts brute, grid;
+  brute.Pts() = grid.Pts() = input;
+  brute.IntersectSegsGridThreshold() = std::numeric_limits<size_t>::max();
+  grid.IntersectSegsGridThreshold() = 0;
+  std::vector<size_t> bruteSegs(brute.SegmentsForCleanPolyOffset());
+  std::vector<size_t> gridSegs(grid.SegmentsForCleanPolyOffset());
+  TS_ASSERT_EQUALS_VEC(bruteSegs, gridSegs);
+  brute.IntersectSegs(bruteSegs);
+  grid.IntersectSegs(gridSegs);
+  TS_ASSERT(brute.Pts().size() > input.size());
+  TS_ASSERT_EQUALS_VEC(brute.Pts(), grid.Pts());
+  std::vector<size_t> bruteSeq(brute.SequenceWithIntersects(bruteSegs));
+  std::vector<size_t> gridSeq(grid.SequenceWithIntersects(gridSegs));
+  TS_ASSERT_EQUALS_VEC(bruteSeq, gridSeq);
+} // MePolyCleanerUnitTests::testIntersectSegsGrid
+
 //} // namespace xms
 #endif // CXX_TEST
@@ -34,6 +34,7 @@ public:
                                double a_tol,
                                MePolyOffsetterOutput& a_out) = 0;
   virtual void SetOriginalOutsidePolygon(const VecPt3d& a_origOutPoly) = 0;
+  virtual void SetNumThreads(int a_numThreads) = 0;
 
   virtual void IntersectCleanInPolys(const std::vector<MePolyOffsetterOutput>& a_offsets,
                                      MePolyOffsetterOutput& a_out,
@@ -79,6 +79,8 @@ public:
   void testCleanInOut1();
   void testCleanInOut1a();
   void testCleanInOut1b();
+  void testClassifyManyLoops();
+  void testIntersectSegsGrid();
 };
 //----- Function prototypes ----------------------------------------------------
 
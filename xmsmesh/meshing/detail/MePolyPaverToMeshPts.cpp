@@ -13,8 +13,16 @@
 #include <xmsmesh/meshing/detail/MePolyPaverToMeshPts.h>
 
 // 3. Standard library headers
+#include <algorithm>
+#include <atomic>
 #include <cfloat>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <limits>
 #include <list>
+#include <mutex>
+#include <thread>
 
 // 4. External library headers
 #include <boost/unordered_set.hpp>
@@ -26,6 +34,9 @@
 #include <xmsmesh/meshing/detail/MeIntersectPolys.h>
 #include <xmsmesh/meshing/detail/MePolyCleaner.h>
 #include <xmsmesh/meshing/detail/MePolyOffsetter.h>
+#include <xmsmesh/meshing/detail/MeParallel.h>
+#include <xmsmesh/meshing/detail/MeStageTimer.h>
+#include <xmsmesh/meshing/detail/MeTracer.h>
 #include <xmsmesh/meshing/MePolyRedistributePts.h>
 #include <xmscore/misc/Progress.h>
 #include <xmscore/misc/XmError.h>
@@ -54,6 +65,10 @@ void mePolyPaverRedistribute(BSHP<MePolyRedistributePts> a_redist,
 //----- Classes / Structs ------------------------------------------------------
 
 //----- Internal functions -----------------------------------------------------
+namespace
+{
+double iEnvelopeArea(const std::vector<Pt3d>& a_pts);
+} // unnamed namespace
 
 //----- Class / Function definitions -------------------------------------------
 namespace
@@ -70,6 +85,34 @@ public:
   int m_iter;
 };
 
+/// \brief A polygon on the paving stack and the polygons created by paving it
+class PolyNode
+{
+public:
+  Poly m_poly;                            ///< the polygon
+  std::vector<BSHP<PolyNode>> m_children; ///< polygons left after paving
+};
+
+/// \brief The classes and buffers used to pave one polygon. Each thread has
+/// its own.
+class PaveScratch
+{
+public:
+  PaveScratch()
+  : m_offsetter(MePolyOffsetter::New())
+  , m_cleaner(MePolyCleaner::New())
+  , m_offsetOutputs()
+  , m_polyOffsetIter(1)
+  , m_stats()
+  {
+  }
+  BSHP<MePolyOffsetter> m_offsetter;                  ///< paves the polygon
+  BSHP<MePolyCleaner> m_cleaner;                      ///< cleans the paved polygons
+  std::vector<MePolyOffsetterOutput> m_offsetOutputs; ///< paved polygons
+  int m_polyOffsetIter;                               ///< iteration from the boundary
+  MePolyMeshStats m_stats;                            ///< time and counts of this thread
+};
+
 class MePolyPaverToMeshPtsImpl : public MePolyPaverToMeshPts
 {
 public:
@@ -78,7 +121,9 @@ public:
   , m_xyTol(1e-9)
   , m_bias(1)
   , m_polyEnvelopeArea(0)
-  , m_polyOffsetIter(1)
+  , m_numThreads(1)
+  , m_stats(nullptr)
+  , m_tracer(nullptr)
   {
   }
 
@@ -91,29 +136,44 @@ public:
   /// \brief
   //------------------------------------------------------------------------------
   void SetRedistributor(BSHP<MePolyRedistributePts> a_) override { m_externalRedist = a_; }
+  //------------------------------------------------------------------------------
+  /// \brief Sets the number of threads used to pave the polygon
+  /// \param a_numThreads The number of threads. See meNumThreadsToUse.
+  //------------------------------------------------------------------------------
+  void SetNumThreads(int a_numThreads) override { m_numThreads = a_numThreads; }
+  //------------------------------------------------------------------------------
+  /// \brief Sets the stats that the time and counts of paving are added to
+  /// \param a_stats The stats. Nothing is timed or counted if null.
+  //------------------------------------------------------------------------------
+  void SetStats(MePolyMeshStats* a_stats) override { m_stats = a_stats; }
+  //------------------------------------------------------------------------------
+  /// \brief Sets the tracer that each paving iteration is added to as a span
+  /// \param a_tracer The tracer. May be null.
+  //------------------------------------------------------------------------------
+  void SetTracer(MeTracer* a_tracer) override { m_tracer = a_tracer; }
   void Setup();
   void TearDown();
   void ProcessStack();
+  void ProcessStackParallel(int a_numThreads);
+  void PavePoly(const Poly& a_poly, PaveScratch& a_scratch, std::vector<Poly>& a_newPolys);
   void AddPolygonToMeshPoints(const Poly& a_poly, bool a_first);
-  void DoPave(const Poly& a_poly);
-  void CleanPave(const Poly& a_poly);
-  void RedistributePts();
-  void ClassifyPolys();
+  void DoPave(const Poly& a_poly, PaveScratch& a_scratch);
+  void CleanPave(const Poly& a_poly, PaveScratch& a_scratch);
+  void RedistributePts(PaveScratch& a_scratch);
+  void ClassifyPolys(PaveScratch& a_scratch, std::vector<Poly>& a_newPolys);
   double AreaFromPolyStack();
 
   BSHP<VecPt3d> m_meshPts;
   std::list<Poly> m_polyStack;
-  BSHP<MePolyOffsetter> m_offsetter;
-  BSHP<MePolyCleaner> m_cleaner;
   BSHP<MePolyRedistributePts> m_redist;
   BSHP<MePolyRedistributePts> m_externalRedist;
   double m_xyTol;
   double m_bias;
   double m_polyEnvelopeArea;
-  int m_polyOffsetIter;
+  int m_numThreads; ///< number of threads used to pave
+  MePolyMeshStats* m_stats; ///< time and counts of paving, may be null
+  MeTracer* m_tracer;       ///< tracer of the paving iterations, may be null
   boost::unordered_set<std::pair<double, double>> m_ptHash;
-
-  std::vector<MePolyOffsetterOutput> m_offsetOutputs;
 };
 
 } // unnamed namespace
@@ -181,7 +241,12 @@ bool MePolyPaverToMeshPtsImpl::PolyToMeshPts(const std::vector<Pt3d>& a_outPoly,
   m_polyStack.back().m_iter = 1;
 
   Setup();
-  ProcessStack();
+  // a single thread would only add overhead to the serial version
+  int numThreads = meNumThreadsToUse(m_numThreads, std::numeric_limits<size_t>::max());
+  if (numThreads > 1)
+    ProcessStackParallel(numThreads);
+  else
+    ProcessStack();
   // fill the output variable
   a_meshPts.swap(*m_meshPts);
   TearDown();
@@ -194,8 +259,6 @@ void MePolyPaverToMeshPtsImpl::Setup()
 {
   // Calculate tolerance for point comparison
   m_meshPts = BSHP<VecPt3d>(new VecPt3d());
-  m_offsetter = MePolyOffsetter::New();
-  m_cleaner = MePolyCleaner::New();
   m_polyEnvelopeArea = AreaFromPolyStack();
   if (!m_externalRedist)
   {
@@ -212,8 +275,6 @@ void MePolyPaverToMeshPtsImpl::Setup()
 void MePolyPaverToMeshPtsImpl::TearDown()
 {
   m_meshPts.reset();
-  m_offsetter.reset();
-  m_cleaner.reset();
   m_redist.reset();
   m_ptHash.clear();
 } // MePolyPaverToMeshPtsImpl::TearDown
@@ -228,24 +289,21 @@ void MePolyPaverToMeshPtsImpl::ProcessStack()
   Progress prog("Paving Polygon");
 
   double area;
+  PaveScratch scratch;
+  std::vector<Poly> newPolys;
   std::list<Poly>::iterator it(m_polyStack.begin());
   bool first(true);
   while (it != m_polyStack.end())
   {
     Poly& p(*it);
 
-    m_polyOffsetIter = p.m_iter;
-    // Pave the polygon
-    DoPave(p);
-    // clean the results from the pave
-    CleanPave(p);
-    // redistribute points on the polygons
-    RedistributePts();
-    // clean again after redistributing the points
-    CleanPave(p);
-    // classify the newly created polys into polygons defined by the "Poly"
-    // class and put them on the stack
-    ClassifyPolys();
+    // pave the polygon and put the polygons that are left on the stack
+    newPolys.clear();
+    PavePoly(p, scratch, newPolys);
+    m_polyStack.insert(m_polyStack.end(), newPolys.begin(), newPolys.end());
+    if (m_stats)
+      scratch.m_stats.m_maxPaveStack =
+        std::max(scratch.m_stats.m_maxPaveStack, (int)m_polyStack.size() - 1);
     // add the points from this polygon to the mesh points
     AddPolygonToMeshPoints(p, first);
     first = false;
@@ -258,8 +316,213 @@ void MePolyPaverToMeshPtsImpl::ProcessStack()
     area = AreaFromPolyStack();
     prog.ProgressStatus(1.0 - (area / m_polyEnvelopeArea));
   }
+  if (m_stats)
+    meAddPolyMeshStats(scratch.m_stats, *m_stats);
 } // MePolyPaverToMeshPtsImpl::ProcessStack
 //------------------------------------------------------------------------------
+/// \brief Processes the stack of polygons on several threads. Gives the same
+/// mesh points as ProcessStack.
+///
+/// Once paving splits a polygon into several polygons they are independent of
+/// each other. Each thread has a queue of polygons to pave. It takes the
+/// newest polygon from its own queue and adds the polygons created by paving
+/// it back to its own queue. A thread with an empty queue takes the oldest
+/// polygon from another thread's queue. The polygons are kept in a tree and
+/// their points are added to the mesh points after all of the paving is done,
+/// in the same order ProcessStack adds them (parents before children,
+/// siblings in the order they were created).
+/// \param a_numThreads The number of threads. Must be at least 2.
+//------------------------------------------------------------------------------
+void MePolyPaverToMeshPtsImpl::ProcessStackParallel(int a_numThreads)
+{
+  Progress prog("Paving Polygon");
+
+  BSHP<PolyNode> root(new PolyNode);
+  root->m_poly = m_polyStack.front();
+  m_polyStack.clear();
+
+  std::vector<std::deque<BSHP<PolyNode>>> queues(a_numThreads);
+  std::vector<std::mutex> queueMutexes(a_numThreads);
+  std::vector<PaveScratch> scratch(a_numThreads);
+  // every thread already paves, so each cleaner runs on its own thread only
+  for (size_t i = 0; i < scratch.size(); ++i)
+    scratch[i].m_cleaner->SetNumThreads(1);
+  std::atomic<size_t> queued(1); // polygons in the queues
+  std::atomic<bool> stop(false); // set when paving a polygon fails
+  std::mutex mtx;                // protects the variables below
+  std::condition_variable cv;
+  size_t unfinished(1); // polygons in the queues or being paved
+  double area(m_polyEnvelopeArea);
+  std::exception_ptr error;
+  queues[0].push_back(root);
+
+  auto worker = [&](int a_thread) {
+    std::vector<Poly> newPolys;
+    while (!stop)
+    {
+      // newest polygon from this thread's queue or oldest from another's
+      BSHP<PolyNode> node;
+      for (int i = 0; !node && i < a_numThreads; ++i)
+      {
+        int q = (a_thread + i) % a_numThreads;
+        std::lock_guard<std::mutex> lock(queueMutexes[q]);
+        if (queues[q].empty())
+          continue;
+        if (i == 0)
+        {
+          node = queues[q].back();
+          queues[q].pop_back();
+        }
+        else
+        {
+          node = queues[q].front();
+          queues[q].pop_front();
+        }
+        --queued;
+      }
+      if (!node)
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv.wait(lock, [&]() { return queued > 0 || unfinished == 0 || error; });
+        if (unfinished == 0 || error)
+          return;
+        continue;
+      }
+
+      try
+      {
+        newPolys.clear();
+        PavePoly(node->m_poly, scratch[a_thread], newPolys);
+      }
+      catch (...)
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!error)
+          error = std::current_exception();
+        stop = true;
+        cv.notify_all();
+        return;
+      }
+
+      double areaChange = -iEnvelopeArea(node->m_poly.m_outside);
+      for (size_t i = 0; i < newPolys.size(); ++i)
+      {
+        node->m_children.push_back(BSHP<PolyNode>(new PolyNode));
+        node->m_children.back()->m_poly = newPolys[i];
+        areaChange += iEnvelopeArea(newPolys[i].m_outside);
+      }
+      {
+        std::lock_guard<std::mutex> lock(queueMutexes[a_thread]);
+        queues[a_thread].insert(queues[a_thread].end(), node->m_children.begin(),
+                                node->m_children.end());
+        queued += node->m_children.size();
+      }
+      if (m_stats)
+      {
+        MePolyMeshStats& stats(scratch[a_thread].m_stats);
+        stats.m_maxPaveStack = std::max(stats.m_maxPaveStack, (int)queued);
+      }
+      {
+        std::lock_guard<std::mutex> lock(mtx);
+        unfinished += node->m_children.size();
+        --unfinished;
+        area += areaChange;
+      }
+      cv.notify_all();
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(a_numThreads);
+  for (int t = 0; t < a_numThreads; ++t)
+    threads.push_back(std::thread(worker, t));
+
+  // report progress from this thread while the others pave
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (unfinished > 0 && !error)
+    {
+      cv.wait(lock);
+      double fraction = 1.0 - (area / m_polyEnvelopeArea);
+      lock.unlock();
+      prog.ProgressStatus(fraction);
+      lock.lock();
+    }
+  }
+  for (auto& t : threads)
+    t.join();
+  if (error)
+    std::rethrow_exception(error);
+  if (m_stats)
+  {
+    for (size_t i = 0; i < scratch.size(); ++i)
+      meAddPolyMeshStats(scratch[i].m_stats, *m_stats);
+  }
+
+  // add the points in the same order as ProcessStack
+  std::vector<BSHP<PolyNode>> level(1, root), nextLevel;
+  bool first(true);
+  while (!level.empty())
+  {
+    nextLevel.clear();
+    for (size_t i = 0; i < level.size(); ++i)
+    {
+      AddPolygonToMeshPoints(level[i]->m_poly, first);
+      first = false;
+      nextLevel.insert(nextLevel.end(), level[i]->m_children.begin(),
+                       level[i]->m_children.end());
+    }
+    level.swap(nextLevel);
+  }
+} // MePolyPaverToMeshPtsImpl::ProcessStackParallel
+//------------------------------------------------------------------------------
+/// \brief Paves one polygon from the stack.
+/// \param a_poly The polygon.
+/// \param a_scratch The classes and buffers used to pave.
+/// \param a_newPolys The polygons left after paving, cleaning, redistributing
+/// points, and cleaning again. These go on the stack.
+//------------------------------------------------------------------------------
+void MePolyPaverToMeshPtsImpl::PavePoly(const Poly& a_poly,
+                                        PaveScratch& a_scratch,
+                                        std::vector<Poly>& a_newPolys)
+{
+  MeTraceSpan span(m_tracer, "pave_poly", "ring", a_poly.m_iter);
+  a_scratch.m_polyOffsetIter = a_poly.m_iter;
+  MePolyMeshStats* stats = m_stats ? &a_scratch.m_stats : nullptr;
+  if (stats)
+  {
+    size_t numPts = a_poly.m_outside.size();
+    for (size_t i = 0; i < a_poly.m_inside.size(); ++i)
+      numPts += a_poly.m_inside[i].size();
+    stats->m_numRings = std::max(stats->m_numRings, a_poly.m_iter);
+    stats->m_maxPavePolyPts = std::max(stats->m_maxPavePolyPts, (int)numPts);
+  }
+  // Pave the polygon
+  {
+    MeStageTimer timer(stats, MePolyMeshStats::DO_PAVE, m_tracer);
+    DoPave(a_poly, a_scratch);
+  }
+  // clean the results from the pave
+  {
+    MeStageTimer timer(stats, MePolyMeshStats::CLEAN_PAVE, m_tracer);
+    CleanPave(a_poly, a_scratch);
+  }
+  // redistribute points on the polygons
+  {
+    MeStageTimer timer(stats, MePolyMeshStats::REDISTRIBUTE_PTS, m_tracer);
+    RedistributePts(a_scratch);
+  }
+  // clean again after redistributing the points
+  {
+    MeStageTimer timer(stats, MePolyMeshStats::CLEAN_PAVE, m_tracer);
+    CleanPave(a_poly, a_scratch);
+  }
+  // classify the newly created polys into polygons defined by the "Poly"
+  // class
+  MeStageTimer timer(stats, MePolyMeshStats::CLASSIFY_POLYS, m_tracer);
+  ClassifyPolys(a_scratch, a_newPolys);
+} // MePolyPaverToMeshPtsImpl::PavePoly
+//------------------------------------------------------------------------------
 /// \brief Takes the points on a_poly and moves them to the output of mesh
 /// node locations
 //------------------------------------------------------------------------------
@@ -326,79 +589,82 @@ void MePolyPaverToMeshPtsImpl::AddPolygonToMeshPoints(const Poly& a_poly, bool /
 //------------------------------------------------------------------------------
 /// \brief Paves inward from OUTSIDE_POLY and paves outward from INSIDE_POLY
 //------------------------------------------------------------------------------
-void MePolyPaverToMeshPtsImpl::DoPave(const Poly& a_poly)
+void MePolyPaverToMeshPtsImpl::DoPave(const Poly& a_poly, PaveScratch& a_scratch)
 {
-  m_offsetOutputs.clear();
+  std::vector<MePolyOffsetterOutput>& offsetOutputs(a_scratch.m_offsetOutputs);
+  offsetOutputs.clear();
 
   MePolyOffsetterOutput offsetOut;
   MePolyOffsetter::polytype pIn(MePolyOffsetter::INSIDE_POLY), pOut(MePolyOffsetter::OUTSIDE_POLY);
   std::vector<Pt3d> pts;
   // pave in from the outer poly
-  m_offsetter->Offset(a_poly.m_outside, pOut, offsetOut, m_xyTol);
-  m_offsetOutputs.push_back(offsetOut);
+  a_scratch.m_offsetter->Offset(a_poly.m_outside, pOut, offsetOut, m_xyTol);
+  offsetOutputs.push_back(offsetOut);
 
   // pave out from the inner polys
   for (size_t i = 0; i < a_poly.m_inside.size(); ++i)
   {
-    m_offsetter->Offset(a_poly.m_inside[i], pIn, offsetOut, m_xyTol);
-    m_offsetOutputs.push_back(offsetOut);
+    a_scratch.m_offsetter->Offset(a_poly.m_inside[i], pIn, offsetOut, m_xyTol);
+    offsetOutputs.push_back(offsetOut);
   }
 } // MePolyPaverToMeshPtsImpl::DoPave
 //------------------------------------------------------------------------------
 /// \brief Cleans up the results from the paving operation. There may be newly
 /// created polygons that intersect.
 //------------------------------------------------------------------------------
-void MePolyPaverToMeshPtsImpl::CleanPave(const Poly& a_poly)
+void MePolyPaverToMeshPtsImpl::CleanPave(const Poly& a_poly, PaveScratch& a_scratch)
 {
-  m_cleaner->SetOriginalOutsidePolygon(a_poly.m_outside);
+  a_scratch.m_cleaner->SetOriginalOutsidePolygon(a_poly.m_outside);
   // intersect the new inner polys with the other inner polys
   MePolyOffsetterOutput out, out2;
-  m_cleaner->IntersectCleanInPolys(m_offsetOutputs, out, m_xyTol);
+  a_scratch.m_cleaner->IntersectCleanInPolys(a_scratch.m_offsetOutputs, out, m_xyTol);
 
   // intersect the new inner polys with the outer polys
-  m_cleaner->IntersectCleanInOutPolys(out, out2, m_xyTol);
-  m_offsetOutputs.clear();
-  m_offsetOutputs.push_back(out2);
+  a_scratch.m_cleaner->IntersectCleanInOutPolys(out, out2, m_xyTol);
+  a_scratch.m_offsetOutputs.clear();
+  a_scratch.m_offsetOutputs.push_back(out2);
 } // MePolyPaverToMeshPtsImpl::CleanPave
 //------------------------------------------------------------------------------
 /// \brief Redistributes the points on polygons. A sizing function maybe used
 /// that comes from a set of points.
 //------------------------------------------------------------------------------
-void MePolyPaverToMeshPtsImpl::RedistributePts()
+void MePolyPaverToMeshPtsImpl::RedistributePts(PaveScratch& a_scratch)
 {
   XM_ASSERT(m_redist);
   if (!m_redist)
     return;
   MePolyOffsetterOutput o;
-  mePolyPaverRedistribute(m_redist, m_offsetOutputs[0], o, m_polyOffsetIter);
-  m_offsetOutputs[0] = o;
+  mePolyPaverRedistribute(m_redist, a_scratch.m_offsetOutputs[0], o, a_scratch.m_polyOffsetIter);
+  a_scratch.m_offsetOutputs[0] = o;
 } // MePolyPaverToMeshPtsImpl::RedistributePts
 //------------------------------------------------------------------------------
 /// \brief Create new polygons to put onto the processing stack. These are the
 /// polygons that are left after paving, cleaning, redistributing points, and
 /// cleaning again.
-/// \param [in] a_iter Tells what iteration this is from the boundary of the
-/// polygon.
+/// \param [in,out] a_scratch The paving results and the iteration from the
+/// boundary of the polygon.
+/// \param [out] a_newPolys The new polygons are added to this.
 //------------------------------------------------------------------------------
-void MePolyPaverToMeshPtsImpl::ClassifyPolys()
+void MePolyPaverToMeshPtsImpl::ClassifyPolys(PaveScratch& a_scratch, std::vector<Poly>& a_newPolys)
 {
-  if (m_offsetOutputs[0].m_pts.empty())
+  MePolyOffsetterOutput& offsetOut(a_scratch.m_offsetOutputs[0]);
+  if (offsetOut.m_pts.empty())
     return;
 
   std::vector<std::vector<size_t>> polys;
   MeIntersectPolys ip;
-  ip.ClassifyPolys(m_offsetOutputs[0], polys);
+  ip.ClassifyPolys(offsetOut, polys);
 
   // put these on the stack
-  std::vector<Pt3d>& pts(m_offsetOutputs[0].m_pts);
+  std::vector<Pt3d>& pts(offsetOut.m_pts);
   Poly p;
-  p.m_iter = m_polyOffsetIter + 1;
+  p.m_iter = a_scratch.m_polyOffsetIter + 1;
   for (size_t i = 0; i < polys.size(); ++i)
   {
     p.m_outside.resize(0);
     p.m_inside.resize(0);
     // get the outside loop
-    std::vector<size_t>& oLoop(m_offsetOutputs[0].m_loops[polys[i][0]]);
+    std::vector<size_t>& oLoop(offsetOut.m_loops[polys[i][0]]);
     for (size_t j = 0; j < oLoop.size(); ++j)
     {
       p.m_outside.push_back(pts[oLoop[j]]);
@@ -406,7 +672,7 @@ void MePolyPaverToMeshPtsImpl::ClassifyPolys()
     // do inside loops
     for (size_t j = 1; j < polys[i].size(); ++j)
     {
-      std::vector<size_t>& iLoop(m_offsetOutputs[0].m_loops[polys[i][j]]);
+      std::vector<size_t>& iLoop(offsetOut.m_loops[polys[i][j]]);
       p.m_inside.push_back(std::vector<Pt3d>());
       for (size_t k = 0; k < iLoop.size(); ++k)
       {
@@ -414,14 +680,14 @@ void MePolyPaverToMeshPtsImpl::ClassifyPolys()
       }
     }
 
-    m_polyStack.push_back(p);
+    a_newPolys.push_back(p);
   }
 
 } // MePolyPaverToMeshPtsImpl::ClassifyPolys
 //------------------------------------------------------------------------------
 /// \brief Computes the envelope area from a vector of points
 //------------------------------------------------------------------------------
-static double iEnvelopeArea(const std::vector<Pt3d>& a_pts)
+double iEnvelopeArea(const std::vector<Pt3d>& a_pts)
 {
   double area;
   Pt3d pMin(XM_DBL_HIGHEST),
@@ -458,6 +724,7 @@ double MePolyPaverToMeshPtsImpl::AreaFromPolyStack()
 
 #include <xmsmesh/meshing/detail/MePolyPaverToMeshPts.t.h>
 
+#include <xmscore/math/math.h>
 #include <xmscore/testing/TestTools.h>
 
 // namespace xms {
@@ -557,6 +824,53 @@ void MePolyPaverToMeshPtsUnitTests::testCase2()
     {2.4260, 1.8985, 0.0}, {2.4335, 2.3440, 0.0}, {2.0093, 2.4589, 0.0}};
   TS_ASSERT_DELTA_VECPT3D(basePts, outPts, 1e-4);
 } // MePolyPaverToMeshPtsUnitTests::testCase1
+//------------------------------------------------------------------------------
+/// \brief tests that paving on several threads gives the same points as
+/// paving on one thread. The narrow channel between the two boxes closes
+/// after the first paving iteration which leaves independent polygons.
+//------------------------------------------------------------------------------
+void MePolyPaverToMeshPtsUnitTests::testParallelMatchesSerial()
+{
+  // x =   0         10         20         30
+  //
+  // y=10  +----------+          +----------+
+  //       |          |          |          |
+  // y=6   |          +----------+          |
+  // y=4   |          +----------+          |
+  //       |          |          |          |
+  // y=0   +----------+          +----------+
+  //
+  std::vector<Pt3d> corners = {{0, 0, 0},   {0, 10, 0},  {10, 10, 0}, {10, 6, 0},
+                               {20, 6, 0},  {20, 10, 0}, {30, 10, 0}, {30, 0, 0},
+                               {20, 0, 0},  {20, 4, 0},  {10, 4, 0},  {10, 0, 0}};
+  std::vector<Pt3d> outPoly;
+  for (size_t i = 0; i < corners.size(); ++i)
+  {
+    const Pt3d& p0(corners[i]);
+    const Pt3d& p1(corners[(i + 1) % corners.size()]);
+    int n = (int)(Mdist(p0.x, p0.y, p1.x, p1.y) + 0.5);
+    for (int j = 0; j < n; ++j)
+    {
+      double t = (double)j / n;
+      outPoly.push_back(Pt3d(p0.x + t * (p1.x - p0.x), p0.y + t * (p1.y - p0.y), 0));
+    }
+  }
+  std::vector<std::vector<Pt3d>> inPoly;
+  double bias(1), tol(1e-9);
+
+  MePolyPaverToMeshPtsImpl serialPaver;
+  std::vector<Pt3d> serialPts;
+  TS_ASSERT(serialPaver.PolyToMeshPts(outPoly, inPoly, bias, tol, serialPts));
+
+  for (int numThreads = 2; numThreads <= 4; ++numThreads)
+  {
+    MePolyPaverToMeshPtsImpl paver;
+    paver.SetNumThreads(numThreads);
+    std::vector<Pt3d> pts;
+    TS_ASSERT(paver.PolyToMeshPts(outPoly, inPoly, bias, tol, pts));
+    TS_ASSERT_DELTA_VECPT3D(serialPts, pts, 0.0);
+  }
+} // MePolyPaverToMeshPtsUnitTests::testParallelMatchesSerial
 
 //} // namespace xms
 #endif
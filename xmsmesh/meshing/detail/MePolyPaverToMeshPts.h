@@ -18,6 +18,8 @@
 namespace xms
 {
 class MePolyRedistributePts;
+class MePolyMeshStats;
+class MeTracer;
 
 //----- Constants / Enumerations -----------------------------------------------
 
@@ -37,6 +39,9 @@ public:
                              std::vector<Pt3d>& a_meshPts) = 0;
 
   virtual void SetRedistributor(BSHP<MePolyRedistributePts> a_) = 0;
+  virtual void SetNumThreads(int a_numThreads) = 0;
+  virtual void SetStats(MePolyMeshStats* a_stats) = 0;
+  virtual void SetTracer(MeTracer* a_tracer) = 0;
 
 private:
   XM_DISALLOW_COPY_AND_ASSIGN(MePolyPaverToMeshPts);
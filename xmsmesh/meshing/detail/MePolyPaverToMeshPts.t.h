@@ -31,6 +31,7 @@ public:
   void testCreateClass();
   void testCase1();
   void testCase2();
+  void testParallelMatchesSerial();
 };
 //----- Function prototypes ----------------------------------------------------
 
@@ -13,11 +13,17 @@
 #include <xmsmesh/meshing/detail/MePolyPts.h>
 
 // 3. Standard library headers
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <limits>
 
 // 4. External library headers
 #pragma warning(push)
 #pragma warning(disable : 4512) // boost code: no assignment operator
 #include <boost/geometry/geometry.hpp>
+#include <boost/geometry/index/rtree.hpp>
 #pragma warning(pop)
 
 // 5. Shared code headers
@@ -38,21 +44,51 @@
 //----- Namespace declaration --------------------------------------------------
 namespace xms
 {
-/// map for segment intersection indices
-typedef std::map<size_t, std::multimap<double, size_t>> SegMap;
-/// map used to see where segments cross each other
-typedef std::map<const std::vector<size_t>*, SegMap> MapSegMap;
-
 //----- Constants / Enumerations -----------------------------------------------
 
 //----- Classes / Structs ------------------------------------------------------
 namespace
 {
 namespace bg = boost::geometry;
+namespace bgi = boost::geometry::index;
+
+/// envelope of a loop and the index of the loop
+typedef std::pair<GmBstBox3d, size_t> MeLoopEnvelope;
+/// rtree of loop envelopes
+typedef bgi::rtree<MeLoopEnvelope, bgi::quadratic<16>> MeLoopRtree;
 
 #define T_TOL 1e-13 ///< tolerance used in multipoly intersector
 
+/// \brief An intersection location on a segment
+struct SegCross
+{
+  const std::vector<size_t>* m_segs; ///< vector of segments that m_seg refers to
+  size_t m_seg;                      ///< index of the segment
+  double m_t;                        ///< parametric location on the segment
+  size_t m_pt;                       ///< index of the intersection point
+};
+
+/// \brief Orders intersections by segment vector, segment and location.
+struct SegCrossLess
+{
+  /// \brief Compares 2 intersections.
+  /// \param a_lhs An intersection.
+  /// \param a_rhs An intersection.
+  /// \return true if a_lhs comes before a_rhs
+  bool operator()(const SegCross& a_lhs, const SegCross& a_rhs) const
+  {
+    if (a_lhs.m_segs != a_rhs.m_segs)
+      return std::less<const std::vector<size_t>*>()(a_lhs.m_segs, a_rhs.m_segs);
+    if (a_lhs.m_seg != a_rhs.m_seg)
+      return a_lhs.m_seg < a_rhs.m_seg;
+    return a_lhs.m_t < a_rhs.m_t;
+  }
+};
+
 } // unnamed namespace
+
+/// vector used to see where segments cross each other
+typedef std::vector<SegCross> VecSegCross;
 /// \brief Implementation of MePolyPts
 class MePolyPts::impl
 {
@@ -60,14 +96,16 @@ public:
   impl()
   : m_xyTol(1e-9)
   , m_pts(new std::vector<Pt3d>())
+  , m_gridThreshold(64)
   {
   }
   ~impl() {}
 
   double m_xyTol;                ///< tolerance for geometric comparisons
   BSHP<std::vector<Pt3d>> m_pts; ///< point locations
-  MapSegMap m_segCross;          ///< map used to see where segment cross each other
+  VecSegCross m_segCross;        ///< where segments cross each other
   BSHP<GmPtSearch> m_ps;         ///< spatial index for searching points
+  size_t m_gridThreshold;        ///< IntersectSegs uses a grid above this many segments
 };
 
 //----- Internal functions -----------------------------------------------------
@@ -95,18 +133,19 @@ static size_t iNextSegIdx(size_t a_i, const std::vector<size_t>& a_seg)
 /// \param a_iSeg Vector of segments that a_i refers to.
 /// \param a_j Index for a point location.
 /// \param a_t Parametric value for the location of point a_j along segment a_i.
-/// \param a_mapSegCross Map that holds information about intersections of line
-/// segments.
+/// \param a_segCross Vector that holds information about intersections of line
+/// segments. It is sorted when the intersections are used.
 //------------------------------------------------------------------------------
 static void iAddIntersection(size_t a_i,
                              const std::vector<size_t>& a_iSeg,
                              size_t a_j,
                              double a_t,
-                             MapSegMap& a_mapSegCross)
+                             VecSegCross& a_segCross)
 {
   if (a_t >= 0 && a_t <= 1)
   {
-    a_mapSegCross[&a_iSeg][a_i].insert(std::make_pair(a_t, a_j));
+    SegCross cross = {&a_iSeg, a_i, a_t, a_j};
+    a_segCross.push_back(cross);
   }
 } // iAddIntersection
 //------------------------------------------------------------------------------
@@ -200,6 +239,98 @@ static bool iEnvelopesOverlapOrTouch(size_t a_i,
   return true;
 } // iEnvelopesOverlapOrTouch
 //------------------------------------------------------------------------------
+/// \brief Finds the pairs of envelopes that overlap or touch using a uniform
+/// grid of buckets. Each envelope is put in every cell that it covers. A pair
+/// is only reported by the cell holding the lower left corner of the
+/// intersection of the 2 envelopes so no pair is reported twice.
+/// \param a_env Vector of segment envelopes.
+/// \return Pairs of envelope indexes (i, j) with i < j. They are sorted in
+/// the same order that the nested loops in MePolyPts::IntersectSegs would
+/// visit them.
+//------------------------------------------------------------------------------
+static std::vector<std::pair<size_t, size_t>> iOverlappingEnvelopePairs(
+  const std::vector<GmBstBox3d>& a_env)
+{
+  std::vector<std::pair<size_t, size_t>> pairs;
+  const size_t n(a_env.size());
+  if (n < 2)
+    return pairs;
+
+  // size the cells so that there are about as many cells as segments but no
+  // smaller than the average segment envelope
+  double xMin(a_env[0].min_corner().x), yMin(a_env[0].min_corner().y);
+  double xMax(a_env[0].max_corner().x), yMax(a_env[0].max_corner().y);
+  double sumExtent(0);
+  for (size_t i = 0; i < n; ++i)
+  {
+    const Pt3d &mn(a_env[i].min_corner()), &mx(a_env[i].max_corner());
+    xMin = std::min(xMin, mn.x);
+    yMin = std::min(yMin, mn.y);
+    xMax = std::max(xMax, mx.x);
+    yMax = std::max(yMax, mx.y);
+    sumExtent += std::max(mx.x - mn.x, mx.y - mn.y);
+  }
+  double dx(xMax - xMin), dy(yMax - yMin);
+  double cellSize = sqrt(dx * dy / n);
+  if (cellSize <= 0)
+    cellSize = std::max(dx, dy) / n;
+  cellSize = std::max(cellSize, sumExtent / n);
+  if (cellSize <= 0)
+    cellSize = 1;
+  size_t nx = std::min((size_t)(dx / cellSize) + 1, n);
+  size_t ny = std::min((size_t)(dy / cellSize) + 1, n);
+  auto cellX = [&](double a_x) { return std::min((size_t)((a_x - xMin) / cellSize), nx - 1); };
+  auto cellY = [&](double a_y) { return std::min((size_t)((a_y - yMin) / cellSize), ny - 1); };
+
+  // bucket the envelopes (compressed rows so the cells are contiguous)
+  std::vector<size_t> cellStart(nx * ny + 1, 0);
+  for (size_t i = 0; i < n; ++i)
+  {
+    size_t x0(cellX(a_env[i].min_corner().x)), x1(cellX(a_env[i].max_corner().x));
+    size_t y0(cellY(a_env[i].min_corner().y)), y1(cellY(a_env[i].max_corner().y));
+    for (size_t y = y0; y <= y1; ++y)
+    {
+      for (size_t x = x0; x <= x1; ++x)
+        ++cellStart[y * nx + x + 1];
+    }
+  }
+  for (size_t c = 1; c < cellStart.size(); ++c)
+    cellStart[c] += cellStart[c - 1];
+  std::vector<size_t> fill(cellStart.begin(), cellStart.end() - 1);
+  std::vector<size_t> cellSegs(cellStart.back());
+  for (size_t i = 0; i < n; ++i)
+  {
+    size_t x0(cellX(a_env[i].min_corner().x)), x1(cellX(a_env[i].max_corner().x));
+    size_t y0(cellY(a_env[i].min_corner().y)), y1(cellY(a_env[i].max_corner().y));
+    for (size_t y = y0; y <= y1; ++y)
+    {
+      for (size_t x = x0; x <= x1; ++x)
+        cellSegs[fill[y * nx + x]++] = i;
+    }
+  }
+
+  // the segments in each cell are in increasing order so i < j
+  for (size_t c = 0; c + 1 < cellStart.size(); ++c)
+  {
+    for (size_t a = cellStart[c]; a < cellStart[c + 1]; ++a)
+    {
+      size_t i(cellSegs[a]);
+      for (size_t b = a + 1; b < cellStart[c + 1]; ++b)
+      {
+        size_t j(cellSegs[b]);
+        if (!iEnvelopesOverlapOrTouch(i, j, a_env, a_env))
+          continue;
+        double x = std::max(a_env[i].min_corner().x, a_env[j].min_corner().x);
+        double y = std::max(a_env[i].min_corner().y, a_env[j].min_corner().y);
+        if (cellY(y) * nx + cellX(x) == c)
+          pairs.push_back(std::make_pair(i, j));
+      }
+    }
+  }
+  std::sort(pairs.begin(), pairs.end());
+  return pairs;
+} // iOverlappingEnvelopePairs
+//------------------------------------------------------------------------------
 /// \brief Computes the T value for the point on the line a_p0, a_p1
 /// \param a_p0 Location of the 1st point defining a line segment.
 /// \param a_p1 Location of the 2nd point defining a line segment.
@@ -242,7 +373,7 @@ static double iCalcIntersectionT(const Pt3d& a_p0, const Pt3d& a_p1, Pt3d& a_iPt
 /// \param a_pts Vector of point locations. The segments just store
 /// indexes that refer to locations in this vector.
 /// \param a_xyTol Tolerance used in geometric calculations.
-/// \param a_mapSegCross Map of intersection information.
+/// \param a_segCross Vector of intersection information.
 /// \return true if the segments share a point
 //------------------------------------------------------------------------------
 static bool iCheckSharedPtIdx(size_t a_i,
@@ -251,7 +382,7 @@ static bool iCheckSharedPtIdx(size_t a_i,
                               const std::vector<size_t>& a_jSeg,
                               const std::vector<Pt3d>& a_pts,
                               double a_xyTol,
-                              MapSegMap& a_mapSegCross)
+                              VecSegCross& a_segCross)
 {
   size_t nexti(iNextSegIdx(a_i, a_iSeg)), nextj(iNextSegIdx(a_j, a_jSeg));
   size_t p00(a_iSeg[a_i]), p01(a_iSeg[nexti]), p10(a_jSeg[a_j]), p11(a_jSeg[nextj]);
@@ -272,7 +403,7 @@ static bool iCheckSharedPtIdx(size_t a_i,
   if (gmOnLineAndBetweenEndpointsWithTol(s1p0, s1p1, p.x, p.y, a_xyTol))
   {
     double t = iCalcIntersectionT(s1p0, s1p1, p, a_xyTol);
-    iAddIntersection(a_i, a_iSeg, idx, t, a_mapSegCross);
+    iAddIntersection(a_i, a_iSeg, idx, t, a_segCross);
   }
   return true;
 } // iCheckSharedPtIdx
@@ -333,7 +464,7 @@ static bool iIntersectTwoSegments(const Pt3d& a_s1p0,
 } // iIntersectTwoSegments
 //------------------------------------------------------------------------------
 /// \brief Sees if 2 segments intersects and if they do then information is
-/// added to the a_mapSegCross.
+/// added to a_segCross.
 /// \param a_i Index to a segment.
 /// \param a_j Index to a segment.
 /// \param a_iSeg Vector of segments referred to by a_i.
@@ -341,7 +472,7 @@ static bool iIntersectTwoSegments(const Pt3d& a_s1p0,
 /// \param a_shptrPts Vector of point locations. The segments just store
 /// indexes that refer to locations in this vector.
 /// \param a_xyTol Tolerance used in geometric calculations.
-/// \param a_mapSegCross Map of intersection information.
+/// \param a_segCross Vector of intersection information.
 /// \param a_ps A PtSearch class. Will hash newly calculated locations with
 /// existing point locations.
 //------------------------------------------------------------------------------
@@ -351,11 +482,11 @@ static void iCheckIntersection(size_t a_i,
                                const std::vector<size_t>& a_jSeg,
                                BSHP<std::vector<Pt3d>>& a_shptrPts,
                                double a_xyTol,
-                               MapSegMap& a_mapSegCross,
+                               VecSegCross& a_segCross,
                                BSHP<GmPtSearch> a_ps)
 {
   std::vector<Pt3d>& spts(*a_shptrPts);
-  if (iCheckSharedPtIdx(a_i, a_j, a_iSeg, a_jSeg, spts, a_xyTol, a_mapSegCross))
+  if (iCheckSharedPtIdx(a_i, a_j, a_iSeg, a_jSeg, spts, a_xyTol, a_segCross))
     return;
 
   // first segment
@@ -380,7 +511,7 @@ static void iCheckIntersection(size_t a_i,
       if (1 == t)
       {
         t = iCalcIntersectionT(s2p0, s2p1, pts[i], a_xyTol);
-        iAddIntersection(a_j, a_jSeg, a_iSeg[nexti], t, a_mapSegCross);
+        iAddIntersection(a_j, a_jSeg, a_iSeg[nexti], t, a_segCross);
       }
       // > 0 is here because at some point in our looping we will consider
       // the same location for both t = 0 and 1 if an endpoint of a segment
@@ -391,7 +522,7 @@ static void iCheckIntersection(size_t a_i,
         if (1 == t2 || 0 == t2)
         {
           if (1 == t2)
-            iAddIntersection(a_i, a_iSeg, a_jSeg[nextj], t, a_mapSegCross);
+            iAddIntersection(a_i, a_iSeg, a_jSeg[nextj], t, a_segCross);
           // ignore 0 because we will hit this point when t2 is 1
         }
         else
@@ -408,8 +539,8 @@ static void iCheckIntersection(size_t a_i,
             a_ps->AddPtToVectorIfUnique(pts[i], a_xyTol, idx);
             ptIdx = (size_t)idx;
           }
-          iAddIntersection(a_i, a_iSeg, ptIdx, t, a_mapSegCross);
-          iAddIntersection(a_j, a_jSeg, ptIdx, t2, a_mapSegCross);
+          iAddIntersection(a_i, a_iSeg, ptIdx, t, a_segCross);
+          iAddIntersection(a_j, a_jSeg, ptIdx, t2, a_segCross);
         }
       }
       if (t < 0 || t > 1)
@@ -421,20 +552,22 @@ static void iCheckIntersection(size_t a_i,
 } // iCheckIntersection
 //------------------------------------------------------------------------------
 /// \brief Returns true if a polygon is inside of another polygon
-/// \param a_poly A polygon used to test a_polyToTest
-/// \param a_polyToTest Vector of indices defining a polygon. Want to determine
-/// if it is inside of a_poly.
-/// \param a_pts Vector of locations referenced by a_polyToTest.
-/// \return true if a_polyToTest is inside of a_poly
+/// \param a_poly A polygon used to test the polygon to test
+/// \param a_begin Start of the indices defining the polygon to test. Want to
+/// determine if it is inside of a_poly.
+/// \param a_end End of the indices defining the polygon to test.
+/// \param a_pts Vector of locations referenced by the polygon to test.
+/// \return true if the polygon to test is inside of a_poly
 //------------------------------------------------------------------------------
 static bool iPolyInsideOfPoly(const GmBstPoly3d& a_poly,
-                              const std::vector<size_t>& a_polyToTest,
+                              const size_t* a_begin,
+                              const size_t* a_end,
                               const std::vector<Pt3d>& a_pts)
 {
   bool out = false;
-  for (size_t i = 0; !out && i < a_polyToTest.size(); ++i)
+  for (const size_t* idx = a_begin; !out && idx != a_end; ++idx)
   {
-    const Pt3d& p(a_pts[a_polyToTest[i]]);
+    const Pt3d& p(a_pts[*idx]);
     if (!bg::covered_by(p, a_poly))
       out = true;
   }
@@ -444,98 +577,228 @@ static bool iPolyInsideOfPoly(const GmBstPoly3d& a_poly,
 } // iPolyInsideOfPoly
 //------------------------------------------------------------------------------
 /// \brief Given a list of polygons, finds the polygons that are inside of other
-/// polygons.
-/// \param a_polyInsideOfPoly 2D vector of polygon indexes.
-/// \param a_loops 2D vector of point indexes that define polygons.
+/// polygons. Only polygons whose envelope contains the envelope of the polygon
+/// being tested are checked. These are found with an rtree of the envelopes.
+/// \param a_polyInsideOfPoly 2D vector of polygon indexes. For each polygon
+/// the indexes of the polygons that it is inside of in increasing order.
+/// \param a_loops Point indexes that define polygons.
 /// \param a_polyPts Class with information on locations of points that define
 /// the polygons.
 //------------------------------------------------------------------------------
 static void iFindPolysInsideOfOtherPolys(std::vector<std::vector<size_t>>& a_polyInsideOfPoly,
-                                         std::list<std::vector<size_t>>& a_loops,
+                                         const MePolyLoops& a_loops,
                                          MePolyPts& a_polyPts)
 {
   std::vector<Pt3d>& pts(a_polyPts.Pts());
-  // create set of point indices that make up polygons
-  std::list<std::vector<size_t>>::iterator it, it2;
+  const size_t numLoops(a_loops.Size());
+  a_polyInsideOfPoly.resize(numLoops);
+  if (numLoops < 2)
+    return;
 
-  // determine which polygons are inside of other polygons
-  size_t cnt_it(0);
-  a_polyInsideOfPoly.resize(a_loops.size());
-  for (it = a_loops.begin(); it != a_loops.end(); ++it, ++cnt_it)
+  std::vector<MeLoopEnvelope> envelopes;
+  envelopes.reserve(numLoops);
+  for (size_t i = 0; i < numLoops; ++i)
   {
-    // create polygon for iterator it
-    GmBstPoly3d poly;
-    for (size_t i = 0; i < it->size(); ++i)
+    GmBstBox3d b;
+    b.min_corner() = b.max_corner() = pts[*a_loops.LoopBegin(i)];
+    for (const size_t* idx = a_loops.LoopBegin(i); idx != a_loops.LoopEnd(i); ++idx)
     {
-      bg::exterior_ring(poly).push_back(pts[(*it)[i]]);
+      const Pt3d& p(pts[*idx]);
+      b.min_corner().x = std::min(b.min_corner().x, p.x);
+      b.min_corner().y = std::min(b.min_corner().y, p.y);
+      b.max_corner().x = std::max(b.max_corner().x, p.x);
+      b.max_corner().y = std::max(b.max_corner().y, p.y);
     }
-    bg::exterior_ring(poly).push_back(pts[(*it)[0]]);
+    b.min_corner().z = b.max_corner().z = 0;
+    envelopes.push_back(MeLoopEnvelope(b, i));
+  }
+  MeLoopRtree rtree(envelopes.begin(), envelopes.end());
 
-    size_t cnt_it2(0);
-    for (it2 = a_loops.begin(); it2 != a_loops.end(); ++it2, ++cnt_it2)
+  // polygons are only created for loops that are found to contain the
+  // envelope of another loop
+  std::vector<GmBstPoly3d> polys(numLoops);
+  std::vector<MeLoopEnvelope> found;
+  std::vector<size_t> candidates;
+  for (size_t j = 0; j < numLoops; ++j)
+  {
+    const GmBstBox3d& jBox(envelopes[j].first);
+    found.resize(0);
+    rtree.query(bgi::intersects(jBox), std::back_inserter(found));
+    candidates.resize(0);
+    for (size_t k = 0; k < found.size(); ++k)
     {
-      if (it == it2)
-        continue;
-      if (iPolyInsideOfPoly(poly, *it2, pts))
+      const GmBstBox3d& iBox(found[k].first);
+      if (found[k].second != j && iBox.min_corner().x <= jBox.min_corner().x &&
+          iBox.min_corner().y <= jBox.min_corner().y &&
+          iBox.max_corner().x >= jBox.max_corner().x && iBox.max_corner().y >= jBox.max_corner().y)
       {
-        a_polyInsideOfPoly[cnt_it2].push_back(cnt_it);
+        candidates.push_back(found[k].second);
+      }
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    for (size_t k = 0; k < candidates.size(); ++k)
+    {
+      size_t i(candidates[k]);
+      GmBstPoly3d& poly(polys[i]);
+      if (bg::exterior_ring(poly).empty())
+      {
+        for (const size_t* idx = a_loops.LoopBegin(i); idx != a_loops.LoopEnd(i); ++idx)
+        {
+          bg::exterior_ring(poly).push_back(pts[*idx]);
+        }
+        bg::exterior_ring(poly).push_back(pts[*a_loops.LoopBegin(i)]);
+      }
+      // stops at the first point that is outside so a polygon that does not
+      // contain loop j is usually rejected after testing one point
+      if (iPolyInsideOfPoly(poly, a_loops.LoopBegin(j), a_loops.LoopEnd(j), pts))
+      {
+        a_polyInsideOfPoly[j].push_back(i);
       }
     }
   }
 } // iFindPolysInsideOfOtherPolys
 //------------------------------------------------------------------------------
 /// \brief Calculates polygon areas
-/// \param a_loops 2D vector of point indexes that define polygons.
+/// \param a_loops Point indexes that define polygons.
 /// \param a_pts Locations referred to by indexes in a_loops.
 /// \return vector of areas, one for each polygon
 //------------------------------------------------------------------------------
-static std::vector<double> iCalcPolyAreas(const std::list<std::vector<size_t>>& a_loops,
+static std::vector<double> iCalcPolyAreas(const MePolyLoops& a_loops,
                                           const std::vector<Pt3d>& a_pts)
 {
   std::vector<double> areas;
-  areas.reserve(a_loops.size());
-  std::list<std::vector<size_t>>::const_iterator it(a_loops.begin());
-  for (; it != a_loops.end(); ++it)
+  areas.reserve(a_loops.Size());
+  std::vector<Pt3d> pts;
+  for (size_t i = 0; i < a_loops.Size(); ++i)
   {
-    std::vector<Pt3d> pts(it->size(), Pt3d());
-    for (size_t i = 0; i < it->size(); ++i)
-      pts[i] = a_pts[(*it)[i]];
+    pts.resize(0);
+    for (const size_t* idx = a_loops.LoopBegin(i); idx != a_loops.LoopEnd(i); ++idx)
+      pts.push_back(a_pts[*idx]);
     areas.push_back(gmPolygonArea(&pts[0], (int)pts.size()));
   }
   return areas;
 } // iCalcPolyAreas
 //------------------------------------------------------------------------------
-/// \brief Removes a repeated segment (2 numbers) from a sequence
-/// \param a_sequence List of indexes defining a closed loop polyline.
+/// \brief Removes repeated segments (2 numbers) from a sequence. "a b a"
+/// becomes "a". The sequence is compacted in place in one pass; removing a
+/// repeated segment can expose another one (a b c b a) which is also removed.
+/// \param a_sequence Vector of indexes defining a closed loop polyline.
 //------------------------------------------------------------------------------
-static void iRemoveRepeatedSegmentFromSequence(std::list<size_t>& a_sequence)
+static void iRemoveRepeatedSegmentsFromSequence(std::vector<size_t>& a_sequence)
 {
-  if (a_sequence.size() < 3)
-    return;
-
-  std::list<size_t>::iterator it(a_sequence.begin());
-  std::list<size_t>::iterator back1(it);
-  ++it;
-  std::list<size_t>::iterator back2(back1);
-  ++back1;
-  ++it;
-  std::list<size_t>::iterator itEnd(a_sequence.end());
-  while (it != itEnd && back1 != itEnd && back2 != itEnd)
-  {
-    if (*it == *back2)
-    { // remove it and back1
-      ++it;
-      a_sequence.erase(back1, it);
-      return;
-    }
+  size_t n(0);
+  for (size_t i = 0; i < a_sequence.size(); ++i)
+  {
+    if (n > 1 && a_sequence[n - 2] == a_sequence[i])
+      --n; // drop the previous index and skip this one
     else
-    {
-      ++back2;
-      ++back1;
-      ++it;
-    }
+      a_sequence[n++] = a_sequence[i];
   }
-} // iRemoveRepeatedSegmentFromSequence
+  a_sequence.resize(n);
+} // iRemoveRepeatedSegmentsFromSequence
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MePolyLoops
+/// \brief Closed loop polylines stored in one vector
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief constructor
+//------------------------------------------------------------------------------
+MePolyLoops::MePolyLoops()
+: m_idxs()
+, m_start(1, 0)
+{
+} // MePolyLoops::MePolyLoops
+//------------------------------------------------------------------------------
+/// \brief Returns the number of loops.
+/// \return The number of loops.
+//------------------------------------------------------------------------------
+size_t MePolyLoops::Size() const
+{
+  return m_start.size() - 1;
+} // MePolyLoops::Size
+//------------------------------------------------------------------------------
+/// \brief Returns true if there are no loops.
+/// \return true if there are no loops.
+//------------------------------------------------------------------------------
+bool MePolyLoops::Empty() const
+{
+  return m_start.size() < 2;
+} // MePolyLoops::Empty
+//------------------------------------------------------------------------------
+/// \brief Returns the number of point indexes in a loop.
+/// \param a_loop Index of the loop.
+/// \return The number of point indexes.
+//------------------------------------------------------------------------------
+size_t MePolyLoops::LoopSize(size_t a_loop) const
+{
+  return m_start[a_loop + 1] - m_start[a_loop];
+} // MePolyLoops::LoopSize
+//------------------------------------------------------------------------------
+/// \brief Returns the first point index of a loop.
+/// \param a_loop Index of the loop.
+/// \return Pointer to the first point index.
+//------------------------------------------------------------------------------
+const size_t* MePolyLoops::LoopBegin(size_t a_loop) const
+{
+  return m_idxs.data() + m_start[a_loop];
+} // MePolyLoops::LoopBegin
+//------------------------------------------------------------------------------
+/// \brief Returns one past the last point index of a loop.
+/// \param a_loop Index of the loop.
+/// \return Pointer to one past the last point index.
+//------------------------------------------------------------------------------
+const size_t* MePolyLoops::LoopEnd(size_t a_loop) const
+{
+  return m_idxs.data() + m_start[a_loop + 1];
+} // MePolyLoops::LoopEnd
+//------------------------------------------------------------------------------
+/// \brief Returns a copy of the point indexes of a loop.
+/// \param a_loop Index of the loop.
+/// \return The point indexes.
+//------------------------------------------------------------------------------
+std::vector<size_t> MePolyLoops::Loop(size_t a_loop) const
+{
+  return std::vector<size_t>(LoopBegin(a_loop), LoopEnd(a_loop));
+} // MePolyLoops::Loop
+//------------------------------------------------------------------------------
+/// \brief Removes all of the loops.
+//------------------------------------------------------------------------------
+void MePolyLoops::Clear()
+{
+  m_idxs.resize(0);
+  m_start.assign(1, 0);
+} // MePolyLoops::Clear
+//------------------------------------------------------------------------------
+/// \brief Adds a loop at the end.
+/// \param a_begin Pointer to the first point index of the loop.
+/// \param a_end Pointer to one past the last point index of the loop.
+//------------------------------------------------------------------------------
+void MePolyLoops::Add(const size_t* a_begin, const size_t* a_end)
+{
+  m_idxs.insert(m_idxs.end(), a_begin, a_end);
+  m_start.push_back(m_idxs.size());
+} // MePolyLoops::Add
+//------------------------------------------------------------------------------
+/// \brief Removes loops while keeping the order of the remaining loops.
+/// \param a_keep Flag for each loop. Loops with 0 are removed.
+//------------------------------------------------------------------------------
+void MePolyLoops::Keep(const std::vector<int>& a_keep)
+{
+  size_t nLoops(0), nIdxs(0);
+  for (size_t i = 0; i < Size(); ++i)
+  {
+    if (!a_keep[i])
+      continue;
+    size_t begin(m_start[i]), end(m_start[i + 1]);
+    for (size_t j = begin; j < end; ++j)
+      m_idxs[nIdxs++] = m_idxs[j];
+    m_start[++nLoops] = nIdxs;
+  }
+  m_idxs.resize(nIdxs);
+  m_start.resize(nLoops + 1);
+} // MePolyLoops::Keep
 
 ////////////////////////////////////////////////////////////////////////////////
 /// \class MePolyPts
@@ -601,12 +864,31 @@ std::vector<size_t> MePolyPts::SegmentsForCleanPolyOffset()
   return retSegs;
 } // MpPolyPts::SegmentsForCleanPolyOffset
 //------------------------------------------------------------------------------
+/// \brief Returns the number of segments above which IntersectSegs finds the
+/// overlapping segment envelopes with a grid instead of testing every pair.
+/// \return The number of segments.
+//------------------------------------------------------------------------------
+size_t& MePolyPts::IntersectSegsGridThreshold()
+{
+  return m_p->m_gridThreshold;
+} // MePolyPts::IntersectSegsGridThreshold
+//------------------------------------------------------------------------------
 /// \brief Intersects the segments
 /// \param a_segs Vector of indexes defining segments.
 //------------------------------------------------------------------------------
 void MePolyPts::IntersectSegs(const std::vector<size_t>& a_segs)
 {
   std::vector<GmBstBox3d> envelopes(iCalcSegEnvelopes(a_segs, Pts()));
+  if (a_segs.size() > m_p->m_gridThreshold)
+  {
+    // The pairs are checked in the same order as the loops below so the new
+    // intersection points get the same indexes.
+    std::vector<std::pair<size_t, size_t>> pairs(iOverlappingEnvelopePairs(envelopes));
+    for (size_t k = 0; k < pairs.size(); ++k)
+      CheckIntersectTwoSegs(pairs[k].first, pairs[k].second, a_segs, a_segs);
+    return;
+  }
+
   for (size_t i = 0; i < a_segs.size(); ++i)
   {
     for (size_t j = i + 1; j < a_segs.size(); ++j)
@@ -626,25 +908,26 @@ void MePolyPts::IntersectSegs(const std::vector<size_t>& a_segs)
 /// \param a_segs List of indexes defining a closed loop polyline.
 /// \return a new sequence
 //------------------------------------------------------------------------------
-std::list<size_t> MePolyPts::SequenceWithIntersects(std::vector<size_t>& a_segs)
+std::vector<size_t> MePolyPts::SequenceWithIntersects(std::vector<size_t>& a_segs)
 {
-  std::list<size_t> sequence;
+  // a stable sort keeps intersections at the same location in the order they
+  // were found
+  VecSegCross& segCross(m_p->m_segCross);
+  std::stable_sort(segCross.begin(), segCross.end(), SegCrossLess());
+  SegCross first = {&a_segs, 0, -1, 0};
+  VecSegCross::const_iterator it(
+    std::lower_bound(segCross.begin(), segCross.end(), first, SegCrossLess()));
 
+  std::vector<size_t> sequence;
+  sequence.reserve(a_segs.size() + segCross.size());
   for (size_t i = 0; i < a_segs.size(); ++i)
   {
     sequence.push_back(a_segs[i]);
-
-    SegMap::iterator it = m_p->m_segCross[&a_segs].find(i);
-    if (it == m_p->m_segCross[&a_segs].end())
-      continue;
-
-    std::multimap<double, size_t>::iterator it1(it->second.begin());
-    for (; it1 != it->second.end(); ++it1)
+    for (; it != segCross.end() && it->m_segs == &a_segs && it->m_seg == i; ++it)
     {
-      size_t& pIdx(it1->second);
       // don't add the same point twice (happens in testCase6c)
-      if (sequence.back() != pIdx)
-        sequence.push_back(pIdx);
+      if (sequence.back() != it->m_pt)
+        sequence.push_back(it->m_pt);
     }
   }
   return sequence;
@@ -667,47 +950,45 @@ void MePolyPts::CheckIntersectTwoSegs(size_t a_i,
 } // MpPolyPts::CheckIntersectTwoSegs
 //------------------------------------------------------------------------------
 /// \brief Calculates new loops from a sequence that has intersections included
-/// \param a_sequence List of indexes defining a closed loop polyline. If the
+/// \param a_sequence Vector of indexes defining a closed loop polyline. If the
 /// polyline intersects with itself then multiple loops are extracted from
 /// the polyline.
-/// \param a_loops List of vector of indexes defining a closed loop polyline.
-/// These are extracted from a_sequence
+/// \param a_loops Indexes defining closed loop polylines. These are
+/// extracted from a_sequence
 //------------------------------------------------------------------------------
-void MePolyPts::CalcLoopsForCleanPolyOffset(std::list<size_t>& a_sequence,
-                                            std::list<std::vector<size_t>>& a_loops)
+void MePolyPts::CalcLoopsForCleanPolyOffset(std::vector<size_t>& a_sequence,
+                                            MePolyLoops& a_loops)
 {
+  // position of the first occurrence of each point index in the sequence
+  const size_t NOT_FOUND(std::numeric_limits<size_t>::max());
+  std::vector<size_t> firstPos;
   while (!a_sequence.empty())
   {
-    // keep doing this until we don't find any more
-    size_t sSize(0);
-    while (sSize != a_sequence.size())
+    iRemoveRepeatedSegmentsFromSequence(a_sequence);
+
+    size_t pos(0), loopStart(NOT_FOUND);
+    for (; loopStart == NOT_FOUND && pos < a_sequence.size(); ++pos)
     {
-      sSize = a_sequence.size();
-      iRemoveRepeatedSegmentFromSequence(a_sequence);
+      size_t ptIdx(a_sequence[pos]);
+      if (ptIdx >= firstPos.size())
+        firstPos.resize(ptIdx + 1, NOT_FOUND);
+      if (firstPos[ptIdx] == NOT_FOUND)
+        firstPos[ptIdx] = pos;
+      else
+        loopStart = firstPos[ptIdx];
     }
+    for (size_t i = 0; i < pos; ++i)
+      firstPos[a_sequence[i]] = NOT_FOUND;
 
-    std::map<size_t, std::list<size_t>::iterator> mapPidxItr;
-    std::map<size_t, std::list<size_t>::iterator>::iterator it1;
-    std::list<size_t>::iterator it(a_sequence.begin());
-    bool loopfound = false;
-    for (; !loopfound && it != a_sequence.end(); ++it)
+    if (loopStart != NOT_FOUND)
     {
-      size_t& ptIdx(*it);
-      it1 = mapPidxItr.find(ptIdx);
-      if (it1 == mapPidxItr.end())
-      {
-        mapPidxItr[ptIdx] = it;
-      }
-      else
-      {
-        a_loops.push_back(std::vector<size_t>(it1->second, it));
-        a_sequence.erase(it1->second, it);
-        loopfound = true;
-      }
+      size_t* seq(a_sequence.data());
+      a_loops.Add(seq + loopStart, seq + pos - 1);
+      a_sequence.erase(a_sequence.begin() + loopStart, a_sequence.begin() + pos - 1);
     }
-    if (!loopfound)
+    else
     {
-      a_loops.push_back(std::vector<size_t>(a_sequence.begin(), a_sequence.end()));
+      a_loops.Add(a_sequence.data(), a_sequence.data() + a_sequence.size());
       a_sequence.clear();
     }
   }
@@ -715,27 +996,21 @@ void MePolyPts::CalcLoopsForCleanPolyOffset(std::list<size_t>& a_sequence,
 //------------------------------------------------------------------------------
 /// \brief Removes loops that are "backwards" for CleanPolyOffset. "backwards"
 /// depends on the type of input (OUTSIDE_POLY or INSIDE_POLY)
-/// \param a_loops List of vector of indexes defining a closed loop polyline.
+/// \param a_loops Indexes defining closed loop polylines.
 /// \param a_pType Type of polygon that was offset either OUTSIDE_POLY or
 /// INSIDE_POLY.
 //------------------------------------------------------------------------------
-void MePolyPts::RemoveBackwardLoopsForCleanPolyOffset(std::list<std::vector<size_t>>& a_loops,
-                                                      int a_pType)
+void MePolyPts::RemoveBackwardLoopsForCleanPolyOffset(MePolyLoops& a_loops, int a_pType)
 {
   std::vector<double> areas(iCalcPolyAreas(a_loops, Pts()));
-  int cnt(0), out(MePolyOffsetter::OUTSIDE_POLY), in(MePolyOffsetter::INSIDE_POLY);
-  std::list<std::vector<size_t>>::iterator it(a_loops.begin()), next;
-  while (it != a_loops.end())
+  int out(MePolyOffsetter::OUTSIDE_POLY), in(MePolyOffsetter::INSIDE_POLY);
+  std::vector<int> keep(areas.size(), 1);
+  for (size_t i = 0; i < areas.size(); ++i)
   {
-    next = it;
-    ++next;
-    if ((a_pType == out && areas[cnt] > 0) || (a_pType == in && areas[cnt] < 0))
-    {
-      a_loops.erase(it);
-    }
-    it = next;
-    cnt++;
+    if ((a_pType == out && areas[i] > 0) || (a_pType == in && areas[i] < 0))
+      keep[i] = 0;
   }
+  a_loops.Keep(keep);
 } // MpPolyPts::RemoveBackwardLoopsForCleanPolyOffset
 //------------------------------------------------------------------------------
 /// \brief Classifies loops extracted from a pave on an INSIDE_POLY and removes
@@ -744,13 +1019,13 @@ void MePolyPts::RemoveBackwardLoopsForCleanPolyOffset(std::list<std::vector<size
 /// we then pave inward on the next step in the algorithm. See testCase8. You
 /// can also generate "inside" polygons that are inside of other "inside"
 /// polygons. These are deleted. Again see testCase8.
-/// \param a_loops List of vector of indexes defining a closed loop polyline.
+/// \param a_loops Indexes defining closed loop polylines.
 /// \param a_loopType Type of polygon defined in a_loops.
 //------------------------------------------------------------------------------
-void MePolyPts::ClassifyLoopsFromInPolyAndRemoveInvalid(std::list<std::vector<size_t>>& a_loops,
+void MePolyPts::ClassifyLoopsFromInPolyAndRemoveInvalid(MePolyLoops& a_loops,
                                                         std::vector<int>& a_loopType)
 {
-  std::vector<std::vector<size_t>> polyInsideOfPoly(a_loops.size());
+  std::vector<std::vector<size_t>> polyInsideOfPoly(a_loops.Size());
   iFindPolysInsideOfOtherPolys(polyInsideOfPoly, a_loops, *this);
 
   std::vector<double> areas(iCalcPolyAreas(a_loops, Pts()));
@@ -763,8 +1038,7 @@ void MePolyPts::ClassifyLoopsFromInPolyAndRemoveInvalid(std::list<std::vector<si
   // if a polygon is not inside of another polygon then just check its area
   // to see if we should remove it
   size_t cnt_it(0);
-  std::list<std::vector<size_t>>::iterator it(a_loops.begin()), next;
-  for (; it != a_loops.end(); ++it, ++cnt_it)
+  for (; cnt_it < a_loops.Size(); ++cnt_it)
   {
     if (polyInsideOfPoly[cnt_it].empty()) {}
     else if (!polyInsideOfPoly[cnt_it].empty())
@@ -782,15 +1056,9 @@ void MePolyPts::ClassifyLoopsFromInPolyAndRemoveInvalid(std::list<std::vector<si
     //}
   }
 
-  for (it = a_loops.begin(), cnt_it = 0; it != a_loops.end(); it = next, ++cnt_it)
+  for (cnt_it = 0; cnt_it < a_loops.Size(); ++cnt_it)
   {
-    next = it;
-    ++next;
-    if (!validPoly[cnt_it])
-    {
-      a_loops.erase(it);
-    }
-    else
+    if (validPoly[cnt_it])
     {
       int type(MePolyOffsetter::INSIDE_POLY); // INSIDE_POLY
       if (areas[cnt_it] < 0)
@@ -798,6 +1066,7 @@ void MePolyPts::ClassifyLoopsFromInPolyAndRemoveInvalid(std::list<std::vector<si
       a_loopType.push_back(type);
     }
   }
+  a_loops.Keep(validPoly);
 } // MpPolyPts::ClassifyLoopsFromInPolyAndRemoveInvalid
 //------------------------------------------------------------------------------
 /// \brief Returns true if a_polyToTest is inside of a_poly
@@ -817,7 +1086,8 @@ bool MePolyPts::PolyInsideOfPoly(const std::vector<size_t>& a_poly,
   }
   bg::exterior_ring(poly).push_back(pts[a_poly[0]]);
 
-  return iPolyInsideOfPoly(poly, a_polyToTest, pts);
+  return iPolyInsideOfPoly(poly, a_polyToTest.data(), a_polyToTest.data() + a_polyToTest.size(),
+                           pts);
 } // MePolyPts::PolyInsideOfPoly
 //------------------------------------------------------------------------------
 /// \brief Returns true if a_polyToTest is inside of a_poly
@@ -836,7 +1106,8 @@ bool MePolyPts::PolyInsideOfPoly(const std::vector<Pt3d>& a_poly,
     bg::exterior_ring(poly).push_back(a_poly[i]);
   }
   std::vector<Pt3d>& pts(Pts());
-  return iPolyInsideOfPoly(poly, a_polyToTest, pts);
+  return iPolyInsideOfPoly(poly, a_polyToTest.data(), a_polyToTest.data() + a_polyToTest.size(),
+                           pts);
 } // MePolyPts::PolyInsideOfPoly
 //------------------------------------------------------------------------------
 /// \brief Returns the index of a location by hashing that location with the
@@ -7,7 +7,6 @@
 #pragma once
 
 //----- Included files ---------------------------------------------------------
-#include <list>
 #include <set>
 #include <vector>
 #include <xmscore/points/pt.h>
@@ -24,6 +23,27 @@ typedef std::set<size_t> SetIdx; ///< typedef for shorter declaration
 //----- Constants / Enumerations -----------------------------------------------
 
 //----- Structs / Classes ------------------------------------------------------
+/// \brief Closed loop polylines stored one after the other in a single vector
+/// of point indexes so that extracting loops does not allocate each loop.
+class MePolyLoops
+{
+public:
+  MePolyLoops();
+
+  size_t Size() const;
+  bool Empty() const;
+  size_t LoopSize(size_t a_loop) const;
+  const size_t* LoopBegin(size_t a_loop) const;
+  const size_t* LoopEnd(size_t a_loop) const;
+  std::vector<size_t> Loop(size_t a_loop) const;
+  void Clear();
+  void Add(const size_t* a_begin, const size_t* a_end);
+  void Keep(const std::vector<int>& a_keep);
+
+  std::vector<size_t> m_idxs;  ///< point indexes of all of the loops
+  std::vector<size_t> m_start; ///< start of each loop in m_idxs plus the end
+};
+
 /// \brief Utility class to work with polygon paving
 class MePolyPts
 {
@@ -37,17 +57,16 @@ public:
 
   std::vector<size_t> HashPts();
   std::vector<size_t> SegmentsForCleanPolyOffset();
+  size_t& IntersectSegsGridThreshold();
   void IntersectSegs(const std::vector<size_t>& a_segs);
-  std::list<size_t> SequenceWithIntersects(std::vector<size_t>& a_segs);
+  std::vector<size_t> SequenceWithIntersects(std::vector<size_t>& a_segs);
   void CheckIntersectTwoSegs(size_t a_i,
                              size_t a_j,
                              const std::vector<size_t>& a_iSeg,
                              const std::vector<size_t>& a_jSeg);
-  void CalcLoopsForCleanPolyOffset(std::list<size_t>& a_sequence,
-                                   std::list<std::vector<size_t>>& a_loops);
-  void RemoveBackwardLoopsForCleanPolyOffset(std::list<std::vector<size_t>>& a_loops, int a_pType);
-  void ClassifyLoopsFromInPolyAndRemoveInvalid(std::list<std::vector<size_t>>& a_loops,
-                                               std::vector<int>& a_loopType);
+  void CalcLoopsForCleanPolyOffset(std::vector<size_t>& a_sequence, MePolyLoops& a_loops);
+  void RemoveBackwardLoopsForCleanPolyOffset(MePolyLoops& a_loops, int a_pType);
+  void ClassifyLoopsFromInPolyAndRemoveInvalid(MePolyLoops& a_loops, std::vector<int>& a_loopType);
 
   bool PolyInsideOfPoly(const std::vector<size_t>& a_poly, const std::vector<size_t>& a_polyToTest);
   bool PolyInsideOfPoly(const std::vector<Pt3d>& a_poly, const std::vector<size_t>& a_polyToTest);
@@ -0,0 +1,446 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup meshing_detail
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/meshing/detail/MePolySizeTree.h>
+
+// 3. Standard library headers
+#include <algorithm>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/misc/XmError.h>
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+namespace
+{
+const size_t LEAF_SIZE = 16;     ///< max number of points in a leaf node
+const int MAX_STACK = 128;       ///< max depth of the traversal stack
+const double NEAR_DIST_SQ = 1e-7; ///< points closer than this get NEAR_WT
+const double NEAR_WT = 1e11;      ///< weight of a point at the query location
+/// relative error of Interp from the approximated nodes divided by the largest
+/// (node size / distance)^2 of them. 3 for each sum and both sums may be off.
+const double ERR_FACTOR = 6.0;
+} // unnamed namespace
+
+//----- Classes / Structs ------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+class MePolySizeTreeImpl : public MePolySizeTree
+{
+public:
+  MePolySizeTreeImpl();
+  virtual ~MePolySizeTreeImpl();
+
+  virtual void SetPts(const VecPt3d& a_pts,
+                      const VecDbl& a_values,
+                      const VecDbl& a_weights,
+                      double a_tol) override;
+  virtual double Interp(const Pt3d& a_pt) const override;
+
+  /// \brief A node of the tree. The points of the node are contiguous in the
+  /// point arrays.
+  struct Node
+  {
+    size_t m_begin;  ///< index of first point
+    size_t m_end;    ///< index one past the last point
+    int m_child[2];  ///< child nodes. -1 if this is a leaf
+    double m_xMin;   ///< min x of the points
+    double m_yMin;   ///< min y of the points
+    double m_xMax;   ///< max x of the points
+    double m_yMax;   ///< max y of the points
+    double m_diagSq; ///< squared diagonal of the bounding box
+    double m_w;      ///< sum of the weights
+    double m_wv;     ///< sum of the weights times the values
+    double m_wX;     ///< x of the weighted centroid
+    double m_wY;     ///< y of the weighted centroid
+    double m_wvX;    ///< x of the centroid weighted by weight times value
+    double m_wvY;    ///< y of the centroid weighted by weight times value
+  };
+
+  int BuildNode(size_t a_begin, size_t a_end, const VecPt3d& a_pts, VecSizet& a_order);
+
+  std::vector<Node> m_nodes; ///< the nodes. The root is node 0
+  VecDbl m_x;                ///< x of the points in tree order
+  VecDbl m_y;                ///< y of the points in tree order
+  VecDbl m_w;                ///< weight of the points in tree order
+  VecDbl m_v;                ///< value of the points in tree order
+  double m_tol;              ///< bound on the relative error of Interp
+}; // class MePolySizeTreeImpl
+
+//----- Internal functions -----------------------------------------------------
+
+//----- Class / Function definitions -------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MePolySizeTreeImpl
+/// \brief Fast approximate inverse distance weighted interpolation of the
+/// edge lengths of a polygon.
+///
+/// MePolyRedistributePts interpolates a size at a location from all of the
+/// points on the polygon boundary using the weight w_i / d_i^2 where d_i is
+/// the distance to the boundary point. Doing this exactly is proportional to
+/// the number of boundary points for every location. This class puts the
+/// points in a k-d tree and, like a Barnes-Hut tree code, replaces the points
+/// of a node that is far enough away with a single point at the weighted
+/// centroid of the node. The first order error terms cancel at the centroid
+/// so the relative error of each approximated node is about
+/// 3 * (node size / distance)^2. The error of the sum of the weights and of
+/// the sum of the weights times the values can add so a node is only
+/// approximated when 6 * (node size / distance)^2 is less than the tolerance.
+/// This keeps the relative error of the interpolated value below the
+/// tolerance. Nearby nodes are always computed exactly.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Constructor
+//------------------------------------------------------------------------------
+MePolySizeTreeImpl::MePolySizeTreeImpl()
+: m_nodes()
+, m_x()
+, m_y()
+, m_w()
+, m_v()
+, m_tol(0.0)
+{
+} // MePolySizeTreeImpl::MePolySizeTreeImpl
+//------------------------------------------------------------------------------
+/// \brief Destructor
+//------------------------------------------------------------------------------
+MePolySizeTreeImpl::~MePolySizeTreeImpl()
+{
+} // MePolySizeTreeImpl::~MePolySizeTreeImpl
+//------------------------------------------------------------------------------
+/// \brief Builds the tree.
+/// \param[in] a_pts: Locations of the points.
+/// \param[in] a_values: Value at each point.
+/// \param[in] a_weights: Weight of each point. Must be positive.
+/// \param[in] a_tol: Bound on the relative error of Interp. 0 means exact.
+//------------------------------------------------------------------------------
+void MePolySizeTreeImpl::SetPts(const VecPt3d& a_pts,
+                                const VecDbl& a_values,
+                                const VecDbl& a_weights,
+                                double a_tol)
+{
+  XM_ENSURE_TRUE_VOID(a_pts.size() == a_values.size() && a_pts.size() == a_weights.size());
+  m_tol = a_tol;
+  m_nodes.clear();
+  m_x.resize(a_pts.size());
+  m_y.resize(a_pts.size());
+  m_w.resize(a_pts.size());
+  m_v.resize(a_pts.size());
+  if (a_pts.empty())
+    return;
+
+  VecSizet order(a_pts.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  m_nodes.reserve(2 * (a_pts.size() / LEAF_SIZE + 1));
+  BuildNode(0, order.size(), a_pts, order);
+
+  for (size_t i = 0; i < order.size(); ++i)
+  {
+    m_x[i] = a_pts[order[i]].x;
+    m_y[i] = a_pts[order[i]].y;
+    m_w[i] = a_weights[order[i]];
+    m_v[i] = a_values[order[i]];
+  }
+
+  // sums and centroids, children before parents
+  for (size_t n = m_nodes.size(); n-- > 0;)
+  {
+    Node& node(m_nodes[n]);
+    node.m_w = node.m_wv = node.m_wX = node.m_wY = node.m_wvX = node.m_wvY = 0.0;
+    for (size_t i = node.m_begin; i < node.m_end; ++i)
+    {
+      double wv = m_w[i] * m_v[i];
+      node.m_w += m_w[i];
+      node.m_wv += wv;
+      node.m_wX += m_w[i] * m_x[i];
+      node.m_wY += m_w[i] * m_y[i];
+      node.m_wvX += wv * m_x[i];
+      node.m_wvY += wv * m_y[i];
+    }
+    if (node.m_w != 0.0)
+    {
+      node.m_wX /= node.m_w;
+      node.m_wY /= node.m_w;
+    }
+    if (node.m_wv != 0.0)
+    {
+      node.m_wvX /= node.m_wv;
+      node.m_wvY /= node.m_wv;
+    }
+  }
+} // MePolySizeTreeImpl::SetPts
+//------------------------------------------------------------------------------
+/// \brief Builds a node and its children by splitting the longer side of the
+/// bounding box at the median point.
+/// \param[in] a_begin: Index in a_order of the first point of the node.
+/// \param[in] a_end: Index in a_order one past the last point of the node.
+/// \param[in] a_pts: Locations of the points.
+/// \param[in,out] a_order: Point indices. Reordered so the points of each
+/// node are contiguous.
+/// \return The index of the node.
+//------------------------------------------------------------------------------
+int MePolySizeTreeImpl::BuildNode(size_t a_begin,
+                                  size_t a_end,
+                                  const VecPt3d& a_pts,
+                                  VecSizet& a_order)
+{
+  int idx = (int)m_nodes.size();
+  m_nodes.push_back(Node());
+  Node node;
+  node.m_begin = a_begin;
+  node.m_end = a_end;
+  node.m_child[0] = node.m_child[1] = -1;
+  const Pt3d& p0(a_pts[a_order[a_begin]]);
+  node.m_xMin = node.m_xMax = p0.x;
+  node.m_yMin = node.m_yMax = p0.y;
+  for (size_t i = a_begin + 1; i < a_end; ++i)
+  {
+    const Pt3d& p(a_pts[a_order[i]]);
+    node.m_xMin = std::min(node.m_xMin, p.x);
+    node.m_xMax = std::max(node.m_xMax, p.x);
+    node.m_yMin = std::min(node.m_yMin, p.y);
+    node.m_yMax = std::max(node.m_yMax, p.y);
+  }
+  double dx = node.m_xMax - node.m_xMin, dy = node.m_yMax - node.m_yMin;
+  node.m_diagSq = dx * dx + dy * dy;
+
+  if (a_end - a_begin > LEAF_SIZE)
+  {
+    size_t mid = (a_begin + a_end) / 2;
+    bool splitX = dx >= dy;
+    std::nth_element(a_order.begin() + a_begin, a_order.begin() + mid, a_order.begin() + a_end,
+                     [&](size_t a, size_t b) {
+                       return splitX ? a_pts[a].x < a_pts[b].x : a_pts[a].y < a_pts[b].y;
+                     });
+    node.m_child[0] = BuildNode(a_begin, mid, a_pts, a_order);
+    node.m_child[1] = BuildNode(mid, a_end, a_pts, a_order);
+  }
+  m_nodes[idx] = node;
+  return idx;
+} // MePolySizeTreeImpl::BuildNode
+//------------------------------------------------------------------------------
+/// \brief Interpolates to a location. The result is the sum of value times
+/// weight / distance squared divided by the sum of weight / distance squared.
+/// \param[in] a_pt: The location.
+/// \return The interpolated value.
+//------------------------------------------------------------------------------
+double MePolySizeTreeImpl::Interp(const Pt3d& a_pt) const
+{
+  if (m_nodes.empty())
+    return 0.0;
+
+  double sumW(0), sumWv(0);
+  int stack[MAX_STACK];
+  int top = 0;
+  stack[top++] = 0;
+  while (top > 0)
+  {
+    const Node& node(m_nodes[stack[--top]]);
+    bool leaf = node.m_child[0] == -1;
+    if (!leaf)
+    {
+      double dx = std::max(std::max(node.m_xMin - a_pt.x, a_pt.x - node.m_xMax), 0.0);
+      double dy = std::max(std::max(node.m_yMin - a_pt.y, a_pt.y - node.m_yMax), 0.0);
+      double boxDistSq = dx * dx + dy * dy;
+      if (boxDistSq >= NEAR_DIST_SQ && ERR_FACTOR * node.m_diagSq < m_tol * boxDistSq)
+      {
+        // far enough away to use the centroids
+        dx = a_pt.x - node.m_wX;
+        dy = a_pt.y - node.m_wY;
+        sumW += node.m_w / (dx * dx + dy * dy);
+        dx = a_pt.x - node.m_wvX;
+        dy = a_pt.y - node.m_wvY;
+        sumWv += node.m_wv / (dx * dx + dy * dy);
+      }
+      else if (top + 2 <= MAX_STACK)
+      {
+        stack[top++] = node.m_child[1];
+        stack[top++] = node.m_child[0];
+      }
+      else
+      {
+        leaf = true;
+      }
+    }
+    if (leaf)
+    {
+      for (size_t i = node.m_begin; i < node.m_end; ++i)
+      {
+        double dx = a_pt.x - m_x[i], dy = a_pt.y - m_y[i];
+        double d2 = dx * dx + dy * dy;
+        double wt = (d2 < NEAR_DIST_SQ ? NEAR_WT : 1 / d2) * m_w[i];
+        sumW += wt;
+        sumWv += wt * m_v[i];
+      }
+    }
+  }
+  return sumW != 0.0 ? sumWv / sumW : 0.0;
+} // MePolySizeTreeImpl::Interp
+//------------------------------------------------------------------------------
+/// \brief Creates an instance of this class
+/// \return MePolySizeTree.
+//------------------------------------------------------------------------------
+BSHP<MePolySizeTree> MePolySizeTree::New()
+{
+  BSHP<MePolySizeTree> ret(new MePolySizeTreeImpl);
+  return ret;
+} // MePolySizeTree::New
+//------------------------------------------------------------------------------
+/// \brief Constructor
+//------------------------------------------------------------------------------
+MePolySizeTree::MePolySizeTree()
+{
+} // MePolySizeTree::MePolySizeTree
+//------------------------------------------------------------------------------
+/// \brief Destructor
+//------------------------------------------------------------------------------
+MePolySizeTree::~MePolySizeTree()
+{
+} // MePolySizeTree::~MePolySizeTree
+
+} // namespace xms
+
+#if CXX_TEST
+////////////////////////////////////////////////////////////////////////////////
+// UNIT TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+#include <xmsmesh/meshing/detail/MePolySizeTree.t.h>
+
+#include <cmath>
+
+#include <xmscore/math/math.h>
+#include <xmscore/testing/TestTools.h>
+
+//----- Namespace declaration --------------------------------------------------
+
+// namespace xms {
+using namespace xms;
+
+namespace
+{
+//------------------------------------------------------------------------------
+/// \brief Exact inverse distance weighted interpolation used to check the tree
+/// \param[in] a_pt: The location.
+/// \param[in] a_pts: Locations of the points.
+/// \param[in] a_values: Value at each point.
+/// \param[in] a_weights: Weight of each point.
+/// \return The interpolated value.
+//------------------------------------------------------------------------------
+double iExactInterp(const Pt3d& a_pt,
+                    const VecPt3d& a_pts,
+                    const VecDbl& a_values,
+                    const VecDbl& a_weights)
+{
+  double sumW(0), sumWv(0);
+  for (size_t i = 0; i < a_pts.size(); ++i)
+  {
+    double dx = a_pt.x - a_pts[i].x, dy = a_pt.y - a_pts[i].y;
+    double d2 = dx * dx + dy * dy;
+    double wt = (d2 < 1e-7 ? 1e11 : 1 / d2) * a_weights[i];
+    sumW += wt;
+    sumWv += wt * a_values[i];
+  }
+  return sumWv / sumW;
+} // iExactInterp
+//------------------------------------------------------------------------------
+/// \brief Makes points on a wavy circle with values that vary around it.
+/// \param[in] a_numPts: The number of points.
+/// \param[out] a_pts: Locations of the points.
+/// \param[out] a_values: Value at each point.
+/// \param[out] a_weights: Weight of each point.
+//------------------------------------------------------------------------------
+void iWavyCircle(size_t a_numPts, VecPt3d& a_pts, VecDbl& a_values, VecDbl& a_weights)
+{
+  a_pts.clear();
+  a_values.clear();
+  a_weights.clear();
+  for (size_t i = 0; i < a_numPts; ++i)
+  {
+    double a = 2 * XM_PI * i / a_numPts;
+    double r = 100 + 10 * sin(7 * a);
+    a_pts.push_back(Pt3d(r * cos(a), r * sin(a), 0));
+    a_values.push_back(2 + sin(3 * a));
+    a_weights.push_back(1 + 0.5 * cos(5 * a));
+  }
+} // iWavyCircle
+} // unnamed namespace
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MePolySizeTreeUnitTests
+/// \brief Tests for MePolySizeTree.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief tests that a tolerance of 0 gives the exact interpolation
+//------------------------------------------------------------------------------
+void MePolySizeTreeUnitTests::testExact()
+{
+  VecPt3d pts;
+  VecDbl values, weights;
+  iWavyCircle(1000, pts, values, weights);
+  BSHP<MePolySizeTree> tree = MePolySizeTree::New();
+  tree->SetPts(pts, values, weights, 0.0);
+
+  VecPt3d queries = {{0, 0, 0}, {50, 20, 0}, {-90, 5, 0}, pts[17], {300, 300, 0}};
+  for (size_t i = 0; i < queries.size(); ++i)
+  {
+    double expected = iExactInterp(queries[i], pts, values, weights);
+    TS_ASSERT_DELTA(expected, tree->Interp(queries[i]), 1e-10);
+  }
+  // at a point the value of the point is returned
+  TS_ASSERT_DELTA(values[17], tree->Interp(pts[17]), 1e-6);
+} // MePolySizeTreeUnitTests::testExact
+//------------------------------------------------------------------------------
+/// \brief tests that the approximation is within the tolerance
+//------------------------------------------------------------------------------
+void MePolySizeTreeUnitTests::testApproximate()
+{
+  VecPt3d pts;
+  VecDbl values, weights;
+  iWavyCircle(5000, pts, values, weights);
+  const double tols[] = {1e-2, 1e-3, 1e-4};
+  for (double tol : tols)
+  {
+    BSHP<MePolySizeTree> tree = MePolySizeTree::New();
+    tree->SetPts(pts, values, weights, tol);
+
+    double maxRelErr = 0;
+    for (int i = -9; i <= 9; ++i)
+    {
+      for (int j = -9; j <= 9; ++j)
+      {
+        Pt3d q(10.0 * i, 10.0 * j, 0);
+        double expected = iExactInterp(q, pts, values, weights);
+        double err = fabs(tree->Interp(q) - expected) / expected;
+        maxRelErr = std::max(maxRelErr, err);
+      }
+    }
+    TS_ASSERT(maxRelErr < tol);
+  }
+} // MePolySizeTreeUnitTests::testApproximate
+
+//} // namespace xms
+
+#endif // CXX_TEST
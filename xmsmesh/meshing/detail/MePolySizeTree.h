@@ -0,0 +1,49 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup meshing_detail
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 3. Standard library headers
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/points/pt.h>
+#include <xmscore/stl/vector.h>
+#include <xmscore/misc/base_macros.h> // for XM_DISALLOW_COPY_AND_ASSIGN
+#include <xmscore/misc/boost_defines.h>
+
+//----- Forward declarations ---------------------------------------------------
+
+namespace xms
+{
+//----- Forward declarations ---------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+class MePolySizeTree
+{
+public:
+  static BSHP<MePolySizeTree> New();
+
+  /// \cond
+  virtual void SetPts(const VecPt3d& a_pts,
+                      const VecDbl& a_values,
+                      const VecDbl& a_weights,
+                      double a_tol) = 0;
+  virtual double Interp(const Pt3d& a_pt) const = 0;
+  /// \endcond
+
+protected:
+  MePolySizeTree();
+  virtual ~MePolySizeTree();
+
+private:
+  XM_DISALLOW_COPY_AND_ASSIGN(MePolySizeTree)
+}; // MePolySizeTree
+
+} // namespace xms
@@ -13,8 +13,10 @@
 #include <xmsmesh/meshing/detail/MeQuadBlossom.h>
 
 // 3. Standard library headers
+#include <algorithm>
 #include <cmath>
 #include <numeric>
+#include <utility>
 
 // 4. External library headers
 
@@ -24,6 +26,7 @@
 #include <xmsgrid/ugrid/XmEdge.h>
 #include <xmsgrid/ugrid/XmUGrid.h>
 #include <xmsinterp/geometry/geoms.h>
+#include <xmsmesh/meshing/detail/MeParallel.h>
 #include <xmsmesh/meshing/detail/MeWeightMatcher.h>
 
 // 6. Non-shared code headers
@@ -99,19 +102,31 @@ class MeQuadBlossomImpl : public MeQuadBlossom
 {
 public:
   MeQuadBlossomImpl(const VecPt3d& a_points, const VecInt2d& a_triangles);
+  MeQuadBlossomImpl(VecPt3d&& a_points, VecInt2d&& a_triangles);
 
   virtual int PreMakeQuads() override;
   virtual BSHP<XmUGrid> MakeQuads(bool a_splitBoundaryPoints,
                                   bool a_useAngle) override;
+  virtual void MakeQuads(bool a_splitBoundaryPoints,
+                         bool a_useAngle,
+                         VecPt3d& a_points,
+                         VecInt2d& a_faces) override;
+  virtual void SetNumSubdomains(int a_numSubdomains) override;
+  virtual void SetNumThreads(int a_numThreads) override;
+  virtual void SetApproximateMatching(bool a_approximate) override;
+  virtual void GetMatchingWeight(double& a_weight, double& a_upperBound) const override;
 
   virtual BSHP<XmUGrid> _MakeQuads(bool a_splitBoundaryPoints = true,
                                    bool a_useAngle = false,
                                    int cost = -10);
+  void MakeQuadFaces(bool a_splitBoundaryPoints, bool a_useAngle, int a_cost = -10);
   const VecPt3d& GetLocations() const;
 
   void PrepareForMatch(int a_cost,
                        bool a_useAngle);
   VecInt MatchTriangles(bool a_splitBoundaryPoints);
+  VecInt MatchSubdomains(bool a_maxCardinality);
+  void PartitionFaces(int a_numParts, VecInt& a_parts);
   void GetEdges(int a_cost);
   void ProcessPointChains(int a_p,
                           VecVecCellData& a_chains,
@@ -147,6 +162,11 @@ public:
   /// of the two extra edge faces.
   /// { p, face0_prior, face0_next, face1_prior, face1_next }
   VecInt2d m_extraPoints;
+  int m_numSubdomains; ///< Number of subdomains matched on their own.
+  int m_numThreads;    ///< Number of threads used to match the subdomains.
+  bool m_approximateMatching;  ///< Use MeWeightMatcher::NewApproximate.
+  double m_matchingWeight;     ///< Total weight of the last matching.
+  double m_matchingUpperBound; ///< Upper bound of the weight of the last matching.
 }; // class MeQuadBlossomImpl
 
 /// An adjacent point and midpoint pair.
@@ -163,6 +183,56 @@ typedef std::vector<VecAdjPointMidpoint> VecVecAdjPointMidpoint;
 
 //----- Class / Function definitions -------------------------------------------
 
+//------------------------------------------------------------------------------
+/// \brief Splits faces into parts of nearly equal size by cutting the
+/// bounding box of the face centroids across its longer side.
+/// \param[in] a_begin The first of the faces to split.
+/// \param[in] a_end One past the last of the faces to split.
+/// \param[in] a_centroids The centroid of each face.
+/// \param[in] a_firstPart The part given to the first group of faces.
+/// \param[in] a_numParts The number of parts to split the faces into.
+/// \param[out] a_parts The part of each face.
+//------------------------------------------------------------------------------
+void BisectFaces(VecInt::iterator a_begin,
+                 VecInt::iterator a_end,
+                 const VecPt3d& a_centroids,
+                 int a_firstPart,
+                 int a_numParts,
+                 VecInt& a_parts)
+{
+  if (a_numParts == 1 || a_begin == a_end)
+  {
+    for (auto it = a_begin; it != a_end; ++it)
+    {
+      a_parts[*it] = a_firstPart;
+    }
+    return;
+  }
+
+  Pt3d boxMin = a_centroids[*a_begin];
+  Pt3d boxMax = boxMin;
+  for (auto it = a_begin; it != a_end; ++it)
+  {
+    const Pt3d& p = a_centroids[*it];
+    boxMin.x = std::min(boxMin.x, p.x);
+    boxMin.y = std::min(boxMin.y, p.y);
+    boxMax.x = std::max(boxMax.x, p.x);
+    boxMax.y = std::max(boxMax.y, p.y);
+  }
+  int axis = boxMax.x - boxMin.x >= boxMax.y - boxMin.y ? 0 : 1;
+
+  // ties are broken by face index so the parts do not depend on the sort
+  int firstParts = a_numParts / 2;
+  auto middle = a_begin + (a_end - a_begin) * firstParts / a_numParts;
+  std::nth_element(a_begin, middle, a_end, [&](int a_lhs, int a_rhs) {
+    double lhs = a_centroids[a_lhs][axis];
+    double rhs = a_centroids[a_rhs][axis];
+    return lhs < rhs || (lhs == rhs && a_lhs < a_rhs);
+  });
+  BisectFaces(a_begin, middle, a_centroids, a_firstPart, firstParts, a_parts);
+  BisectFaces(middle, a_end, a_centroids, a_firstPart + firstParts, a_numParts - firstParts,
+              a_parts);
+} // BisectFaces
 //------------------------------------------------------------------------------
 /// \brief Converts the 3 edge 2D cells of a UGrid into a 2D vector.
 /// \param[in] a_ugrid The UGrid to convert.
@@ -384,6 +454,27 @@ int FindMidpoint(const VecVecAdjPointMidpoint& a_edgeMidsides, int a_idx0, int a
 MeQuadBlossomImpl::MeQuadBlossomImpl(const VecPt3d& a_points, const VecInt2d& a_triangles)
 : m_points(a_points)
 , m_faces(a_triangles)
+, m_numSubdomains(1)
+, m_numThreads(1)
+, m_approximateMatching(false)
+, m_matchingWeight(0.0)
+, m_matchingUpperBound(0.0)
+{
+} // MeQuadBlossomImpl::MeQuadBlossomImpl
+//------------------------------------------------------------------------------
+/// \brief Constructor that takes the points and triangles without copying
+/// them.
+/// \param[in] a_points The points. Moved from.
+/// \param[in] a_triangles The triangles. Moved from.
+//------------------------------------------------------------------------------
+MeQuadBlossomImpl::MeQuadBlossomImpl(VecPt3d&& a_points, VecInt2d&& a_triangles)
+: m_points(std::move(a_points))
+, m_faces(std::move(a_triangles))
+, m_numSubdomains(1)
+, m_numThreads(1)
+, m_approximateMatching(false)
+, m_matchingWeight(0.0)
+, m_matchingUpperBound(0.0)
 {
 } // MeQuadBlossomImpl::MeQuadBlossomImpl
 //------------------------------------------------------------------------------
@@ -418,6 +509,71 @@ BSHP<XmUGrid> MeQuadBlossomImpl::MakeQuads(bool a_splitBoundaryPoints,
   return _MakeQuads(a_splitBoundaryPoints, a_useAngle);
 } // MeQuadBlossomImpl::MakeQuads
 //------------------------------------------------------------------------------
+/// \brief Turn faces from triangles into quads like the other MakeQuads but
+/// give back the points and faces instead of building a UGrid. The points and
+/// faces are moved out, so this can only be called once.
+/// \param[in] a_splitBoundaryPoints See the other MakeQuads.
+/// \param[in] a_useAngle See the other MakeQuads.
+/// \param[out] a_points The points including any new points.
+/// \param[out] a_faces The point indices of the quads and any triangles left.
+//------------------------------------------------------------------------------
+void MeQuadBlossomImpl::MakeQuads(bool a_splitBoundaryPoints,
+                                  bool a_useAngle,
+                                  VecPt3d& a_points,
+                                  VecInt2d& a_faces)
+{
+  MakeQuadFaces(a_splitBoundaryPoints, a_useAngle);
+  a_points.swap(m_points);
+  a_faces.swap(m_faces);
+  m_points.clear();
+  m_faces.clear();
+} // MeQuadBlossomImpl::MakeQuads
+//------------------------------------------------------------------------------
+/// \brief Sets the number of subdomains the triangles are split into. Each
+/// subdomain is matched on its own and then the triangles along the borders
+/// between subdomains are matched again together. This is much faster than
+/// matching all of the triangles at once but the result may be a little
+/// worse. See NumSubdomainsForRunTime.
+/// \param[in] a_numSubdomains The number of subdomains. The default of 1
+/// matches all of the triangles at once.
+//------------------------------------------------------------------------------
+void MeQuadBlossomImpl::SetNumSubdomains(int a_numSubdomains)
+{
+  m_numSubdomains = std::max(1, a_numSubdomains);
+} // MeQuadBlossomImpl::SetNumSubdomains
+//------------------------------------------------------------------------------
+/// \brief Sets the number of threads used to match the subdomains.
+/// \param[in] a_numThreads The number of threads. See meNumThreadsToUse.
+//------------------------------------------------------------------------------
+void MeQuadBlossomImpl::SetNumThreads(int a_numThreads)
+{
+  m_numThreads = a_numThreads;
+} // MeQuadBlossomImpl::SetNumThreads
+//------------------------------------------------------------------------------
+/// \brief Sets whether to match the triangles with a near linear time
+/// approximation instead of the maximum weight matching. It is much faster
+/// for previews of big meshes but the quads are a little worse and more
+/// triangles may be left. The subdomains aren't used when true. See
+/// GetMatchingWeight.
+/// \param[in] a_approximate True to use the approximation.
+//------------------------------------------------------------------------------
+void MeQuadBlossomImpl::SetApproximateMatching(bool a_approximate)
+{
+  m_approximateMatching = a_approximate;
+} // MeQuadBlossomImpl::SetApproximateMatching
+//------------------------------------------------------------------------------
+/// \brief Gets the total weight of the edges removed by the last MakeQuads
+/// and an upper bound of the weight of any matching. Their ratio is a lower
+/// bound of how close the matching is to the maximum weight.
+/// \param[out] a_weight The total weight of the matched edges.
+/// \param[out] a_upperBound The upper bound of the weight.
+//------------------------------------------------------------------------------
+void MeQuadBlossomImpl::GetMatchingWeight(double& a_weight, double& a_upperBound) const
+{
+  a_weight = m_matchingWeight;
+  a_upperBound = m_matchingUpperBound;
+} // MeQuadBlossomImpl::GetMatchingWeight
+//------------------------------------------------------------------------------
 /// \brief Turn faces from triangles into quads by using MeWeightMatcher
 /// to identify edges to drop and then by calling EliminateEdges to remove them.
 /// \param[in] a_splitBoundaryPoints If necessary, split boundary points to
@@ -432,13 +588,25 @@ BSHP<XmUGrid> MeQuadBlossomImpl::_MakeQuads(bool a_splitBoundaryPoints /*= true
                                             bool a_useAngle /*= false*/,
                                             int a_cost /*= -10*/)
 {
-  PrepareForMatch(a_cost, a_useAngle);
-  VecInt eliminate = MatchTriangles(a_splitBoundaryPoints);
-  EliminateEdges(eliminate);
+  MakeQuadFaces(a_splitBoundaryPoints, a_useAngle, a_cost);
   BSHP<XmUGrid> ugrid = BuildUGrid(m_points, m_faces);
   return ugrid;
 } // MeQuadBlossomImpl::MakeQuads
 //------------------------------------------------------------------------------
+/// \brief Turn m_faces from triangles into quads. See _MakeQuads.
+/// \param[in] a_splitBoundaryPoints See _MakeQuads.
+/// \param[in] a_useAngle See _MakeQuads.
+/// \param[in] a_cost See _MakeQuads.
+//------------------------------------------------------------------------------
+void MeQuadBlossomImpl::MakeQuadFaces(bool a_splitBoundaryPoints,
+                                      bool a_useAngle,
+                                      int a_cost /*= -10*/)
+{
+  PrepareForMatch(a_cost, a_useAngle);
+  VecInt eliminate = MatchTriangles(a_splitBoundaryPoints);
+  EliminateEdges(eliminate);
+} // MeQuadBlossomImpl::MakeQuadFaces
+//------------------------------------------------------------------------------
 /// \brief Prepare for MakeQuads call by computing the edges and costs.
 ///
 /// Calculates an array of costs for each edge (or pair of adjacent triangles).
@@ -482,8 +650,28 @@ void MeQuadBlossomImpl::PrepareForMatch(int a_cost,
 VecInt MeQuadBlossomImpl::MatchTriangles(bool a_splitBoundaryPoints)
 {
   bool maxCardinality = a_splitBoundaryPoints;
-  BSHP<MeWeightMatcher> matcher = MeWeightMatcher::New();
-  VecInt result = matcher->MatchWeights(m_costs, maxCardinality);
+  VecInt result;
+  if (m_approximateMatching)
+  {
+    BSHP<MeWeightMatcher> matcher = MeWeightMatcher::NewApproximate();
+    result = matcher->MatchWeights(m_costs, maxCardinality);
+  }
+  else if (m_numSubdomains > 1)
+  {
+    result = MatchSubdomains(maxCardinality);
+  }
+  else
+  {
+    BSHP<MeWeightMatcher> matcher = MeWeightMatcher::New();
+    result = matcher->MatchWeights(m_costs, maxCardinality);
+  }
+
+  // the edges of each face in increasing order
+  VecInt2d faceEdges(result.size(), VecInt());
+  for (int k = 0; k < (int)m_costs.size(); ++k)
+  {
+    faceEdges[m_costs[k].m_f0].push_back(k);
+  }
 
   // VecInt unmatched;
   VecInt eliminate;
@@ -497,7 +685,10 @@ VecInt MeQuadBlossomImpl::MatchTriangles(bool a_splitBoundaryPoints)
     // if j == -1, then j < i
     if (j > i)
     {
-      for (int k = 0; k < m_costs.size(); ++k)
+      VecInt edges = faceEdges[i];
+      edges.insert(edges.end(), faceEdges[j].begin(), faceEdges[j].end());
+      std::sort(edges.begin(), edges.end());
+      for (int k : edges)
       {
         if ((i == m_costs[k].m_f0 && j == m_costs[k].m_f1) ||
             (i == m_costs[k].m_f1 && j == m_costs[k].m_f0))
@@ -507,9 +698,144 @@ VecInt MeQuadBlossomImpl::MatchTriangles(bool a_splitBoundaryPoints)
       }
     }
   }
+
+  m_matchingWeight = 0.0;
+  for (int k : eliminate)
+  {
+    m_matchingWeight += m_costs[k].m_weight;
+  }
+  m_matchingUpperBound = MeWeightMatcher::WeightUpperBound(m_costs);
   return eliminate;
 } // MeQuadBlossomImpl::MatchTriangles
 //------------------------------------------------------------------------------
+/// \brief Matches the faces by splitting them into subdomains that are matched
+/// on their own (in parallel). The faces on the borders between subdomains,
+/// the faces they were matched to and the faces left unmatched are then
+/// matched again together.
+/// \param[in] a_maxCardinality Passed to MeWeightMatcher::MatchWeights for
+/// the final match of the border faces.
+/// \return For each face the face it is matched to or -1. Same as
+/// MeWeightMatcher::MatchWeights for all of m_costs.
+//------------------------------------------------------------------------------
+VecInt MeQuadBlossomImpl::MatchSubdomains(bool a_maxCardinality)
+{
+  int numFaces = (int)m_faces.size();
+  VecInt parts;
+  PartitionFaces(m_numSubdomains, parts);
+
+  // number the faces of each subdomain from 0 and give each subdomain the
+  // edges between its faces
+  VecInt2d partFaces(m_numSubdomains, VecInt());
+  VecInt localIdx(numFaces, 0);
+  for (int f = 0; f < numFaces; ++f)
+  {
+    localIdx[f] = (int)partFaces[parts[f]].size();
+    partFaces[parts[f]].push_back(f);
+  }
+  std::vector<VecMeEdge> partEdges(m_numSubdomains, VecMeEdge());
+  std::vector<bool> onBorder(numFaces, false);
+  for (auto& edge : m_costs)
+  {
+    int part = parts[edge.m_f0];
+    if (part == parts[edge.m_f1])
+    {
+      partEdges[part].push_back({localIdx[edge.m_f0], localIdx[edge.m_f1], edge.m_weight});
+    }
+    else
+    {
+      onBorder[edge.m_f0] = true;
+      onBorder[edge.m_f1] = true;
+    }
+  }
+
+  // without max cardinality so that triangles cut off at the subdomain
+  // borders do not force poor matches across the whole subdomain
+  VecInt mates(numFaces, -1);
+  int numThreads = meNumThreadsToUse(m_numThreads, partEdges.size());
+  meParallelFor(partEdges.size(), numThreads, [&](size_t a_part, int) {
+    BSHP<MeWeightMatcher> matcher = MeWeightMatcher::New();
+    VecInt result = matcher->MatchWeights(partEdges[a_part], false);
+    const VecInt& faces = partFaces[a_part];
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+      if (result[i] != -1)
+      {
+        mates[faces[i]] = faces[result[i]];
+      }
+    }
+  });
+
+  // free the faces along the borders, their mates, and the unmatched faces
+  std::vector<bool> isFree(numFaces, false);
+  for (int f = 0; f < numFaces; ++f)
+  {
+    if (mates[f] == -1)
+    {
+      isFree[f] = true;
+    }
+    else if (onBorder[f])
+    {
+      isFree[f] = true;
+      isFree[mates[f]] = true;
+    }
+  }
+  VecInt freeFaces;
+  for (int f = 0; f < numFaces; ++f)
+  {
+    if (isFree[f])
+    {
+      localIdx[f] = (int)freeFaces.size();
+      freeFaces.push_back(f);
+      mates[f] = -1;
+    }
+  }
+  VecMeEdge freeEdges;
+  for (auto& edge : m_costs)
+  {
+    if (isFree[edge.m_f0] && isFree[edge.m_f1])
+    {
+      freeEdges.push_back({localIdx[edge.m_f0], localIdx[edge.m_f1], edge.m_weight});
+    }
+  }
+  BSHP<MeWeightMatcher> matcher = MeWeightMatcher::New();
+  VecInt result = matcher->MatchWeights(freeEdges, a_maxCardinality);
+  for (size_t i = 0; i < result.size(); ++i)
+  {
+    if (result[i] != -1)
+    {
+      mates[freeFaces[i]] = freeFaces[result[i]];
+    }
+  }
+  return mates;
+} // MeQuadBlossomImpl::MatchSubdomains
+//------------------------------------------------------------------------------
+/// \brief Splits the faces into parts of nearly equal size that are close
+/// together using recursive coordinate bisection of the face centroids.
+/// \param[in] a_numParts The number of parts.
+/// \param[out] a_parts The part of each face.
+//------------------------------------------------------------------------------
+void MeQuadBlossomImpl::PartitionFaces(int a_numParts, VecInt& a_parts)
+{
+  int numFaces = (int)m_faces.size();
+  VecPt3d centroids(numFaces, Pt3d());
+  for (int f = 0; f < numFaces; ++f)
+  {
+    const VecInt& face = m_faces[f];
+    for (int p : face)
+    {
+      centroids[f] += m_points[p];
+    }
+    if (!face.empty())
+    {
+      centroids[f] /= (double)face.size();
+    }
+  }
+  VecInt faces(numFaces, 0);
+  std::iota(faces.begin(), faces.end(), 0);
+  a_parts.assign(numFaces, 0);
+  BisectFaces(faces.begin(), faces.end(), centroids, 0, a_numParts, a_parts);
+} // MeQuadBlossomImpl::PartitionFaces
+//------------------------------------------------------------------------------
 /// \brief Returns interior, boundary, and extra edges.
 /// \param[in] a_cost The cost to associate with psuedo-extra edges that are
 /// conceptually between two boundary edges that share a point that has more
@@ -930,6 +1256,18 @@ BSHP<MeQuadBlossom> MeQuadBlossom::New(BSHP<XmUGrid> a_ugrid)
   return wm;
 } // MeQuadBlossom::New
 //------------------------------------------------------------------------------
+/// \brief Create new MeQuadBlossom from points and triangles without building
+/// a UGrid.
+/// \param[in] a_points The points. Moved from.
+/// \param[in] a_triangles The point indices of each triangle. Moved from.
+/// \return The new MeQuadBlossom.
+//------------------------------------------------------------------------------
+BSHP<MeQuadBlossom> MeQuadBlossom::New(VecPt3d&& a_points, VecInt2d&& a_triangles)
+{
+  BSHP<MeQuadBlossom> wm(new MeQuadBlossomImpl(std::move(a_points), std::move(a_triangles)));
+  return wm;
+} // MeQuadBlossom::New
+//------------------------------------------------------------------------------
 /// \brief Constructor.
 //------------------------------------------------------------------------------
 MeQuadBlossom::MeQuadBlossom()
@@ -943,15 +1281,33 @@ MeQuadBlossom::~MeQuadBlossom()
 } // MeQuadBlossom::~MeQuadBlossom
 //------------------------------------------------------------------------------
 /// \brief Get the estimated time to run the Quad Blossom algorithm in minutes.
+/// Fit to the weight_matcher benchmark of MeWeightMatcher::New on triangle
+/// grids, which takes about 0.13 seconds for 10,000 points and 1 minute for
+/// 500,000 points. The time grows about as the number of points to the 1.6.
 /// \param[in] a_numPoints The number of mesh points.
 /// \return The estimated minutes to generate the quad mesh.
 //------------------------------------------------------------------------------
 double MeQuadBlossom::EstimatedRunTimeInMinutes(int a_numPoints)
 {
-  double minutes = 6.8E-11 * a_numPoints * a_numPoints * a_numPoints;
+  double minutes = 8.1E-10 * pow((double)a_numPoints, 1.6);
   return minutes;
 } // MeQuadBlossom::EstimatedRunTimeInMinutes
 //------------------------------------------------------------------------------
+/// \brief Get the number of subdomains to use with SetNumSubdomains so that
+/// the Quad Blossom algorithm is expected to run in the given time. Splitting
+/// into n subdomains divides the estimated time by about n to the 0.6.
+/// \param[in] a_numPoints The number of mesh points.
+/// \param[in] a_minutes The desired run time in minutes.
+/// \return The number of subdomains. At least 1.
+//------------------------------------------------------------------------------
+int MeQuadBlossom::NumSubdomainsForRunTime(int a_numPoints, double a_minutes)
+{
+  double minutes = EstimatedRunTimeInMinutes(a_numPoints);
+  if (a_minutes <= 0.0 || minutes <= a_minutes)
+    return 1;
+  return (int)ceil(pow(minutes / a_minutes, 1.0 / 0.6));
+} // MeQuadBlossom::NumSubdomainsForRunTime
+//------------------------------------------------------------------------------
 /// \brief Splits UGrid with 2D cells into quads by adding midpoints for each
 /// edge and creating a quad by attaching adjacent midsides to the centroid.
 /// \param[in] a_ugrid The input UGrid that contains only 2D cells.
@@ -1035,11 +1391,31 @@ BSHP<XmUGrid> MeQuadBlossom::SplitToQuads(BSHP<XmUGrid> a_ugrid)
 
 #include <xmscore/testing/TestTools.h>
 #include <xmsinterp/triangulate/TrTriangulatorPoints.h>
+#include <xmsmesh/tutorial/TutMeshing.t.h>
 
 //----- Namespace declaration --------------------------------------------------
 
 using namespace xms;
 
+namespace
+{
+//------------------------------------------------------------------------------
+/// \brief Creates a grid of cells split into 2 triangles with the interior
+/// points moved. See tutJiggledGrid.
+/// \param[in] a_size The number of points in each direction.
+/// \param[out] a_points The points.
+/// \param[out] a_triangles The triangles.
+//------------------------------------------------------------------------------
+void iTriangleGrid(int a_size, VecPt3d& a_points, VecInt2d& a_triangles)
+{
+  VecInt tris;
+  tutJiggledGrid(a_size, a_points, tris);
+  a_triangles.clear();
+  for (size_t i = 0; i + 2 < tris.size(); i += 3)
+    a_triangles.push_back({tris[i], tris[i + 1], tris[i + 2]});
+} // iTriangleGrid
+} // namespace
+
 ////////////////////////////////////////////////////////////////////////////////
 /// \class MeQuadBlossomUnitTests
 /// \brief Contains unit tests for MeQuadBlossom and MeQuadBlossomImpl classes.
@@ -2001,11 +2377,11 @@ void MeQuadBlossomUnitTests::testSplitToQuads()
 //------------------------------------------------------------------------------
 void MeQuadBlossomUnitTests::testEstimatedRunTime()
 {
-  TS_ASSERT_DELTA(0.0085, MeQuadBlossom::EstimatedRunTimeInMinutes(500), 0.001);
-  TS_ASSERT_DELTA(0.0680, MeQuadBlossom::EstimatedRunTimeInMinutes(1000), 0.001);
-  TS_ASSERT_DELTA(8.5000, MeQuadBlossom::EstimatedRunTimeInMinutes(5000), 0.001);
-  TS_ASSERT_DELTA(68.0, MeQuadBlossom::EstimatedRunTimeInMinutes(10000), 0.001);
-  TS_ASSERT_DELTA(68000.0, MeQuadBlossom::EstimatedRunTimeInMinutes(100000), 0.001);
+  TS_ASSERT_DELTA(5.11e-5, MeQuadBlossom::EstimatedRunTimeInMinutes(1000), 1e-7);
+  TS_ASSERT_DELTA(0.00203, MeQuadBlossom::EstimatedRunTimeInMinutes(10000), 1e-5);
+  TS_ASSERT_DELTA(0.0810, MeQuadBlossom::EstimatedRunTimeInMinutes(100000), 1e-4);
+  TS_ASSERT_DELTA(1.064, MeQuadBlossom::EstimatedRunTimeInMinutes(500000), 0.001);
+  TS_ASSERT_DELTA(3.225, MeQuadBlossom::EstimatedRunTimeInMinutes(1000000), 0.001);
 } // MeQuadBlossomUnitTests::testEstimatedRunTime
 //------------------------------------------------------------------------------
 /// \brief Test PreMakeQuads function.
@@ -2125,5 +2501,79 @@ void MeQuadBlossomUnitTests::testPreMakeQuads()
     TS_ASSERT_EQUALS(expectedFaces, faces);
   }
 } // MeQuadBlossomUnitTests::testPreMakeQuads
+//------------------------------------------------------------------------------
+/// \brief Test matching the triangles in subdomains.
+//------------------------------------------------------------------------------
+void MeQuadBlossomUnitTests::testMatchSubdomains()
+{
+  VecPt3d points;
+  VecInt2d triangles;
+  iTriangleGrid(14, points, triangles);
+
+  // parts are the same size
+  MeQuadBlossomImpl parted(points, triangles);
+  VecInt parts;
+  parted.PartitionFaces(3, parts);
+  VecInt partSizes(3, 0);
+  for (int part : parts)
+    ++partSizes[part];
+  VecInt expectedSizes = {112, 113, 113};
+  TS_ASSERT_EQUALS(expectedSizes, partSizes);
+
+  const bool splitBoundaryPoints = true;
+  const bool useAngle = false;
+  const int cost = -10;
+  VecInt weights, numEliminated;
+  VecInt2d eliminated;
+  for (int numSubdomains : {1, 4, 4})
+  {
+    MeQuadBlossomImpl blossom(points, triangles);
+    blossom.SetNumSubdomains(numSubdomains);
+    blossom.SetNumThreads((int)eliminated.size() + 1);
+    blossom.PrepareForMatch(cost, useAngle);
+    VecInt eliminate = blossom.MatchTriangles(splitBoundaryPoints);
+    int weight = 0;
+    for (int k : eliminate)
+      weight += blossom.m_costs[k].m_weight;
+    weights.push_back(weight);
+    eliminated.push_back(eliminate);
+  }
+
+  // the subdomains give nearly the same matching for any number of threads
+  TS_ASSERT_EQUALS(eliminated[1], eliminated[2]);
+  TS_ASSERT_EQUALS(eliminated[0].size(), eliminated[1].size());
+  TS_ASSERT(weights[1] <= weights[0]);
+  TS_ASSERT(weights[1] >= 0.98 * weights[0]);
+
+  TS_ASSERT_EQUALS(1, MeQuadBlossom::NumSubdomainsForRunTime(1000, 1.0));
+  TS_ASSERT_EQUALS(1, MeQuadBlossom::NumSubdomainsForRunTime(100000, 1.0));
+  TS_ASSERT_EQUALS(4, MeQuadBlossom::NumSubdomainsForRunTime(500000, 0.5));
+} // MeQuadBlossomUnitTests::testMatchSubdomains
+//------------------------------------------------------------------------------
+/// \brief Test matching the triangles with the approximate matcher.
+//------------------------------------------------------------------------------
+void MeQuadBlossomUnitTests::testApproximateMatching()
+{
+  VecPt3d points;
+  VecInt2d triangles;
+  iTriangleGrid(14, points, triangles);
+
+  double weights[2], upperBounds[2];
+  int numCells[2];
+  for (int approximate = 0; approximate < 2; ++approximate)
+  {
+    MeQuadBlossomImpl blossom(points, triangles);
+    blossom.SetApproximateMatching(approximate != 0);
+    BSHP<XmUGrid> ugrid = blossom.MakeQuads(false, false);
+    blossom.GetMatchingWeight(weights[approximate], upperBounds[approximate]);
+    numCells[approximate] = ugrid->GetCellCount();
+  }
+
+  TS_ASSERT_EQUALS(upperBounds[0], upperBounds[1]);
+  TS_ASSERT(weights[0] <= upperBounds[0]);
+  TS_ASSERT(weights[1] <= weights[0]);
+  TS_ASSERT(weights[1] >= 0.9 * weights[0]);
+  TS_ASSERT(numCells[1] >= numCells[0]);
+} // MeQuadBlossomUnitTests::testApproximateMatching
 
 #endif // CXX_TEST
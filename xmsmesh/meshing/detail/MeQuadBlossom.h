@@ -35,6 +35,7 @@ class MeQuadBlossom
 {
 public:
   static BSHP<MeQuadBlossom> New(BSHP<XmUGrid> a_ugrid);
+  static BSHP<MeQuadBlossom> New(VecPt3d&& a_points, VecInt2d&& a_triangles);
   MeQuadBlossom();
   virtual ~MeQuadBlossom();
 
@@ -42,9 +43,18 @@ public:
   virtual int PreMakeQuads() = 0;
   virtual BSHP<XmUGrid> MakeQuads(bool a_splitBoundaryPoints,
                                   bool a_useAngle) = 0;
+  virtual void MakeQuads(bool a_splitBoundaryPoints,
+                         bool a_useAngle,
+                         VecPt3d& a_points,
+                         VecInt2d& a_faces) = 0;
+  virtual void SetNumSubdomains(int a_numSubdomains) = 0;
+  virtual void SetNumThreads(int a_numThreads) = 0;
+  virtual void SetApproximateMatching(bool a_approximate) = 0;
+  virtual void GetMatchingWeight(double& a_weight, double& a_upperBound) const = 0;
   /// \endcond
   
   static double EstimatedRunTimeInMinutes(int a_numPoints);
+  static int NumSubdomainsForRunTime(int a_numPoints, double a_minutes);
   static BSHP<XmUGrid> SplitToQuads(BSHP<XmUGrid> a_ugrid);
   
 private:
@@ -37,6 +37,8 @@ public:
   void testSplitToQuads();
   void testEstimatedRunTime();
   void testPreMakeQuads();
+  void testMatchSubdomains();
+  void testApproximateMatching();
 };
 
 //} // namespace xms
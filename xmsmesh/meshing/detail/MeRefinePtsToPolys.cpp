@@ -25,6 +25,7 @@
 #include <xmsinterp/geometry/GmPtSearch.h>
 #include <xmsmesh/meshing/MeMultiPolyMesherIo.h>
 #include <xmsmesh/meshing/MeMeshUtils.h>
+#include <xmsmesh/meshing/detail/MeParallel.h>
 #include <xmscore/misc/XmLog.h>
 
 // 6. Non-shared code headers
@@ -181,7 +182,10 @@ void MeRefinePtsToPolysImpl::FindPtsInsidePolygon(const std::vector<Pt3d>& a_out
            << dist << " for the point to be included by the meshing process.";
         std::string msg = ss.str();
         meModifyMessageWithPolygonId(m_polyId, msg);
-        XM_LOG(xmlog::error, msg);
+        {
+          std::lock_guard<std::mutex> lock(meLogMutex());
+          XM_LOG(xmlog::error, msg);
+        }
         a_refPtsProcessed.push_back(m_pts[i].m_pt);
       }
       else
@@ -238,7 +242,10 @@ void MeRefinePtsToPolysImpl::CheckRefPtsTooCloseToOtherRefPts(
            << target << " for the point to be included by the meshing process.";
         std::string msg = ss.str();
         meModifyMessageWithPolygonId(m_polyId, msg);
-        XM_LOG(xmlog::error, msg);
+        {
+          std::lock_guard<std::mutex> lock(meLogMutex());
+          XM_LOG(xmlog::error, msg);
+        }
         a_refPtsProcessed.push_back(pj);
       }
     }
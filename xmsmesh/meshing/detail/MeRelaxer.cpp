@@ -13,7 +13,9 @@
 #include <xmsmesh/meshing/detail/MeRelaxer.h>
 
 // 3. Standard library headers
+#include <algorithm>
 #include <cfloat>
+#include <chrono>
 
 // 4. External library headers
 
@@ -30,7 +32,10 @@
 #include <xmsinterp/interpolate/InterpBase.h>
 #include <xmsinterp/triangulate/TrTin.h>
 #include <xmsinterp/triangulate/triangles.h>
+#include <xmsmesh/meshing/MeMultiPolyMesherIo.h>
 #include <xmsmesh/meshing/MePolyRedistributePts.h>
+#include <xmsmesh/meshing/detail/MeParallel.h>
+#include <xmsmesh/meshing/detail/MePointAdjacency.h>
 
 // 6. Non-shared code headers
 
@@ -46,6 +51,37 @@ namespace xms
 
 //----- Classes / Structs ------------------------------------------------------
 
+//----- Internal functions -----------------------------------------------------
+namespace
+{
+//------------------------------------------------------------------------------
+/// \brief Computes the quality of a triangle. See MeRelaxIteration.
+/// \param a_p0: The first point of the triangle.
+/// \param a_p1: The second point of the triangle.
+/// \param a_p2: The third point of the triangle.
+/// \param a_area: The signed area of the triangle.
+/// \return The quality. Negative if the area is negative.
+//------------------------------------------------------------------------------
+double iTriangleQuality(const Pt3d& a_p0, const Pt3d& a_p1, const Pt3d& a_p2, double a_area)
+{
+  const double kNormalize = 4.0 * sqrt(3.0);
+  double lengths = sqr(a_p1.x - a_p0.x) + sqr(a_p1.y - a_p0.y) + sqr(a_p2.x - a_p1.x) +
+                   sqr(a_p2.y - a_p1.y) + sqr(a_p0.x - a_p2.x) + sqr(a_p0.y - a_p2.y);
+  return lengths > 0.0 ? kNormalize * a_area / lengths : 0.0;
+} // iTriangleQuality
+//------------------------------------------------------------------------------
+/// \brief Computes twice the signed area of a triangle.
+/// \param a_p0: The first point of the triangle.
+/// \param a_p1: The second point of the triangle.
+/// \param a_p2: The third point of the triangle.
+/// \return Twice the area. Positive if the points are counter clockwise.
+//------------------------------------------------------------------------------
+double iDoubleArea(const Pt3d& a_p0, const Pt3d& a_p1, const Pt3d& a_p2)
+{
+  return (a_p1.x - a_p0.x) * (a_p2.y - a_p0.y) - (a_p1.y - a_p0.y) * (a_p2.x - a_p0.x);
+} // iDoubleArea
+} // unnamed namespace
+
 ////////////////////////////////////////////////////////////////////////////////
 class MeRelaxerImpl : public MeRelaxer
 {
@@ -53,7 +89,7 @@ public:
   /// Point flags
   enum RelaxFlagEnum { RELAX_RELAX = 1 };
   /// Types of relaxation, or the relaxation algorithms
-  enum RelaxTypeEnum { RELAXTYPE_AREA, RELAXTYPE_ANGLE, RELAXTYPE_SPRING };
+  enum RelaxTypeEnum { RELAXTYPE_AREA, RELAXTYPE_ANGLE, RELAXTYPE_SPRING, RELAXTYPE_ODT };
 
   MeRelaxerImpl();
   virtual ~MeRelaxerImpl();
@@ -72,13 +108,62 @@ public:
   /// \param a_sizer: The size function class
   //------------------------------------------------------------------------------
   virtual void SetPointSizer(BSHP<MePolyRedistributePts> a_sizer) override { m_sizer = a_sizer; }
+  //------------------------------------------------------------------------------
+  /// \brief Sets the number of threads used to relax the points. Only used
+  /// when the points are relaxed in color classes (see SetColored).
+  /// \param a_numThreads The number of threads. See meNumThreadsToUse.
+  //------------------------------------------------------------------------------
+  virtual void SetNumThreads(int a_numThreads) override { m_numThreads = a_numThreads; }
+  //------------------------------------------------------------------------------
+  /// \brief Sets whether the points are relaxed in color classes (see
+  /// RelaxMarkedPointsColored) instead of one after another. The result of
+  /// colored relaxation does not depend on the number of threads.
+  /// \param a_colored true to relax the points in color classes.
+  //------------------------------------------------------------------------------
+  virtual void SetColored(bool a_colored) override { m_colored = a_colored; }
+  //------------------------------------------------------------------------------
+  /// \brief Sets the most iterations done by Relax.
+  /// \param a_maxIterations The most iterations. The default is 3.
+  //------------------------------------------------------------------------------
+  virtual void SetMaxIterations(int a_maxIterations) override { m_maxIterations = a_maxIterations; }
+  //------------------------------------------------------------------------------
+  /// \brief Sets the change in average triangle quality below which Relax
+  /// stops iterating.
+  /// \param a_tolerance The tolerance. 0 does all of the iterations.
+  //------------------------------------------------------------------------------
+  virtual void SetConvergenceTolerance(double a_tolerance) override { m_tolerance = a_tolerance; }
+  //------------------------------------------------------------------------------
+  /// \brief Sets the time after which Relax stops iterating.
+  /// \param a_seconds The time limit in seconds. 0 has no limit.
+  //------------------------------------------------------------------------------
+  virtual void SetTimeLimit(double a_seconds) override { m_timeLimit = a_seconds; }
+  //------------------------------------------------------------------------------
+  /// \brief Sets whether the metrics of each iteration are computed. They are
+  /// always computed when there is a convergence tolerance.
+  /// \param a_compute true to compute the metrics.
+  //------------------------------------------------------------------------------
+  virtual void SetComputeMetrics(bool a_compute) override { m_computeMetrics = a_compute; }
+  //------------------------------------------------------------------------------
+  /// \brief Gets the metrics of the iterations done by Relax.
+  /// \return The metrics of each iteration.
+  //------------------------------------------------------------------------------
+  virtual const std::vector<MeRelaxIteration>& GetMetrics() const override { return m_metrics; }
 
   void ComputeCentroids();
+  void ComputeMoves(const VecPt3d& a_oldPoints, MeRelaxIteration& a_metrics);
+  void ComputeQuality(MeRelaxIteration& a_metrics);
   void RelaxMarkedPoints(RelaxTypeEnum a_relaxType, int a_iteration, int a_numiterations);
+  void RelaxMarkedPointsColored(RelaxTypeEnum a_relaxType, int a_numThreads);
+  void ColorMarkedPoints(VecInt2d& a_colors);
+  void OdtRelaxMarkedPoints(int a_numThreads);
+  bool RelaxPoint(RelaxTypeEnum a_relaxType, size_t a_point);
+  void UpdatePointSize(size_t a_point);
   void AreaRelax(int a_point, Pt3d& a_newLocation);
   void AngleRelax(int a_point, Pt3d& a_newLocation);
   void SpringRelaxSinglePoint(int a_point, Pt3d& a_newLocation);
   void SetupNeighbors();
+  bool DeletePoints();
+  bool RetriangulateCavity(int a_point, VecInt& a_deadTris);
   void SetupPointSizes();
   bool NewLocationIsValid(size_t a_idx, Pt3d& a_newLocation);
   bool AllTrianglesHavePositiveArea(BSHP<TrTin> a_tin);
@@ -91,8 +176,15 @@ public:
   RelaxTypeEnum m_relaxType;   ///< the type of relaxation to perform. See RelaxTypeEnum
   BSHP<MePolyRedistributePts> m_sizer; ///< size function used by the spring relax method
   VecDbl m_pointSizes;                 ///< sizer size at each mesh point
-  VecInt2d m_pointNeighbors;           ///< neighbor points for spring relaxation
+  MePointAdjacency m_pointNeighbors;   ///< neighbor points for spring relaxation and coloring
   VecInt m_pointsToDelete;             ///< indexes of points that must be removed
+  int m_numThreads;                    ///< number of threads used to relax the points
+  bool m_colored;                      ///< true to relax the points in color classes
+  int m_maxIterations;                 ///< most iterations done by Relax
+  double m_tolerance;                  ///< quality change that ends the iterations
+  double m_timeLimit;                  ///< seconds after which the iterations end
+  bool m_computeMetrics;               ///< true to compute m_metrics
+  std::vector<MeRelaxIteration> m_metrics; ///< metrics of each iteration
 };                                     // class MeRelaxerImpl
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -113,6 +205,13 @@ MeRelaxerImpl::MeRelaxerImpl()
 , m_sizer()
 , m_pointSizes()
 , m_pointsToDelete()
+, m_numThreads(1)
+, m_colored(false)
+, m_maxIterations(3)
+, m_tolerance(0.0)
+, m_timeLimit(0.0)
+, m_computeMetrics(false)
+, m_metrics()
 {
 } // MeRelaxerImpl::MeRelaxerImpl
 //------------------------------------------------------------------------------
@@ -126,7 +225,9 @@ MeRelaxerImpl::~MeRelaxerImpl()
 ///
 /// Iteratively relaxes the interior nodes.  Also swaps edges to maintain the
 /// Delauney criterion after each set of relaxations. Also merges triangles.
-/// Compare to myiRelaxSwapAndMerge.
+/// Compare to myiRelaxSwapAndMerge. Stops after m_maxIterations, when an
+/// iteration changes the average triangle quality by less than m_tolerance
+/// or when m_timeLimit runs out.
 /// \param a_tin: The tin with triangles.
 /// \param a_fixedPoints: Points that shouldn't be moved (boundaries,
 ///                       breaklines). 0-based point indices.
@@ -135,6 +236,8 @@ void MeRelaxerImpl::Relax(/*MeshPolyEnum a_meshPolyEnum,*/
                           const VecInt& a_fixedPoints,
                           BSHP<TrTin> a_tin)
 {
+  // the metrics are of this call only, even if relaxing fails
+  m_metrics.clear();
   XM_ENSURE_TRUE_VOID_NO_ASSERT(a_tin);
   XM_ENSURE_TRUE_VOID(!a_tin->TrisAdjToPts().empty());
   XM_ENSURE_TRUE_VOID(AllTrianglesHavePositiveArea(a_tin));
@@ -158,8 +261,11 @@ void MeRelaxerImpl::Relax(/*MeshPolyEnum a_meshPolyEnum,*/
 #ifdef _DEBUG
   VecPt3d& pts(m_tin->Points());
 #endif
-  int numiterations(3); // default to 3 for area relaxation
+  int numiterations(std::max(1, m_maxIterations));
+  bool computeMetrics(m_computeMetrics || m_tolerance > 0.0);
+  std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
   RelaxTypeEnum relaxtype(m_relaxType);
+  bool needNeighbors(relaxtype != RELAXTYPE_ODT && m_colored);
   if (relaxtype == RELAXTYPE_SPRING)
   {
     if (!m_sizer)
@@ -168,7 +274,10 @@ void MeRelaxerImpl::Relax(/*MeshPolyEnum a_meshPolyEnum,*/
         "No size function specified with spring relaxation "
         "method. Relaxation method has been set to AREA "
         "relaxation.";
-      XM_LOG(xmlog::warning, msg);
+      {
+        std::lock_guard<std::mutex> lock(meLogMutex());
+        XM_LOG(xmlog::warning, msg);
+      }
       relaxtype = RELAXTYPE_AREA;
     }
     else
@@ -177,23 +286,55 @@ void MeRelaxerImpl::Relax(/*MeshPolyEnum a_meshPolyEnum,*/
       {
         SetupPointSizes();
       }
-      SetupNeighbors();
-      XM_ASSERT(pts.size() == m_pointNeighbors.size());
+      needNeighbors = true;
       XM_ASSERT(pts.size() == m_pointSizes.size());
     }
   }
+  else if (relaxtype == RELAXTYPE_ODT && m_sizer && m_pointSizes.empty())
+  {
+    SetupPointSizes();
+  }
   XM_ASSERT(pts.size() == m_flags.size());
+  if (needNeighbors)
+  {
+    SetupNeighbors();
+    XM_ASSERT(pts.size() == m_pointNeighbors.NumPoints());
+  }
 
   int iteration = 0;
+  double quality(0.0);
+  VecPt3d oldPoints;
+  if (computeMetrics)
+  {
+    MeRelaxIteration initial;
+    ComputeQuality(initial);
+    quality = initial.m_meanQuality;
+  }
 
   // Perform relaxation and swap
   for (int i = 0; i < numiterations; ++i)
   {
     ++iteration;
+    if (computeMetrics)
+      oldPoints = m_tin->Points();
     RelaxMarkedPoints(relaxtype, iteration, numiterations);
-    // delete points and triangles
+    if (computeMetrics)
+    {
+      m_metrics.push_back(MeRelaxIteration());
+      ComputeMoves(oldPoints, m_metrics.back());
+    }
+    // delete points and fill the holes they leave
+    if (!m_pointsToDelete.empty() && DeletePoints())
+    {
+      ComputeCentroids();
+      if (needNeighbors)
+        SetupNeighbors();
+    }
+    // delete points and triangles so the points are triangulated again
     if (!m_pointsToDelete.empty())
     {
+      if (computeMetrics)
+        ComputeQuality(m_metrics.back());
       m_tin->Triangles().clear();
       m_tin->TrisAdjToPts().clear();
       VecPt3d& pts(m_tin->Points());
@@ -211,12 +352,32 @@ void MeRelaxerImpl::Relax(/*MeshPolyEnum a_meshPolyEnum,*/
       m_pointsToDelete.clear();
       break;
     }
+    VecInt oldTris;
+    if (needNeighbors)
+      oldTris = m_tin->Triangles();
     bool trianglesChanged(false);
     trianglesChanged = m_tin->OptimizeTriangulation();
 
-    if (trianglesChanged && RELAXTYPE_SPRING == relaxtype)
-    { // set up spring relax if the triangles have changed
-      SetupNeighbors();
+    if (trianglesChanged && needNeighbors)
+    { // patch the neighbors where edges were swapped
+      m_pointNeighbors.SwapEdges(oldTris, m_tin->Triangles());
+    }
+
+    if (computeMetrics)
+    {
+      ComputeQuality(m_metrics.back());
+      // the quality can drop for an iteration before it improves again so
+      // only stop when it stops changing
+      double change = fabs(m_metrics.back().m_meanQuality - quality);
+      quality = m_metrics.back().m_meanQuality;
+      if (m_tolerance > 0.0 && change < m_tolerance)
+        break;
+    }
+    if (m_timeLimit > 0.0)
+    {
+      std::chrono::duration<double> elapsed(std::chrono::steady_clock::now() - start);
+      if (elapsed.count() >= m_timeLimit)
+        break;
     }
   }
 
@@ -224,8 +385,8 @@ void MeRelaxerImpl::Relax(/*MeshPolyEnum a_meshPolyEnum,*/
 //------------------------------------------------------------------------------
 /// \brief Sets the relaxation method
 /// \param[in] a_relaxType: Case insensitive string that identifies the type of
-/// relaxation. Acceptable values include: "spring_relax" \return true if the
-/// relaxtype could be set
+/// relaxation. Acceptable values include: "spring_relaxation" and
+/// "odt_relaxation" \return true if the relaxtype could be set
 //------------------------------------------------------------------------------
 bool MeRelaxerImpl::SetRelaxationMethod(const std::string& a_relaxType)
 {
@@ -236,6 +397,11 @@ bool MeRelaxerImpl::SetRelaxationMethod(const std::string& a_relaxType)
     m_relaxType = RELAXTYPE_SPRING;
     rval = true;
   }
+  else if (type == "odt_relaxation")
+  {
+    m_relaxType = RELAXTYPE_ODT;
+    rval = true;
+  }
   return rval;
 } // MeRelaxerImpl::SetRelaxationMethod
 //------------------------------------------------------------------------------
@@ -251,6 +417,49 @@ void MeRelaxerImpl::ComputeCentroids()
   }
 } // MeRelaxerImpl::ComputeCentroids
 //------------------------------------------------------------------------------
+/// \brief Computes how far the points moved in an iteration.
+/// \param a_oldPoints: The points before the iteration.
+/// \param a_metrics: The metrics of the iteration.
+//------------------------------------------------------------------------------
+void MeRelaxerImpl::ComputeMoves(const VecPt3d& a_oldPoints, MeRelaxIteration& a_metrics)
+{
+  const VecPt3d& points = m_tin->Points();
+  double total(0.0);
+  int numRelaxed(0);
+  a_metrics.m_maxMove = 0.0;
+  for (size_t p = 0; p < a_oldPoints.size(); ++p)
+  {
+    if (!m_flags[p])
+      continue;
+    double move = Mdist(a_oldPoints[p].x, a_oldPoints[p].y, points[p].x, points[p].y);
+    a_metrics.m_maxMove = std::max(a_metrics.m_maxMove, move);
+    total += move;
+    ++numRelaxed;
+  }
+  a_metrics.m_meanMove = numRelaxed ? total / numRelaxed : 0.0;
+} // MeRelaxerImpl::ComputeMoves
+//------------------------------------------------------------------------------
+/// \brief Computes the quality of the triangles. See MeRelaxIteration.
+/// \param a_metrics: The metrics of the iteration.
+//------------------------------------------------------------------------------
+void MeRelaxerImpl::ComputeQuality(MeRelaxIteration& a_metrics)
+{
+  const VecPt3d& points = m_tin->Points();
+  const VecInt& tris = m_tin->Triangles();
+  size_t numTri = tris.size() / 3;
+  double total(0.0);
+  a_metrics.m_minQuality = numTri ? 1.0 : 0.0;
+  for (size_t t = 0; t < numTri; ++t)
+  {
+    double area = m_tin->TriangleArea(static_cast<int>(t));
+    double quality = iTriangleQuality(points[tris[t * 3]], points[tris[t * 3 + 1]],
+                                      points[tris[t * 3 + 2]], area);
+    a_metrics.m_minQuality = std::min(a_metrics.m_minQuality, quality);
+    total += quality;
+  }
+  a_metrics.m_meanQuality = numTri ? total / numTri : 0.0;
+} // MeRelaxerImpl::ComputeQuality
+//------------------------------------------------------------------------------
 /// \brief Relaxes the points marked by m_flags. Compare to rlRelaxMarkedNodes.
 /// \param a_relaxType: RelaxTypeEnum.
 /// \param a_iteration: Current iteration (for progress).
@@ -262,55 +471,256 @@ void MeRelaxerImpl::RelaxMarkedPoints(RelaxTypeEnum a_relaxType,
 {
   XM_ASSERT(a_iteration > 0 && a_numiterations > 0 && a_iteration <= a_numiterations);
 
+  size_t nPoints = m_tin->Points().size();
+  int numThreads = meNumThreadsToUse(m_numThreads, nPoints);
+  if (RELAXTYPE_ODT == a_relaxType)
+  {
+    OdtRelaxMarkedPoints(numThreads);
+    return;
+  }
+  if (m_colored)
+  {
+    RelaxMarkedPointsColored(a_relaxType, numThreads);
+    return;
+  }
+
   // Relax the marked nodes
-  VecPt3d& points = m_tin->Points(); // for convenience
-  size_t nPoints = points.size();
-  Pt3d origlocation, newlocation;
   for (size_t p = 0; p < nPoints; ++p)
   {
     if (m_flags[p])
     {
-      origlocation = points[p];
-      // do general point relax
-      switch (a_relaxType)
-      {
-      case RELAXTYPE_AREA:
-        AreaRelax((int)p, newlocation);
-        break;
-      case RELAXTYPE_ANGLE:
-        AngleRelax((int)p, newlocation);
-        break;
-      case RELAXTYPE_SPRING:
-        SpringRelaxSinglePoint((int)p, newlocation);
-        break;
-      default:
-        XM_ASSERT(false);
-        break;
-      }
-      // preserve the elevation
-      newlocation.z = origlocation.z;
-
-      // Change the points location and check for bad triangles
-      if (NewLocationIsValid(p, newlocation))
-      {
-        points[p] = newlocation;
-        if (m_sizer)
-        {
-          // point moved and we must update its target size when doing
-          // spring_relax
-          m_pointSizes[p] = m_sizer->SizeFromLocation(points[p]);
-        }
-      }
+      if (RelaxPoint(a_relaxType, p))
+        UpdatePointSize(p);
       else if (RELAXTYPE_SPRING == a_relaxType)
       { // mark point for deletion
         m_pointsToDelete.push_back(static_cast<int>(p));
       }
-
     } // if (m_flags[p])
 
   } // for (int p = 0; p < nPoints; ++p)
 } // MeRelaxerImpl::RelaxMarkedPoints
 //------------------------------------------------------------------------------
+/// \brief Relaxes the points marked by m_flags on several threads. The points
+/// are split into color classes where no 2 points of the same color are in
+/// the same triangle. Relaxing a point only reads the points in its adjacent
+/// triangles so all of the points of one color are relaxed at the same time.
+/// The colors are relaxed one after another. The result does not depend on
+/// the number of threads. The sizes of the moved points are updated on this
+/// thread after each color because the size function may not be used by
+/// several threads at once.
+/// \param a_relaxType: RelaxTypeEnum.
+/// \param a_numThreads: The number of threads.
+//------------------------------------------------------------------------------
+void MeRelaxerImpl::RelaxMarkedPointsColored(RelaxTypeEnum a_relaxType, int a_numThreads)
+{
+  const size_t kBlockSize = 256; // points relaxed by one task
+  VecInt2d colors;
+  ColorMarkedPoints(colors);
+  std::vector<char> moved(m_tin->Points().size(), 0);
+  std::vector<char> invalid(m_tin->Points().size(), 0);
+  for (size_t c = 0; c < colors.size(); ++c)
+  {
+    const VecInt& points(colors[c]);
+    size_t numBlocks = (points.size() + kBlockSize - 1) / kBlockSize;
+    meParallelFor(numBlocks, a_numThreads, [&](size_t a_block, int) {
+      size_t end = std::min(points.size(), (a_block + 1) * kBlockSize);
+      for (size_t i = a_block * kBlockSize; i < end; ++i)
+      {
+        if (RelaxPoint(a_relaxType, points[i]))
+          moved[points[i]] = 1;
+        else
+          invalid[points[i]] = 1;
+      }
+    });
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+      if (moved[points[i]])
+        UpdatePointSize(points[i]);
+    }
+  }
+  if (RELAXTYPE_SPRING == a_relaxType)
+  { // mark points for deletion
+    for (size_t p = 0; p < invalid.size(); ++p)
+    {
+      if (invalid[p])
+        m_pointsToDelete.push_back(static_cast<int>(p));
+    }
+  }
+} // MeRelaxerImpl::RelaxMarkedPointsColored
+//------------------------------------------------------------------------------
+/// \brief Colors the points marked by m_flags so that no 2 points of the same
+/// color are in the same triangle. Greedy coloring in point order so the
+/// colors only depend on the triangulation. Uses m_pointNeighbors.
+/// \param[out] a_colors: The points of each color in increasing order.
+//------------------------------------------------------------------------------
+void MeRelaxerImpl::ColorMarkedPoints(VecInt2d& a_colors)
+{
+  size_t nPoints = m_flags.size();
+  VecInt color(nPoints, XM_NONE);
+  VecInt usedBy; // usedBy[c] is the last point with a neighbor of color c
+  a_colors.clear();
+  for (size_t p = 0; p < nPoints; ++p)
+  {
+    if (!m_flags[p])
+      continue;
+    // only points before p have a color
+    const int* end = m_pointNeighbors.End(static_cast<int>(p));
+    for (const int* n = m_pointNeighbors.Begin(static_cast<int>(p)); n != end; ++n)
+    {
+      if (color[*n] != XM_NONE)
+        usedBy[color[*n]] = static_cast<int>(p);
+    }
+    size_t c = 0;
+    while (c < usedBy.size() && usedBy[c] == static_cast<int>(p))
+      ++c;
+    if (c == usedBy.size())
+    {
+      usedBy.push_back(XM_NONE);
+      a_colors.push_back(VecInt());
+    }
+    color[p] = static_cast<int>(c);
+    a_colors[c].push_back(static_cast<int>(p));
+  }
+} // MeRelaxerImpl::ColorMarkedPoints
+//------------------------------------------------------------------------------
+/// \brief Relaxes the points marked by m_flags toward an optimal Delaunay
+/// triangulation (ODT). Each point moves to the average of the circumcenters
+/// of its triangles, weighted by triangle area times a density of 1 / size^2
+/// when there is a size function. This minimizes the interpolation error of
+/// the triangulation and spreads the points out faster than area relaxation.
+///
+/// All of the new locations are computed from the current ones (a Jacobi
+/// sweep), so the result does not depend on the number of threads. Points
+/// only move 3/4 of the way because full Jacobi steps can oscillate. The
+/// weighted circumcenters are first computed into flat arrays in a loop
+/// over the triangles with no branches, then gathered for each point. The
+/// points are moved in index order and a point is not moved if its new
+/// location would make a triangle with no area.
+/// \param a_numThreads: The number of threads.
+//------------------------------------------------------------------------------
+void MeRelaxerImpl::OdtRelaxMarkedPoints(int a_numThreads)
+{
+  const size_t kBlockSize = 1024; // triangles or points done by one task
+  const double kStep = 0.75;      // part of the way to the new location
+  VecPt3d& points = m_tin->Points();
+  const VecInt& tris = m_tin->Triangles();
+  const VecInt2d& trisAdjToPts = m_tin->TrisAdjToPts();
+  const bool density = m_sizer && m_pointSizes.size() == points.size();
+  size_t numTri = tris.size() / 3;
+  VecDbl weight(numTri), weightX(numTri), weightY(numTri);
+  size_t numBlocks = (numTri + kBlockSize - 1) / kBlockSize;
+  meParallelFor(numBlocks, a_numThreads, [&](size_t a_block, int) {
+    size_t end = std::min(numTri, (a_block + 1) * kBlockSize);
+    for (size_t t = a_block * kBlockSize; t < end; ++t)
+    {
+      const Pt3d& p0 = points[tris[t * 3]];
+      const Pt3d& p1 = points[tris[t * 3 + 1]];
+      const Pt3d& p2 = points[tris[t * 3 + 2]];
+      double bx = p1.x - p0.x, by = p1.y - p0.y;
+      double cx = p2.x - p0.x, cy = p2.y - p0.y;
+      double b2 = bx * bx + by * by, c2 = cx * cx + cy * cy;
+      double d = 2.0 * (bx * cy - by * cx); // 4 * area
+      double w = 0.25 * d;
+      if (density)
+      {
+        double size = (m_pointSizes[tris[t * 3]] + m_pointSizes[tris[t * 3 + 1]] +
+                       m_pointSizes[tris[t * 3 + 2]]) /
+                      3.0;
+        w /= size * size;
+      }
+      // the circumcenter is p0 + (cy * b2 - by * c2, bx * c2 - cx * b2) / d
+      double wd = w / d;
+      weight[t] = w;
+      weightX[t] = w * p0.x + wd * (cy * b2 - by * c2);
+      weightY[t] = w * p0.y + wd * (bx * c2 - cx * b2);
+    }
+  });
+
+  size_t nPoints = points.size();
+  VecPt3d newLocations(nPoints);
+  numBlocks = (nPoints + kBlockSize - 1) / kBlockSize;
+  meParallelFor(numBlocks, a_numThreads, [&](size_t a_block, int) {
+    size_t end = std::min(nPoints, (a_block + 1) * kBlockSize);
+    for (size_t p = a_block * kBlockSize; p < end; ++p)
+    {
+      if (!m_flags[p])
+        continue;
+      double sumW(0.0), sumX(0.0), sumY(0.0);
+      const VecInt& adjTris = trisAdjToPts[p];
+      for (size_t i = 0; i < adjTris.size(); ++i)
+      {
+        sumW += weight[adjTris[i]];
+        sumX += weightX[adjTris[i]];
+        sumY += weightY[adjTris[i]];
+      }
+      newLocations[p] = points[p];
+      if (sumW > 0.0)
+      {
+        newLocations[p].x += kStep * (sumX / sumW - points[p].x);
+        newLocations[p].y += kStep * (sumY / sumW - points[p].y);
+      }
+    }
+  });
+
+  for (size_t p = 0; p < nPoints; ++p)
+  {
+    if (m_flags[p] && NewLocationIsValid(p, newLocations[p]))
+    {
+      points[p] = newLocations[p];
+      UpdatePointSize(p);
+    }
+  }
+} // MeRelaxerImpl::OdtRelaxMarkedPoints
+//------------------------------------------------------------------------------
+/// \brief Relaxes one point and moves it if the new location is valid.
+/// \param a_relaxType: RelaxTypeEnum.
+/// \param a_point: The point index to be relaxed.
+/// \return false if the new location would make a triangle with no area. The
+/// point is not moved. See UpdatePointSize if the point was moved.
+//------------------------------------------------------------------------------
+bool MeRelaxerImpl::RelaxPoint(RelaxTypeEnum a_relaxType, size_t a_point)
+{
+  VecPt3d& points = m_tin->Points(); // for convenience
+  Pt3d origlocation(points[a_point]), newlocation;
+  // do general point relax
+  switch (a_relaxType)
+  {
+  case RELAXTYPE_AREA:
+    AreaRelax((int)a_point, newlocation);
+    break;
+  case RELAXTYPE_ANGLE:
+    AngleRelax((int)a_point, newlocation);
+    break;
+  case RELAXTYPE_SPRING:
+    SpringRelaxSinglePoint((int)a_point, newlocation);
+    break;
+  default:
+    XM_ASSERT(false);
+    break;
+  }
+  // preserve the elevation
+  newlocation.z = origlocation.z;
+
+  // Change the points location and check for bad triangles
+  if (!NewLocationIsValid(a_point, newlocation))
+    return false;
+  points[a_point] = newlocation;
+  return true;
+} // MeRelaxerImpl::RelaxPoint
+//------------------------------------------------------------------------------
+/// \brief Updates the target size of a point after it was moved.
+/// \param a_point: The point index.
+//------------------------------------------------------------------------------
+void MeRelaxerImpl::UpdatePointSize(size_t a_point)
+{
+  if (m_sizer)
+  {
+    // point moved and we must update its target size when doing
+    // spring_relax
+    m_pointSizes[a_point] = m_sizer->SizeFromLocation(m_tin->Points()[a_point]);
+  }
+} // MeRelaxerImpl::UpdatePointSize
+//------------------------------------------------------------------------------
 /// \brief Relax a point using area of surrounding triangles. Trys to move
 ///        point to the center of the area. Compare to rliAreaRelax.
 /// \param[in] a_point: The point index to be relaxed.
@@ -427,11 +837,12 @@ void MeRelaxerImpl::SpringRelaxSinglePoint(int a_point, Pt3d& a_newLocation)
 
   double springStiffness(1.0);
   VecPt3d& points = m_tin->Points();
-  VecInt& neighbors(m_pointNeighbors[a_point]);
-  double numPtsFactor(1.7 / (double)neighbors.size());
+  const int* neighbors(m_pointNeighbors.Begin(a_point));
+  size_t numNeighbors(m_pointNeighbors.NumNeighbors(a_point));
+  double numPtsFactor(1.7 / (double)numNeighbors);
   Pt3d& p0(points[a_point]);
   double size0(m_pointSizes[a_point]);
-  for (size_t i = 0; i < neighbors.size(); ++i)
+  for (size_t i = 0; i < numNeighbors; ++i)
   {
     int neighborIdx = neighbors[i];
     Pt3d& p1(points[neighborIdx]);
@@ -452,46 +863,204 @@ void MeRelaxerImpl::SpringRelaxSinglePoint(int a_point, Pt3d& a_newLocation)
 } // MeRelaxerImpl::SpringRelax
 //------------------------------------------------------------------------------
 /// \brief Set up neighbor point information to be used by the
-/// spring relax algorithm
+/// spring relax algorithm and to color the points. It is patched after
+/// edges are swapped instead of being set up again.
 //------------------------------------------------------------------------------
 void MeRelaxerImpl::SetupNeighbors()
 {
-  m_pointNeighbors.clear();
-  VecPt3d& points = m_tin->Points();
-  size_t nPts(points.size());
+  size_t nPts(m_tin->Points().size());
   if (m_flags.empty())
   {
     m_flags.assign(nPts, RELAX_RELAX);
   }
-  m_pointNeighbors.assign(nPts, VecInt());
+  m_pointNeighbors.Build(m_tin->Triangles(), nPts);
+} // MeRelaxerImpl::SetupNeighbors()
+//------------------------------------------------------------------------------
+/// \brief Deletes the points in m_pointsToDelete. The hole around each point
+/// is filled with new triangles and the rest of the triangles are kept.
+/// Points and triangles are removed by moving the last one into their place.
+/// \return false if a hole could not be filled. The triangles must then be
+/// cleared and the points deleted and triangulated again.
+//------------------------------------------------------------------------------
+bool MeRelaxerImpl::DeletePoints()
+{
+  VecInt deadTris;
+  for (size_t i = 0; i < m_pointsToDelete.size(); ++i)
+  {
+    if (!RetriangulateCavity(m_pointsToDelete[i], deadTris))
+      return false;
+  }
+
+  // remove the triangles that are no longer used, largest index first so the
+  // last triangle is never one of them
   VecInt& tris = m_tin->Triangles();
-  VecInt2d& adjTris2d = m_tin->TrisAdjToPts();
-  for (size_t i = 0; i < points.size(); ++i)
+  VecInt2d& trisAdjToPts = m_tin->TrisAdjToPts();
+  std::sort(deadTris.rbegin(), deadTris.rend());
+  for (size_t i = 0; i < deadTris.size(); ++i)
   {
-    if (m_flags[i] == 0) // We don't relax fixed points, so we don't need its neighbors.
+    int dead = deadTris[i];
+    int last = static_cast<int>(tris.size() / 3) - 1;
+    if (dead != last)
     {
-      continue;
+      for (int t = 0; t < 3; ++t)
+      {
+        int pt = tris[last * 3 + t];
+        tris[dead * 3 + t] = pt;
+        VecInt& adjTris = trisAdjToPts[pt];
+        adjTris.erase(std::find(adjTris.begin(), adjTris.end(), last));
+        adjTris.insert(std::lower_bound(adjTris.begin(), adjTris.end(), dead), dead);
+      }
     }
-    const VecInt& adjTris = adjTris2d[i];
-    size_t numTri = adjTris.size();
-    // find the other points that make up the edges that a_point is connected to
-    std::set<int> setPoints;
-    for (size_t j = 0; j < numTri; ++j)
+    tris.resize(tris.size() - 3);
+  }
+
+  // remove the points, largest index first
+  VecPt3d& pts(m_tin->Points());
+  VecDbl& szs(m_pointSizes);
+  for (auto it = m_pointsToDelete.rbegin(); it != m_pointsToDelete.rend(); ++it)
+  {
+    int idx = *it;
+    int last = static_cast<int>(pts.size()) - 1;
+    XM_ASSERT(trisAdjToPts[idx].empty());
+    if (idx != last)
     {
-      int idx = adjTris[j] * 3;
-      for (int t = 0; t < 3; ++t)
+      const VecInt& adjTris = trisAdjToPts[last];
+      for (size_t i = 0; i < adjTris.size(); ++i)
       {
-#ifdef _DEBUG
-        int ptIdx = tris[idx + t];
-#endif
-        XM_ASSERT(ptIdx < nPts);
-        setPoints.insert(tris[idx + t]);
+        int* tri = &tris[adjTris[i] * 3];
+        *std::find(tri, tri + 3, last) = idx;
       }
+      trisAdjToPts[idx].swap(trisAdjToPts[last]);
+    }
+    trisAdjToPts.pop_back();
+    pts[idx] = pts.back();
+    pts.pop_back();
+    if (!szs.empty())
+    {
+      szs[idx] = szs.back();
+      szs.pop_back();
     }
-    setPoints.erase(static_cast<int>(i));
-    m_pointNeighbors[i] = VecInt(setPoints.begin(), setPoints.end());
+    m_flags[idx] = m_flags.back();
+    m_flags.pop_back();
   }
-} // MeRelaxerImpl::SetupNeighbors()
+  m_pointsToDelete.clear();
+  return true;
+} // MeRelaxerImpl::DeletePoints
+//------------------------------------------------------------------------------
+/// \brief Removes the triangles around a point and fills the hole with new
+/// triangles. The polygon around the point is cut into triangles by
+/// repeatedly cutting off the best shaped ear. The new triangles reuse the
+/// indexes of the old ones and the 2 indexes left over are added to
+/// a_deadTris.
+/// \param a_point: The point index.
+/// \param a_deadTris: Triangles that are no longer used.
+/// \return false if the triangles around the point do not form a closed
+/// polygon or it could not be filled.
+//------------------------------------------------------------------------------
+bool MeRelaxerImpl::RetriangulateCavity(int a_point, VecInt& a_deadTris)
+{
+  VecInt& tris = m_tin->Triangles();
+  VecInt2d& trisAdjToPts = m_tin->TrisAdjToPts();
+  const VecPt3d& points = m_tin->Points();
+  const VecInt adjTris(trisAdjToPts[a_point]);
+  size_t numTri = adjTris.size();
+  if (numTri < 3)
+    return false;
+
+  // the edges opposite the point, counter clockwise
+  std::vector<std::pair<int, int>> edges;
+  for (size_t i = 0; i < numTri; ++i)
+  {
+    int local = m_tin->LocalIndex(adjTris[i], a_point);
+    edges.push_back(std::make_pair(tris[adjTris[i] * 3 + (local + 1) % 3],
+                                   tris[adjTris[i] * 3 + (local + 2) % 3]));
+  }
+  VecInt ring(1, edges[0].first);
+  int next = edges[0].second;
+  for (size_t i = 1; i < numTri; ++i)
+  {
+    ring.push_back(next);
+    size_t e = 0;
+    while (e < numTri && edges[e].first != next)
+      ++e;
+    if (e == numTri)
+      return false;
+    next = edges[e].second;
+  }
+  if (next != ring[0])
+    return false;
+  VecInt sorted(ring);
+  std::sort(sorted.begin(), sorted.end());
+  if (std::adjacent_find(sorted.begin(), sorted.end()) != sorted.end())
+    return false;
+
+  VecInt newTris;
+  while (ring.size() > 3)
+  {
+    size_t n = ring.size(), best = n;
+    double bestQuality(0.0);
+    for (size_t i = 0; i < n; ++i)
+    {
+      const Pt3d& p0 = points[ring[(i + n - 1) % n]];
+      const Pt3d& p1 = points[ring[i]];
+      const Pt3d& p2 = points[ring[(i + 1) % n]];
+      double area = 0.5 * iDoubleArea(p0, p1, p2);
+      if (!GT_EPS(area, 0.0, FLT_EPSILON))
+        continue;
+      bool empty(true);
+      for (size_t j = 2; empty && j < n - 1; ++j)
+      {
+        const Pt3d& p = points[ring[(i + j) % n]];
+        empty = iDoubleArea(p0, p1, p) < 0.0 || iDoubleArea(p1, p2, p) < 0.0 ||
+                iDoubleArea(p2, p0, p) < 0.0;
+      }
+      double quality = iTriangleQuality(p0, p1, p2, area);
+      if (empty && quality > bestQuality)
+      {
+        best = i;
+        bestQuality = quality;
+      }
+    }
+    if (best == n)
+      return false;
+    newTris.push_back(ring[(best + n - 1) % n]);
+    newTris.push_back(ring[best]);
+    newTris.push_back(ring[(best + 1) % n]);
+    ring.erase(ring.begin() + best);
+  }
+  if (!GT_EPS(0.5 * iDoubleArea(points[ring[0]], points[ring[1]], points[ring[2]]), 0.0,
+              FLT_EPSILON))
+    return false;
+  newTris.insert(newTris.end(), ring.begin(), ring.end());
+
+  // replace the old triangles with the new ones
+  for (size_t i = 0; i < numTri; ++i)
+  {
+    for (int t = 0; t < 3; ++t)
+    {
+      VecInt& ptTris = trisAdjToPts[tris[adjTris[i] * 3 + t]];
+      ptTris.erase(std::find(ptTris.begin(), ptTris.end(), adjTris[i]));
+    }
+  }
+  for (size_t i = 0; i + 2 < numTri; ++i)
+  {
+    int tri = adjTris[i];
+    for (int t = 0; t < 3; ++t)
+    {
+      int pt = newTris[i * 3 + t];
+      tris[tri * 3 + t] = pt;
+      VecInt& ptTris = trisAdjToPts[pt];
+      ptTris.insert(std::lower_bound(ptTris.begin(), ptTris.end(), tri), tri);
+    }
+  }
+  for (size_t i = numTri - 2; i < numTri; ++i)
+  {
+    for (int t = 0; t < 3; ++t)
+      tris[adjTris[i] * 3 + t] = XM_NONE;
+    a_deadTris.push_back(adjTris[i]);
+  }
+  return true;
+} // MeRelaxerImpl::RetriangulateCavity
 //------------------------------------------------------------------------------
 /// \brief Set up point sizes to be used by the
 /// spring relax algorithm
@@ -587,6 +1156,7 @@ MeRelaxer::~MeRelaxer()
 
 #include <xmscore/testing/TestTools.h>
 #include <xmsinterp/triangulate/TrTriangulatorPoints.h>
+#include <xmsmesh/tutorial/TutMeshing.t.h>
 
 //----- Namespace declaration --------------------------------------------------
 
@@ -713,7 +1283,10 @@ void MeRelaxerUnitTests::testSpringRelaxSetup()
   VecInt2d expectedPointNeighbors = {
     {1, 3, 4}, {0, 2, 4}, {1, 4, 5},    {0, 4, 6, 7, 9}, {0, 1, 2, 3, 5, 7, 8},
     {2, 4, 8}, {3, 9},    {3, 4, 8, 9}, {4, 5, 7},       {3, 6, 7}};
-  TS_ASSERT_EQUALS_VEC2D(expectedPointNeighbors, r.m_pointNeighbors);
+  VecInt2d pointNeighbors;
+  for (int i = 0; i < (int)points.size(); ++i)
+    pointNeighbors.push_back(r.m_pointNeighbors.Neighbors(i));
+  TS_ASSERT_EQUALS_VEC2D(expectedPointNeighbors, pointNeighbors);
 } // MeRelaxerUnitTests::testSpringRelaxSetup
 //------------------------------------------------------------------------------
 /// \brief Tests the spring relax setup. Uses the TIN below. This tin has
@@ -754,7 +1327,10 @@ void MeRelaxerUnitTests::testSpringRelaxSetup2()
   VecInt2d expectedPointNeighbors = {
     {1, 3, 4}, {0, 2, 4}, {1, 4, 5}, {0, 4, 6, 9}, {0, 1, 2, 3, 5, 7, 8},
     {2, 4, 8}, {3, 9},    {4, 8},    {4, 5, 7},    {3, 6}};
-  TS_ASSERT_EQUALS_VEC2D(expectedPointNeighbors, r.m_pointNeighbors);
+  VecInt2d pointNeighbors;
+  for (int i = 0; i < (int)points.size(); ++i)
+    pointNeighbors.push_back(r.m_pointNeighbors.Neighbors(i));
+  TS_ASSERT_EQUALS_VEC2D(expectedPointNeighbors, pointNeighbors);
 } // MeRelaxerUnitTests::testSpringRelaxSetup
 //------------------------------------------------------------------------------
 /// \brief Tests the spring relax of a point. Uses the TIN below.
@@ -1024,6 +1600,270 @@ void MeRelaxerUnitTests::testAllTrianglesHavePositiveArea()
   tin->Triangles() = tris;
   TS_ASSERT(!r.AllTrianglesHavePositiveArea(tin));
 } // MeRelaxerUnitTests::testAllTrianglesHavePositiveArea
+//------------------------------------------------------------------------------
+/// \brief Creates a tin on a grid of points with the points moved a little.
+/// Each grid cell is split into 2 triangles. See tutJiggledGrid.
+/// \param a_size: The number of points in each direction.
+/// \param a_fixedPoints: The points on the boundary of the grid.
+/// \return The tin.
+//------------------------------------------------------------------------------
+static BSHP<TrTin> iJiggledGridTin(int a_size, VecInt& a_fixedPoints)
+{
+  BSHP<TrTin> tin = TrTin::New();
+  tutJiggledGrid(a_size, tin->Points(), tin->Triangles());
+  a_fixedPoints.clear();
+  for (int i = 0; i < a_size; ++i)
+  {
+    for (int j = 0; j < a_size; ++j)
+    {
+      if (i == 0 || j == 0 || i == a_size - 1 || j == a_size - 1)
+        a_fixedPoints.push_back(i * a_size + j);
+    }
+  }
+  tin->BuildTrisAdjToPts();
+  return tin;
+} // iJiggledGridTin
+//------------------------------------------------------------------------------
+/// \brief Creates a jiggled grid tin with the interior points squeezed toward
+/// the middle so it takes several iterations to spread them out.
+/// \param a_size: The number of points in each direction.
+/// \param a_fixedPoints: The points on the boundary of the grid.
+/// \return The tin.
+//------------------------------------------------------------------------------
+static BSHP<TrTin> iSqueezedGridTin(int a_size, VecInt& a_fixedPoints)
+{
+  BSHP<TrTin> tin = iJiggledGridTin(a_size, a_fixedPoints);
+  double middle = (a_size - 1) * 5.0;
+  VecPt3d& pts = tin->Points();
+  for (size_t i = 0; i < pts.size(); ++i)
+  {
+    if (std::find(a_fixedPoints.begin(), a_fixedPoints.end(), (int)i) == a_fixedPoints.end())
+    {
+      pts[i].x = middle + (pts[i].x - middle) * 0.5;
+      pts[i].y = middle + (pts[i].y - middle) * 0.5;
+    }
+  }
+  return tin;
+} // iSqueezedGridTin
+//------------------------------------------------------------------------------
+/// \brief Tests that points of the same color do not share a triangle and
+/// that only the points being relaxed get a color.
+//------------------------------------------------------------------------------
+void MeRelaxerUnitTests::testColorMarkedPoints()
+{
+  VecInt fixedPoints;
+  BSHP<TrTin> tin = iJiggledGridTin(8, fixedPoints);
+
+  MeRelaxerImpl r;
+  r.m_tin = tin;
+  r.m_flags.assign(tin->Points().size(), MeRelaxerImpl::RELAX_RELAX);
+  for (size_t i = 0; i < fixedPoints.size(); ++i)
+    r.m_flags[fixedPoints[i]] = 0;
+  r.SetupNeighbors();
+  VecInt2d colors;
+  r.ColorMarkedPoints(colors);
+  // the grid needs at least 3 colors; greedy in point order uses 4
+  TS_ASSERT_EQUALS(4, colors.size());
+
+  VecInt color(tin->Points().size(), -1);
+  size_t numColored(0);
+  for (size_t c = 0; c < colors.size(); ++c)
+  {
+    for (size_t i = 0; i < colors[c].size(); ++i)
+    {
+      TS_ASSERT_EQUALS(-1, color[colors[c][i]]);
+      color[colors[c][i]] = (int)c;
+      ++numColored;
+    }
+  }
+  TS_ASSERT_EQUALS(36, numColored);
+  for (size_t i = 0; i < fixedPoints.size(); ++i)
+    TS_ASSERT_EQUALS(-1, color[fixedPoints[i]]);
+
+  const VecInt& tris(tin->Triangles());
+  for (size_t t = 0; t < tris.size(); t += 3)
+  {
+    for (int k = 0; k < 3; ++k)
+    {
+      int c0 = color[tris[t + k]], c1 = color[tris[t + (k + 1) % 3]];
+      TS_ASSERT(c0 == -1 || c0 != c1);
+    }
+  }
+} // MeRelaxerUnitTests::testColorMarkedPoints
+//------------------------------------------------------------------------------
+/// \brief Tests that relaxing in color classes gives the same result for
+/// any number of threads and is close to relaxing one point after another.
+//------------------------------------------------------------------------------
+void MeRelaxerUnitTests::testRelaxColored()
+{
+  VecInt fixedPoints;
+  BSHP<TrTin> tin1 = iJiggledGridTin(12, fixedPoints);
+  BSHP<TrTin> tin2 = iJiggledGridTin(12, fixedPoints);
+  VecPt3d startPts(tin1->Points());
+
+  BSHP<MeRelaxer> relaxer = MeRelaxer::New();
+  relaxer->Relax(fixedPoints, tin1);
+  relaxer = MeRelaxer::New();
+  relaxer->SetColored(true);
+  relaxer->Relax(fixedPoints, tin2);
+  for (int numThreads = 2; numThreads <= 4; ++numThreads)
+  {
+    BSHP<TrTin> tin = iJiggledGridTin(12, fixedPoints);
+    relaxer = MeRelaxer::New();
+    relaxer->SetColored(true);
+    relaxer->SetNumThreads(numThreads);
+    relaxer->Relax(fixedPoints, tin);
+    TS_ASSERT_EQUALS_VEC(tin2->Points(), tin->Points());
+  }
+
+  TS_ASSERT_DELTA_VECPT3D(tin1->Points(), tin2->Points(), 1.0);
+  for (size_t i = 0; i < tin2->NumTriangles(); ++i)
+  {
+    TS_ASSERT(tin2->TriangleArea((int)i) > 0.0);
+  }
+  // the interior points moved toward the grid
+  double startError(0), error(0);
+  for (size_t i = 0; i < startPts.size(); ++i)
+  {
+    Pt3d grid(10.0 * (i % 12), 10.0 * (i / 12), 0);
+    startError += Mdist(grid.x, grid.y, startPts[i].x, startPts[i].y);
+    error += Mdist(grid.x, grid.y, tin2->Points()[i].x, tin2->Points()[i].y);
+  }
+  TS_ASSERT(error < startError);
+} // MeRelaxerUnitTests::testRelaxColored
+//------------------------------------------------------------------------------
+/// \brief Tests that relaxing stops when the quality stops improving, and
+/// that the metrics of each iteration are returned.
+//------------------------------------------------------------------------------
+void MeRelaxerUnitTests::testRelaxConvergence()
+{
+  VecInt fixedPoints;
+  BSHP<TrTin> tin = iJiggledGridTin(12, fixedPoints);
+  BSHP<MeRelaxer> relaxer = MeRelaxer::New();
+  relaxer->SetComputeMetrics(true);
+  relaxer->Relax(fixedPoints, tin);
+  // the default is 3 iterations
+  TS_ASSERT_EQUALS(3, relaxer->GetMetrics().size());
+  // relaxing again replaces the metrics
+  relaxer->Relax(fixedPoints, tin);
+  TS_ASSERT_EQUALS(3, relaxer->GetMetrics().size());
+
+  tin = iSqueezedGridTin(12, fixedPoints);
+  relaxer = MeRelaxer::New();
+  relaxer->SetMaxIterations(100);
+  relaxer->SetConvergenceTolerance(1e-4);
+  relaxer->Relax(fixedPoints, tin);
+  const std::vector<MeRelaxIteration>& metrics = relaxer->GetMetrics();
+  size_t numIterations = metrics.size();
+  TS_ASSERT(numIterations > 2);
+  TS_ASSERT(numIterations < 100);
+  for (size_t i = 1; i < numIterations; ++i)
+  {
+    TS_ASSERT(metrics[i].m_maxMove < metrics[i - 1].m_maxMove);
+    TS_ASSERT(metrics[i].m_meanMove <= metrics[i].m_maxMove);
+    TS_ASSERT(metrics[i].m_minQuality <= metrics[i].m_meanQuality);
+    // only the last iteration changed the quality by less than the tolerance
+    double change = fabs(metrics[i].m_meanQuality - metrics[i - 1].m_meanQuality);
+    TS_ASSERT_EQUALS(i == numIterations - 1, change < 1e-4);
+  }
+  TS_ASSERT(metrics[0].m_minQuality > 0.0);
+
+  // a time limit that runs out in the first iteration
+  tin = iJiggledGridTin(12, fixedPoints);
+  relaxer = MeRelaxer::New();
+  relaxer->SetMaxIterations(100);
+  relaxer->SetComputeMetrics(true);
+  relaxer->SetTimeLimit(1e-12);
+  relaxer->Relax(fixedPoints, tin);
+  TS_ASSERT_EQUALS(1, relaxer->GetMetrics().size());
+} // MeRelaxerUnitTests::testRelaxConvergence
+
+//------------------------------------------------------------------------------
+/// \brief Tests that ODT relaxation reaches the best quality of area
+/// relaxation in fewer iterations and gives the same result on any number of
+/// threads.
+//------------------------------------------------------------------------------
+void MeRelaxerUnitTests::testOdtRelax()
+{
+  VecInt fixedPoints;
+  BSHP<TrTin> tin = iSqueezedGridTin(12, fixedPoints);
+  BSHP<MeRelaxer> relaxer = MeRelaxer::New();
+  relaxer->SetMaxIterations(20);
+  relaxer->SetComputeMetrics(true);
+  relaxer->Relax(fixedPoints, tin);
+  const std::vector<MeRelaxIteration>& areaMetrics = relaxer->GetMetrics();
+  size_t areaIterations(0);
+  for (size_t i = 1; i < areaMetrics.size(); ++i)
+  {
+    if (areaMetrics[i].m_meanQuality > areaMetrics[areaIterations].m_meanQuality)
+      areaIterations = i;
+  }
+  double areaQuality = areaMetrics[areaIterations].m_meanQuality;
+
+  BSHP<TrTin> tin1 = iSqueezedGridTin(12, fixedPoints);
+  relaxer = MeRelaxer::New();
+  TS_ASSERT(relaxer->SetRelaxationMethod("ODT_Relaxation"));
+  relaxer->SetMaxIterations(20);
+  relaxer->SetComputeMetrics(true);
+  relaxer->Relax(fixedPoints, tin1);
+  const std::vector<MeRelaxIteration>& odtMetrics = relaxer->GetMetrics();
+  size_t odtIterations(0);
+  while (odtIterations < odtMetrics.size() &&
+         odtMetrics[odtIterations].m_meanQuality < areaQuality)
+    ++odtIterations;
+  TS_ASSERT(odtIterations < areaIterations);
+  TS_ASSERT(odtMetrics.back().m_meanQuality > areaQuality + 0.1);
+  for (size_t i = 0; i < tin1->NumTriangles(); ++i)
+  {
+    TS_ASSERT(tin1->TriangleArea((int)i) > 0.0);
+  }
+
+  BSHP<TrTin> tin3 = iSqueezedGridTin(12, fixedPoints);
+  relaxer = MeRelaxer::New();
+  relaxer->SetRelaxationMethod("odt_relaxation");
+  relaxer->SetMaxIterations(20);
+  relaxer->SetNumThreads(3);
+  relaxer->Relax(fixedPoints, tin3);
+  TS_ASSERT_EQUALS_VEC(tin1->Points(), tin3->Points());
+} // MeRelaxerUnitTests::testOdtRelax
+//------------------------------------------------------------------------------
+/// \brief Tests that deleting points fills the holes and keeps the rest of
+/// the triangles.
+//------------------------------------------------------------------------------
+void MeRelaxerUnitTests::testDeletePoints()
+{
+  VecInt fixedPoints;
+  BSHP<TrTin> tin = iJiggledGridTin(6, fixedPoints);
+  VecPt3d oldPts(tin->Points());
+
+  MeRelaxerImpl r;
+  r.m_tin = tin;
+  r.m_flags.assign(tin->Points().size(), MeRelaxerImpl::RELAX_RELAX);
+  for (size_t i = 0; i < fixedPoints.size(); ++i)
+    r.m_flags[fixedPoints[i]] = 0;
+  r.m_pointsToDelete = {8, 27};
+  TS_ASSERT(r.DeletePoints());
+  TS_ASSERT(r.m_pointsToDelete.empty());
+
+  // each hole loses 2 triangles and the last points take the deleted places
+  TS_ASSERT_EQUALS(46, tin->NumTriangles());
+  TS_ASSERT_EQUALS(34, tin->Points().size());
+  TS_ASSERT_EQUALS(34, r.m_flags.size());
+  TS_ASSERT_EQUALS(oldPts[35], tin->Points()[27]);
+  TS_ASSERT_EQUALS(oldPts[34], tin->Points()[8]);
+  TS_ASSERT_EQUALS(0, r.m_flags[8]);
+  TS_ASSERT_EQUALS(MeRelaxerImpl::RELAX_RELAX, r.m_flags[9]);
+  TS_ASSERT(r.AllTrianglesHavePositiveArea(tin));
+  VecInt2d trisAdjToPts(tin->TrisAdjToPts());
+  tin->BuildTrisAdjToPts();
+  TS_ASSERT_EQUALS(tin->TrisAdjToPts().size(), trisAdjToPts.size());
+  for (size_t i = 0; i < trisAdjToPts.size(); ++i)
+    TS_ASSERT_EQUALS_VEC(tin->TrisAdjToPts()[i], trisAdjToPts[i]);
+
+  // a point on the boundary does not have a closed hole around it
+  r.m_pointsToDelete = {1};
+  TS_ASSERT(!r.DeletePoints());
+} // MeRelaxerUnitTests::testDeletePoints
 
 //} // namespace xms
 #endif // CXX_TEST
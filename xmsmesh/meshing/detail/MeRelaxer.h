@@ -26,6 +26,7 @@ namespace xms
 
 class TrTin;
 class MePolyRedistributePts;
+class MeRelaxIteration;
 
 ////////////////////////////////////////////////////////////////////////////////
 class MeRelaxer
@@ -37,6 +38,13 @@ public:
   virtual void Relax(const VecInt& a_fixedPoints, boost::shared_ptr<TrTin> a_tin) = 0;
   virtual bool SetRelaxationMethod(const std::string& a_relaxType) = 0;
   virtual void SetPointSizer(BSHP<MePolyRedistributePts> a_sizer) = 0;
+  virtual void SetNumThreads(int a_numThreads) = 0;
+  virtual void SetColored(bool a_colored) = 0;
+  virtual void SetMaxIterations(int a_maxIterations) = 0;
+  virtual void SetConvergenceTolerance(double a_tolerance) = 0;
+  virtual void SetTimeLimit(double a_seconds) = 0;
+  virtual void SetComputeMetrics(bool a_compute) = 0;
+  virtual const std::vector<MeRelaxIteration>& GetMetrics() const = 0;
   /// \endcond
 
 protected:
@@ -32,6 +32,11 @@ public:
   void testSpringRelaxSinglePoint3();
   void testNewLocationIsValid();
   void testAllTrianglesHavePositiveArea();
+  void testColorMarkedPoints();
+  void testRelaxColored();
+  void testRelaxConvergence();
+  void testOdtRelax();
+  void testDeletePoints();
 };
 
 //} // namespace xms
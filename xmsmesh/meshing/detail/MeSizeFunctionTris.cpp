@@ -0,0 +1,384 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup meshing_detail
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/meshing/detail/MeSizeFunctionTris.h>
+
+// 3. Standard library headers
+#include <mutex>
+
+// 4. External library headers
+#include <boost/make_shared.hpp>
+
+// 5. Shared code headers
+#include <xmscore/misc/XmError.h>
+#include <xmsinterp/geometry/GmMultiPolyIntersector.h>
+#include <xmsinterp/geometry/GmMultiPolyIntersectionSorter.h>
+#include <xmsinterp/geometry/GmMultiPolyIntersectionSorterTerse.h>
+#include <xmsinterp/interpolate/InterpBase.h>
+#include <xmsinterp/triangulate/TrTriangulatorPoints.h>
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+class MeSizeFunctionTrisImpl : public MeSizeFunctionTris
+{
+public:
+  MeSizeFunctionTrisImpl(BSHP<InterpBase> a_interp, BSHP<VecPt3d> a_pts, BSHP<VecInt> a_tris);
+  virtual ~MeSizeFunctionTrisImpl();
+
+  //------------------------------------------------------------------------------
+  /// \brief Returns the size function interpolator
+  /// \return The interpolator. May be null.
+  //------------------------------------------------------------------------------
+  virtual BSHP<InterpBase> Interp() const override { return m_interp; }
+  virtual bool IsCurrent(BSHP<InterpBase> a_interp) const override;
+  virtual void InterpToPts(const VecPt3d& a_pts, VecFlt& a_scalars) const override;
+  //------------------------------------------------------------------------------
+  /// \brief Returns the size function points
+  /// \return The points.
+  //------------------------------------------------------------------------------
+  virtual const VecPt3d& Pts() const override { return *m_pts; }
+  virtual const VecInt& Tris() const override;
+  virtual BSHP<GmMultiPolyIntersector> AcquireIntersector() const override;
+  virtual void ReleaseIntersector(BSHP<GmMultiPolyIntersector> a_intersector) const override;
+
+  void BuildTris() const;
+  static BSHP<VecInt> TriangulatePts(const VecPt3d& a_pts);
+
+  BSHP<InterpBase> m_interp;          ///< interpolator the triangles came from
+  BSHP<VecPt3d> m_interpPts;          ///< points of m_interp when this was built
+  BSHP<VecInt> m_interpTris;          ///< triangles of m_interp when this was built
+  size_t m_numInterpPts;              ///< size of m_interpPts when this was built
+  size_t m_numInterpTris;             ///< size of m_interpTris when this was built
+  BSHP<VecPt3d> m_pts;                ///< size function points
+  mutable BSHP<VecInt> m_tris;        ///< size function triangles, built by BuildTris
+  mutable VecInt2d m_polys;           ///< triangles as polygons for the intersectors
+  mutable std::once_flag m_trisBuilt; ///< makes BuildTris run once
+  mutable std::mutex m_mutex;         ///< protects m_intersectors
+  mutable std::mutex m_interpMutex;   ///< serializes calls to m_interp
+  /// intersectors not currently in use
+  mutable std::vector<BSHP<GmMultiPolyIntersector>> m_intersectors;
+}; // class MeSizeFunctionTrisImpl
+
+//----- Internal functions -----------------------------------------------------
+
+//----- Class / Function definitions -------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MeSizeFunctionTrisImpl
+/// \brief The triangles of a size function and the classes used to intersect
+/// polylines with them.
+///
+/// Building the triangulation of the size function and the spatial index in
+/// GmMultiPolyIntersector is expensive for large size functions. This class
+/// builds them once so they can be shared by every polygon that uses the same
+/// size function. The triangles are built the first time they are needed and
+/// do not change after that. GmMultiPolyIntersector is not thread safe so each
+/// caller acquires an intersector, uses it, and releases it for the next
+/// caller. At most one intersector is built for each thread that uses the
+/// class at the same time.
+///
+/// InterpBase is not thread safe either so InterpToPts lets one thread at a
+/// time use the interpolator. Elevation functions shared by several polygons
+/// are wrapped in this class for that reason alone and their triangles are
+/// never built.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Constructor
+/// \param[in] a_interp: The size function interpolator. May be null.
+/// \param[in] a_pts: The size function points.
+/// \param[in] a_tris: The size function triangles.
+//------------------------------------------------------------------------------
+MeSizeFunctionTrisImpl::MeSizeFunctionTrisImpl(BSHP<InterpBase> a_interp,
+                                               BSHP<VecPt3d> a_pts,
+                                               BSHP<VecInt> a_tris)
+: m_interp(a_interp)
+, m_interpPts(a_pts)
+, m_interpTris(a_tris)
+, m_numInterpPts(a_pts ? a_pts->size() : 0)
+, m_numInterpTris(a_tris ? a_tris->size() : 0)
+, m_pts(a_pts ? a_pts : BSHP<VecPt3d>(new VecPt3d()))
+, m_tris(a_tris ? a_tris : BSHP<VecInt>(new VecInt()))
+, m_polys()
+, m_trisBuilt()
+, m_mutex()
+, m_interpMutex()
+, m_intersectors()
+{
+} // MeSizeFunctionTrisImpl::MeSizeFunctionTrisImpl
+//------------------------------------------------------------------------------
+/// \brief Destructor
+//------------------------------------------------------------------------------
+MeSizeFunctionTrisImpl::~MeSizeFunctionTrisImpl()
+{
+} // MeSizeFunctionTrisImpl::~MeSizeFunctionTrisImpl
+//------------------------------------------------------------------------------
+/// \brief Checks if this class was built from the current points and
+/// triangles of an interpolator.
+///
+/// The points and triangles of an interpolator are replaced by
+/// InterpBase::SetPtsTris. Points edited in place are not detected.
+/// \param[in] a_interp: The interpolator.
+/// \return true if the class can be used for a_interp.
+//------------------------------------------------------------------------------
+bool MeSizeFunctionTrisImpl::IsCurrent(BSHP<InterpBase> a_interp) const
+{
+  if (!a_interp || a_interp != m_interp)
+    return false;
+  BSHP<VecPt3d> pts = a_interp->GetPts();
+  BSHP<VecInt> tris = a_interp->GetTris();
+  return pts == m_interpPts && tris == m_interpTris && (!pts || pts->size() == m_numInterpPts) &&
+         (!tris || tris->size() == m_numInterpTris);
+} // MeSizeFunctionTrisImpl::IsCurrent
+//------------------------------------------------------------------------------
+/// \brief Interpolates the size function to locations. The interpolator is
+/// not thread safe so only one thread at a time uses it.
+/// \param[in] a_pts: The locations.
+/// \param[out] a_scalars: The size at each location. Empty if the class was
+/// not created from an interpolator.
+//------------------------------------------------------------------------------
+void MeSizeFunctionTrisImpl::InterpToPts(const VecPt3d& a_pts, VecFlt& a_scalars) const
+{
+  a_scalars.clear();
+  XM_ENSURE_TRUE_VOID(m_interp);
+  std::lock_guard<std::mutex> lock(m_interpMutex);
+  m_interp->InterpToPts(a_pts, a_scalars);
+} // MeSizeFunctionTrisImpl::InterpToPts
+//------------------------------------------------------------------------------
+/// \brief Returns the size function triangles. The points are triangulated
+/// the first time if there are no triangles.
+/// \return The triangles as 3 point indices per triangle.
+//------------------------------------------------------------------------------
+const VecInt& MeSizeFunctionTrisImpl::Tris() const
+{
+  std::call_once(m_trisBuilt, &MeSizeFunctionTrisImpl::BuildTris, this);
+  return *m_tris;
+} // MeSizeFunctionTrisImpl::Tris
+//------------------------------------------------------------------------------
+/// \brief Triangulates the points if there are no triangles and makes the
+/// polygons used by the intersectors. Only called through std::call_once.
+//------------------------------------------------------------------------------
+void MeSizeFunctionTrisImpl::BuildTris() const
+{
+  if (m_tris->empty())
+    m_tris = TriangulatePts(*m_pts);
+
+  m_polys.assign(m_tris->size() / 3, VecInt(3, 0));
+  const VecInt& tris(*m_tris);
+  for (size_t i = 0, idx = 0; i < m_polys.size(); ++i, idx += 3)
+  {
+    m_polys[i][0] = tris[idx + 0];
+    m_polys[i][1] = tris[idx + 1];
+    m_polys[i][2] = tris[idx + 2];
+  }
+} // MeSizeFunctionTrisImpl::BuildTris
+//------------------------------------------------------------------------------
+/// \brief Gets an intersector that is not being used by anyone else. Call
+/// ReleaseIntersector when done with it.
+/// \return The intersector.
+//------------------------------------------------------------------------------
+BSHP<GmMultiPolyIntersector> MeSizeFunctionTrisImpl::AcquireIntersector() const
+{
+  std::call_once(m_trisBuilt, &MeSizeFunctionTrisImpl::BuildTris, this);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_intersectors.empty())
+    {
+      BSHP<GmMultiPolyIntersector> intersector = m_intersectors.back();
+      m_intersectors.pop_back();
+      return intersector;
+    }
+  }
+
+  BSHP<GmMultiPolyIntersectionSorterTerse> sorterTerse =
+    boost::make_shared<GmMultiPolyIntersectionSorterTerse>();
+  BSHP<GmMultiPolyIntersectionSorter> sorter = BDPC<GmMultiPolyIntersectionSorter>(sorterTerse);
+  return GmMultiPolyIntersector::New(*m_pts, m_polys, sorter);
+} // MeSizeFunctionTrisImpl::AcquireIntersector
+//------------------------------------------------------------------------------
+/// \brief Returns an intersector from AcquireIntersector so it can be used
+/// again.
+/// \param[in] a_intersector: The intersector.
+//------------------------------------------------------------------------------
+void MeSizeFunctionTrisImpl::ReleaseIntersector(BSHP<GmMultiPolyIntersector> a_intersector) const
+{
+  XM_ENSURE_TRUE_VOID(a_intersector);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_intersectors.push_back(a_intersector);
+} // MeSizeFunctionTrisImpl::ReleaseIntersector
+//------------------------------------------------------------------------------
+/// \brief Triangulates points.
+/// \param[in] a_pts: The points.
+/// \return The triangles. Empty if the points could not be triangulated.
+//------------------------------------------------------------------------------
+BSHP<VecInt> MeSizeFunctionTrisImpl::TriangulatePts(const VecPt3d& a_pts)
+{
+  BSHP<VecInt> tris(new VecInt());
+  VecInt vTris;
+  TrTriangulatorPoints tri(a_pts, vTris);
+  tri.Triangulate();
+  tris->reserve(vTris.size());
+  for (size_t i = 0; i < vTris.size(); ++i)
+    tris->push_back((int)vTris[i]);
+  return tris;
+} // MeSizeFunctionTrisImpl::TriangulatePts
+//------------------------------------------------------------------------------
+/// \brief Creates the triangles of a size function interpolator. The points
+/// are triangulated when the triangles are first needed if the interpolator
+/// does not have triangles.
+/// \param[in] a_interp: The size function interpolator.
+/// \return MeSizeFunctionTris.
+//------------------------------------------------------------------------------
+BSHP<MeSizeFunctionTris> MeSizeFunctionTris::New(BSHP<InterpBase> a_interp)
+{
+  XM_ENSURE_TRUE(a_interp, BSHP<MeSizeFunctionTris>());
+  BSHP<MeSizeFunctionTris> ret(
+    new MeSizeFunctionTrisImpl(a_interp, a_interp->GetPts(), a_interp->GetTris()));
+  return ret;
+} // MeSizeFunctionTris::New
+//------------------------------------------------------------------------------
+/// \brief Creates the triangles of a size function from points and triangles.
+/// The points are triangulated if a_tris is empty.
+/// \param[in] a_pts: The size function points.
+/// \param[in] a_tris: The size function triangles.
+/// \return MeSizeFunctionTris.
+//------------------------------------------------------------------------------
+BSHP<MeSizeFunctionTris> MeSizeFunctionTris::New(BSHP<VecPt3d> a_pts, BSHP<VecInt> a_tris)
+{
+  BSHP<MeSizeFunctionTris> ret(new MeSizeFunctionTrisImpl(BSHP<InterpBase>(), a_pts, a_tris));
+  return ret;
+} // MeSizeFunctionTris::New
+//------------------------------------------------------------------------------
+/// \brief Constructor
+//------------------------------------------------------------------------------
+MeSizeFunctionTris::MeSizeFunctionTris()
+{
+} // MeSizeFunctionTris::MeSizeFunctionTris
+//------------------------------------------------------------------------------
+/// \brief Destructor
+//------------------------------------------------------------------------------
+MeSizeFunctionTris::~MeSizeFunctionTris()
+{
+} // MeSizeFunctionTris::~MeSizeFunctionTris
+
+} // namespace xms
+
+#if CXX_TEST
+////////////////////////////////////////////////////////////////////////////////
+// UNIT TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+#include <xmsmesh/meshing/detail/MeSizeFunctionTris.t.h>
+
+#include <xmscore/testing/TestTools.h>
+#include <xmsinterp/interpolate/InterpIdw.h>
+#include <xmsinterp/interpolate/InterpLinear.h>
+
+//----- Namespace declaration --------------------------------------------------
+
+// namespace xms {
+using namespace xms;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MeSizeFunctionTrisUnitTests
+/// \brief Tests for MeSizeFunctionTris.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief tests using the triangles from the interpolator
+//------------------------------------------------------------------------------
+void MeSizeFunctionTrisUnitTests::testTrisFromInterp()
+{
+  BSHP<VecPt3d> pts(new VecPt3d());
+  *pts = {{-10, -10, 10}, {-10, 110, 10}, {110, 110, 10}, {110, -10, 10}, {60, 70, 1}};
+  BSHP<VecInt> tris(new VecInt());
+  *tris = {0, 4, 1, 1, 4, 2, 2, 4, 3, 3, 4, 0};
+  BSHP<InterpBase> linear(InterpLinear::New());
+  linear->SetPtsTris(pts, tris);
+
+  BSHP<MeSizeFunctionTris> sizeTris = MeSizeFunctionTris::New(linear);
+  TS_ASSERT(sizeTris->Interp() == linear);
+  TS_ASSERT_EQUALS_VEC(*pts, sizeTris->Pts());
+  TS_ASSERT_EQUALS_VEC(*tris, sizeTris->Tris());
+  TS_ASSERT(sizeTris->IsCurrent(linear));
+
+  // changing the points and triangles of the interpolator
+  BSHP<VecPt3d> pts2(new VecPt3d(*pts));
+  BSHP<VecInt> tris2(new VecInt(*tris));
+  linear->SetPtsTris(pts2, tris2);
+  TS_ASSERT(!sizeTris->IsCurrent(linear));
+
+  BSHP<InterpBase> linear2(InterpLinear::New());
+  linear2->SetPtsTris(pts2, tris2);
+  TS_ASSERT(!sizeTris->IsCurrent(linear2));
+  TS_ASSERT(!sizeTris->IsCurrent(BSHP<InterpBase>()));
+} // MeSizeFunctionTrisUnitTests::testTrisFromInterp
+//------------------------------------------------------------------------------
+/// \brief tests triangulating the points when the interpolator has no
+/// triangles
+//------------------------------------------------------------------------------
+void MeSizeFunctionTrisUnitTests::testTriangulate()
+{
+  BSHP<VecPt3d> pts(new VecPt3d());
+  *pts = {{0, 0, 1}, {10, 0, 1}, {10, 10, 1}, {0, 10, 1}};
+  BSHP<InterpBase> idw(InterpIdw::New());
+  idw->SetPtsTris(pts, BSHP<VecInt>(new VecInt()));
+
+  BSHP<MeSizeFunctionTris> sizeTris = MeSizeFunctionTris::New(idw);
+  // the points are not triangulated until the triangles are needed
+  BSHP<MeSizeFunctionTrisImpl> impl = BDPC<MeSizeFunctionTrisImpl>(sizeTris);
+  TS_ASSERT(impl->m_tris->empty());
+  TS_ASSERT_EQUALS(6, sizeTris->Tris().size());
+  TS_ASSERT(idw->GetTris()->empty());
+  TS_ASSERT(sizeTris->IsCurrent(idw));
+} // MeSizeFunctionTrisUnitTests::testTriangulate
+//------------------------------------------------------------------------------
+/// \brief tests that intersectors are reused after they are released
+//------------------------------------------------------------------------------
+void MeSizeFunctionTrisUnitTests::testIntersectorReuse()
+{
+  BSHP<VecPt3d> pts(new VecPt3d());
+  *pts = {{0, 0, 1}, {10, 0, 1}, {10, 10, 1}, {0, 10, 1}};
+  BSHP<VecInt> tris(new VecInt());
+  *tris = {0, 1, 2, 0, 2, 3};
+  BSHP<MeSizeFunctionTris> sizeTris = MeSizeFunctionTris::New(pts, tris);
+
+  BSHP<GmMultiPolyIntersector> one = sizeTris->AcquireIntersector();
+  BSHP<GmMultiPolyIntersector> two = sizeTris->AcquireIntersector();
+  TS_ASSERT(one);
+  TS_ASSERT(two);
+  TS_ASSERT(one != two);
+  sizeTris->ReleaseIntersector(one);
+  BSHP<GmMultiPolyIntersector> three = sizeTris->AcquireIntersector();
+  TS_ASSERT(one == three);
+
+  VecInt polys;
+  VecPt3d iPts;
+  three->TraverseLineSegment(1, 5, 9, 5, polys, iPts);
+  VecPt3d expected = {{1, 5, 0}, {5, 5, 0}, {9, 5, 0}};
+  TS_ASSERT_DELTA_VECPT3D(expected, iPts, 1e-9);
+} // MeSizeFunctionTrisUnitTests::testIntersectorReuse
+
+//} // namespace xms
+
+#endif // CXX_TEST
@@ -0,0 +1,54 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup meshing_detail
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 3. Standard library headers
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/stl/vector.h>
+#include <xmscore/misc/base_macros.h> // for XM_DISALLOW_COPY_AND_ASSIGN
+#include <xmscore/misc/boost_defines.h>
+
+//----- Forward declarations ---------------------------------------------------
+
+namespace xms
+{
+//----- Forward declarations ---------------------------------------------------
+
+class InterpBase;
+class GmMultiPolyIntersector;
+
+////////////////////////////////////////////////////////////////////////////////
+class MeSizeFunctionTris
+{
+public:
+  static BSHP<MeSizeFunctionTris> New(BSHP<InterpBase> a_interp);
+  static BSHP<MeSizeFunctionTris> New(BSHP<VecPt3d> a_pts, BSHP<VecInt> a_tris);
+
+  /// \cond
+  virtual BSHP<InterpBase> Interp() const = 0;
+  virtual bool IsCurrent(BSHP<InterpBase> a_interp) const = 0;
+  virtual void InterpToPts(const VecPt3d& a_pts, VecFlt& a_scalars) const = 0;
+  virtual const VecPt3d& Pts() const = 0;
+  virtual const VecInt& Tris() const = 0;
+  virtual BSHP<GmMultiPolyIntersector> AcquireIntersector() const = 0;
+  virtual void ReleaseIntersector(BSHP<GmMultiPolyIntersector> a_intersector) const = 0;
+  /// \endcond
+
+protected:
+  MeSizeFunctionTris();
+  virtual ~MeSizeFunctionTris();
+
+private:
+  XM_DISALLOW_COPY_AND_ASSIGN(MeSizeFunctionTris)
+}; // MeSizeFunctionTris
+
+} // namespace xms
@@ -0,0 +1,183 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup meshing_detail
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/meshing/detail/MeStageTimer.h>
+
+// 3. Standard library headers
+#include <algorithm>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmsmesh/meshing/detail/MeTracer.h>
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+
+//----- Class / Function definitions -------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MeStageTimer
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Adds the time since construction and one call to the stage and adds
+/// the span to the tracer.
+//------------------------------------------------------------------------------
+void MeStageTimer::Stop()
+{
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  if (m_stats)
+  {
+    std::chrono::duration<double> elapsed(end - m_start);
+    m_stats->m_seconds[m_stage] += elapsed.count();
+    ++m_stats->m_calls[m_stage];
+  }
+  if (m_tracer)
+    m_tracer->AddSpan(mePolyMeshStageName(m_stage), m_start, end);
+} // MeStageTimer::Stop
+//------------------------------------------------------------------------------
+/// \brief Gets the name of a stage of meshing a polygon.
+/// \param[in] a_stage: The stage.
+/// \return The name in lower case with underscores. Empty if a_stage is not a
+/// stage.
+//------------------------------------------------------------------------------
+const char* mePolyMeshStageName(MePolyMeshStats::Stage a_stage)
+{
+  static const char* names[MePolyMeshStats::NUM_STAGES] = {"generate_mesh_pts",
+                                                            "do_pave",
+                                                            "clean_pave",
+                                                            "redistribute_pts",
+                                                            "classify_polys",
+                                                            "triangulate",
+                                                            "find_poly_point_idxs",
+                                                            "fix_four_triangle_pts",
+                                                            "add_breaklines",
+                                                            "delete_outside_tris",
+                                                            "relax"};
+  if (a_stage < 0 || a_stage >= MePolyMeshStats::NUM_STAGES)
+    return "";
+  return names[a_stage];
+} // mePolyMeshStageName
+//------------------------------------------------------------------------------
+/// \brief Adds stats from another thread or another pass to stats. Times and
+/// counts are added. The rings and the container sizes are the largest of the
+/// two.
+/// \param[in] a_from: The stats to add.
+/// \param[in,out] a_to: The stats added to.
+//------------------------------------------------------------------------------
+void meAddPolyMeshStats(const MePolyMeshStats& a_from, MePolyMeshStats& a_to)
+{
+  for (int i = 0; i < MePolyMeshStats::NUM_STAGES; ++i)
+  {
+    a_to.m_seconds[i] += a_from.m_seconds[i];
+    a_to.m_calls[i] += a_from.m_calls[i];
+  }
+  a_to.m_numRings = std::max(a_to.m_numRings, a_from.m_numRings);
+  a_to.m_numMeshPts += a_from.m_numMeshPts;
+  a_to.m_maxPaveStack = std::max(a_to.m_maxPaveStack, a_from.m_maxPaveStack);
+  a_to.m_maxPavePolyPts = std::max(a_to.m_maxPavePolyPts, a_from.m_maxPavePolyPts);
+} // meAddPolyMeshStats
+
+} // namespace xms
+
+#ifdef CXX_TEST
+////////////////////////////////////////////////////////////////////////////////
+// UNIT TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+#include <xmsmesh/meshing/detail/MeStageTimer.t.h>
+
+#include <xmscore/testing/TestTools.h>
+
+//----- Namespace declaration --------------------------------------------------
+
+// namespace xms {
+using namespace xms;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MeStageTimerUnitTests
+/// \brief Tests for MeStageTimer.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Tests that a timer adds time and a call to only its stage and that a
+/// timer without stats does nothing.
+//------------------------------------------------------------------------------
+void MeStageTimerUnitTests::testTimer()
+{
+  {
+    MeStageTimer timer(nullptr, MePolyMeshStats::RELAX);
+  }
+
+  MePolyMeshStats stats;
+  for (int i = 0; i < 2; ++i)
+  {
+    MeStageTimer timer(&stats, MePolyMeshStats::TRIANGULATE);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() == start)
+      ;
+  }
+  TS_ASSERT_EQUALS(2, stats.m_calls[MePolyMeshStats::TRIANGULATE]);
+  TS_ASSERT(stats.m_seconds[MePolyMeshStats::TRIANGULATE] > 0.0);
+  for (int i = 0; i < MePolyMeshStats::NUM_STAGES; ++i)
+  {
+    if (i == MePolyMeshStats::TRIANGULATE)
+      continue;
+    TS_ASSERT_EQUALS(0, stats.m_calls[i]);
+    TS_ASSERT_EQUALS(0.0, stats.m_seconds[i]);
+  }
+} // MeStageTimerUnitTests::testTimer
+//------------------------------------------------------------------------------
+/// \brief Tests adding stats and the stage names.
+//------------------------------------------------------------------------------
+void MeStageTimerUnitTests::testAddStats()
+{
+  MePolyMeshStats a, b;
+  a.m_seconds[MePolyMeshStats::DO_PAVE] = 1.5;
+  a.m_calls[MePolyMeshStats::DO_PAVE] = 3;
+  a.m_numRings = 4;
+  a.m_maxPaveStack = 2;
+  b.m_seconds[MePolyMeshStats::DO_PAVE] = 0.5;
+  b.m_calls[MePolyMeshStats::DO_PAVE] = 1;
+  b.m_numRings = 2;
+  b.m_numMeshPts = 10;
+  b.m_maxPaveStack = 5;
+  b.m_maxPavePolyPts = 40;
+  meAddPolyMeshStats(b, a);
+  TS_ASSERT_EQUALS(2.0, a.m_seconds[MePolyMeshStats::DO_PAVE]);
+  TS_ASSERT_EQUALS(4, a.m_calls[MePolyMeshStats::DO_PAVE]);
+  TS_ASSERT_EQUALS(4, a.m_numRings);
+  TS_ASSERT_EQUALS(10, a.m_numMeshPts);
+  TS_ASSERT_EQUALS(5, a.m_maxPaveStack);
+  TS_ASSERT_EQUALS(40, a.m_maxPavePolyPts);
+
+  TS_ASSERT_EQUALS(std::string("generate_mesh_pts"),
+                   mePolyMeshStageName(MePolyMeshStats::GENERATE_MESH_PTS));
+  TS_ASSERT_EQUALS(std::string("relax"), mePolyMeshStageName(MePolyMeshStats::RELAX));
+  TS_ASSERT_EQUALS(std::string(""), mePolyMeshStageName(MePolyMeshStats::NUM_STAGES));
+} // MeStageTimerUnitTests::testAddStats
+
+//} // namespace xms
+
+#endif // CXX_TEST
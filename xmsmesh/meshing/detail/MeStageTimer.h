@@ -0,0 +1,77 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup meshing_detail
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 3. Standard library headers
+#include <chrono>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/misc/base_macros.h>
+#include <xmsmesh/meshing/MeMultiPolyMesherIo.h>
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+class MeTracer;
+
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Structs / Classes ------------------------------------------------------
+/// \brief Adds the time from its construction to its destruction to a stage
+/// of MePolyMeshStats and as a span named after the stage to a MeTracer. Does
+/// nothing, not even read the clock, when the stats and the tracer are null.
+class MeStageTimer
+{
+public:
+  //----------------------------------------------------------------------------
+  /// \brief Starts timing a stage.
+  /// \param[in] a_stats: The stats the time is added to. May be null.
+  /// \param[in] a_stage: The stage.
+  /// \param[in] a_tracer: The tracer the span is added to. May be null.
+  //----------------------------------------------------------------------------
+  MeStageTimer(MePolyMeshStats* a_stats,
+               MePolyMeshStats::Stage a_stage,
+               MeTracer* a_tracer = nullptr)
+  : m_stats(a_stats)
+  , m_stage(a_stage)
+  , m_tracer(a_tracer)
+  , m_start()
+  {
+    if (m_stats || m_tracer)
+      m_start = std::chrono::steady_clock::now();
+  }
+  //----------------------------------------------------------------------------
+  /// \brief Adds the time since construction to the stage.
+  //----------------------------------------------------------------------------
+  ~MeStageTimer()
+  {
+    if (m_stats || m_tracer)
+      Stop();
+  }
+
+private:
+  XM_DISALLOW_COPY_AND_ASSIGN(MeStageTimer);
+  void Stop();
+
+  MePolyMeshStats* m_stats;                      ///< stats the time is added to
+  MePolyMeshStats::Stage m_stage;                ///< the stage being timed
+  MeTracer* m_tracer;                            ///< tracer the span is added to
+  std::chrono::steady_clock::time_point m_start; ///< when timing started
+};
+
+//----- Function prototypes ----------------------------------------------------
+const char* mePolyMeshStageName(MePolyMeshStats::Stage a_stage);
+void meAddPolyMeshStats(const MePolyMeshStats& a_from, MePolyMeshStats& a_to);
+
+} // namespace xms
@@ -0,0 +1,221 @@
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup meshing_detail
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 1. Precompiled header
+
+// 2. My own header
+#include <xmsmesh/meshing/detail/MeTracer.h>
+
+// 3. Standard library headers
+#include <fstream>
+#include <iomanip>
+
+// 4. External library headers
+
+// 5. Shared code headers
+
+// 6. Non-shared code headers
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- External globals -------------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Classes / Structs ------------------------------------------------------
+
+//----- Internal functions -----------------------------------------------------
+
+//----- Class / Function definitions -------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MeTracer
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Constructor. Times are from now and the thread creating the tracer
+/// is the first lane.
+//------------------------------------------------------------------------------
+MeTracer::MeTracer()
+: m_start(Clock::now())
+, m_mutex()
+, m_spans()
+, m_lanes()
+{
+  m_lanes[std::this_thread::get_id()] = 0;
+} // MeTracer::MeTracer
+//------------------------------------------------------------------------------
+/// \brief Adds a span on the calling thread.
+/// \param[in] a_name: The name of the span. Must be a string literal.
+/// \param[in] a_start: When the span started.
+/// \param[in] a_end: When the span ended.
+/// \param[in] a_argName: The name of an argument shown with the span. Must be
+/// a string literal or null for no argument.
+/// \param[in] a_argValue: The value of the argument.
+//------------------------------------------------------------------------------
+void MeTracer::AddSpan(const char* a_name,
+                       Clock::time_point a_start,
+                       Clock::time_point a_end,
+                       const char* a_argName,
+                       int a_argValue)
+{
+  typedef std::chrono::duration<double, std::micro> Microseconds;
+  Span span;
+  span.m_name = a_name;
+  span.m_argName = a_argName;
+  span.m_argValue = a_argValue;
+  span.m_start = Microseconds(a_start - m_start).count();
+  span.m_duration = Microseconds(a_end - a_start).count();
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_lanes.insert(std::make_pair(std::this_thread::get_id(), (int)m_lanes.size()));
+  span.m_lane = it.first->second;
+  m_spans.push_back(span);
+} // MeTracer::AddSpan
+//------------------------------------------------------------------------------
+/// \brief Gets the number of spans added.
+/// \return The number of spans.
+//------------------------------------------------------------------------------
+size_t MeTracer::NumSpans() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return m_spans.size();
+} // MeTracer::NumSpans
+//------------------------------------------------------------------------------
+/// \brief Writes the spans as trace event JSON. Each span is a complete ("X")
+/// event and each lane is named with a metadata ("M") event.
+/// \param[in] a_os: The stream written to.
+//------------------------------------------------------------------------------
+void MeTracer::Write(std::ostream& a_os) const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  std::ios::fmtflags flags = a_os.flags();
+  std::streamsize precision = a_os.precision();
+  a_os << std::fixed << std::setprecision(3);
+  a_os << "{\"traceEvents\":[";
+  for (int lane = 0; lane < (int)m_lanes.size(); ++lane)
+  {
+    a_os << (lane == 0 ? "\n" : ",\n");
+    a_os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << lane
+         << ",\"args\":{\"name\":\"";
+    if (lane == 0)
+      a_os << "caller";
+    else
+      a_os << "thread " << lane;
+    a_os << "\"}}";
+  }
+  for (const Span& span : m_spans)
+  {
+    a_os << ",\n{\"name\":\"" << span.m_name << "\",\"cat\":\"xmsmesh\",\"ph\":\"X\",\"pid\":1"
+         << ",\"tid\":" << span.m_lane << ",\"ts\":" << span.m_start
+         << ",\"dur\":" << span.m_duration;
+    if (span.m_argName)
+      a_os << ",\"args\":{\"" << span.m_argName << "\":" << span.m_argValue << "}";
+    a_os << "}";
+  }
+  a_os << "\n],\"displayTimeUnit\":\"ms\"}\n";
+  a_os.flags(flags);
+  a_os.precision(precision);
+} // MeTracer::Write
+//------------------------------------------------------------------------------
+/// \brief Writes the spans to a file as trace event JSON.
+/// \param[in] a_fileName: The file.
+/// \return true if the file was written.
+//------------------------------------------------------------------------------
+bool MeTracer::WriteFile(const std::string& a_fileName) const
+{
+  std::ofstream os(a_fileName.c_str());
+  if (!os)
+    return false;
+  Write(os);
+  return (bool)os;
+} // MeTracer::WriteFile
+
+} // namespace xms
+
+#ifdef CXX_TEST
+////////////////////////////////////////////////////////////////////////////////
+// UNIT TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+#include <xmsmesh/meshing/detail/MeTracer.t.h>
+
+#include <sstream>
+
+#include <xmscore/testing/TestTools.h>
+
+//----- Namespace declaration --------------------------------------------------
+
+// namespace xms {
+using namespace xms;
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MeTracerUnitTests
+/// \brief Tests for MeTracer.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Tests the JSON written for spans on the creating thread and on
+/// another thread.
+//------------------------------------------------------------------------------
+void MeTracerUnitTests::testWrite()
+{
+  MeTracer tracer;
+  MeTracer::Clock::time_point start = MeTracer::Clock::now();
+  tracer.AddSpan("polygon", start, start + std::chrono::microseconds(1500), "poly", 2);
+  std::thread thread([&]() {
+    tracer.AddSpan("relax", start, start + std::chrono::microseconds(250));
+  });
+  thread.join();
+  TS_ASSERT_EQUALS(2, tracer.NumSpans());
+
+  std::stringstream ss;
+  tracer.Write(ss);
+  std::string json = ss.str();
+  TS_ASSERT_EQUALS(0, json.find("{\"traceEvents\":["));
+  TS_ASSERT(json.find("\"tid\":0,\"args\":{\"name\":\"caller\"}") != std::string::npos);
+  TS_ASSERT(json.find("\"tid\":1,\"args\":{\"name\":\"thread 1\"}") != std::string::npos);
+  TS_ASSERT(json.find("{\"name\":\"polygon\",\"cat\":\"xmsmesh\",\"ph\":\"X\",\"pid\":1,"
+                      "\"tid\":0,") != std::string::npos);
+  TS_ASSERT(json.find("\"dur\":1500.000,\"args\":{\"poly\":2}}") != std::string::npos);
+  TS_ASSERT(json.find("{\"name\":\"relax\",\"cat\":\"xmsmesh\",\"ph\":\"X\",\"pid\":1,"
+                      "\"tid\":1,") != std::string::npos);
+  TS_ASSERT(json.find("\"dur\":250.000}") != std::string::npos);
+} // MeTracerUnitTests::testWrite
+//------------------------------------------------------------------------------
+/// \brief Tests that a span adds itself to a tracer and that a span without a
+/// tracer does nothing.
+//------------------------------------------------------------------------------
+void MeTracerUnitTests::testSpan()
+{
+  {
+    MeTraceSpan span(nullptr, "nothing");
+  }
+  MeTracer tracer;
+  {
+    MeTraceSpan outer(&tracer, "outer");
+    MeTraceSpan inner(&tracer, "inner", "ring", 3);
+  }
+  TS_ASSERT_EQUALS(2, tracer.NumSpans());
+  std::stringstream ss;
+  tracer.Write(ss);
+  std::string json = ss.str();
+  // the inner span ends first
+  size_t inner = json.find("\"name\":\"inner\"");
+  size_t outer = json.find("\"name\":\"outer\"");
+  TS_ASSERT(inner != std::string::npos && outer != std::string::npos);
+  TS_ASSERT(inner < outer);
+  TS_ASSERT(json.find("\"args\":{\"ring\":3}") != std::string::npos);
+} // MeTracerUnitTests::testSpan
+
+//} // namespace xms
+
+#endif // CXX_TEST
@@ -0,0 +1,121 @@
+#pragma once
+//------------------------------------------------------------------------------
+/// \file
+/// \ingroup meshing_detail
+/// \copyright (C) Copyright Aquaveo 2018. Distributed under FreeBSD License
+/// (See accompanying file LICENSE or https://aqaveo.com/bsd/license.txt)
+//------------------------------------------------------------------------------
+
+//----- Included files ---------------------------------------------------------
+
+// 3. Standard library headers
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 4. External library headers
+
+// 5. Shared code headers
+#include <xmscore/misc/base_macros.h>
+
+//----- Forward declarations ---------------------------------------------------
+
+//----- Namespace declaration --------------------------------------------------
+
+namespace xms
+{
+//----- Constants / Enumerations -----------------------------------------------
+
+//----- Structs / Classes ------------------------------------------------------
+/// \brief Records spans of time on each thread and writes them as trace event
+/// JSON that can be loaded in a trace viewer such as chrome://tracing or
+/// Perfetto. Each thread is its own lane. Spans can be added from any thread.
+class MeTracer
+{
+public:
+  /// the clock used for the spans
+  typedef std::chrono::steady_clock Clock;
+
+  MeTracer();
+
+  void AddSpan(const char* a_name,
+               Clock::time_point a_start,
+               Clock::time_point a_end,
+               const char* a_argName = nullptr,
+               int a_argValue = 0);
+  size_t NumSpans() const;
+  void Write(std::ostream& a_os) const;
+  bool WriteFile(const std::string& a_fileName) const;
+
+private:
+  XM_DISALLOW_COPY_AND_ASSIGN(MeTracer);
+
+  /// \brief A span of time on a thread.
+  struct Span
+  {
+    const char* m_name;    ///< name of the span, a string literal
+    const char* m_argName; ///< name of the argument, a string literal or null
+    int m_argValue;        ///< value of the argument
+    int m_lane;            ///< index of the thread
+    double m_start;        ///< microseconds from the creation of the tracer
+    double m_duration;     ///< microseconds
+  };
+
+  Clock::time_point m_start;              ///< when the tracer was created
+  mutable std::mutex m_mutex;             ///< protects the variables below
+  std::vector<Span> m_spans;              ///< the spans in the order they ended
+  std::map<std::thread::id, int> m_lanes; ///< lane of each thread
+};
+
+/// \brief Adds a span from its construction to its destruction to a tracer.
+/// Does nothing, not even read the clock, when the tracer is null.
+class MeTraceSpan
+{
+public:
+  //----------------------------------------------------------------------------
+  /// \brief Starts a span.
+  /// \param[in] a_tracer: The tracer. May be null.
+  /// \param[in] a_name: The name of the span. Must be a string literal.
+  /// \param[in] a_argName: The name of an argument shown with the span. Must
+  /// be a string literal or null.
+  /// \param[in] a_argValue: The value of the argument.
+  //----------------------------------------------------------------------------
+  MeTraceSpan(MeTracer* a_tracer,
+              const char* a_name,
+              const char* a_argName = nullptr,
+              int a_argValue = 0)
+  : m_tracer(a_tracer)
+  , m_name(a_name)
+  , m_argName(a_argName)
+  , m_argValue(a_argValue)
+  , m_start()
+  {
+    if (m_tracer)
+      m_start = MeTracer::Clock::now();
+  }
+  //----------------------------------------------------------------------------
+  /// \brief Adds the span to the tracer.
+  //----------------------------------------------------------------------------
+  ~MeTraceSpan()
+  {
+    if (m_tracer)
+      m_tracer->AddSpan(m_name, m_start, MeTracer::Clock::now(), m_argName, m_argValue);
+  }
+
+private:
+  XM_DISALLOW_COPY_AND_ASSIGN(MeTraceSpan);
+
+  MeTracer* m_tracer;                  ///< the tracer
+  const char* m_name;                  ///< name of the span
+  const char* m_argName;               ///< name of the argument
+  int m_argValue;                      ///< value of the argument
+  MeTracer::Clock::time_point m_start; ///< start of the span
+};
+
+//----- Function prototypes ----------------------------------------------------
+
+} // namespace xms
@@ -22,7 +22,10 @@
 #include <xmsmesh/meshing/detail/MeWeightMatcher.h>
 
 // 3. Standard library headers
+#include <algorithm>
+#include <functional>
 #include <numeric>
+#include <queue>
 
 // 4. External library headers
 
@@ -1238,13 +1241,16 @@ void MeWeightMatcherImpl::addBlossom(int a_base, int a_k)
     {
       // This subblossom does not have a list of least-slack edges;
       // get the information from the vertices.
-      VecIntPy nblist;
-      for (int idx2 = 0; idx2 < m_neighbEnd[v].size(); ++idx2)
+      VecIntPy leaves = blossomLeaves(bv);
+      nblists.resize(leaves.size());
+      for (int idx2 = 0; idx2 < leaves.size(); ++idx2)
       {
-        int p = m_neighbEnd[v][idx2];
-        nblist.push_back(p / 2);
+        int leaf = leaves[idx2];
+        for (int idx3 = 0; idx3 < m_neighbEnd[leaf].size(); ++idx3)
+        {
+          nblists[idx2].push_back(m_neighbEnd[leaf][idx3] / 2);
+        }
       }
-      nblists.resize(blossomLeaves(bv).size(), nblist);
     }
     else
     {
@@ -1796,203 +1802,1546 @@ const MeEdge& MeWeightMatcherImpl::GetEdge(int a_idx)
   return m_edges[a_idx];
 } // MeWeightMatcherImpl::GetEdge
 
-} // namespace
+/// Priority queue of (key, index) pairs with the smallest key on top.
+typedef std::priority_queue<std::pair<int, int>,
+                            std::vector<std::pair<int, int>>,
+                            std::greater<std::pair<int, int>>>
+  MinHeap;
 
 ////////////////////////////////////////////////////////////////////////////////
-/// \class MeWeightMatcher
-/// \see MeWeightMatcherImpl
+/// \class MeFastWeightMatcherImpl
+/// \brief Maximum weight matcher for large graphs.
+///
+/// Uses the same primal-dual blossom algorithm as MeWeightMatcherImpl with
+/// the following changes so that large meshes can be matched:
+/// - All data is kept in flat vectors sized once in Init and the neighbours
+///   of the vertices are stored in compressed rows.
+/// - Dual variables are updated lazily from the running total of the deltas
+///   so a dual update doesn't visit every vertex and blossom.
+/// - The least slack edges and the least z T-blossoms used to compute delta2,
+///   delta3 and delta4 are kept in priority queues instead of being found by
+///   scanning every vertex and blossom.
+/// - After an augmentation only the two alternating trees joined by the
+///   augmenting path are removed. The other trees remain valid and are
+///   kept so the single vertices aren't relabeled at every stage.
+///
+/// The matching has the same total weight (and cardinality) as the one from
+/// MeWeightMatcherImpl but may differ when there are several optimums.
 ////////////////////////////////////////////////////////////////////////////////
+class MeFastWeightMatcherImpl : public MeWeightMatcher
+{
+public:
+  MeFastWeightMatcherImpl();
+
+  virtual VecInt MatchWeights(const VecMeEdge& a_edges, bool a_maxCardinality = false) override;
+
+  void Init(const VecMeEdge& a_edges);
+  int Dual(int a_x) const;
+  void SetDualRate(int a_x, int a_rate);
+  int Slack(int a_k) const;
+  void BlossomLeaves(int a_b, VecInt& a_leaves);
+  void AssignLabel(int a_w, int a_t, int a_p);
+  void ScanVertex(int a_v);
+  int ScanBlossom(int a_v, int a_w);
+  void AddBlossom(int a_base, int a_k);
+  void ExpandBlossom(int a_b, bool a_endStage);
+  void AugmentBlossom(int a_b, int a_v);
+  void AugmentMatching(int a_k);
+  void FreeTree(int a_root);
+  void FreeVertex(int a_v);
+  bool FindDelta(bool a_maxCardinality, int& a_deltaType, int& a_delta, int& a_deltaIdx);
+
+  int m_nEdge;     ///< Number of edges.
+  int m_nVertex;   ///< Number of vertices.
+  int m_maxWeight; ///< Maximum of the edge weights (at least 0).
+  int m_nSingle;   ///< Number of single vertices.
+
+  VecInt m_endPoint;    ///< Vertex of each edge endpoint (2*k and 2*k+1 for edge k).
+  VecInt m_weight;      ///< Weight of each edge.
+  VecInt m_neighbStart; ///< Start of the remote endpoints of vertex v in m_neighbEnd.
+  VecInt m_neighbEnd;   ///< Remote endpoints of the edges of each vertex.
+
+  VecInt m_mate;           ///< Remote endpoint of the matched edge of a vertex or -1.
+  VecInt m_label;          ///< 0 free, 1 S or 2 T (see MeWeightMatcherImpl::m_label).
+  VecInt m_labelEnd;       ///< Remote endpoint of the edge a blossom got its label through.
+  VecInt m_inBlossom;      ///< Top-level blossom of each vertex.
+  VecInt m_blossomParent;  ///< Parent of each blossom or -1 if top-level.
+  VecInt2d m_blossomChildren; ///< Sub-blossoms of each blossom starting at the base.
+  VecInt m_blossomBase;    ///< Base vertex of each blossom or -1 if unused.
+  VecInt2d m_blossomEndPts;   ///< Endpoints of the edges connecting sub-blossoms.
+  VecInt m_unusedBlossoms; ///< Stack of unused blossom numbers.
+
+  /// Dual variable of each vertex (2 * u(v)) and blossom (z(b)) at the time
+  /// it was last updated. The current value is found with Dual.
+  VecInt m_dualVar;
+  VecInt m_dualTime; ///< Value of m_delta when m_dualVar was last updated.
+  VecInt m_dualRate; ///< Change of the dual variable per unit of m_delta.
+  int m_delta;       ///< Sum of the deltas of all dual updates.
+
+  VecInt m_root;            ///< Root vertex of the tree of each labeled top-level blossom.
+  VecInt2d m_treeBlossoms;  ///< Blossoms labeled in the tree of each root vertex.
+  VecInt m_queue;           ///< Stack of S-vertices that need to be scanned.
+  MinHeap m_freeEdges;      ///< Slack + m_delta of edges from S to free vertices.
+  MinHeap m_sEdges;         ///< Slack / 2 + m_delta of edges between S-blossoms.
+  MinHeap m_tBlossoms;      ///< Dual + m_delta of T-blossoms.
+
+  VecInt m_leaves; ///< Scratch vector of blossom leaves.
+  VecInt m_stack;  ///< Scratch stack to traverse blossoms.
+  VecInt m_next;   ///< Scratch vector used to build m_neighbEnd.
+};
+
 //------------------------------------------------------------------------------
-/// \brief Create new weight matcher.
-/// \return The new MeWeightMatcher.
+/// \brief Wraps a negative index of a vector the way python does.
+/// \param[in] a_idx The index, -a_size <= a_idx < a_size.
+/// \param[in] a_size The size of the vector.
+/// \return The index, 0 <= index < a_size.
 //------------------------------------------------------------------------------
-BSHP<MeWeightMatcher> MeWeightMatcher::New()
+int iWrap(int a_idx, int a_size)
 {
-  BSHP<MeWeightMatcher> wm(new MeWeightMatcherImpl);
-  return wm;
-} // MeWeightMatcher::New
+  return a_idx < 0 ? a_idx + a_size : a_idx;
+} // iWrap
+
 //------------------------------------------------------------------------------
-/// \brief Constructor.
+/// \brief Constructor
 //------------------------------------------------------------------------------
-MeWeightMatcher::MeWeightMatcher()
+MeFastWeightMatcherImpl::MeFastWeightMatcherImpl()
+: m_nEdge(0)
+, m_nVertex(0)
+, m_maxWeight(0)
+, m_nSingle(0)
+, m_delta(0)
 {
-} // MeWeightMatcher::MeWeightMatcher
+} // MeFastWeightMatcherImpl::MeFastWeightMatcherImpl
 //------------------------------------------------------------------------------
-/// \brief Destructor.
+/// \brief Determine which interior edges to remove and which boundary points to
+/// split.
+/// \param[in] a_edges The edges to operate on. Each edge identifies a pair of
+/// adjacent faces and weight to prioritize against other edges.
+/// \param[in] a_maxCardinality When true identify boundary points to split
+/// (extend into the interior to create a new edge).
+/// \return A vector v of integers where v[i] is -1 the edge wasn't removed.
+/// Otherwise, the edge between face i and face v[i] should be removed.
 //------------------------------------------------------------------------------
-MeWeightMatcher::~MeWeightMatcher()
+VecInt MeFastWeightMatcherImpl::MatchWeights(const VecMeEdge& a_edges,
+                                             bool a_maxCardinality /* = false*/)
 {
-} // MeWeightMatcher::~MeWeightMatcher
-
-} // namespace xms
-
-#if CXX_TEST
-////////////////////////////////////////////////////////////////////////////////
-// UNIT TESTS
-////////////////////////////////////////////////////////////////////////////////
-
-#include <xmsmesh/meshing/detail/MeWeightMatcher.t.h>
+  Init(a_edges);
+  if (m_nEdge == 0)
+  {
+    return VecInt();
+  }
 
-#include <xmscore/testing/TestTools.h>
-#include <xmsinterp/triangulate/TrTriangulatorPoints.h>
+  // Every single vertex is the root of an alternating tree.
+  for (int v = 0; v < m_nVertex; ++v)
+  {
+    AssignLabel(v, 1, -1);
+  }
 
-//----- Namespace declaration --------------------------------------------------
+  while (true)
+  {
+    // Grow the trees and augment the matching until no more vertices can be
+    // reached through tight edges.
+    while (!m_queue.empty())
+    {
+      int v = m_queue.back();
+      m_queue.pop_back();
+      // vertices of trees removed by an augmentation are no longer S
+      if (m_label[m_inBlossom[v]] == 1)
+      {
+        ScanVertex(v);
+      }
+    }
 
-using namespace xms;
+    // Reduce slack in the optimization problem.
+    int deltaType, delta, deltaIdx;
+    if (!FindDelta(a_maxCardinality, deltaType, delta, deltaIdx))
+    {
+      // No further improvement possible; max-cardinality optimum reached.
+      break;
+    }
+    m_delta += delta;
 
-namespace
-{
-/// Helper to run matcher tests.
-#define TS_ASSERT_MATCH_WEIGHTS(a_expected, a_edges, a_cardinality) \
-  _TS_ASSERT_MATCH_WEIGHTS(__FILE__, __LINE__, a_expected, a_edges, a_cardinality)
-/// Helper to run matcher tests.
-#define _TS_ASSERT_MATCH_WEIGHTS(a_file, a_line, a_expected, a_edges, a_cardinality) \
-  iMatchWeights(a_file, a_line, a_expected, a_edges, a_cardinality)
+    if (deltaType == 1)
+    {
+      // No further improvement possible; optimum reached.
+      break;
+    }
+    else if (deltaType == 2)
+    {
+      // Continue the search from the S end of the least-slack edge.
+      int i = m_endPoint[2 * deltaIdx];
+      if (m_label[m_inBlossom[i]] != 1)
+      {
+        i = m_endPoint[2 * deltaIdx + 1];
+      }
+      m_queue.push_back(i);
+    }
+    else if (deltaType == 3)
+    {
+      // Continue the search from an end of the least-slack edge.
+      m_queue.push_back(m_endPoint[2 * deltaIdx]);
+    }
+    else if (deltaType == 4)
+    {
+      // Expand the least-z blossom.
+      ExpandBlossom(deltaIdx, false);
+    }
+  }
 
-//------------------------------------------------------------------------------
-/// \brief Helper function to create a weight matcher and run a test.
-/// \param[in] a_file The file for the test (this source file).
-/// \param[in] a_line The line iMatchWeights was called from.
-/// \param[in] a_expected The expected matcher output.
-/// \param[in] a_edges The matcher edge input.
-/// \param[in] a_useMaxCardinality Cardinality value passed to matcher.
-//------------------------------------------------------------------------------
-void iMatchWeights(const char* a_file,
-                   int a_line,
-                   const VecInt& a_expected,
-                   const VecInt2d& a_edges,
-                   bool a_useMaxCardinality = false)
-{
-  VecMeEdge edges;
-  for (auto& edgeVec : a_edges)
+  // Transform m_mate[] such that m_mate[v] is the vertex to which v is paired.
+  for (int v = 0; v < m_nVertex; ++v)
   {
-    MeEdge edge(edgeVec[0], edgeVec[1], edgeVec[2]);
-    edges.push_back(edge);
+    if (m_mate[v] >= 0)
+    {
+      m_mate[v] = m_endPoint[m_mate[v]];
+    }
   }
-
-  MeWeightMatcherImpl weightMatcher;
-  VecInt matchWeights = weightMatcher.MatchWeights(edges, a_useMaxCardinality);
-  _TS_ASSERT_EQUALS(a_file, a_line, a_expected, matchWeights);
-} // iTestMatchWeights
-
-} // namespace
-////////////////////////////////////////////////////////////////////////////////
-/// \class MeWeightMatcherUnitTests
-/// \brief Tests for MeWeightMatcher.
-////////////////////////////////////////////////////////////////////////////////
+  return m_mate;
+} // MeFastWeightMatcherImpl::MatchWeights
 //------------------------------------------------------------------------------
-/// \brief Test VecIntPy class.
+/// \brief Initialize class member values.
+/// \param[in] a_edges A vector of adjacent faces and weights.
 //------------------------------------------------------------------------------
-void MeWeightMatcherUnitTests::testPythonVectors()
+void MeFastWeightMatcherImpl::Init(const VecMeEdge& a_edges)
 {
-  VecInt vals = {1, 5, -1, 1, 2, 3, 4};
-  VecIntPy values(vals);
-  TS_ASSERT_EQUALS(4, values.back());
-  TS_ASSERT_EQUALS(3, values[-2]);
-
-  auto min = values.min();
-  TS_ASSERT_EQUALS(-1, min);
-
-  min = values.min(1, 3);
-  TS_ASSERT_EQUALS(-1, min);
-
-  auto max = values.max();
-  TS_ASSERT_EQUALS(5, max);
-
-  max = values.max(2, 6);
-  TS_ASSERT_EQUALS(3, max);
-
-  values.rotate(4);
-  VecInt expected = {2, 3, 4, 1, 5, -1, 1};
-  TS_ASSERT_EQUALS(expected, values.ToVecInt());
-
-  auto index = values.index(1);
-  TS_ASSERT_EQUALS(3, index);
-
-  values.resize_to_count(7);
-  expected = {0, 1, 2, 3, 4, 5, 6};
-  TS_ASSERT_EQUALS(expected, values.ToVecInt());
+  m_nEdge = (int)a_edges.size();
+  m_nVertex = 0;
+  m_maxWeight = 0;
+  m_endPoint.resize(2 * m_nEdge);
+  m_weight.resize(m_nEdge);
+  for (int k = 0; k < m_nEdge; ++k)
+  {
+    const MeEdge& edge = a_edges[k];
+    XM_ASSERT(edge.m_f0 >= 0 && edge.m_f1 >= 0 && edge.m_f0 != edge.m_f1);
+    m_nVertex = std::max(m_nVertex, std::max(edge.m_f0, edge.m_f1) + 1);
+    m_maxWeight = std::max(m_maxWeight, edge.m_weight);
+    m_endPoint[2 * k] = edge.m_f0;
+    m_endPoint[2 * k + 1] = edge.m_f1;
+    m_weight[k] = edge.m_weight;
+  }
 
-  values.resize_to_count(4, 5);
-  expected = {5, 6, 7, 8};
-  TS_ASSERT_EQUALS(expected, values.ToVecInt());
+  // remote endpoints of the edges attached to each vertex in edge order
+  m_neighbStart.assign(m_nVertex + 1, 0);
+  for (int p = 0; p < 2 * m_nEdge; ++p)
+  {
+    ++m_neighbStart[m_endPoint[p] + 1];
+  }
+  std::partial_sum(m_neighbStart.begin(), m_neighbStart.end(), m_neighbStart.begin());
+  m_next.assign(m_neighbStart.begin(), m_neighbStart.end() - 1);
+  m_neighbEnd.resize(2 * m_nEdge);
+  for (int p = 0; p < 2 * m_nEdge; ++p)
+  {
+    m_neighbEnd[m_next[m_endPoint[p]]++] = p ^ 1;
+  }
 
-  values.reverse();
-  expected = {8, 7, 6, 5};
-  TS_ASSERT_EQUALS(expected, values.ToVecInt());
-} // MeWeightMatcherUnitTests::testPythonVectors
+  int nBlossom = 2 * m_nVertex;
+  m_nSingle = m_nVertex;
+  m_mate.assign(m_nVertex, -1);
+  m_label.assign(nBlossom, 0);
+  m_labelEnd.assign(nBlossom, -1);
+  m_inBlossom.resize(m_nVertex);
+  std::iota(m_inBlossom.begin(), m_inBlossom.end(), 0);
+  m_blossomParent.assign(nBlossom, -1);
+  m_blossomChildren.resize(nBlossom);
+  m_blossomEndPts.resize(nBlossom);
+  for (int b = m_nVertex; b < nBlossom; ++b)
+  {
+    m_blossomChildren[b].clear();
+    m_blossomEndPts[b].clear();
+  }
+  m_blossomBase.assign(nBlossom, -1);
+  std::iota(m_blossomBase.begin(), m_blossomBase.begin() + m_nVertex, 0);
+  m_unusedBlossoms.resize(m_nVertex);
+  std::iota(m_unusedBlossoms.begin(), m_unusedBlossoms.end(), m_nVertex);
+
+  m_dualVar.assign(nBlossom, 0);
+  std::fill(m_dualVar.begin(), m_dualVar.begin() + m_nVertex, m_maxWeight);
+  m_dualTime.assign(nBlossom, 0);
+  m_dualRate.assign(nBlossom, 0);
+  m_delta = 0;
+
+  m_root.assign(nBlossom, -1);
+  m_treeBlossoms.resize(m_nVertex);
+  for (auto& blossoms : m_treeBlossoms)
+  {
+    blossoms.clear();
+  }
+  m_queue.clear();
+  m_freeEdges = MinHeap();
+  m_sEdges = MinHeap();
+  m_tBlossoms = MinHeap();
+} // MeFastWeightMatcherImpl::Init
 //------------------------------------------------------------------------------
-/// \brief Test empty input graph.
+/// \brief Get the current dual variable of a vertex or blossom.
+/// \param[in] a_x The vertex or blossom.
+/// \return 2 * u(v) for a vertex or z(b) for a blossom.
 //------------------------------------------------------------------------------
-void MeWeightMatcherUnitTests::test10_empty()
+int MeFastWeightMatcherImpl::Dual(int a_x) const
 {
-#ifdef DEBUG
-  printf("test10_empty\n\n");
-#endif
-  TS_ASSERT_MATCH_WEIGHTS({}, {}, false);
-} // MeWeightMatcherUnitTests::test10_empty
+  return m_dualVar[a_x] + m_dualRate[a_x] * (m_delta - m_dualTime[a_x]);
+} // MeFastWeightMatcherImpl::Dual
 //------------------------------------------------------------------------------
-/// \brief Test single edge.
+/// \brief Set how a dual variable changes with the deltas from now on. Must be
+/// called whenever a vertex or blossom changes label or stops being top-level.
+/// \param[in] a_x The vertex or blossom.
+/// \param[in] a_rate -1 for S-vertices and T-blossoms, 1 for T-vertices and
+/// S-blossoms and 0 otherwise.
 //------------------------------------------------------------------------------
-void MeWeightMatcherUnitTests::test11_singleedge()
+void MeFastWeightMatcherImpl::SetDualRate(int a_x, int a_rate)
 {
-#ifdef DEBUG
-  printf("test11_singleedge\n\n");
-#endif
-  VecInt2d edges = {{0, 1, 1}};
-  VecInt expected = {1, 0};
-  TS_ASSERT_MATCH_WEIGHTS(expected, edges, false);
-} // MeWeightMatcherUnitTests::test11_singleedge
+  m_dualVar[a_x] = Dual(a_x);
+  m_dualTime[a_x] = m_delta;
+  m_dualRate[a_x] = a_rate;
+} // MeFastWeightMatcherImpl::SetDualRate
 //------------------------------------------------------------------------------
-/// \brief Test with two edges.
+/// \brief Return 2 * slack of an edge (does not work inside blossoms).
+/// \param[in] a_k The index of the edge.
+/// \return 2 * slack of the edge.
 //------------------------------------------------------------------------------
-void MeWeightMatcherUnitTests::test12()
+int MeFastWeightMatcherImpl::Slack(int a_k) const
 {
-#ifdef DEBUG
-  printf("test12\n\n");
-#endif
-  VecInt2d edges = {{1, 2, 10}, {2, 3, 11}};
-  VecInt expected = {-1, -1, 3, 2};
-  TS_ASSERT_MATCH_WEIGHTS(expected, edges, false);
-} // MeWeightMatcherUnitTests::test12
+  return Dual(m_endPoint[2 * a_k]) + Dual(m_endPoint[2 * a_k + 1]) - 2 * m_weight[a_k];
+} // MeFastWeightMatcherImpl::Slack
 //------------------------------------------------------------------------------
-/// \brief Test with three edges.
+/// \brief Append the vertices of a blossom to a vector.
+/// \param[in] a_b The blossom.
+/// \param[in,out] a_leaves The vector the vertices are appended to.
 //------------------------------------------------------------------------------
-void MeWeightMatcherUnitTests::test13()
+void MeFastWeightMatcherImpl::BlossomLeaves(int a_b, VecInt& a_leaves)
 {
-#ifdef DEBUG
-  printf("test13\n\n");
-#endif
-  VecInt2d edges = {{1, 2, 5}, {2, 3, 11}, {3, 4, 5}};
-  VecInt expected = {-1, -1, 3, 2, -1};
-  TS_ASSERT_MATCH_WEIGHTS(expected, edges, false);
-} // MeWeightMatcherUnitTests::test13
+  m_stack.assign(1, a_b);
+  while (!m_stack.empty())
+  {
+    int b = m_stack.back();
+    m_stack.pop_back();
+    if (b < m_nVertex)
+    {
+      a_leaves.push_back(b);
+    }
+    else
+    {
+      m_stack.insert(m_stack.end(), m_blossomChildren[b].rbegin(), m_blossomChildren[b].rend());
+    }
+  }
+} // MeFastWeightMatcherImpl::BlossomLeaves
 //------------------------------------------------------------------------------
-/// \brief Test maximum cardinality.
+/// \brief Assign label t to the top-level blossom containing vertex w and
+/// record the fact that w was reached through the edge with remote endpoint p.
+/// \param[in] a_w A vertex index.
+/// \param[in] a_t The label to assign.
+/// \param[in] a_p The remote end point or -1 for the root of a tree.
 //------------------------------------------------------------------------------
-void MeWeightMatcherUnitTests::test14_maxcard()
+void MeFastWeightMatcherImpl::AssignLabel(int a_w, int a_t, int a_p)
 {
-#ifdef DEBUG
-  printf("test14_maxcard\n\n");
-#endif
-  VecInt2d edges = {{1, 2, 5}, {2, 3, 11}, {3, 4, 5}};
-  VecInt expected = {-1, 2, 1, 4, 3};
-  TS_ASSERT_MATCH_WEIGHTS(expected, edges, true);
-} // MeWeightMatcherUnitTests::test14_maxcard
+  int b = m_inBlossom[a_w];
+  XM_ASSERT(m_label[a_w] == 0 && m_label[b] == 0);
+  m_label[a_w] = m_label[b] = a_t;
+  m_labelEnd[a_w] = m_labelEnd[b] = a_p;
+  int root = a_p == -1 ? a_w : m_root[m_inBlossom[m_endPoint[a_p]]];
+  m_root[b] = root;
+  m_treeBlossoms[root].push_back(b);
+
+  m_leaves.clear();
+  BlossomLeaves(b, m_leaves);
+  if (a_t == 1)
+  {
+    // b became an S-vertex/blossom; add its vertices to the queue.
+    for (int v : m_leaves)
+    {
+      SetDualRate(v, -1);
+      m_queue.push_back(v);
+    }
+    if (b >= m_nVertex)
+    {
+      SetDualRate(b, 1);
+    }
+  }
+  else if (a_t == 2)
+  {
+    for (int v : m_leaves)
+    {
+      SetDualRate(v, 1);
+    }
+    if (b >= m_nVertex)
+    {
+      SetDualRate(b, -1);
+      m_tBlossoms.push(std::make_pair(Dual(b) + m_delta, b));
+    }
+    // b became a T-vertex/blossom; assign label S to its mate.
+    int mateBase = m_mate[m_blossomBase[b]];
+    XM_ASSERT(mateBase >= 0);
+    AssignLabel(m_endPoint[mateBase], 1, mateBase ^ 1);
+  }
+} // MeFastWeightMatcherImpl::AssignLabel
 //------------------------------------------------------------------------------
-/// \brief Test negative weights.
+/// \brief Scan the neighbours of an S-vertex labeling, making blossoms and
+/// augmenting through tight edges and queueing the other edges for the deltas.
+/// \param[in] a_v The S-vertex.
 //------------------------------------------------------------------------------
-void MeWeightMatcherUnitTests::test16_negative()
+void MeFastWeightMatcherImpl::ScanVertex(int a_v)
 {
-#ifdef DEBUG
-  printf("test16_negative\n\n");
-#endif
-  VecInt2d edges = {{1, 2, 2}, {1, 3, -2}, {2, 3, 1}, {2, 4, -1}, {3, 4, -6}};
-  VecInt expected = {-1, 2, 1, -1, -1};
-  TS_ASSERT_MATCH_WEIGHTS(expected, edges, false);
-#ifdef DEBUG
-  printf("test16_negative-true\n\n");
-#endif
+  for (int idx = m_neighbStart[a_v]; idx < m_neighbStart[a_v + 1]; ++idx)
+  {
+    int p = m_neighbEnd[idx];
+    int k = p / 2;
+    int w = m_endPoint[p];
+    int bw = m_inBlossom[w];
+    if (m_inBlossom[a_v] == bw)
+    {
+      // this edge is internal to a blossom; ignore it
+      continue;
+    }
+
+    int kslack = Slack(k);
+    if (kslack <= 0)
+    {
+      if (m_label[bw] == 0)
+      {
+        // (C1) w is a free vertex;
+        // label w with T and label its mate with S (R12).
+        AssignLabel(w, 2, p ^ 1);
+      }
+      else if (m_label[bw] == 1)
+      {
+        // (C2) w is an S-vertex (not in the same blossom);
+        // follow back-links to discover either an
+        // augmenting path or a new blossom.
+        int base = ScanBlossom(a_v, w);
+        if (base >= 0)
+        {
+          AddBlossom(base, k);
+        }
+        else
+        {
+          // a_v is no longer labeled after the augmentation
+          AugmentMatching(k);
+          return;
+        }
+      }
+      else if (m_label[w] == 0)
+      {
+        // w is inside a T-blossom, but w itself has not
+        // yet been reached from outside the blossom;
+        // mark it as reached (we need this to relabel
+        // during T-blossom expansion).
+        m_label[w] = 2;
+        m_labelEnd[w] = p ^ 1;
+      }
+    }
+    else if (m_label[bw] == 1)
+    {
+      m_sEdges.push(std::make_pair(kslack / 2 + m_delta, k));
+    }
+    else if (m_label[bw] == 0)
+    {
+      m_freeEdges.push(std::make_pair(kslack + m_delta, k));
+    }
+  }
+} // MeFastWeightMatcherImpl::ScanVertex
+//------------------------------------------------------------------------------
+/// \brief Trace back from vertices v and w to discover either a new blossom
+/// or an augmenting path.
+/// \param[in] a_v A vertex index
+/// \param[in] a_w Another vertex index
+/// \return The base vertex of the new blossom or -1.
+//------------------------------------------------------------------------------
+int MeFastWeightMatcherImpl::ScanBlossom(int a_v, int a_w)
+{
+  // Trace back from v and w, placing breadcrumbs as we go.
+  m_stack.clear();
+  int base = -1;
+  while (a_v != -1 || a_w != -1)
+  {
+    // Look for a breadcrumb in v's blossom or put a new breadcrumb.
+    int b = m_inBlossom[a_v];
+    if (m_label[b] & 4)
+    {
+      base = m_blossomBase[b];
+      break;
+    }
+    XM_ASSERT(m_label[b] == 1);
+    m_stack.push_back(b);
+    m_label[b] = 5;
+    // Trace one step back.
+    if (m_labelEnd[b] == -1)
+    {
+      // The base of blossom b is single; stop tracing this path.
+      a_v = -1;
+    }
+    else
+    {
+      a_v = m_endPoint[m_labelEnd[b]];
+      b = m_inBlossom[a_v];
+      XM_ASSERT(m_label[b] == 2);
+      // b is a T-blossom; trace one more step back.
+      a_v = m_endPoint[m_labelEnd[b]];
+    }
+    // Swap v and w so that we alternate between both paths.
+    if (a_w != -1)
+    {
+      std::swap(a_v, a_w);
+    }
+  }
+  // Remove breadcrumbs.
+  for (int b : m_stack)
+  {
+    m_label[b] = 1;
+  }
+  return base;
+} // MeFastWeightMatcherImpl::ScanBlossom
+//------------------------------------------------------------------------------
+/// \brief Construct a new blossom with given base, containing edge k which
+/// connects a pair of S vertices. Label the new blossom as S; set its dual
+/// variable to zero; relabel its T-vertices to S and add them to the queue.
+/// \param[in] a_base A vertex index
+/// \param[in] a_k An edge index
+//------------------------------------------------------------------------------
+void MeFastWeightMatcherImpl::AddBlossom(int a_base, int a_k)
+{
+  int v = m_endPoint[2 * a_k];
+  int w = m_endPoint[2 * a_k + 1];
+  int bb = m_inBlossom[a_base];
+  int bv = m_inBlossom[v];
+  int bw = m_inBlossom[w];
+  // Create blossom.
+  int b = m_unusedBlossoms.back();
+  m_unusedBlossoms.pop_back();
+  m_blossomBase[b] = a_base;
+  m_blossomParent[b] = -1;
+  m_blossomParent[bb] = b;
+  // Make list of sub-blossoms and their interconnecting edge endpoints.
+  VecInt& path = m_blossomChildren[b];
+  VecInt& endps = m_blossomEndPts[b];
+  path.clear();
+  endps.clear();
+  // Trace back from v to base.
+  while (bv != bb)
+  {
+    m_blossomParent[bv] = b;
+    path.push_back(bv);
+    endps.push_back(m_labelEnd[bv]);
+    v = m_endPoint[m_labelEnd[bv]];
+    bv = m_inBlossom[v];
+  }
+  // Reverse lists, add endpoint that connects the pair of S vertices.
+  path.push_back(bb);
+  std::reverse(path.begin(), path.end());
+  std::reverse(endps.begin(), endps.end());
+  endps.push_back(2 * a_k);
+  // Trace back from w to base.
+  while (bw != bb)
+  {
+    m_blossomParent[bw] = b;
+    path.push_back(bw);
+    endps.push_back(m_labelEnd[bw] ^ 1);
+    w = m_endPoint[m_labelEnd[bw]];
+    bw = m_inBlossom[w];
+  }
+  // Set label to S and dual variable to zero.
+  XM_ASSERT(m_label[bb] == 1);
+  m_label[b] = 1;
+  m_labelEnd[b] = m_labelEnd[bb];
+  m_root[b] = m_root[bb];
+  m_treeBlossoms[m_root[b]].push_back(b);
+  m_dualVar[b] = 0;
+  m_dualTime[b] = m_delta;
+  m_dualRate[b] = 1;
+  for (int sub : path)
+  {
+    if (sub >= m_nVertex)
+    {
+      SetDualRate(sub, 0);
+    }
+  }
+  // Relabel vertices.
+  m_leaves.clear();
+  BlossomLeaves(b, m_leaves);
+  for (int leaf : m_leaves)
+  {
+    if (m_label[m_inBlossom[leaf]] == 2)
+    {
+      // This T-vertex now turns into an S-vertex because it becomes
+      // part of an S-blossom; add it to the queue.
+      m_queue.push_back(leaf);
+    }
+    m_inBlossom[leaf] = b;
+    SetDualRate(leaf, -1);
+  }
+} // MeFastWeightMatcherImpl::AddBlossom
+//------------------------------------------------------------------------------
+/// \brief Expand the given top-level blossom.
+/// \param[in] a_b The blossom.
+/// \param[in] a_endStage True if the blossom is an S-blossom of a tree being
+/// removed, false if it is a T-blossom whose dual reached zero.
+//------------------------------------------------------------------------------
+void MeFastWeightMatcherImpl::ExpandBlossom(int a_b, bool a_endStage)
+{
+  VecInt& children = m_blossomChildren[a_b];
+  VecInt& endps = m_blossomEndPts[a_b];
+  int size = (int)children.size();
+  VecInt leaves;
+  SetDualRate(a_b, 0);
+  if (!a_endStage)
+  {
+    // the sub-blossoms get new labels below
+    BlossomLeaves(a_b, leaves);
+    for (int v : leaves)
+    {
+      SetDualRate(v, 0);
+    }
+  }
+
+  // Convert sub-blossoms into top-level blossoms.
+  for (int s : children)
+  {
+    m_blossomParent[s] = -1;
+    if (s < m_nVertex)
+    {
+      m_inBlossom[s] = s;
+    }
+    else if (a_endStage && Dual(s) == 0)
+    {
+      // Recursively expand this sub-blossom.
+      ExpandBlossom(s, a_endStage);
+    }
+    else
+    {
+      leaves.clear();
+      BlossomLeaves(s, leaves);
+      for (int v : leaves)
+      {
+        m_inBlossom[v] = s;
+      }
+    }
+  }
+
+  // If we expand a T-blossom its sub-blossoms must be relabeled.
+  if (!a_endStage && m_label[a_b] == 2)
+  {
+    // Start at the sub-blossom through which the expanding
+    // blossom obtained its label, and relabel sub-blossoms until
+    // we reach the base.
+    int entryChild = m_inBlossom[m_endPoint[m_labelEnd[a_b] ^ 1]];
+    int j = (int)(std::find(children.begin(), children.end(), entryChild) - children.begin());
+    // Decide in which direction we will go round the blossom.
+    int jstep = -1;
+    int endptrick = 1;
+    if (j & 1)
+    {
+      // Start index is odd; go forward and wrap.
+      j -= size;
+      jstep = 1;
+      endptrick = 0;
+    }
+
+    // Move along the blossom until we get to the base.
+    int p = m_labelEnd[a_b];
+    while (j != 0)
+    {
+      // Relabel the T-sub-blossom.
+      m_label[m_endPoint[p ^ 1]] = 0;
+      m_label[m_endPoint[endps[iWrap(j - endptrick, size)] ^ endptrick ^ 1]] = 0;
+      AssignLabel(m_endPoint[p ^ 1], 2, p);
+      // Step to the next S-sub-blossom and note its forward endpoint.
+      j += jstep;
+      p = endps[iWrap(j - endptrick, size)] ^ endptrick;
+      // Step to the next T-sub-blossom.
+      j += jstep;
+    }
+    // Relabel the base T-sub-blossom WITHOUT stepping through to
+    // its mate (so don't call AssignLabel).
+    int bv = children[iWrap(j, size)];
+    m_label[m_endPoint[p ^ 1]] = m_label[bv] = 2;
+    m_labelEnd[m_endPoint[p ^ 1]] = m_labelEnd[bv] = p;
+    m_root[bv] = m_root[a_b];
+    m_treeBlossoms[m_root[bv]].push_back(bv);
+    leaves.clear();
+    BlossomLeaves(bv, leaves);
+    for (int v : leaves)
+    {
+      SetDualRate(v, 1);
+    }
+    if (bv >= m_nVertex)
+    {
+      SetDualRate(bv, -1);
+      m_tBlossoms.push(std::make_pair(Dual(bv) + m_delta, bv));
+    }
+    // Continue along the blossom until we get back to entryChild.
+    j += jstep;
+    while (children[iWrap(j, size)] != entryChild)
+    {
+      // Examine the vertices of the sub-blossom to see whether
+      // it is reachable from a neighbouring S-vertex outside the
+      // expanding blossom.
+      bv = children[iWrap(j, size)];
+      j += jstep;
+      if (m_label[bv] == 1)
+      {
+        // This sub-blossom just got label S through one of its
+        // neighbours; leave it.
+        continue;
+      }
+      leaves.clear();
+      BlossomLeaves(bv, leaves);
+      auto reached =
+        std::find_if(leaves.begin(), leaves.end(), [&](int v) { return m_label[v] != 0; });
+      // If the sub-blossom contains a reachable vertex, assign
+      // label T to the sub-blossom.
+      if (reached != leaves.end())
+      {
+        int v = *reached;
+        m_label[v] = 0;
+        m_label[m_endPoint[m_mate[m_blossomBase[bv]]]] = 0;
+        AssignLabel(v, 2, m_labelEnd[v]);
+      }
+    }
+
+    // Sub-blossoms left unlabeled are now free.
+    for (int s : children)
+    {
+      if (m_label[s] == 0)
+      {
+        leaves.clear();
+        BlossomLeaves(s, leaves);
+        for (int v : leaves)
+        {
+          FreeVertex(v);
+        }
+      }
+    }
+  }
+
+  // Recycle the blossom number.
+  m_label[a_b] = m_labelEnd[a_b] = m_root[a_b] = -1;
+  children.clear();
+  endps.clear();
+  m_blossomBase[a_b] = -1;
+  m_unusedBlossoms.push_back(a_b);
+} // MeFastWeightMatcherImpl::ExpandBlossom
+//------------------------------------------------------------------------------
+/// \brief Swap matched/unmatched edges over an alternating path through
+/// blossom b between vertex v and the base vertex. Keep blossom bookkeeping
+/// consistent.
+/// \param[in] a_b The blossom.
+/// \param[in] a_v The vertex.
+//------------------------------------------------------------------------------
+void MeFastWeightMatcherImpl::AugmentBlossom(int a_b, int a_v)
+{
+  // Bubble up through the blossom tree from vertex v to an immediate
+  // sub-blossom of b.
+  int t = a_v;
+  while (m_blossomParent[t] != a_b)
+  {
+    t = m_blossomParent[t];
+  }
+  // Recursively deal with the first sub-blossom.
+  if (t >= m_nVertex)
+  {
+    AugmentBlossom(t, a_v);
+  }
+  VecInt& children = m_blossomChildren[a_b];
+  VecInt& endps = m_blossomEndPts[a_b];
+  int size = (int)children.size();
+  // Decide in which direction we will go round the blossom.
+  int i = (int)(std::find(children.begin(), children.end(), t) - children.begin());
+  int j = i;
+  int jstep = -1;
+  int endptrick = 1;
+  if (i & 1)
+  {
+    // Start index is odd; go forward and wrap.
+    j -= size;
+    jstep = 1;
+    endptrick = 0;
+  }
+  // Move along the blossom until we get to the base.
+  while (j != 0)
+  {
+    // Step to the next sub-blossom and augment it recursively.
+    j += jstep;
+    t = children[iWrap(j, size)];
+    int p = endps[iWrap(j - endptrick, size)] ^ endptrick;
+    if (t >= m_nVertex)
+    {
+      AugmentBlossom(t, m_endPoint[p]);
+    }
+    // Step to the next sub-blossom and augment it recursively.
+    j += jstep;
+    t = children[iWrap(j, size)];
+    if (t >= m_nVertex)
+    {
+      AugmentBlossom(t, m_endPoint[p ^ 1]);
+    }
+    // Match the edge connecting those sub-blossoms.
+    m_mate[m_endPoint[p]] = p ^ 1;
+    m_mate[m_endPoint[p ^ 1]] = p;
+  }
+  // Rotate the list of sub-blossoms to put the new base at the front.
+  std::rotate(children.begin(), children.begin() + i, children.end());
+  std::rotate(endps.begin(), endps.begin() + i, endps.end());
+  m_blossomBase[a_b] = m_blossomBase[children[0]];
+  XM_ASSERT(m_blossomBase[a_b] == a_v);
+} // MeFastWeightMatcherImpl::AugmentBlossom
+//------------------------------------------------------------------------------
+/// \brief Swap matched/unmatched edges over an alternating path between
+/// two single vertices and remove the two trees of the path. The augmenting
+/// path runs through edge k which connects a pair of S vertices.
+/// \param[in] a_k The edge index.
+//------------------------------------------------------------------------------
+void MeFastWeightMatcherImpl::AugmentMatching(int a_k)
+{
+  int roots[] = {m_root[m_inBlossom[m_endPoint[2 * a_k]]],
+                 m_root[m_inBlossom[m_endPoint[2 * a_k + 1]]]};
+  for (int end = 0; end < 2; ++end)
+  {
+    int s = m_endPoint[2 * a_k + end];
+    int p = 2 * a_k + 1 - end;
+    // Match vertex s to remote endpoint p. Then trace back from s
+    // until we find a single vertex, swapping matched and unmatched
+    // edges as we go.
+    while (true)
+    {
+      int bs = m_inBlossom[s];
+      XM_ASSERT(m_label[bs] == 1);
+      // Augment through the S-blossom from s to base.
+      if (bs >= m_nVertex)
+      {
+        AugmentBlossom(bs, s);
+      }
+      m_mate[s] = p;
+      // Trace one step back.
+      if (m_labelEnd[bs] == -1)
+      {
+        // Reached single vertex; stop.
+        break;
+      }
+      int t = m_endPoint[m_labelEnd[bs]];
+      int bt = m_inBlossom[t];
+      XM_ASSERT(m_label[bt] == 2);
+      // Trace one step back.
+      s = m_endPoint[m_labelEnd[bt]];
+      int j = m_endPoint[m_labelEnd[bt] ^ 1];
+      // Augment through the T-blossom from j to base.
+      if (bt >= m_nVertex)
+      {
+        AugmentBlossom(bt, j);
+      }
+      m_mate[j] = m_labelEnd[bt];
+      // Keep the opposite endpoint;
+      // it will be assigned to m_mate[s] in the next step.
+      p = m_labelEnd[bt] ^ 1;
+    }
+  }
+  m_nSingle -= 2;
+
+  // The vertices of both trees are now matched and free.
+  m_leaves.clear();
+  FreeTree(roots[0]);
+  FreeTree(roots[1]);
+  for (int v : m_leaves)
+  {
+    FreeVertex(v);
+  }
+} // MeFastWeightMatcherImpl::AugmentMatching
+//------------------------------------------------------------------------------
+/// \brief Remove the labels of the blossoms in a tree and expand its
+/// S-blossoms with a zero dual. The vertices of the tree are appended to
+/// m_leaves.
+/// \param[in] a_root The root vertex of the tree.
+//------------------------------------------------------------------------------
+void MeFastWeightMatcherImpl::FreeTree(int a_root)
+{
+  VecInt& blossoms = m_treeBlossoms[a_root];
+  for (int b : blossoms)
+  {
+    // skip blossoms that have since been nested, expanded or relabeled
+    if (m_blossomParent[b] != -1 || m_label[b] <= 0 || m_root[b] != a_root)
+    {
+      continue;
+    }
+
+    int label = m_label[b];
+    size_t first = m_leaves.size();
+    BlossomLeaves(b, m_leaves);
+    for (size_t i = first; i < m_leaves.size(); ++i)
+    {
+      int v = m_leaves[i];
+      SetDualRate(v, 0);
+      m_label[v] = 0;
+      m_labelEnd[v] = -1;
+    }
+    m_label[b] = 0;
+    m_labelEnd[b] = -1;
+    m_root[b] = -1;
+    if (b >= m_nVertex)
+    {
+      SetDualRate(b, 0);
+      // clear the labels the sub-blossoms had when they were top-level
+      m_stack.assign(1, b);
+      while (!m_stack.empty())
+      {
+        int parent = m_stack.back();
+        m_stack.pop_back();
+        for (int s : m_blossomChildren[parent])
+        {
+          if (s >= m_nVertex)
+          {
+            m_label[s] = 0;
+            m_labelEnd[s] = -1;
+            m_stack.push_back(s);
+          }
+        }
+      }
+      if (label == 1 && Dual(b) == 0)
+      {
+        ExpandBlossom(b, true);
+      }
+    }
+  }
+  blossoms.clear();
+} // MeFastWeightMatcherImpl::FreeTree
+//------------------------------------------------------------------------------
+/// \brief Queue the edges between a vertex that became free and the S-vertices
+/// of other trees.
+/// \param[in] a_v The vertex.
+//------------------------------------------------------------------------------
+void MeFastWeightMatcherImpl::FreeVertex(int a_v)
+{
+  int bv = m_inBlossom[a_v];
+  for (int idx = m_neighbStart[a_v]; idx < m_neighbStart[a_v + 1]; ++idx)
+  {
+    int p = m_neighbEnd[idx];
+    int w = m_endPoint[p];
+    int bw = m_inBlossom[w];
+    if (bw == bv)
+    {
+      continue;
+    }
+
+    if (m_label[bw] == 1)
+    {
+      int kslack = Slack(p / 2);
+      if (kslack <= 0)
+      {
+        // rescan w to label the tree through this tight edge
+        m_queue.push_back(w);
+      }
+      else
+      {
+        m_freeEdges.push(std::make_pair(kslack + m_delta, p / 2));
+      }
+    }
+    else if (m_label[bw] == 2 && m_label[w] == 2 && bw != w &&
+             m_endPoint[m_labelEnd[w]] == a_v)
+    {
+      // w was reached from a_v when a_v was an S-vertex
+      m_label[w] = 0;
+      m_labelEnd[w] = -1;
+    }
+  }
+} // MeFastWeightMatcherImpl::FreeVertex
+//------------------------------------------------------------------------------
+/// \brief Find the smallest delta that keeps the dual feasible.
+/// \param[in] a_maxCardinality True to find a maximum cardinality matching.
+/// \param[out] a_deltaType The type of the delta from 1 to 4.
+/// \param[out] a_delta The delta.
+/// \param[out] a_deltaIdx The edge for delta 2 and 3 or the blossom for 4.
+/// \return false if no further improvement is possible.
+//------------------------------------------------------------------------------
+bool MeFastWeightMatcherImpl::FindDelta(bool a_maxCardinality,
+                                        int& a_deltaType,
+                                        int& a_delta,
+                                        int& a_deltaIdx)
+{
+  a_deltaType = -1;
+  a_delta = 0;
+  a_deltaIdx = -1;
+
+  // delta1: the minimum value of any vertex dual. All single vertices are
+  // roots of trees with the minimum dual.
+  if (!a_maxCardinality)
+  {
+    if (m_nSingle == 0)
+    {
+      return false;
+    }
+    a_deltaType = 1;
+    a_delta = m_maxWeight - m_delta;
+  }
+
+  // Entries that no longer match the labels or the slack are stale.
+  // delta2: the minimum slack on any edge between an S-vertex and a free
+  // vertex.
+  while (!m_freeEdges.empty())
+  {
+    int k = m_freeEdges.top().second;
+    int key = m_freeEdges.top().first - m_delta;
+    int li = m_label[m_inBlossom[m_endPoint[2 * k]]];
+    int lj = m_label[m_inBlossom[m_endPoint[2 * k + 1]]];
+    if (li + lj == 1 && Slack(k) == key)
+    {
+      if (a_deltaType == -1 || key < a_delta)
+      {
+        a_deltaType = 2;
+        a_delta = key;
+        a_deltaIdx = k;
+      }
+      break;
+    }
+    m_freeEdges.pop();
+  }
+
+  // delta3: half the minimum slack on any edge between a pair of S-blossoms.
+  while (!m_sEdges.empty())
+  {
+    int k = m_sEdges.top().second;
+    int key = m_sEdges.top().first - m_delta;
+    int bi = m_inBlossom[m_endPoint[2 * k]];
+    int bj = m_inBlossom[m_endPoint[2 * k + 1]];
+    if (bi != bj && m_label[bi] == 1 && m_label[bj] == 1 && Slack(k) == 2 * key)
+    {
+      if (a_deltaType == -1 || key < a_delta)
+      {
+        a_deltaType = 3;
+        a_delta = key;
+        a_deltaIdx = k;
+      }
+      break;
+    }
+    m_sEdges.pop();
+  }
+
+  // delta4: minimum z variable of any T-blossom.
+  while (!m_tBlossoms.empty())
+  {
+    int b = m_tBlossoms.top().second;
+    int key = m_tBlossoms.top().first - m_delta;
+    if (m_blossomBase[b] >= 0 && m_blossomParent[b] == -1 && m_label[b] == 2 && Dual(b) == key)
+    {
+      if (a_deltaType == -1 || key < a_delta)
+      {
+        a_deltaType = 4;
+        a_delta = key;
+        a_deltaIdx = b;
+      }
+      break;
+    }
+    m_tBlossoms.pop();
+  }
+  return a_deltaType != -1;
+} // MeFastWeightMatcherImpl::FindDelta
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MeApproxWeightMatcherImpl
+/// \brief Approximate maximum weight matcher that runs in near linear time.
+///
+/// The edges are matched greedily from the heaviest down which gives at least
+/// half of the maximum weight. The matching is then improved by local
+/// augmentations that replace a matched edge with the best edges from its two
+/// vertices to single vertices.
+////////////////////////////////////////////////////////////////////////////////
+class MeApproxWeightMatcherImpl : public MeWeightMatcher
+{
+public:
+  virtual VecInt MatchWeights(const VecMeEdge& a_edges, bool a_maxCardinality = false) override;
+
+  void BestSingleNeighbors(const VecMeEdge& a_edges,
+                           int a_v,
+                           int a_exclude,
+                           bool a_maxCardinality,
+                           int a_best[2]);
+  bool Augment(const VecMeEdge& a_edges, int a_k, bool a_maxCardinality);
+
+  VecInt m_neighbStart; ///< Start of the edges of vertex v in m_neighbEdges.
+  VecInt m_neighbEdges; ///< Edges attached to each vertex.
+  VecInt m_mate;        ///< Matched edge of each vertex or -1.
+};
+
+//------------------------------------------------------------------------------
+/// \brief Approximate the maximum weight matching.
+/// \param[in] a_edges The edges to operate on. Each edge identifies a pair of
+/// adjacent faces and weight to prioritize against other edges.
+/// \param[in] a_maxCardinality When true prefer matching more vertices over
+/// weight. Edges with a weight of zero or less are only used when true.
+/// \return A vector v of integers where v[i] is -1 if face i isn't matched.
+/// Otherwise, face i is matched to face v[i].
+//------------------------------------------------------------------------------
+VecInt MeApproxWeightMatcherImpl::MatchWeights(const VecMeEdge& a_edges,
+                                               bool a_maxCardinality /* = false*/)
+{
+  int nEdge = (int)a_edges.size();
+  int nVertex = 0;
+  for (auto& edge : a_edges)
+  {
+    nVertex = std::max(nVertex, std::max(edge.m_f0, edge.m_f1) + 1);
+  }
+  if (nEdge == 0)
+  {
+    return VecInt();
+  }
+
+  m_neighbStart.assign(nVertex + 1, 0);
+  for (auto& edge : a_edges)
+  {
+    ++m_neighbStart[edge.m_f0 + 1];
+    ++m_neighbStart[edge.m_f1 + 1];
+  }
+  std::partial_sum(m_neighbStart.begin(), m_neighbStart.end(), m_neighbStart.begin());
+  VecInt next(m_neighbStart.begin(), m_neighbStart.end() - 1);
+  m_neighbEdges.resize(2 * nEdge);
+  for (int k = 0; k < nEdge; ++k)
+  {
+    m_neighbEdges[next[a_edges[k].m_f0]++] = k;
+    m_neighbEdges[next[a_edges[k].m_f1]++] = k;
+  }
+
+  // greedy matching from the heaviest edge
+  VecInt order;
+  order.reserve(nEdge);
+  for (int k = 0; k < nEdge; ++k)
+  {
+    if (a_maxCardinality || a_edges[k].m_weight > 0)
+    {
+      order.push_back(k);
+    }
+  }
+  std::sort(order.begin(), order.end(), [&](int a_k0, int a_k1) {
+    if (a_edges[a_k0].m_weight != a_edges[a_k1].m_weight)
+      return a_edges[a_k0].m_weight > a_edges[a_k1].m_weight;
+    return a_k0 < a_k1;
+  });
+  auto matchGreedily = [&]() {
+    for (int k : order)
+    {
+      const MeEdge& edge = a_edges[k];
+      if (m_mate[edge.m_f0] == -1 && m_mate[edge.m_f1] == -1)
+      {
+        m_mate[edge.m_f0] = m_mate[edge.m_f1] = k;
+      }
+    }
+  };
+  m_mate.assign(nVertex, -1);
+  matchGreedily();
+
+  // a few passes of local augmentations; each pass is linear
+  const int MAX_PASSES = 3;
+  bool improved = true;
+  for (int pass = 0; pass < MAX_PASSES && improved; ++pass)
+  {
+    improved = false;
+    for (int k : order)
+    {
+      if (m_mate[a_edges[k].m_f0] == k && Augment(a_edges, k, a_maxCardinality))
+      {
+        improved = true;
+      }
+    }
+    // match vertices left single by replacing an edge with one edge
+    matchGreedily();
+  }
+
+  VecInt mates(nVertex, -1);
+  for (int v = 0; v < nVertex; ++v)
+  {
+    int k = m_mate[v];
+    if (k != -1)
+    {
+      mates[v] = a_edges[k].m_f0 == v ? a_edges[k].m_f1 : a_edges[k].m_f0;
+    }
+  }
+  return mates;
+} // MeApproxWeightMatcherImpl::MatchWeights
+//------------------------------------------------------------------------------
+/// \brief Find the two heaviest edges from a vertex to different single
+/// vertices.
+/// \param[in] a_edges The edges.
+/// \param[in] a_v The vertex.
+/// \param[in] a_exclude A vertex to skip.
+/// \param[in] a_maxCardinality If false edges with a weight of zero or less
+/// are skipped.
+/// \param[out] a_best The heaviest and second heaviest edges or -1.
+//------------------------------------------------------------------------------
+void MeApproxWeightMatcherImpl::BestSingleNeighbors(const VecMeEdge& a_edges,
+                                                    int a_v,
+                                                    int a_exclude,
+                                                    bool a_maxCardinality,
+                                                    int a_best[2])
+{
+  a_best[0] = a_best[1] = -1;
+  for (int idx = m_neighbStart[a_v]; idx < m_neighbStart[a_v + 1]; ++idx)
+  {
+    int k = m_neighbEdges[idx];
+    const MeEdge& edge = a_edges[k];
+    int w = edge.m_f0 == a_v ? edge.m_f1 : edge.m_f0;
+    if (w == a_exclude || m_mate[w] != -1 || (!a_maxCardinality && edge.m_weight <= 0))
+    {
+      continue;
+    }
+    if (a_best[0] == -1 || edge.m_weight > a_edges[a_best[0]].m_weight)
+    {
+      a_best[1] = a_best[0];
+      a_best[0] = k;
+    }
+    else if (a_best[1] == -1 || edge.m_weight > a_edges[a_best[1]].m_weight)
+    {
+      a_best[1] = k;
+    }
+  }
+} // MeApproxWeightMatcherImpl::BestSingleNeighbors
+//------------------------------------------------------------------------------
+/// \brief Try to replace a matched edge (u, v) with edges (a, u) and/or
+/// (v, b) to single vertices a and b.
+/// \param[in] a_edges The edges.
+/// \param[in] a_k The matched edge.
+/// \param[in] a_maxCardinality True if replacing the edge with two edges is
+/// always better.
+/// \return True if the matching changed.
+//------------------------------------------------------------------------------
+bool MeApproxWeightMatcherImpl::Augment(const VecMeEdge& a_edges, int a_k, bool a_maxCardinality)
+{
+  int u = a_edges[a_k].m_f0;
+  int v = a_edges[a_k].m_f1;
+  int bestU[2], bestV[2];
+  BestSingleNeighbors(a_edges, u, v, a_maxCardinality, bestU);
+  BestSingleNeighbors(a_edges, v, u, a_maxCardinality, bestV);
+  if (bestU[0] == -1 && bestV[0] == -1)
+  {
+    return false;
+  }
+
+  auto weight = [&](int a_edge) { return a_edges[a_edge].m_weight; };
+  auto other = [&](int a_edge, int a_vertex) {
+    return a_edges[a_edge].m_f0 == a_vertex ? a_edges[a_edge].m_f1 : a_edges[a_edge].m_f0;
+  };
+
+  // the best pair of edges to different single vertices
+  int pairU = -1, pairV = -1;
+  for (int i = 0; i < 2; ++i)
+  {
+    for (int j = 0; j < 2; ++j)
+    {
+      if (bestU[i] == -1 || bestV[j] == -1 || other(bestU[i], u) == other(bestV[j], v))
+        continue;
+      if (pairU == -1 || weight(bestU[i]) + weight(bestV[j]) > weight(pairU) + weight(pairV))
+      {
+        pairU = bestU[i];
+        pairV = bestV[j];
+      }
+    }
+  }
+
+  // with max cardinality matching two edges is always better
+  int current = weight(a_k);
+  int newU = -1, newV = -1;
+  if (pairU != -1 && (a_maxCardinality || weight(pairU) + weight(pairV) > current))
+  {
+    newU = pairU;
+    newV = pairV;
+  }
+  else
+  {
+    // replace the edge with a heavier edge to a single vertex
+    int best = current;
+    if (bestU[0] != -1 && weight(bestU[0]) > best)
+    {
+      newU = bestU[0];
+      best = weight(newU);
+    }
+    if (bestV[0] != -1 && weight(bestV[0]) > best)
+    {
+      newU = -1;
+      newV = bestV[0];
+    }
+  }
+  if (newU == -1 && newV == -1)
+  {
+    return false;
+  }
+
+  m_mate[u] = m_mate[v] = -1;
+  for (int k : {newU, newV})
+  {
+    if (k != -1)
+    {
+      m_mate[a_edges[k].m_f0] = m_mate[a_edges[k].m_f1] = k;
+    }
+  }
+  return true;
+} // MeApproxWeightMatcherImpl::Augment
+
+} // namespace
+
+////////////////////////////////////////////////////////////////////////////////
+/// \class MeWeightMatcher
+/// \see MeFastWeightMatcherImpl
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Create new weight matcher.
+/// \return The new MeWeightMatcher.
+//------------------------------------------------------------------------------
+BSHP<MeWeightMatcher> MeWeightMatcher::New()
+{
+  BSHP<MeWeightMatcher> wm(new MeFastWeightMatcherImpl);
+  return wm;
+} // MeWeightMatcher::New
+//------------------------------------------------------------------------------
+/// \brief Create new approximate weight matcher. It is much faster than the
+/// matcher from New but the weight of the matching may be lower.
+/// \return The new MeWeightMatcher.
+/// \see MeApproxWeightMatcherImpl
+//------------------------------------------------------------------------------
+BSHP<MeWeightMatcher> MeWeightMatcher::NewApproximate()
+{
+  BSHP<MeWeightMatcher> wm(new MeApproxWeightMatcherImpl);
+  return wm;
+} // MeWeightMatcher::NewApproximate
+//------------------------------------------------------------------------------
+/// \brief Computes an upper bound of the weight of any matching of the edges.
+/// Half the heaviest positive weight at each vertex is a feasible dual
+/// solution so their sum is at least the maximum weight.
+/// \param[in] a_edges The edges.
+/// \return The upper bound.
+//------------------------------------------------------------------------------
+double MeWeightMatcher::WeightUpperBound(const VecMeEdge& a_edges)
+{
+  VecInt heaviest;
+  for (auto& edge : a_edges)
+  {
+    size_t size = (size_t)std::max(edge.m_f0, edge.m_f1) + 1;
+    if (heaviest.size() < size)
+    {
+      heaviest.resize(size, 0);
+    }
+    heaviest[edge.m_f0] = std::max(heaviest[edge.m_f0], edge.m_weight);
+    heaviest[edge.m_f1] = std::max(heaviest[edge.m_f1], edge.m_weight);
+  }
+  double bound = 0.0;
+  for (int weight : heaviest)
+  {
+    bound += weight;
+  }
+  return bound / 2.0;
+} // MeWeightMatcher::WeightUpperBound
+//------------------------------------------------------------------------------
+/// \brief Constructor.
+//------------------------------------------------------------------------------
+MeWeightMatcher::MeWeightMatcher()
+{
+} // MeWeightMatcher::MeWeightMatcher
+//------------------------------------------------------------------------------
+/// \brief Destructor.
+//------------------------------------------------------------------------------
+MeWeightMatcher::~MeWeightMatcher()
+{
+} // MeWeightMatcher::~MeWeightMatcher
+
+} // namespace xms
+
+#if CXX_TEST
+////////////////////////////////////////////////////////////////////////////////
+// UNIT TESTS
+////////////////////////////////////////////////////////////////////////////////
+
+#include <xmsmesh/meshing/detail/MeWeightMatcher.t.h>
+
+#include <xmscore/testing/TestTools.h>
+#include <xmsinterp/triangulate/TrTriangulatorPoints.h>
+
+//----- Namespace declaration --------------------------------------------------
+
+using namespace xms;
+
+namespace
+{
+/// Helper to run matcher tests.
+#define TS_ASSERT_MATCH_WEIGHTS(a_expected, a_edges, a_cardinality) \
+  _TS_ASSERT_MATCH_WEIGHTS(__FILE__, __LINE__, a_expected, a_edges, a_cardinality)
+/// Helper to run matcher tests.
+#define _TS_ASSERT_MATCH_WEIGHTS(a_file, a_line, a_expected, a_edges, a_cardinality) \
+  iMatchWeights(a_file, a_line, a_expected, a_edges, a_cardinality)
+
+//------------------------------------------------------------------------------
+/// \brief Helper function to create a weight matcher and run a test.
+/// \param[in] a_file The file for the test (this source file).
+/// \param[in] a_line The line iMatchWeights was called from.
+/// \param[in] a_expected The expected matcher output.
+/// \param[in] a_edges The matcher edge input.
+/// \param[in] a_useMaxCardinality Cardinality value passed to matcher.
+//------------------------------------------------------------------------------
+void iMatchWeights(const char* a_file,
+                   int a_line,
+                   const VecInt& a_expected,
+                   const VecInt2d& a_edges,
+                   bool a_useMaxCardinality = false)
+{
+  VecMeEdge edges;
+  for (auto& edgeVec : a_edges)
+  {
+    MeEdge edge(edgeVec[0], edgeVec[1], edgeVec[2]);
+    edges.push_back(edge);
+  }
+
+  MeWeightMatcherImpl weightMatcher;
+  VecInt matchWeights = weightMatcher.MatchWeights(edges, a_useMaxCardinality);
+  _TS_ASSERT_EQUALS(a_file, a_line, a_expected, matchWeights);
+
+  MeFastWeightMatcherImpl fastMatcher;
+  matchWeights = fastMatcher.MatchWeights(edges, a_useMaxCardinality);
+  _TS_ASSERT_EQUALS(a_file, a_line, a_expected, matchWeights);
+} // iTestMatchWeights
+//------------------------------------------------------------------------------
+/// \brief Helper function to get the cardinality and total weight of a
+/// matching.
+/// \param[in] a_edges The matcher edge input.
+/// \param[in] a_mates The matcher output.
+/// \param[out] a_cardinality The number of matched edges.
+/// \return The total weight of the matched edges or -1 if the matching isn't
+/// valid.
+//------------------------------------------------------------------------------
+int iMatchingWeight(const VecMeEdge& a_edges, const VecInt& a_mates, int& a_cardinality)
+{
+  a_cardinality = 0;
+  int weight = 0;
+  for (int v = 0; v < (int)a_mates.size(); ++v)
+  {
+    int w = a_mates[v];
+    if (w >= 0 && a_mates[w] != v)
+      return -1;
+    if (w <= v)
+      continue;
+    // parallel edges have the largest weight
+    int edgeWeight = -1;
+    for (auto& edge : a_edges)
+    {
+      if ((edge.m_f0 == v && edge.m_f1 == w) || (edge.m_f0 == w && edge.m_f1 == v))
+        edgeWeight = std::max(edgeWeight, edge.m_weight);
+    }
+    if (edgeWeight < 0)
+      return -1;
+    weight += edgeWeight;
+    ++a_cardinality;
+  }
+  return weight;
+} // iMatchingWeight
+
+} // namespace
+////////////////////////////////////////////////////////////////////////////////
+/// \class MeWeightMatcherUnitTests
+/// \brief Tests for MeWeightMatcher.
+////////////////////////////////////////////////////////////////////////////////
+//------------------------------------------------------------------------------
+/// \brief Test VecIntPy class.
+//------------------------------------------------------------------------------
+void MeWeightMatcherUnitTests::testPythonVectors()
+{
+  VecInt vals = {1, 5, -1, 1, 2, 3, 4};
+  VecIntPy values(vals);
+  TS_ASSERT_EQUALS(4, values.back());
+  TS_ASSERT_EQUALS(3, values[-2]);
+
+  auto min = values.min();
+  TS_ASSERT_EQUALS(-1, min);
+
+  min = values.min(1, 3);
+  TS_ASSERT_EQUALS(-1, min);
+
+  auto max = values.max();
+  TS_ASSERT_EQUALS(5, max);
+
+  max = values.max(2, 6);
+  TS_ASSERT_EQUALS(3, max);
+
+  values.rotate(4);
+  VecInt expected = {2, 3, 4, 1, 5, -1, 1};
+  TS_ASSERT_EQUALS(expected, values.ToVecInt());
+
+  auto index = values.index(1);
+  TS_ASSERT_EQUALS(3, index);
+
+  values.resize_to_count(7);
+  expected = {0, 1, 2, 3, 4, 5, 6};
+  TS_ASSERT_EQUALS(expected, values.ToVecInt());
+
+  values.resize_to_count(4, 5);
+  expected = {5, 6, 7, 8};
+  TS_ASSERT_EQUALS(expected, values.ToVecInt());
+
+  values.reverse();
+  expected = {8, 7, 6, 5};
+  TS_ASSERT_EQUALS(expected, values.ToVecInt());
+} // MeWeightMatcherUnitTests::testPythonVectors
+//------------------------------------------------------------------------------
+/// \brief Test empty input graph.
+//------------------------------------------------------------------------------
+void MeWeightMatcherUnitTests::test10_empty()
+{
+#ifdef DEBUG
+  printf("test10_empty\n\n");
+#endif
+  TS_ASSERT_MATCH_WEIGHTS({}, {}, false);
+} // MeWeightMatcherUnitTests::test10_empty
+//------------------------------------------------------------------------------
+/// \brief Test single edge.
+//------------------------------------------------------------------------------
+void MeWeightMatcherUnitTests::test11_singleedge()
+{
+#ifdef DEBUG
+  printf("test11_singleedge\n\n");
+#endif
+  VecInt2d edges = {{0, 1, 1}};
+  VecInt expected = {1, 0};
+  TS_ASSERT_MATCH_WEIGHTS(expected, edges, false);
+} // MeWeightMatcherUnitTests::test11_singleedge
+//------------------------------------------------------------------------------
+/// \brief Test with two edges.
+//------------------------------------------------------------------------------
+void MeWeightMatcherUnitTests::test12()
+{
+#ifdef DEBUG
+  printf("test12\n\n");
+#endif
+  VecInt2d edges = {{1, 2, 10}, {2, 3, 11}};
+  VecInt expected = {-1, -1, 3, 2};
+  TS_ASSERT_MATCH_WEIGHTS(expected, edges, false);
+} // MeWeightMatcherUnitTests::test12
+//------------------------------------------------------------------------------
+/// \brief Test with three edges.
+//------------------------------------------------------------------------------
+void MeWeightMatcherUnitTests::test13()
+{
+#ifdef DEBUG
+  printf("test13\n\n");
+#endif
+  VecInt2d edges = {{1, 2, 5}, {2, 3, 11}, {3, 4, 5}};
+  VecInt expected = {-1, -1, 3, 2, -1};
+  TS_ASSERT_MATCH_WEIGHTS(expected, edges, false);
+} // MeWeightMatcherUnitTests::test13
+//------------------------------------------------------------------------------
+/// \brief Test maximum cardinality.
+//------------------------------------------------------------------------------
+void MeWeightMatcherUnitTests::test14_maxcard()
+{
+#ifdef DEBUG
+  printf("test14_maxcard\n\n");
+#endif
+  VecInt2d edges = {{1, 2, 5}, {2, 3, 11}, {3, 4, 5}};
+  VecInt expected = {-1, 2, 1, 4, 3};
+  TS_ASSERT_MATCH_WEIGHTS(expected, edges, true);
+} // MeWeightMatcherUnitTests::test14_maxcard
+//------------------------------------------------------------------------------
+/// \brief Test negative weights.
+//------------------------------------------------------------------------------
+void MeWeightMatcherUnitTests::test16_negative()
+{
+#ifdef DEBUG
+  printf("test16_negative\n\n");
+#endif
+  VecInt2d edges = {{1, 2, 2}, {1, 3, -2}, {2, 3, 1}, {2, 4, -1}, {3, 4, -6}};
+  VecInt expected = {-1, 2, 1, -1, -1};
+  TS_ASSERT_MATCH_WEIGHTS(expected, edges, false);
+#ifdef DEBUG
+  printf("test16_negative-true\n\n");
+#endif
   expected = {-1, 3, 4, 1, 2};
   TS_ASSERT_MATCH_WEIGHTS(expected, edges, true);
 } // MeWeightMatcherUnitTests::test16_negative
@@ -2284,5 +3633,92 @@ void MeWeightMatcherUnitTests::testComplexQuad()
   TS_ASSERT_MATCH_WEIGHTS(expected, edges, false);
   TS_ASSERT_MATCH_WEIGHTS(expected, edges, true);
 } // MeWeightMatcherUnitTests::testComplexQuad
+//------------------------------------------------------------------------------
+/// \brief Test the fast matcher finds matchings with the same weight and
+/// cardinality as the python port on generated graphs.
+//------------------------------------------------------------------------------
+void MeWeightMatcherUnitTests::testFastMatcherRandomGraphs()
+{
+  unsigned int seed = 1;
+  auto random = [&](int a_max) {
+    seed = seed * 1103515245 + 12345;
+    return (int)((seed >> 16) % a_max);
+  };
+  for (int graph = 0; graph < 300; ++graph)
+  {
+    int numVertices = 4 + random(40);
+    int numEdges = numVertices + random(3 * numVertices);
+    // few distinct weights make many ties and blossoms
+    int maxWeight = graph % 2 ? 4 : 100;
+    VecMeEdge edges;
+    for (int i = 0; i < numEdges; ++i)
+    {
+      int f0 = random(numVertices);
+      int f1 = random(numVertices);
+      if (f0 != f1)
+        edges.push_back(MeEdge(f0, f1, random(maxWeight)));
+    }
+
+    for (int maxCardinality = 0; maxCardinality < 2; ++maxCardinality)
+    {
+      MeWeightMatcherImpl weightMatcher;
+      MeFastWeightMatcherImpl fastMatcher;
+      VecInt mates = weightMatcher.MatchWeights(edges, maxCardinality != 0);
+      VecInt fastMates = fastMatcher.MatchWeights(edges, maxCardinality != 0);
+      TS_ASSERT_EQUALS(mates.size(), fastMates.size());
+      int cardinality, fastCardinality;
+      int weight = iMatchingWeight(edges, mates, cardinality);
+      int fastWeight = iMatchingWeight(edges, fastMates, fastCardinality);
+      TS_ASSERT_EQUALS(weight, fastWeight);
+      if (maxCardinality)
+      {
+        TS_ASSERT_EQUALS(cardinality, fastCardinality);
+      }
+    }
+  }
+} // MeWeightMatcherUnitTests::testFastMatcherRandomGraphs
+//------------------------------------------------------------------------------
+/// \brief Test the approximate matcher improves the greedy matching and is
+/// within half of the maximum weight on generated graphs.
+//------------------------------------------------------------------------------
+void MeWeightMatcherUnitTests::testApproximateMatcher()
+{
+  // greedy takes the heaviest edge 1-2 and augmenting replaces it with 0-1
+  // and 2-3
+  VecMeEdge path = {{0, 1, 2}, {1, 2, 3}, {2, 3, 2}};
+  MeApproxWeightMatcherImpl approxMatcher;
+  VecInt expected = {1, 0, 3, 2};
+  TS_ASSERT_EQUALS_VEC(expected, approxMatcher.MatchWeights(path, false));
+  TS_ASSERT_EQUALS(5.0, MeWeightMatcher::WeightUpperBound(path));
+
+  unsigned int seed = 7;
+  auto random = [&](int a_max) {
+    seed = seed * 1103515245 + 12345;
+    return (int)((seed >> 16) % a_max);
+  };
+  for (int graph = 0; graph < 300; ++graph)
+  {
+    int numVertices = 4 + random(40);
+    int numEdges = numVertices + random(3 * numVertices);
+    VecMeEdge edges;
+    for (int i = 0; i < numEdges; ++i)
+    {
+      int f0 = random(numVertices);
+      int f1 = random(numVertices);
+      if (f0 != f1)
+        edges.push_back(MeEdge(f0, f1, random(100)));
+    }
+
+    MeFastWeightMatcherImpl fastMatcher;
+    VecInt mates = fastMatcher.MatchWeights(edges, false);
+    VecInt approxMates = approxMatcher.MatchWeights(edges, false);
+    int cardinality, approxCardinality;
+    int weight = iMatchingWeight(edges, mates, cardinality);
+    int approxWeight = iMatchingWeight(edges, approxMates, approxCardinality);
+    TS_ASSERT(approxWeight <= weight);
+    TS_ASSERT(2 * approxWeight >= weight);
+    TS_ASSERT(weight <= MeWeightMatcher::WeightUpperBound(edges));
+  }
+} // MeWeightMatcherUnitTests::testApproximateMatcher
 
 #endif // CXX_TEST
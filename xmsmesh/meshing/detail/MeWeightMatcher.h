@@ -66,6 +66,8 @@ class MeWeightMatcher
 {
 public:
   static BSHP<MeWeightMatcher> New();
+  static BSHP<MeWeightMatcher> NewApproximate();
+  static double WeightUpperBound(const VecMeEdge& a_edges);
   MeWeightMatcher();
   virtual ~MeWeightMatcher();
 
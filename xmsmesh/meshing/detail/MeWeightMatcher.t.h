@@ -45,6 +45,8 @@ public:
   void testSimpleTriangle();
   void testSimpleQuad();
   void testComplexQuad();
+  void testFastMatcherRandomGraphs();
+  void testApproximateMatcher();
 };
 
 //} // namespace xms
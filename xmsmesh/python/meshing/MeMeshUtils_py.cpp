@@ -206,6 +206,31 @@ void initMeMeshUtils(py::module &m) {
        return py::make_tuple(rval, errors);
      },generate_mesh_doc, py::arg("mesh_io"));
   // ---------------------------------------------------------------------------
+  // function: make_quad_mesh
+  // ---------------------------------------------------------------------------
+  const char* make_quad_mesh_doc = R"pydoc(
+      Turns the triangles of a generated mesh into quads and removes the bad
+      quads without building a UGrid in between.
+
+      Args:
+          mesh_io (:class:`MultiPolyMesherIo <xmsmesh.meshing.MultiPolyMesherIo>`): A generated triangle mesh. The points and cells are replaced by the quad mesh.
+          max_aspect (float, optional): The maximum aspect ratio for the diagonals of a quad.
+          split_boundary_points (bool, optional): Split boundary points to make quads from unmatched boundary triangles.
+          use_angle (bool, optional): Use the angle instead of the distance to compute the interior edge cost.
+
+      Returns:
+        tuple: true if the quad mesh was made successfully false otherwise, and a string of messages.
+  )pydoc";
+    modMeshUtils.def("make_quad_mesh",
+     [](xms::MeMultiPolyMesherIo &mesh_io, double max_aspect, bool split_boundary_points,
+        bool use_angle) -> py::iterable
+     {
+       bool rval = xms::meMakeQuadMesh(mesh_io, max_aspect, split_boundary_points, use_angle);
+       std::string errors = xms::XmLog::Instance().GetAndClearStackStr();
+       return py::make_tuple(rval, errors);
+     },make_quad_mesh_doc, py::arg("mesh_io"), py::arg("max_aspect")=0.7,
+       py::arg("split_boundary_points")=true, py::arg("use_angle")=false);
+  // ---------------------------------------------------------------------------
   // function: generate_2dm
   // ---------------------------------------------------------------------------
     const char* generate_2dm_doc = R"pydoc(
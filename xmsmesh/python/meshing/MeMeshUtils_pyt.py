@@ -316,6 +316,37 @@ class TestMeshUtils(unittest.TestCase):
         self.assertTrue(status)
         self.assertEqual(error, '')
 
+    def test_make_quad_mesh(self):
+        outside_poly = [
+            (0, 10, 0), (0, 20, 0), (0, 30, 0), (0, 40, 0), (0, 50, 0), (0, 60, 0), (0, 70, 0), (0, 80, 0),
+            (0, 90, 0), (0, 100, 0), (10, 100, 0), (20, 100, 0), (30, 100, 0), (40, 100, 0), (50, 100, 0), (60, 100, 0),
+            (70, 100, 0), (80, 100, 0), (90, 100, 0), (100, 100, 0), (100, 90, 0), (100, 80, 0), (100, 70, 0),
+            (100, 60, 0), (100, 50, 0), (100, 40, 0), (100, 30, 0), (100, 20, 0), (100, 10, 0), (100, 0, 0),
+            (90, 0, 0), (80, 0, 0), (70, 0, 0), (60, 0, 0), (50, 0, 0), (40, 0, 0), (30, 0, 0), (20, 0, 0), (10, 0, 0),
+            (0, 0, 0)
+        ]
+        input_poly = PolyInput(outside_poly, [])
+        input = MultiPolyMesherIo(())
+        input.poly_inputs = [input_poly]
+        status, error = mesh_utils.generate_mesh(input)
+        self.assertTrue(status)
+        status, error = mesh_utils.make_quad_mesh(input)
+        self.assertTrue(status)
+        self.assertEqual(error, '')
+        cells = input.cells
+        num_quads = 0
+        i = 0
+        while i < len(cells):
+            self.assertTrue(cells[i] in (5, 9))
+            if cells[i] == 9:
+                num_quads += 1
+            i += cells[i + 1] + 2
+        self.assertTrue(num_quads > 0)
+
+        # the cells are no longer all triangles
+        status, error = mesh_utils.make_quad_mesh(input)
+        self.assertFalse(status)
+
     def test_generate_2dm(self):
         io = MultiPolyMesherIo(())
         _ = mesh_utils.generate_2dm(io, "fname.2dm")
@@ -19,6 +19,7 @@
 
 #include <xmsmesh/python/meshing/meshing_py.h>
 #include <xmsmesh/meshing/MeMultiPolyMesherIo.h>
+#include <xmsmesh/meshing/detail/MeStageTimer.h>
 
 //----- Namespace declaration --------------------------------------------------
 namespace py = pybind11;
@@ -84,6 +85,67 @@ void initMeMultiPolyMesherIo(py::module &m) {
         &xms::MeMultiPolyMesherIo::m_returnCellPolygons, 
         return_cell_polygons_doc);
     // ---------------------------------------------------------------------------
+    // function: num_threads
+    // ---------------------------------------------------------------------------
+    const char* num_threads_doc = R"pydoc(
+        Number of threads used to mesh the polygons. 1 (the default) meshes the
+        polygons one after another. 0 uses one thread per hardware core.
+        Threads that are not needed for other polygons help pave a polygon. The
+        resulting mesh is the same regardless of the number of threads.
+    )pydoc";
+    polyMesherIo.def_readwrite("num_threads", &xms::MeMultiPolyMesherIo::m_numThreads,
+        num_threads_doc);
+    // ---------------------------------------------------------------------------
+    // function: parallel_relax
+    // ---------------------------------------------------------------------------
+    const char* parallel_relax_doc = R"pydoc(
+        If True, the mesh points are relaxed in color classes so threads that
+        are not needed for other polygons help relax a polygon. The mesh
+        differs slightly from False (the default) but it is the same
+        regardless of the number of threads.
+    )pydoc";
+    polyMesherIo.def_readwrite("parallel_relax", &xms::MeMultiPolyMesherIo::m_parallelRelax,
+        parallel_relax_doc);
+    // ---------------------------------------------------------------------------
+    // function: return_relax_metrics
+    // ---------------------------------------------------------------------------
+    const char* return_relax_metrics_doc = R"pydoc(
+        If True, the relax_metrics list will be filled when meshing occurs.
+    )pydoc";
+    polyMesherIo.def_readwrite("return_relax_metrics",
+        &xms::MeMultiPolyMesherIo::m_returnRelaxMetrics,
+        return_relax_metrics_doc);
+    // ---------------------------------------------------------------------------
+    // function: merge_tolerance
+    // ---------------------------------------------------------------------------
+    const char* merge_tolerance_doc = R"pydoc(
+        Points on the boundaries of neighboring polygons that are within this
+        xy distance of each other are merged into one point. 0 (the default)
+        only merges points with the same x and y.
+    )pydoc";
+    polyMesherIo.def_readwrite("merge_tolerance", &xms::MeMultiPolyMesherIo::m_mergeTolerance,
+        merge_tolerance_doc);
+    // ---------------------------------------------------------------------------
+    // function: return_stats
+    // ---------------------------------------------------------------------------
+    const char* return_stats_doc = R"pydoc(
+        If True, the poly_stats list will be filled when meshing occurs.
+        Nothing is timed or counted when False (the default).
+    )pydoc";
+    polyMesherIo.def_readwrite("return_stats", &xms::MeMultiPolyMesherIo::m_returnStats,
+        return_stats_doc);
+    // ---------------------------------------------------------------------------
+    // function: trace_file
+    // ---------------------------------------------------------------------------
+    const char* trace_file_doc = R"pydoc(
+        If not empty, a timeline of meshing is written to this file as trace
+        event JSON that can be loaded in a trace viewer such as chrome://tracing
+        or Perfetto. There is a span for each polygon and for each paving
+        iteration and stage within it, with one lane per thread.
+    )pydoc";
+    polyMesherIo.def_readwrite("trace_file", &xms::MeMultiPolyMesherIo::m_traceFile,
+        trace_file_doc);
+    // ---------------------------------------------------------------------------
     // function: points
     // ---------------------------------------------------------------------------
     const char* points_doc = R"pydoc(
@@ -124,6 +186,65 @@ void initMeMultiPolyMesherIo(py::module &m) {
                 self.m_cellPolygons = *xms::VecIntFromPyIter(cell_polygons);
             },cell_polygons_doc);
     // ---------------------------------------------------------------------------
+    // function: relax_metrics
+    // ---------------------------------------------------------------------------
+    const char* relax_metrics_doc = R"pydoc(
+        The relaxation iterations of each PolyInput. Each iteration is a tuple of
+        (max_move, mean_move, min_quality, mean_quality). The quality of a
+        triangle is 1 for an equilateral triangle and goes to 0 as it flattens.
+        (Populated by meshing functions when return_relax_metrics is True)
+    )pydoc";
+    polyMesherIo.def_property_readonly("relax_metrics",
+            [](xms::MeMultiPolyMesherIo &self) -> py::iterable {
+                py::tuple ret_tuple(self.m_relaxMetrics.size());
+                for (size_t i = 0; i < self.m_relaxMetrics.size(); ++i) {
+                    const std::vector<xms::MeRelaxIteration>& metrics = self.m_relaxMetrics[i];
+                    py::tuple poly_tuple(metrics.size());
+                    for (size_t j = 0; j < metrics.size(); ++j) {
+                        poly_tuple[j] = py::make_tuple(metrics[j].m_maxMove, metrics[j].m_meanMove,
+                                                       metrics[j].m_minQuality, metrics[j].m_meanQuality);
+                    }
+                    ret_tuple[i] = poly_tuple;
+                }
+                return ret_tuple;
+            },relax_metrics_doc);
+    // ---------------------------------------------------------------------------
+    // function: poly_stats
+    // ---------------------------------------------------------------------------
+    const char* poly_stats_doc = R"pydoc(
+        The time and counts of meshing each PolyInput. Each is a dict with
+        'seconds' and 'calls' dicts keyed by stage name (generate_mesh_pts,
+        do_pave, clean_pave, redistribute_pts, classify_polys, triangulate,
+        find_poly_point_idxs, fix_four_triangle_pts, add_breaklines,
+        delete_outside_tris, relax) and the counts 'num_rings',
+        'num_mesh_pts', 'max_pave_stack' and 'max_pave_poly_pts'. The paving
+        stages are part of generate_mesh_pts.
+        (Populated by meshing functions when return_stats is True)
+    )pydoc";
+    polyMesherIo.def_property_readonly("poly_stats",
+            [](xms::MeMultiPolyMesherIo &self) -> py::iterable {
+                py::tuple ret_tuple(self.m_polyStats.size());
+                for (size_t i = 0; i < self.m_polyStats.size(); ++i) {
+                    const xms::MePolyMeshStats& stats = self.m_polyStats[i];
+                    py::dict seconds, calls;
+                    for (int j = 0; j < xms::MePolyMeshStats::NUM_STAGES; ++j) {
+                        const char* name =
+                          xms::mePolyMeshStageName((xms::MePolyMeshStats::Stage)j);
+                        seconds[name] = stats.m_seconds[j];
+                        calls[name] = stats.m_calls[j];
+                    }
+                    py::dict poly_dict;
+                    poly_dict["seconds"] = seconds;
+                    poly_dict["calls"] = calls;
+                    poly_dict["num_rings"] = stats.m_numRings;
+                    poly_dict["num_mesh_pts"] = stats.m_numMeshPts;
+                    poly_dict["max_pave_stack"] = stats.m_maxPaveStack;
+                    poly_dict["max_pave_poly_pts"] = stats.m_maxPavePolyPts;
+                    ret_tuple[i] = poly_dict;
+                }
+                return ret_tuple;
+            },poly_stats_doc);
+    // ---------------------------------------------------------------------------
     // function: poly_inputs
     // ---------------------------------------------------------------------------
     const char* poly_inputs_doc = R"pydoc(
@@ -187,6 +308,12 @@ void initMeMultiPolyMesherIo(py::module &m) {
         std::string offOn[2] = {"False", "True"};
         ss << "Check Topology: " << offOn[(int)self.m_checkTopology] << "\n";
         ss << "Return Cell Polygons: " << offOn[(int)self.m_returnCellPolygons] << "\n";
+        ss << "Num Threads: " << self.m_numThreads << "\n";
+        ss << "Parallel Relax: " << offOn[(int)self.m_parallelRelax] << "\n";
+        ss << "Return Relax Metrics: " << offOn[(int)self.m_returnRelaxMetrics] << "\n";
+        ss << "Merge Tolerance: " << self.m_mergeTolerance << "\n";
+        ss << "Return Stats: " << offOn[(int)self.m_returnStats] << "\n";
+        ss << "Trace File: " << self.m_traceFile << "\n";
         return ss.str();
     });
 }
@@ -402,11 +529,49 @@ void initMePolyInput(py::module &m) {
     // ---------------------------------------------------------------------------
     const char* relaxation_method_doc = R"pydoc(
         Relaxation method. The default relaxation method is an area
-        relax. Set the value to "spring_relaxation". See MeRelaxer.cpp for
-        details on spring relaxation.
+        relax. Set the value to "spring_relaxation" or "odt_relaxation". See
+        MeRelaxer.cpp for details on spring and optimal Delaunay relaxation.
     )pydoc";
     polyInput.def_readwrite("relaxation_method",
       &xms::MePolyInput::m_relaxationMethod,relaxation_method_doc);
+    // ---------------------------------------------------------------------------
+    // property: size_from_poly_tolerance
+    // ---------------------------------------------------------------------------
+    const char* size_from_poly_tolerance_doc = R"pydoc(
+        Tolerance for approximating the size function that is created from
+        the spacing of the polygon points when size_function is not set.
+        Larger values are faster and less accurate. The relative error of
+        the sizes is less than the tolerance. The default of 0 is exact.
+    )pydoc";
+    polyInput.def_readwrite("size_from_poly_tolerance",
+      &xms::MePolyInput::m_sizeFromPolyTolerance,size_from_poly_tolerance_doc);
+    // ---------------------------------------------------------------------------
+    // property: relax_max_iterations
+    // ---------------------------------------------------------------------------
+    const char* relax_max_iterations_doc = R"pydoc(
+        Most relaxation iterations. The default is 3.
+    )pydoc";
+    polyInput.def_readwrite("relax_max_iterations",
+      &xms::MePolyInput::m_relaxMaxIterations,relax_max_iterations_doc);
+    // ---------------------------------------------------------------------------
+    // property: relax_tolerance
+    // ---------------------------------------------------------------------------
+    const char* relax_tolerance_doc = R"pydoc(
+        Relaxation stops when an iteration changes the average triangle
+        quality by less than this. The default of 0 always does
+        relax_max_iterations iterations.
+    )pydoc";
+    polyInput.def_readwrite("relax_tolerance",
+      &xms::MePolyInput::m_relaxTolerance,relax_tolerance_doc);
+    // ---------------------------------------------------------------------------
+    // property: relax_time_limit
+    // ---------------------------------------------------------------------------
+    const char* relax_time_limit_doc = R"pydoc(
+        Relaxation stops after the iteration that uses up this many seconds.
+        The default of 0 has no time limit.
+    )pydoc";
+    polyInput.def_readwrite("relax_time_limit",
+      &xms::MePolyInput::m_relaxTimeLimit,relax_time_limit_doc);
     // -------------------------------------------------------------------------
     // function: __str__
     // -------------------------------------------------------------------------
@@ -36,6 +36,14 @@ class TestMultiPolyMesherIo(unittest.TestCase):
         self.assertIsInstance(io, MultiPolyMesherIo)
         self.assertEqual(False, io.check_topology)
         self.assertEqual(True, io.return_cell_polygons)
+        self.assertEqual(1, io.num_threads)
+        self.assertEqual(False, io.parallel_relax)
+        self.assertEqual(False, io.return_relax_metrics)
+        self.assertEqual(0.0, io.merge_tolerance)
+        self.assertEqual(False, io.return_stats)
+        self.assertEqual('', io.trace_file)
+        self.assertEqual(0, len(io.relax_metrics))
+        self.assertEqual(0, len(io.poly_stats))
         self.assertEqual(0, len(io.points))
         self.assertEqual(0, len(io.cells))
         self.assertEqual(0, len(io.cell_polygons))
@@ -52,6 +60,24 @@ class TestMultiPolyMesherIo(unittest.TestCase):
         io.return_cell_polygons = False
         self.assertEqual(False, io.return_cell_polygons)
 
+        io.num_threads = 4
+        self.assertEqual(4, io.num_threads)
+
+        io.parallel_relax = True
+        self.assertEqual(True, io.parallel_relax)
+
+        io.return_relax_metrics = True
+        self.assertEqual(True, io.return_relax_metrics)
+
+        io.merge_tolerance = 1e-6
+        self.assertEqual(1e-6, io.merge_tolerance)
+
+        io.return_stats = True
+        self.assertEqual(True, io.return_stats)
+
+        io.trace_file = 'mesh_trace.json'
+        self.assertEqual('mesh_trace.json', io.trace_file)
+
         points = ((1, 1, 2), (1, 2, 3), (2, 3, 4), (3, 4, 5))
         io.points = points
         self.assertArraysEqual(points, io.points)
@@ -186,6 +212,22 @@ class TestPolyInput(unittest.TestCase):
         pi.relaxation_method = relaxation_method
         self.assertEqual(relaxation_method, pi.relaxation_method)
 
+        self.assertEqual(0.0, pi.size_from_poly_tolerance)
+        pi.size_from_poly_tolerance = 1e-3
+        self.assertEqual(1e-3, pi.size_from_poly_tolerance)
+
+        self.assertEqual(3, pi.relax_max_iterations)
+        pi.relax_max_iterations = 20
+        self.assertEqual(20, pi.relax_max_iterations)
+
+        self.assertEqual(0.0, pi.relax_tolerance)
+        pi.relax_tolerance = 1e-3
+        self.assertEqual(1e-3, pi.relax_tolerance)
+
+        self.assertEqual(0.0, pi.relax_time_limit)
+        pi.relax_time_limit = 0.5
+        self.assertEqual(0.5, pi.relax_time_limit)
+
 class TestRefinePoint(unittest.TestCase):
     """Test RefinePoint functions."""
 
@@ -92,6 +92,20 @@ void initMePolyRedistributePts(py::module &m) {
         }, py::arg("out_poly"),
           py::arg("inside_polys"),py::arg("size_bias"));
     // -------------------------------------------------------------------------
+    // function: set_size_from_poly_tolerance
+    // -------------------------------------------------------------------------
+    const char* set_size_from_poly_tolerance_doc = R"pydoc(
+        Sets the tolerance used to approximate the size function created by
+        set_size_func_from_poly. Larger values are faster and less accurate.
+        The relative error of the sizes is less than the tolerance. The
+        default of 0 is exact.
+
+        Args:
+            tol (float): The tolerance. 0 for exact interpolation.
+    )pydoc";
+    polyRedistribute.def("set_size_from_poly_tolerance", &xms::MePolyRedistributePts::SetSizeFromPolyTolerance,
+          set_size_from_poly_tolerance_doc,py::arg("tol"));
+    // -------------------------------------------------------------------------
     // function: set_constant_size_func
     // -------------------------------------------------------------------------
     const char* set_constant_size_func_doc = R"pydoc(
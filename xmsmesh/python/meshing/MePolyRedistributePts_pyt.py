@@ -54,6 +54,18 @@ class TestPolyRedistributePts(unittest.TestCase):
         r.set_size_func_from_poly(out_poly, in_polys, size_bias)
         # TODO: No way to test if there size function was set correctly
 
+    def test_set_size_from_poly_tolerance(self):
+        out_poly = ((0, 0, 0), (0, 10, 0), (10, 10, 0), (10, 0, 0))
+        in_polys = ()
+        exact = PolyRedistributePts()
+        exact.set_size_func_from_poly(out_poly, in_polys, 1.0)
+        r = PolyRedistributePts()
+        r.set_size_from_poly_tolerance(1e-3)
+        r.set_size_func_from_poly(out_poly, in_polys, 1.0)
+        poly_line = ((0, 0, 0), (5, 0, 0), (10, 0, 0))
+        np.testing.assert_array_almost_equal(exact.redistribute(poly_line),
+                                             r.redistribute(poly_line))
+
     def test_constant_size_func(self):
         r = PolyRedistributePts()
         r.set_constant_size_func(0.75)
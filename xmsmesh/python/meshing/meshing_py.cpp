@@ -61,7 +61,11 @@ std::string PyReprStringFromMePolyInput(const xms::MePolyInput& a_polyInput)
   ss << "remove_internal_four_triangle_pts: " << a_polyInput.m_removeInternalFourTrianglePts << "\n";
   ss << "poly_id: " << a_polyInput.m_polyId << "\n";
   ss << "seed_points: " << xms::StringFromVecPt3d(a_polyInput.m_seedPoints);
-  ss << "relaxation_method: " << a_polyInput.m_relaxationMethod;
+  ss << "relaxation_method: " << a_polyInput.m_relaxationMethod << "\n";
+  ss << "size_from_poly_tolerance: " << a_polyInput.m_sizeFromPolyTolerance << "\n";
+  ss << "relax_max_iterations: " << a_polyInput.m_relaxMaxIterations << "\n";
+  ss << "relax_tolerance: " << a_polyInput.m_relaxTolerance << "\n";
+  ss << "relax_time_limit: " << a_polyInput.m_relaxTimeLimit;
   return ss.str();
 } // PyReprStringFromMePolyInput
 
@@ -233,6 +233,64 @@ bool tutReadPolygons(const std::string& a_fname, VecPt3d2d& a_outside, VecPt3d3d
   return true;
 } // tutReadPolygons
 //------------------------------------------------------------------------------
+/// \brief  helper function to create a row of 100 by 100 square polygons.
+/// Square i goes from x = 100 * i to x = 100 * (i + 1).
+/// \param a_numPolys The number of squares.
+/// \param a_ptsPerSide The number of points on each side of a square. 1 gives
+/// just the corners.
+/// \param a_io The squares are added to MeMultiPolyMesherIo::m_polys.
+//------------------------------------------------------------------------------
+void tutSquarePolygons(int a_numPolys, int a_ptsPerSide, MeMultiPolyMesherIo& a_io)
+{
+  double step = 100.0 / a_ptsPerSide;
+  for (int i = 0; i < a_numPolys; ++i)
+  {
+    double x0 = i * 100.0, x1 = x0 + 100.0;
+    MePolyInput poly;
+    for (int j = 0; j < a_ptsPerSide; ++j)
+      poly.m_outPoly.push_back(Pt3d(x0, j * step, 0));
+    for (int j = 0; j < a_ptsPerSide; ++j)
+      poly.m_outPoly.push_back(Pt3d(x0 + j * step, 100, 0));
+    for (int j = a_ptsPerSide; j > 0; --j)
+      poly.m_outPoly.push_back(Pt3d(x1, j * step, 0));
+    for (int j = a_ptsPerSide; j > 0; --j)
+      poly.m_outPoly.push_back(Pt3d(x0 + j * step, 0, 0));
+    a_io.m_polys.push_back(poly);
+  }
+} // tutSquarePolygons
+//------------------------------------------------------------------------------
+/// \brief  helper function to create a grid of points 10 apart with the
+/// interior points moved a little. Each grid cell is split into 2 triangles.
+/// \param a_size The number of points in each direction.
+/// \param a_points The points. The point in row i and column j is
+/// i * a_size + j.
+/// \param a_triangles The triangles as 3 point indexes each.
+//------------------------------------------------------------------------------
+void tutJiggledGrid(int a_size, VecPt3d& a_points, VecInt& a_triangles)
+{
+  a_points.clear();
+  a_triangles.clear();
+  for (int i = 0; i < a_size; ++i)
+  {
+    for (int j = 0; j < a_size; ++j)
+    {
+      bool boundary = i == 0 || j == 0 || i == a_size - 1 || j == a_size - 1;
+      double dx = boundary ? 0 : ((i * 7 + j * 3) % 5 - 2) * 0.8;
+      double dy = boundary ? 0 : ((i * 3 + j * 5) % 5 - 2) * 0.8;
+      a_points.push_back(Pt3d(j * 10.0 + dx, i * 10.0 + dy, 0));
+    }
+  }
+  for (int i = 0; i < a_size - 1; ++i)
+  {
+    for (int j = 0; j < a_size - 1; ++j)
+    {
+      int p0 = i * a_size + j, p1 = p0 + 1, p2 = p1 + a_size, p3 = p0 + a_size;
+      int tris[] = {p0, p1, p2, p0, p2, p3};
+      a_triangles.insert(a_triangles.end(), &tris[0], &tris[6]);
+    }
+  }
+} // tutJiggledGrid
+//------------------------------------------------------------------------------
 /// \brief  helper function to generate 2dm file and compare to a baseline
 /// \param a_io mesher input
 /// \param a_fileBase base file name for output file and base line file
@@ -992,8 +1050,10 @@ void TutMeshingIntermediateTests::test_Example_QuadBlossom_BadQuadRemover()
   int nBoundaryEdges = quadBlossom->PreMakeQuads();
   TS_ASSERT((nBoundaryEdges & 0x1) == 0); 
 
-  // The MeQuadBlossom basic algorithm is O(N^3). Check the estimated minutes.  If too large,
-  // Then split the mesh into smaller sub-UGrids, then call MakeQuads on each one.
+  // The MeQuadBlossom run time grows about as N^1.6 and is about a minute for 500,000 points.
+  // Check the estimated minutes. If too large, split the mesh into subdomains with
+  // SetNumSubdomains or use SetApproximateMatching before calling MakeQuads.
+  // NumSubdomainsForRunTime gives the number of subdomains for a desired run time.
   double minutes = xms::MeQuadBlossom::EstimatedRunTimeInMinutes(ugrid->GetPointCount());
   TS_ASSERT(minutes < 2.0);
 
@@ -25,6 +25,8 @@ class MeMultiPolyMesherIo;
 
 bool tutReadMeshIoFromFile(const std::string& a_fname, MeMultiPolyMesherIo& a_io);
 bool tutReadPolygons(const std::string& a_fname, VecPt3d2d& a_outside, VecPt3d3d& a_inside);
+void tutSquarePolygons(int a_numPolys, int a_ptsPerSide, MeMultiPolyMesherIo& a_io);
+void tutJiggledGrid(int a_size, VecPt3d& a_points, VecInt& a_triangles);
 } // namespace xms
 
 /// \brief Class for testing meshing functionality